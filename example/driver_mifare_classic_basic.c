@@ -36,8 +36,7 @@
 
 #include "driver_mifare_classic_basic.h"
 
-static mifare_classic_handle_t gs_handle;        /**< mifare_classic handle */
-static uint8_t gs_id[4];                         /**< local id */
+static mifare_classic_basic_t gs_basic;        /**< default basic instance */
 
 /**
  * @brief     interface print format data
@@ -52,30 +51,49 @@ static void s_debug_print(const char *const fmt, ...)
 }
 
 /**
- * @brief  basic example init
- * @return status code
- *         - 0 success
- *         - 1 init failed
- * @note   none
+ * @brief     basic example authentication with the recovery
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of authentication
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 authentication failed
+ * @note      a failed authentication drops the card to idle, so it is reselected at once
+ *            with the cached uid and the next key can be tried without a search
  */
-uint8_t mifare_classic_basic_init(void)
+static uint8_t a_basic_authentication(mifare_classic_basic_t *basic, uint8_t block,
+                                      mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     
-    /* link function */
-    DRIVER_MIFARE_CLASSIC_LINK_INIT(&gs_handle, mifare_classic_handle_t);
-    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(&gs_handle, mifare_classic_interface_contactless_init);
-    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(&gs_handle, mifare_classic_interface_contactless_deinit);
-    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(&gs_handle, mifare_classic_interface_contactless_transceiver);
-    DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&gs_handle, mifare_classic_interface_delay_ms);
-#ifndef NO_DEBUG
-    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_handle, mifare_classic_interface_debug_print);
-#else
-    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_handle, s_debug_print);
-#endif
+    /* authentication */
+    res = mifare_classic_authentication(&basic->handle, basic->id, block, key_type, key);
+    if (res != 0)
+    {
+        /* reselect */
+        (void)mifare_classic_reselect(&basic->handle, basic->id);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     basic example init of a linked instance
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      the handle of the instance must be linked
+ */
+static uint8_t a_basic_init(mifare_classic_basic_t *basic)
+{
+    uint8_t res;
     
     /* init */
-    res = mifare_classic_init(&gs_handle);
+    res = mifare_classic_init(&basic->handle);
     if (res != 0)
     {
         mifare_classic_interface_debug_print("mifare_classic: init failed.\n");
@@ -83,9 +101,56 @@ uint8_t mifare_classic_basic_init(void)
         return 1;
     }
     
+    /* skip the authentication of an already open sector */
+    res = mifare_classic_set_auth_cache(&basic->handle, MIFARE_CLASSIC_BOOL_TRUE);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set auth cache failed.\n");
+        (void)mifare_classic_deinit(&basic->handle);
+        
+        return 1;
+    }
+    
+    /* aggressive polling after a card leaves, back off to the default delay when idle */
+    res = mifare_classic_poll_init(&basic->poll, MIFARE_CLASSIC_POLL_MODE_ADAPTIVE,
+                                   MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_FAST_DELAY_MS,
+                                   MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_DELAY_MS,
+                                   MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_FAST_PERIOD_MS);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: poll init failed.\n");
+        (void)mifare_classic_deinit(&basic->handle);
+        
+        return 1;
+    }
+    
     return 0;
 }
 
+/**
+ * @brief  basic example init
+ * @return status code
+ *         - 0 success
+ *         - 1 init failed
+ * @note   none
+ */
+uint8_t mifare_classic_basic_init(void)
+{
+    /* link function */
+    DRIVER_MIFARE_CLASSIC_LINK_INIT(&gs_basic.handle, mifare_classic_handle_t);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(&gs_basic.handle, mifare_classic_interface_contactless_init);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(&gs_basic.handle, mifare_classic_interface_contactless_deinit);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(&gs_basic.handle, mifare_classic_interface_contactless_transceiver);
+    DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&gs_basic.handle, mifare_classic_interface_delay_ms);
+#ifndef NO_DEBUG
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_basic.handle, mifare_classic_interface_debug_print);
+#else
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_basic.handle, s_debug_print);
+#endif
+    
+    return a_basic_init(&gs_basic);
+}
+
 /**
  * @brief  basic example deinit
  * @return status code
@@ -94,11 +159,367 @@ uint8_t mifare_classic_basic_init(void)
  * @note   none
  */
 uint8_t mifare_classic_basic_deinit(void)
+{
+    return mifare_classic_basic_deinit_r(&gs_basic);
+}
+
+/**
+ * @brief  basic example halt
+ * @return status code
+ *         - 0 success
+ *         - 1 halt failed
+ * @note   none
+ */
+uint8_t mifare_classic_basic_halt(void)
+{
+    return mifare_classic_basic_halt_r(&gs_basic);
+}
+
+/**
+ * @brief  basic example wake up
+ * @return status code
+ *         - 0 success
+ *         - 1 wake up failed
+ * @note   none
+ */
+uint8_t mifare_classic_basic_wake_up(void)
+{
+    return mifare_classic_basic_wake_up_r(&gs_basic);
+}
+
+/**
+ * @brief      basic example search
+ * @param[out] *type pointer to a type buffer
+ * @param[out] *id pointer to an id buffer
+ * @param[in]  timeout check times
+ * @return     status code
+ *             - 0 success
+ *             - 1 timeout
+ * @note       the delay between two polls adapts to the poll mode,
+ *             id is the authentication id and a 7 bytes uid is read by mifare_classic_basic_get_uid
+ */
+uint8_t mifare_classic_basic_search(mifare_classic_type_t *type, uint8_t id[4], int32_t timeout)
+{
+    return mifare_classic_basic_search_r(&gs_basic, type, id, timeout);
+}
+
+/**
+ * @brief      basic example get the uid of the found card
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 get uid failed
+ * @note       the uid has 4 or 7 bytes
+ */
+uint8_t mifare_classic_basic_get_uid(mifare_classic_uid_t *uid)
+{
+    return mifare_classic_basic_get_uid_r(&gs_basic, uid);
+}
+
+/**
+ * @brief     basic example set the search poll mode
+ * @param[in] mode poll mode
+ * @return    status code
+ *            - 0 success
+ *            - 1 set poll mode failed
+ * @note      MIFARE_CLASSIC_POLL_MODE_FIXED keeps the default delay between two polls
+ */
+uint8_t mifare_classic_basic_set_poll_mode(mifare_classic_poll_mode_t mode)
+{
+    return mifare_classic_basic_set_poll_mode_r(&gs_basic, mode);
+}
+
+/**
+ * @brief      basic example get the search detection latency
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get latency failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_get_latency(uint32_t *last_ms, uint32_t *max_ms, uint32_t *avg_ms)
+{
+    return mifare_classic_basic_get_latency_r(&gs_basic, last_ms, max_ms, avg_ms);
+}
+
+/**
+ * @brief      basic example authentication with a keyring
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  block block of authentication
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 authentication failed
+ * @note       the found key can be passed to the other basic functions, the open session
+ *             saves their authentication
+ */
+uint8_t mifare_classic_basic_keyring_authentication(mifare_classic_keyring_t *ring, uint8_t block,
+                                                    mifare_classic_authentication_key_t *key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_keyring_authentication_r(&gs_basic, ring, block, key_type, key);
+}
+
+/**
+ * @brief      basic example read
+ * @param[in]  block block of read
+ * @param[out] *data pointer to a data buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
+                                  mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_read_r(&gs_basic, block, data, key_type, key);
+}
+
+/**
+ * @brief      basic example read all data blocks of a sector
+ * @param[in]  sector read sector
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read sector failed
+ * @note       the sector trailer is not read, data must hold 15 * 16 bytes for the large sectors of s70
+ */
+uint8_t mifare_classic_basic_read_sector(uint8_t sector, uint8_t *data, uint8_t *block_count,
+                                         mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_read_sector_r(&gs_basic, sector, data, block_count, key_type, key);
+}
+
+/**
+ * @brief     basic example write
+ * @param[in] block block of write
+ * @param[in] *data pointer to a data buffer
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_write(uint8_t block, uint8_t data[16],
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_write_r(&gs_basic, block, data, key_type, key);
+}
+
+/**
+ * @brief     basic example init as a value
+ * @param[in] block block of init
+ * @param[in] value inited value
+ * @param[in] addr address
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value init failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_init(uint8_t block, int32_t value, uint8_t addr,
+                                        mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_value_init_r(&gs_basic, block, value, addr, key_type, key);
+}
+
+/**
+ * @brief     basic example write value
+ * @param[in] block block of write
+ * @param[in] value written value
+ * @param[in] addr address
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value written failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_write(uint8_t block, int32_t value, uint8_t addr,
+                                         mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_value_write_r(&gs_basic, block, value, addr, key_type, key);
+}
+
+/**
+ * @brief      basic example read value
+ * @param[in]  block block of read
+ * @param[out] *value pointer to a read value buffer
+ * @param[out] *addr pointer to a read address buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 value read failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_value_read(uint8_t block, int32_t *value, uint8_t *addr,
+                                         mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_value_read_r(&gs_basic, block, value, addr, key_type, key);
+}
+
+/**
+ * @brief     basic example increment value
+ * @param[in] block block of increment
+ * @param[in] value increment value
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value increment failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_increment(uint8_t block, uint32_t value,
+                                             mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_value_increment_r(&gs_basic, block, value, key_type, key);
+}
+
+/**
+ * @brief     basic example decrement value
+ * @param[in] block block of decrement
+ * @param[in] value decrement value
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value decrement failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
+                                             mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    return mifare_classic_basic_value_decrement_r(&gs_basic, block, value, key_type, key);
+}
+
+/**
+ * @brief     basic example set the sector permission
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] sector set sector
+ * @param[in] *key_a pointer to a key a buffer
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 block3(block15) permission
+ * @param[in] user_data user data
+ * @param[in] *key_b pointer to a key b buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 set sector permission failed
+ * @note      block_0_0_4, block_1_5_9, block_2_10_14, permission(c1_c2_c3) definition is below
+ *            c1  c2  c3        read        write        increment        decrement/transfer/restore
+ *            0   0   0        keya|b       keya|b         keya|b                  keya|b
+ *            0   1   0        keya|b       never          never                   never
+ *            1   0   0        keya|b       keyb           never                   never
+ *            1   1   0        keya|b       keyb           keyb                    keya|b
+ *            0   0   1        keya|b       never          never                   keya|b
+ *            0   1   1        keyb         keyb           never                   never
+ *            1   0   1        keyb         never          never                   never
+ *            1   1   1        never        never          never                   never
+ *                                                                                      
+ *            block_3_15 permission(c1_c2_c3) definition is below
+ *            c1  c2  c3    keya_read    keya_write    access_read    access_write    keyb_read    keyb_write
+ *            0   0   0      never        keya            keya           never          keya          keya
+ *            0   1   0      never        never           keya           never          keya          never
+ *            1   0   0      never        keyb           keya|b          never          never         keyb
+ *            1   1   0      never        never          keya|b          never          never         never
+ *            0   0   1      never        keya            keya           keya           keya          keya
+ *            0   1   1      never        keyb           keya|b          keyb           never         keyb
+ *            1   0   1      never        never          keya|b          keyb           never         never
+ *            1   1   1      never        never          keya|b          never          never         never
+ */
+uint8_t mifare_classic_basic_set_permission(mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                            uint8_t sector, uint8_t key_a[6], uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                            uint8_t block_2_10_14, uint8_t block_3_15, uint8_t user_data, uint8_t key_b[6])
+{
+    return mifare_classic_basic_set_permission_r(&gs_basic, key_type, key, sector, key_a, block_0_0_4,
+                                                 block_1_5_9, block_2_10_14, block_3_15, user_data, key_b);
+}
+
+/**
+ * @brief      basic example get the sector permission
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  sector get sector
+ * @param[out] *block_0_0_4 pointer to a block0(block0-4) permission buffer
+ * @param[out] *block_1_5_9 pointer to a block1(block5-9) permission buffer
+ * @param[out] *block_2_10_14 pointer to a block2(block10-14) permission buffer
+ * @param[out] *block_3_15 pointer to a block3(block15) permission buffer
+ * @param[out] *user_data pointer to a user data buffer
+ * @param[out] *key_b pointer to a key b buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get sector permission failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_get_permission(mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                            uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                            uint8_t *block_2_10_14, uint8_t *block_3_15, uint8_t *user_data, uint8_t key_b[6])
+{
+    return mifare_classic_basic_get_permission_r(&gs_basic, key_type, key, sector, block_0_0_4, block_1_5_9,
+                                                 block_2_10_14, block_3_15, user_data, key_b);
+}
+
+/**
+ * @brief     basic example init of an instance
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] *context pointer to a user context
+ * @param[in] *contactless_init pointer to a contactless_init_ctx function address
+ * @param[in] *contactless_deinit pointer to a contactless_deinit_ctx function address
+ * @param[in] *contactless_transceiver pointer to a contactless_transceiver_ctx function address
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      context is passed to the callbacks, so one set of callbacks can drive several readers,
+ *            every instance has its own handle and can run in its own thread
+ */
+uint8_t mifare_classic_basic_init_r(mifare_classic_basic_t *basic, void *context,
+                                    uint8_t (*contactless_init)(void *context),
+                                    uint8_t (*contactless_deinit)(void *context),
+                                    uint8_t (*contactless_transceiver)(void *context, uint8_t *in_buf, uint8_t in_len,
+                                                                       uint8_t *out_buf, uint8_t *out_len))
+{
+    /* link function */
+    DRIVER_MIFARE_CLASSIC_LINK_INIT(&basic->handle, mifare_classic_handle_t);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(&basic->handle, context);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT_CTX(&basic->handle, contactless_init);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT_CTX(&basic->handle, contactless_deinit);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER_CTX(&basic->handle, contactless_transceiver);
+    DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&basic->handle, mifare_classic_interface_delay_ms);
+#ifndef NO_DEBUG
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&basic->handle, mifare_classic_interface_debug_print);
+#else
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&basic->handle, s_debug_print);
+#endif
+    
+    return a_basic_init(basic);
+}
+
+/**
+ * @brief     basic example deinit
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 deinit failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_deinit_r(mifare_classic_basic_t *basic)
 {
     uint8_t res;
     
     /* deinit */
-    res = mifare_classic_deinit(&gs_handle);
+    res = mifare_classic_deinit(&basic->handle);
     if (res != 0)
     {
         return 1;
@@ -108,18 +529,19 @@ uint8_t mifare_classic_basic_deinit(void)
 }
 
 /**
- * @brief  basic example halt
- * @return status code
- *         - 0 success
- *         - 1 halt failed
- * @note   none
+ * @brief     basic example halt
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 halt failed
+ * @note      none
  */
-uint8_t mifare_classic_basic_halt(void)
+uint8_t mifare_classic_basic_halt_r(mifare_classic_basic_t *basic)
 {
     uint8_t res;
     
     /* halt */
-    res = mifare_classic_halt(&gs_handle);
+    res = mifare_classic_halt(&basic->handle);
     if (res != 0)
     {
         return 1;
@@ -129,19 +551,20 @@ uint8_t mifare_classic_basic_halt(void)
 }
 
 /**
- * @brief  basic example wake up
- * @return status code
- *         - 0 success
- *         - 1 wake up failed
- * @note   none
+ * @brief     basic example wake up
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 wake up failed
+ * @note      none
  */
-uint8_t mifare_classic_basic_wake_up(void)
+uint8_t mifare_classic_basic_wake_up_r(mifare_classic_basic_t *basic)
 {
     uint8_t res;
     mifare_classic_type_t type;
     
     /* wake up */
-    res = mifare_classic_wake_up(&gs_handle, &type);
+    res = mifare_classic_wake_up(&basic->handle, &type);
     if (res != 0)
     {
         return 1;
@@ -152,67 +575,141 @@ uint8_t mifare_classic_basic_wake_up(void)
 
 /**
  * @brief      basic example search
+ * @param[in]  *basic pointer to a basic instance structure
  * @param[out] *type pointer to a type buffer
  * @param[out] *id pointer to an id buffer
  * @param[in]  timeout check times
  * @return     status code
  *             - 0 success
  *             - 1 timeout
+ * @note       the delay between two polls adapts to the poll mode,
+ *             id is the authentication id and a 7 bytes uid is read by mifare_classic_basic_get_uid_r
+ */
+uint8_t mifare_classic_basic_search_r(mifare_classic_basic_t *basic, mifare_classic_type_t *type, uint8_t id[4],
+                                      int32_t timeout)
+{
+    uint8_t res;
+    
+    /* poll */
+    res = mifare_classic_poll_search(&basic->handle, &basic->poll, type, &basic->uid, timeout);
+    if (res != 0)
+    {
+        return 1;
+    }
+    
+    /* the authentication uses 4 bytes of the uid */
+    res = mifare_classic_uid_to_id(&basic->uid, basic->id);
+    if (res != 0)
+    {
+        return 1;
+    }
+    memcpy(id, basic->id, 4);
+    
+    return 0;
+}
+
+/**
+ * @brief      basic example get the uid of the found card
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 get uid failed
+ * @note       the uid has 4 or 7 bytes
+ */
+uint8_t mifare_classic_basic_get_uid_r(mifare_classic_basic_t *basic, mifare_classic_uid_t *uid)
+{
+    if (basic->uid.len == 0)
+    {
+        return 1;
+    }
+    memcpy(uid, &basic->uid, sizeof(mifare_classic_uid_t));
+    
+    return 0;
+}
+
+/**
+ * @brief     basic example set the search poll mode
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] mode poll mode
+ * @return    status code
+ *            - 0 success
+ *            - 1 set poll mode failed
+ * @note      MIFARE_CLASSIC_POLL_MODE_FIXED keeps the default delay between two polls
+ */
+uint8_t mifare_classic_basic_set_poll_mode_r(mifare_classic_basic_t *basic, mifare_classic_poll_mode_t mode)
+{
+    if (mode > MIFARE_CLASSIC_POLL_MODE_IRQ)
+    {
+        return 1;
+    }
+    basic->poll.mode = (uint8_t)mode;
+    
+    return 0;
+}
+
+/**
+ * @brief      basic example get the search detection latency
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get latency failed
  * @note       none
  */
-uint8_t mifare_classic_basic_search(mifare_classic_type_t *type, uint8_t id[4], int32_t timeout)
+uint8_t mifare_classic_basic_get_latency_r(mifare_classic_basic_t *basic, uint32_t *last_ms, uint32_t *max_ms,
+                                           uint32_t *avg_ms)
+{
+    if (mifare_classic_poll_get_latency(&basic->poll, last_ms, max_ms, avg_ms) != 0)
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      basic example authentication with a keyring
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  block block of authentication
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 authentication failed
+ * @note       the found key can be passed to the other basic functions, the open session
+ *             saves their authentication
+ */
+uint8_t mifare_classic_basic_keyring_authentication_r(mifare_classic_basic_t *basic, mifare_classic_keyring_t *ring,
+                                                      uint8_t block, mifare_classic_authentication_key_t *key_type,
+                                                      uint8_t key[6])
 {
     uint8_t res;
+    uint8_t index;
     
-    /* loop */
-    while (1)
-    {
-        /* request */
-        res = mifare_classic_request(&gs_handle, type);
-        if (res == 0)
-        {
-            /* anti collision_cl1 */
-            res = mifare_classic_anticollision_cl1(&gs_handle, id);
-            if (res == 0)
-            {
-                /* cl1 */
-                res = mifare_classic_select_cl1(&gs_handle, id);
-                if (res == 0)
-                {
-                    memcpy(gs_id, id, 4);
-                    
-                    return 0;
-                }
-            }
-        }
-        
-        /* delay */
-        mifare_classic_interface_delay_ms(MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_DELAY_MS);
-        
-        /* check the timeout */
-        if (timeout < 0)
-        {
-            /* never timeout */
-            continue;
-        }
-        else
-        {
-            /* timeout */
-            if (timeout == 0)
-            {
-                return 1;
-            }
-            else
-            {
-                /* timout-- */
-                timeout--;
-            }
-        }
+    /* authentication */
+    res = mifare_classic_keyring_authentication(&basic->handle, ring, basic->id, block, &index);
+    if (res != 0)
+    {
+        return 1;
     }
+    
+    /* get the key */
+    res = mifare_classic_keyring_get_key(ring, index, key_type, key);
+    if (res != 0)
+    {
+        return 1;
+    }
+    
+    return 0;
 }
 
 /**
  * @brief      basic example read
+ * @param[in]  *basic pointer to a basic instance structure
  * @param[in]  block block of read
  * @param[out] *data pointer to a data buffer
  * @param[in]  key_type authentication key type
@@ -222,20 +719,20 @@ uint8_t mifare_classic_basic_search(mifare_classic_type_t *type, uint8_t id[4],
  *             - 1 read failed
  * @note       none
  */
-uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
-                                  mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_read_r(mifare_classic_basic_t *basic, uint8_t block, uint8_t data[16],
+                                    mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -246,14 +743,14 @@ uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* read */
-    res = mifare_classic_read(&gs_handle, block, data);
+    res = mifare_classic_read(&basic->handle, block, data);
     if (res != 0)
     {
         return 1;
@@ -262,8 +759,42 @@ uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
     return 0;
 }
 
+/**
+ * @brief      basic example read all data blocks of a sector
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  sector read sector
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read sector failed
+ * @note       the sector trailer is not read, data must hold 15 * 16 bytes for the large sectors of s70
+ */
+uint8_t mifare_classic_basic_read_sector_r(mifare_classic_basic_t *basic, uint8_t sector, uint8_t *data,
+                                           uint8_t *block_count, mifare_classic_authentication_key_t key_type,
+                                           uint8_t key[6])
+{
+    uint8_t res;
+    
+    /* read sector */
+    res = mifare_classic_read_sector(&basic->handle, basic->id, sector, key_type, key,
+                                     MIFARE_CLASSIC_BOOL_FALSE, data, block_count);
+    if (res != 0)
+    {
+        /* the card is idle after a failure */
+        (void)mifare_classic_reselect(&basic->handle, basic->id);
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
 /**
  * @brief     basic example write
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] block block of write
  * @param[in] *data pointer to a data buffer
  * @param[in] key_type authentication key type
@@ -273,20 +804,20 @@ uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
  *            - 1 write failed
  * @note      none
  */
-uint8_t mifare_classic_basic_write(uint8_t block, uint8_t data[16],
-                                   mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_write_r(mifare_classic_basic_t *basic, uint8_t block, uint8_t data[16],
+                                     mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -297,14 +828,14 @@ uint8_t mifare_classic_basic_write(uint8_t block, uint8_t data[16],
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* write */
-    res = mifare_classic_write(&gs_handle, block, data);
+    res = mifare_classic_write(&basic->handle, block, data);
     if (res != 0)
     {
         return 1;
@@ -315,6 +846,7 @@ uint8_t mifare_classic_basic_write(uint8_t block, uint8_t data[16],
 
 /**
  * @brief     basic example init as a value
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] block block of init
  * @param[in] value inited value
  * @param[in] addr address
@@ -325,20 +857,20 @@ uint8_t mifare_classic_basic_write(uint8_t block, uint8_t data[16],
  *            - 1 value init failed
  * @note      none
  */
-uint8_t mifare_classic_basic_value_init(uint8_t block, int32_t value, uint8_t addr,
-                                        mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_value_init_r(mifare_classic_basic_t *basic, uint8_t block, int32_t value, uint8_t addr,
+                                          mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -349,14 +881,14 @@ uint8_t mifare_classic_basic_value_init(uint8_t block, int32_t value, uint8_t ad
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* value init */
-    res  = mifare_classic_value_init(&gs_handle, block, value, addr);
+    res  = mifare_classic_value_init(&basic->handle, block, value, addr);
     if (res != 0)
     {
         return 1;
@@ -367,6 +899,7 @@ uint8_t mifare_classic_basic_value_init(uint8_t block, int32_t value, uint8_t ad
 
 /**
  * @brief     basic example write value
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] block block of write
  * @param[in] value written value
  * @param[in] addr address
@@ -377,20 +910,20 @@ uint8_t mifare_classic_basic_value_init(uint8_t block, int32_t value, uint8_t ad
  *            - 1 value written failed
  * @note      none
  */
-uint8_t mifare_classic_basic_value_write(uint8_t block, int32_t value, uint8_t addr,
-                                         mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_value_write_r(mifare_classic_basic_t *basic, uint8_t block, int32_t value, uint8_t addr,
+                                           mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -401,14 +934,14 @@ uint8_t mifare_classic_basic_value_write(uint8_t block, int32_t value, uint8_t a
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* value write */
-    res  = mifare_classic_value_write(&gs_handle, block, value, addr);
+    res  = mifare_classic_value_write(&basic->handle, block, value, addr);
     if (res != 0)
     {
         return 1;
@@ -419,6 +952,7 @@ uint8_t mifare_classic_basic_value_write(uint8_t block, int32_t value, uint8_t a
 
 /**
  * @brief      basic example read value
+ * @param[in]  *basic pointer to a basic instance structure
  * @param[in]  block block of read
  * @param[out] *value pointer to a read value buffer
  * @param[out] *addr pointer to a read address buffer
@@ -429,20 +963,20 @@ uint8_t mifare_classic_basic_value_write(uint8_t block, int32_t value, uint8_t a
  *             - 1 value read failed
  * @note       none
  */
-uint8_t mifare_classic_basic_value_read(uint8_t block, int32_t *value, uint8_t *addr,
-                                         mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_value_read_r(mifare_classic_basic_t *basic, uint8_t block, int32_t *value, uint8_t *addr,
+                                          mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -453,14 +987,14 @@ uint8_t mifare_classic_basic_value_read(uint8_t block, int32_t *value, uint8_t *
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* value read */
-    res  = mifare_classic_value_read(&gs_handle, block, value, addr);
+    res  = mifare_classic_value_read(&basic->handle, block, value, addr);
     if (res != 0)
     {
         return 1;
@@ -471,6 +1005,7 @@ uint8_t mifare_classic_basic_value_read(uint8_t block, int32_t *value, uint8_t *
 
 /**
  * @brief     basic example increment value
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] block block of increment
  * @param[in] value increment value
  * @param[in] key_type authentication key type
@@ -480,20 +1015,20 @@ uint8_t mifare_classic_basic_value_read(uint8_t block, int32_t *value, uint8_t *
  *            - 1 value increment failed
  * @note      none
  */
-uint8_t mifare_classic_basic_value_increment(uint8_t block, uint32_t value,
-                                             mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_value_increment_r(mifare_classic_basic_t *basic, uint8_t block, uint32_t value,
+                                               mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -504,19 +1039,19 @@ uint8_t mifare_classic_basic_value_increment(uint8_t block, uint32_t value,
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* increment */
-    res  = mifare_classic_increment(&gs_handle, block, value);
+    res  = mifare_classic_increment(&basic->handle, block, value);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_transfer(&gs_handle, block);
+    res = mifare_classic_transfer(&basic->handle, block);
     if (res != 0)
     {
         return 1;
@@ -527,6 +1062,7 @@ uint8_t mifare_classic_basic_value_increment(uint8_t block, uint32_t value,
 
 /**
  * @brief     basic example decrement value
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] block block of decrement
  * @param[in] value decrement value
  * @param[in] key_type authentication key type
@@ -536,20 +1072,20 @@ uint8_t mifare_classic_basic_value_increment(uint8_t block, uint32_t value,
  *            - 1 value decrement failed
  * @note      none
  */
-uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
-                                             mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_basic_value_decrement_r(mifare_classic_basic_t *basic, uint8_t block, uint32_t value,
+                                               mifare_classic_authentication_key_t key_type, uint8_t key[6])
 {
     uint8_t res;
     uint8_t sector;
     uint8_t block_check;
     
     /* check the block */
-    res = mifare_classic_block_to_sector(&gs_handle, block, &sector);
+    res = mifare_classic_block_to_sector(&basic->handle, block, &sector);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block_check);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block_check);
     if (res != 0)
     {
         return 1;
@@ -560,19 +1096,19 @@ uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* decrement */
-    res  = mifare_classic_decrement(&gs_handle, block, value);
+    res  = mifare_classic_decrement(&basic->handle, block, value);
     if (res != 0)
     {
         return 1;
     }
-    res = mifare_classic_transfer(&gs_handle, block);
+    res = mifare_classic_transfer(&basic->handle, block);
     if (res != 0)
     {
         return 1;
@@ -583,6 +1119,7 @@ uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
 
 /**
  * @brief     basic example set the sector permission
+ * @param[in] *basic pointer to a basic instance structure
  * @param[in] key_type authentication key type
  * @param[in] *key pointer to a key buffer
  * @param[in] sector set sector
@@ -606,7 +1143,7 @@ uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
  *            0   1   1        keyb         keyb           never                   never
  *            1   0   1        keyb         never          never                   never
  *            1   1   1        never        never          never                   never
- *                                                                                      
+ *
  *            block_3_15 permission(c1_c2_c3) definition is below
  *            c1  c2  c3    keya_read    keya_write    access_read    access_write    keyb_read    keyb_write
  *            0   0   0      never        keya            keya           never          keya          keya
@@ -618,29 +1155,31 @@ uint8_t mifare_classic_basic_value_decrement(uint8_t block, uint32_t value,
  *            1   0   1      never        never          keya|b          keyb           never         never
  *            1   1   1      never        never          keya|b          never          never         never
  */
-uint8_t mifare_classic_basic_set_permission(mifare_classic_authentication_key_t key_type, uint8_t key[6],
-                                            uint8_t sector, uint8_t key_a[6], uint8_t block_0_0_4, uint8_t block_1_5_9,
-                                            uint8_t block_2_10_14, uint8_t block_3_15, uint8_t user_data, uint8_t key_b[6])
+uint8_t mifare_classic_basic_set_permission_r(mifare_classic_basic_t *basic,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              uint8_t sector, uint8_t key_a[6], uint8_t block_0_0_4,
+                                              uint8_t block_1_5_9, uint8_t block_2_10_14, uint8_t block_3_15,
+                                              uint8_t user_data, uint8_t key_b[6])
 {
     uint8_t res;
     uint8_t block;
     
     /* get the last block */
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block);
     if (res != 0)
     {
         return 1;
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* set sector permission */
-    res = mifare_classic_set_sector_permission(&gs_handle, sector, key_a, block_0_0_4, block_1_5_9, 
+    res = mifare_classic_set_sector_permission(&basic->handle, sector, key_a, block_0_0_4, block_1_5_9, 
                                                block_2_10_14, block_3_15, user_data, key_b);
     if (res != 0)
     {
@@ -652,6 +1191,7 @@ uint8_t mifare_classic_basic_set_permission(mifare_classic_authentication_key_t
 
 /**
  * @brief      basic example get the sector permission
+ * @param[in]  *basic pointer to a basic instance structure
  * @param[in]  key_type authentication key type
  * @param[in]  *key pointer to a key buffer
  * @param[in]  sector get sector
@@ -666,29 +1206,31 @@ uint8_t mifare_classic_basic_set_permission(mifare_classic_authentication_key_t
  *             - 1 get sector permission failed
  * @note       none
  */
-uint8_t mifare_classic_basic_get_permission(mifare_classic_authentication_key_t key_type, uint8_t key[6],
-                                            uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
-                                            uint8_t *block_2_10_14, uint8_t *block_3_15, uint8_t *user_data, uint8_t key_b[6])
+uint8_t mifare_classic_basic_get_permission_r(mifare_classic_basic_t *basic,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                              uint8_t *block_2_10_14, uint8_t *block_3_15, uint8_t *user_data,
+                                              uint8_t key_b[6])
 {
     uint8_t res;
     uint8_t block;
     
     /* get the last block */
-    res = mifare_classic_sector_last_block(&gs_handle, sector, &block);
+    res = mifare_classic_sector_last_block(&basic->handle, sector, &block);
     if (res != 0)
     {
         return 1;
     }
     
     /* authentication */
-    res = mifare_classic_authentication(&gs_handle, gs_id, block, key_type, key);
+    res = a_basic_authentication(basic, block, key_type, key);
     if (res != 0)
     {
         return 1;
     }
     
     /* set sector permission */
-    res = mifare_classic_get_sector_permission(&gs_handle, sector, block_0_0_4, block_1_5_9, 
+    res = mifare_classic_get_sector_permission(&basic->handle, sector, block_0_0_4, block_1_5_9, 
                                                block_2_10_14, block_3_15, user_data, key_b);
     if (res != 0)
     {
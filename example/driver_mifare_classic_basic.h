@@ -38,6 +38,8 @@
 #define DRIVER_MIFARE_CLASSIC_BASIC_H
 
 #include "driver_mifare_classic_interface.h"
+#include "driver_mifare_classic_keyring.h"
+#include "driver_mifare_classic_poll.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -53,7 +55,20 @@ extern "C"{
 /**
  * @brief mifare classic basic example default definition
  */
-#define MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_DELAY_MS        200        /**< 5Hz */
+#define MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_DELAY_MS                200         /**< 5Hz */
+#define MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_FAST_DELAY_MS           20          /**< 50Hz */
+#define MIFARE_CLASSIC_BASIC_DEFAULT_SEARCH_FAST_PERIOD_MS          2000        /**< 2s */
+
+/**
+ * @brief mifare classic basic instance structure definition
+ */
+typedef struct mifare_classic_basic_s
+{
+    mifare_classic_handle_t handle;        /**< mifare_classic handle */
+    uint8_t id[4];                         /**< local authentication id */
+    mifare_classic_uid_t uid;              /**< local uid */
+    mifare_classic_poll_t poll;            /**< search poll */
+} mifare_classic_basic_t;
 
 /**
  * @brief  basic example init
@@ -81,10 +96,58 @@ uint8_t mifare_classic_basic_deinit(void);
  * @return     status code
  *             - 0 success
  *             - 1 timeout
- * @note       none
+ * @note       the delay between two polls adapts to the poll mode,
+ *             id is the authentication id and a 7 bytes uid is read by mifare_classic_basic_get_uid
  */
 uint8_t mifare_classic_basic_search(mifare_classic_type_t *type, uint8_t id[4], int32_t timeout);
 
+/**
+ * @brief      basic example get the uid of the found card
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 get uid failed
+ * @note       the uid has 4 or 7 bytes
+ */
+uint8_t mifare_classic_basic_get_uid(mifare_classic_uid_t *uid);
+
+/**
+ * @brief     basic example set the search poll mode
+ * @param[in] mode poll mode
+ * @return    status code
+ *            - 0 success
+ *            - 1 set poll mode failed
+ * @note      MIFARE_CLASSIC_POLL_MODE_FIXED keeps the default delay between two polls
+ */
+uint8_t mifare_classic_basic_set_poll_mode(mifare_classic_poll_mode_t mode);
+
+/**
+ * @brief      basic example get the search detection latency
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get latency failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_get_latency(uint32_t *last_ms, uint32_t *max_ms, uint32_t *avg_ms);
+
+/**
+ * @brief      basic example authentication with a keyring
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  block block of authentication
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 authentication failed
+ * @note       the found key can be passed to the other basic functions, the open session
+ *             saves their authentication
+ */
+uint8_t mifare_classic_basic_keyring_authentication(mifare_classic_keyring_t *ring, uint8_t block,
+                                                    mifare_classic_authentication_key_t *key_type, uint8_t key[6]);
+
 /**
  * @brief      basic example read
  * @param[in]  block block of read
@@ -99,6 +162,21 @@ uint8_t mifare_classic_basic_search(mifare_classic_type_t *type, uint8_t id[4],
 uint8_t mifare_classic_basic_read(uint8_t block, uint8_t data[16],
                                   mifare_classic_authentication_key_t key_type, uint8_t key[6]);
 
+/**
+ * @brief      basic example read all data blocks of a sector
+ * @param[in]  sector read sector
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read sector failed
+ * @note       the sector trailer is not read, data must hold 15 * 16 bytes for the large sectors of s70
+ */
+uint8_t mifare_classic_basic_read_sector(uint8_t sector, uint8_t *data, uint8_t *block_count,
+                                         mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
 /**
  * @brief     basic example write
  * @param[in] block block of write
@@ -265,6 +343,315 @@ uint8_t mifare_classic_basic_get_permission(mifare_classic_authentication_key_t
                                             uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
                                             uint8_t *block_2_10_14, uint8_t *block_3_15, uint8_t *user_data, uint8_t key_b[6]);
 
+/**
+ * @brief     basic example init of an instance
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] *context pointer to a user context
+ * @param[in] *contactless_init pointer to a contactless_init_ctx function address
+ * @param[in] *contactless_deinit pointer to a contactless_deinit_ctx function address
+ * @param[in] *contactless_transceiver pointer to a contactless_transceiver_ctx function address
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      context is passed to the callbacks, so one set of callbacks can drive several readers,
+ *            every instance has its own handle and can run in its own thread
+ */
+uint8_t mifare_classic_basic_init_r(mifare_classic_basic_t *basic, void *context,
+                                    uint8_t (*contactless_init)(void *context),
+                                    uint8_t (*contactless_deinit)(void *context),
+                                    uint8_t (*contactless_transceiver)(void *context, uint8_t *in_buf, uint8_t in_len,
+                                                                       uint8_t *out_buf, uint8_t *out_len));
+
+/**
+ * @brief     basic example deinit
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 deinit failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_deinit_r(mifare_classic_basic_t *basic);
+
+/**
+ * @brief     basic example halt
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 halt failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_halt_r(mifare_classic_basic_t *basic);
+
+/**
+ * @brief     basic example wake up
+ * @param[in] *basic pointer to a basic instance structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 wake up failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_wake_up_r(mifare_classic_basic_t *basic);
+
+/**
+ * @brief      basic example search
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[out] *type pointer to a type buffer
+ * @param[out] *id pointer to an id buffer
+ * @param[in]  timeout check times
+ * @return     status code
+ *             - 0 success
+ *             - 1 timeout
+ * @note       the delay between two polls adapts to the poll mode,
+ *             id is the authentication id and a 7 bytes uid is read by mifare_classic_basic_get_uid_r
+ */
+uint8_t mifare_classic_basic_search_r(mifare_classic_basic_t *basic, mifare_classic_type_t *type, uint8_t id[4],
+                                      int32_t timeout);
+
+/**
+ * @brief      basic example get the uid of the found card
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 get uid failed
+ * @note       the uid has 4 or 7 bytes
+ */
+uint8_t mifare_classic_basic_get_uid_r(mifare_classic_basic_t *basic, mifare_classic_uid_t *uid);
+
+/**
+ * @brief     basic example set the search poll mode
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] mode poll mode
+ * @return    status code
+ *            - 0 success
+ *            - 1 set poll mode failed
+ * @note      MIFARE_CLASSIC_POLL_MODE_FIXED keeps the default delay between two polls
+ */
+uint8_t mifare_classic_basic_set_poll_mode_r(mifare_classic_basic_t *basic, mifare_classic_poll_mode_t mode);
+
+/**
+ * @brief      basic example get the search detection latency
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get latency failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_get_latency_r(mifare_classic_basic_t *basic, uint32_t *last_ms, uint32_t *max_ms,
+                                           uint32_t *avg_ms);
+
+/**
+ * @brief      basic example authentication with a keyring
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  block block of authentication
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 authentication failed
+ * @note       the found key can be passed to the other basic functions, the open session
+ *             saves their authentication
+ */
+uint8_t mifare_classic_basic_keyring_authentication_r(mifare_classic_basic_t *basic, mifare_classic_keyring_t *ring,
+                                                      uint8_t block, mifare_classic_authentication_key_t *key_type,
+                                                      uint8_t key[6]);
+
+/**
+ * @brief      basic example read
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  block block of read
+ * @param[out] *data pointer to a data buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_read_r(mifare_classic_basic_t *basic, uint8_t block, uint8_t data[16],
+                                    mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief      basic example read all data blocks of a sector
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  sector read sector
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read sector failed
+ * @note       the sector trailer is not read, data must hold 15 * 16 bytes for the large sectors of s70
+ */
+uint8_t mifare_classic_basic_read_sector_r(mifare_classic_basic_t *basic, uint8_t sector, uint8_t *data,
+                                           uint8_t *block_count, mifare_classic_authentication_key_t key_type,
+                                           uint8_t key[6]);
+
+/**
+ * @brief     basic example write
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of write
+ * @param[in] *data pointer to a data buffer
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_write_r(mifare_classic_basic_t *basic, uint8_t block, uint8_t data[16],
+                                     mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief     basic example init as a value
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of init
+ * @param[in] value inited value
+ * @param[in] addr address
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value init failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_init_r(mifare_classic_basic_t *basic, uint8_t block, int32_t value, uint8_t addr,
+                                          mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief     basic example write value
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of write
+ * @param[in] value written value
+ * @param[in] addr address
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value written failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_write_r(mifare_classic_basic_t *basic, uint8_t block, int32_t value, uint8_t addr,
+                                           mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief      basic example read value
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  block block of read
+ * @param[out] *value pointer to a read value buffer
+ * @param[out] *addr pointer to a read address buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 value read failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_value_read_r(mifare_classic_basic_t *basic, uint8_t block, int32_t *value, uint8_t *addr,
+                                          mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief     basic example increment value
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of increment
+ * @param[in] value increment value
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value increment failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_increment_r(mifare_classic_basic_t *basic, uint8_t block, uint32_t value,
+                                               mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief     basic example decrement value
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] block block of decrement
+ * @param[in] value decrement value
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 value decrement failed
+ * @note      none
+ */
+uint8_t mifare_classic_basic_value_decrement_r(mifare_classic_basic_t *basic, uint8_t block, uint32_t value,
+                                               mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief     basic example set the sector permission
+ * @param[in] *basic pointer to a basic instance structure
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] sector set sector
+ * @param[in] *key_a pointer to a key a buffer
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 block3(block15) permission
+ * @param[in] user_data user data
+ * @param[in] *key_b pointer to a key b buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 set sector permission failed
+ * @note      block_0_0_4, block_1_5_9, block_2_10_14, permission(c1_c2_c3) definition is below
+ *            c1  c2  c3        read        write        increment        decrement/transfer/restore
+ *            0   0   0        keya|b       keya|b         keya|b                  keya|b
+ *            0   1   0        keya|b       never          never                   never
+ *            1   0   0        keya|b       keyb           never                   never
+ *            1   1   0        keya|b       keyb           keyb                    keya|b
+ *            0   0   1        keya|b       never          never                   keya|b
+ *            0   1   1        keyb         keyb           never                   never
+ *            1   0   1        keyb         never          never                   never
+ *            1   1   1        never        never          never                   never
+ *
+ *            block_3_15 permission(c1_c2_c3) definition is below
+ *            c1  c2  c3    keya_read    keya_write    access_read    access_write    keyb_read    keyb_write
+ *            0   0   0      never        keya            keya           never          keya          keya
+ *            0   1   0      never        never           keya           never          keya          never
+ *            1   0   0      never        keyb           keya|b          never          never         keyb
+ *            1   1   0      never        never          keya|b          never          never         never
+ *            0   0   1      never        keya            keya           keya           keya          keya
+ *            0   1   1      never        keyb           keya|b          keyb           never         keyb
+ *            1   0   1      never        never          keya|b          keyb           never         never
+ *            1   1   1      never        never          keya|b          never          never         never
+ */
+uint8_t mifare_classic_basic_set_permission_r(mifare_classic_basic_t *basic,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              uint8_t sector, uint8_t key_a[6], uint8_t block_0_0_4,
+                                              uint8_t block_1_5_9, uint8_t block_2_10_14, uint8_t block_3_15,
+                                              uint8_t user_data, uint8_t key_b[6]);
+
+/**
+ * @brief      basic example get the sector permission
+ * @param[in]  *basic pointer to a basic instance structure
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  sector get sector
+ * @param[out] *block_0_0_4 pointer to a block0(block0-4) permission buffer
+ * @param[out] *block_1_5_9 pointer to a block1(block5-9) permission buffer
+ * @param[out] *block_2_10_14 pointer to a block2(block10-14) permission buffer
+ * @param[out] *block_3_15 pointer to a block3(block15) permission buffer
+ * @param[out] *user_data pointer to a user data buffer
+ * @param[out] *key_b pointer to a key b buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get sector permission failed
+ * @note       none
+ */
+uint8_t mifare_classic_basic_get_permission_r(mifare_classic_basic_t *basic,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                              uint8_t *block_2_10_14, uint8_t *block_3_15, uint8_t *user_data,
+                                              uint8_t key_b[6]);
+
 /**
  * @}
  */
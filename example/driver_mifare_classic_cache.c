@@ -0,0 +1,543 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_cache.c
+ * @brief     driver mifare classic cache source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#include "driver_mifare_classic_cache.h"
+
+/**
+ * @brief     check a cached block
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] block block number
+ * @return    1 if the block can be cached, 0 if not
+ * @note      the sector trailers are never cached because the keys read back as zeros,
+ *            the manufacturer block 0 is never cached so that a flush can't write it
+ */
+static uint8_t a_cache_block_check(mifare_classic_cache_t *cache, uint8_t block)
+{
+    uint8_t sector;
+    uint8_t last;
+    
+    if ((block == 0) || ((cache->handle->type == MIFARE_CLASSIC_TYPE_S50) && (block >= 64)))
+    {
+        return 0;
+    }
+    if (mifare_classic_block_to_sector(cache->handle, block, &sector) != 0)
+    {
+        return 0;
+    }
+    if (mifare_classic_sector_last_block(cache->handle, sector, &last) != 0)
+    {
+        return 0;
+    }
+    
+    return (block != last) ? 1 : 0;
+}
+
+/**
+ * @brief     find the line of a block
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] block block number
+ * @return    line index or MIFARE_CLASSIC_CACHE_MAX_BLOCK if not found
+ * @note      none
+ */
+static uint8_t a_cache_find(mifare_classic_cache_t *cache, uint8_t block)
+{
+    uint8_t i;
+    
+    for (i = 0; i < MIFARE_CLASSIC_CACHE_MAX_BLOCK; i++)
+    {
+        if (((cache->line[i].flag & MIFARE_CLASSIC_CACHE_FLAG_VALID) != 0) && (cache->line[i].block == block))
+        {
+            return i;
+        }
+    }
+    
+    return MIFARE_CLASSIC_CACHE_MAX_BLOCK;
+}
+
+/**
+ * @brief     find a free line
+ * @param[in] *cache pointer to a cache structure
+ * @return    line index or MIFARE_CLASSIC_CACHE_MAX_BLOCK if all lines are dirty
+ * @note      an empty line is used first, then the least recently used clean line
+ */
+static uint8_t a_cache_victim(mifare_classic_cache_t *cache)
+{
+    uint8_t i;
+    uint8_t v;
+    
+    v = MIFARE_CLASSIC_CACHE_MAX_BLOCK;
+    for (i = 0; i < MIFARE_CLASSIC_CACHE_MAX_BLOCK; i++)
+    {
+        if ((cache->line[i].flag & MIFARE_CLASSIC_CACHE_FLAG_VALID) == 0)
+        {
+            return i;
+        }
+        if ((cache->line[i].flag & MIFARE_CLASSIC_CACHE_FLAG_DIRTY) != 0)
+        {
+            continue;
+        }
+        if ((v == MIFARE_CLASSIC_CACHE_MAX_BLOCK) || (cache->line[i].age < cache->line[v].age))
+        {
+            v = i;
+        }
+    }
+    
+    return v;
+}
+
+/**
+ * @brief     handle a failed command
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 1 the card is still there
+ *            - 5 card is lost
+ * @note      the card is idle after a failed command, so it is selected again,
+ *            the session is discarded when the card doesn't answer
+ */
+static uint8_t a_cache_failed(mifare_classic_cache_t *cache)
+{
+    if (mifare_classic_reselect(cache->handle, cache->id) != 0)
+    {
+        (void)mifare_classic_cache_discard(cache);
+        
+        return 5;
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief     cache init
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 cache or handle is NULL
+ * @note      the auth cache of the handle is enabled, so a sector is only authenticated again
+ *            when the key, the key type or the card changes
+ */
+uint8_t mifare_classic_cache_init(mifare_classic_cache_t *cache, mifare_classic_handle_t *handle)
+{
+    if ((cache == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+    
+    if (mifare_classic_set_auth_cache(handle, MIFARE_CLASSIC_BOOL_TRUE) != 0)
+    {
+        return 1;
+    }
+    
+    memset(cache, 0, sizeof(mifare_classic_cache_t));
+    cache->handle = handle;
+    
+    return 0;
+}
+
+/**
+ * @brief     cache begin a card session
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      the card must be selected, the lines are kept for the same id and dropped for another id
+ */
+uint8_t mifare_classic_cache_begin(mifare_classic_cache_t *cache, uint8_t id[4])
+{
+    if ((cache == NULL) || (id == NULL))
+    {
+        return 2;
+    }
+    
+    if ((cache->open == 0) || (memcmp(cache->id, id, 4) != 0))
+    {
+        (void)mifare_classic_cache_discard(cache);
+        memcpy(cache->id, id, 4);
+    }
+    cache->open = 1;
+    
+    return 0;
+}
+
+/**
+ * @brief      cache read a block
+ * @param[in]  *cache pointer to a cache structure
+ * @param[in]  block read block
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[out] *data pointer to a data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 cache is NULL
+ *             - 3 no session is open
+ *             - 4 block is invalid, block 0 and the sector trailers can't be cached
+ *             - 5 card is lost
+ * @note       a cached block is served without any rf exchange, a missed block is read from the card
+ *             with one authentication when its sector is not authenticated yet
+ */
+uint8_t mifare_classic_cache_read(mifare_classic_cache_t *cache, uint8_t block,
+                                  mifare_classic_authentication_key_t key_type, uint8_t key[6], uint8_t data[16])
+{
+    uint8_t i;
+    
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    if (cache->open == 0)
+    {
+        return 3;
+    }
+    if (a_cache_block_check(cache, block) == 0)
+    {
+        return 4;
+    }
+    
+    /* serve a cached block */
+    i = a_cache_find(cache, block);
+    if (i != MIFARE_CLASSIC_CACHE_MAX_BLOCK)
+    {
+        cache->hit++;
+        cache->line[i].age = ++cache->clock;
+        memcpy(data, cache->line[i].data, 16);
+        
+        return 0;
+    }
+    
+    /* read the card */
+    cache->miss++;
+    if ((mifare_classic_authentication(cache->handle, cache->id, block, key_type, key) != 0) ||
+        (mifare_classic_read(cache->handle, block, data) != 0))
+    {
+        return a_cache_failed(cache);
+    }
+    
+    /* keep the block when a line is free */
+    i = a_cache_victim(cache);
+    if (i != MIFARE_CLASSIC_CACHE_MAX_BLOCK)
+    {
+        cache->line[i].flag = MIFARE_CLASSIC_CACHE_FLAG_VALID;
+        cache->line[i].block = block;
+        cache->line[i].key_type = (uint8_t)key_type;
+        memcpy(cache->line[i].key, key, 6);
+        memcpy(cache->line[i].data, data, 16);
+        cache->line[i].age = ++cache->clock;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     cache write a block
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] block write block
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] *data pointer to a data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 4 block is invalid, block 0 and the sector trailers can't be cached
+ *            - 5 card is lost
+ * @note      the data is only buffered and the block is marked dirty, writing the card content again
+ *            marks nothing, the cache is flushed when all lines are dirty
+ */
+uint8_t mifare_classic_cache_write(mifare_classic_cache_t *cache, uint8_t block,
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6], uint8_t data[16])
+{
+    uint8_t res;
+    uint8_t i;
+    
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    if (cache->open == 0)
+    {
+        return 3;
+    }
+    if (a_cache_block_check(cache, block) == 0)
+    {
+        return 4;
+    }
+    
+    i = a_cache_find(cache, block);
+    if (i != MIFARE_CLASSIC_CACHE_MAX_BLOCK)
+    {
+        /* the same content needs no write */
+        if (memcmp(cache->line[i].data, data, 16) == 0)
+        {
+            cache->line[i].age = ++cache->clock;
+            
+            return 0;
+        }
+    }
+    else
+    {
+        /* make room by writing back the dirty blocks */
+        i = a_cache_victim(cache);
+        if (i == MIFARE_CLASSIC_CACHE_MAX_BLOCK)
+        {
+            res = mifare_classic_cache_flush(cache);
+            if (res != 0)
+            {
+                return res;
+            }
+            i = a_cache_victim(cache);
+        }
+        cache->line[i].block = block;
+    }
+    cache->line[i].flag = MIFARE_CLASSIC_CACHE_FLAG_VALID | MIFARE_CLASSIC_CACHE_FLAG_DIRTY;
+    cache->line[i].key_type = (uint8_t)key_type;
+    memcpy(cache->line[i].key, key, 6);
+    memcpy(cache->line[i].data, data, 16);
+    cache->line[i].age = ++cache->clock;
+    
+    return 0;
+}
+
+/**
+ * @brief     cache flush the dirty blocks
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 5 card is lost
+ * @note      the dirty blocks are written in block order with one authentication per sector,
+ *            a block which can't be written stays dirty
+ */
+uint8_t mifare_classic_cache_flush(mifare_classic_cache_t *cache)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t n;
+    uint8_t t;
+    uint8_t j;
+    uint8_t sector;
+    uint8_t last_sector;
+    uint8_t last_key_type;
+    uint8_t failed;
+    uint8_t auth_failed;
+    uint8_t order[MIFARE_CLASSIC_CACHE_MAX_BLOCK];
+    
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    if (cache->open == 0)
+    {
+        return 3;
+    }
+    
+    /* sort the dirty lines by block */
+    n = 0;
+    for (i = 0; i < MIFARE_CLASSIC_CACHE_MAX_BLOCK; i++)
+    {
+        if ((cache->line[i].flag & MIFARE_CLASSIC_CACHE_FLAG_DIRTY) == 0)
+        {
+            continue;
+        }
+        order[n] = i;
+        for (j = n; j > 0; j--)
+        {
+            if (cache->line[order[j - 1]].block < cache->line[order[j]].block)
+            {
+                break;
+            }
+            t = order[j - 1];
+            order[j - 1] = order[j];
+            order[j] = t;
+        }
+        n++;
+    }
+    
+    /* write sector by sector */
+    failed = 0;
+    auth_failed = 0;
+    last_sector = 0xFF;
+    last_key_type = 0xFF;
+    for (j = 0; j < n; j++)
+    {
+        i = order[j];
+        (void)mifare_classic_block_to_sector(cache->handle, cache->line[i].block, &sector);
+        if ((sector != last_sector) || (cache->line[i].key_type != last_key_type))
+        {
+            last_sector = sector;
+            last_key_type = cache->line[i].key_type;
+            auth_failed = 0;
+        }
+        
+        /* a key which failed is not tried again in the same sector */
+        if (auth_failed != 0)
+        {
+            continue;
+        }
+        if (mifare_classic_authentication(cache->handle, cache->id, cache->line[i].block,
+                                          (mifare_classic_authentication_key_t)cache->line[i].key_type,
+                                          cache->line[i].key) != 0)
+        {
+            auth_failed = 1;
+        }
+        if ((auth_failed != 0) || (mifare_classic_write(cache->handle, cache->line[i].block, cache->line[i].data) != 0))
+        {
+            res = a_cache_failed(cache);
+            if (res != 1)
+            {
+                return res;
+            }
+            failed = 1;
+            
+            continue;
+        }
+        cache->rf_write++;
+        cache->line[i].flag &= (uint8_t)(~MIFARE_CLASSIC_CACHE_FLAG_DIRTY);
+    }
+    
+    return (failed != 0) ? 1 : 0;
+}
+
+/**
+ * @brief     cache abort the buffered writes
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      the dirty blocks are dropped and the clean blocks are kept
+ */
+uint8_t mifare_classic_cache_abort(mifare_classic_cache_t *cache)
+{
+    uint8_t i;
+    
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    
+    for (i = 0; i < MIFARE_CLASSIC_CACHE_MAX_BLOCK; i++)
+    {
+        if ((cache->line[i].flag & MIFARE_CLASSIC_CACHE_FLAG_DIRTY) != 0)
+        {
+            cache->line[i].flag = 0;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     cache discard the card session
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      all blocks are dropped, it runs by itself when the card is lost
+ */
+uint8_t mifare_classic_cache_discard(mifare_classic_cache_t *cache)
+{
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    
+    memset(cache->line, 0, sizeof(cache->line));
+    cache->open = 0;
+    
+    return 0;
+}
+
+/**
+ * @brief     cache flush and halt the card
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 5 card is lost
+ *            - 6 halt failed
+ * @note      the session ends after the halt, a failed flush keeps the session and the card
+ *            for another flush or an abort
+ */
+uint8_t mifare_classic_cache_halt(mifare_classic_cache_t *cache)
+{
+    uint8_t res;
+    
+    res = mifare_classic_cache_flush(cache);
+    if (res != 0)
+    {
+        return res;
+    }
+    (void)mifare_classic_cache_discard(cache);
+    if (mifare_classic_halt(cache->handle) != 0)
+    {
+        return 6;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      cache get the statistics
+ * @param[in]  *cache pointer to a cache structure
+ * @param[out] *hit pointer to a read hit counter buffer
+ * @param[out] *miss pointer to a read miss counter buffer
+ * @param[out] *rf_write pointer to a card write counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 cache is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_cache_get_statistics(mifare_classic_cache_t *cache, uint32_t *hit, uint32_t *miss, uint32_t *rf_write)
+{
+    if (cache == NULL)
+    {
+        return 2;
+    }
+    
+    *hit = cache->hit;
+    *miss = cache->miss;
+    *rf_write = cache->rf_write;
+    
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_cache.h
+ * @brief     driver mifare classic cache header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#ifndef DRIVER_MIFARE_CLASSIC_CACHE_H
+#define DRIVER_MIFARE_CLASSIC_CACHE_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_cache_driver mifare classic cache driver function
+ * @brief    mifare classic cache driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare classic cache size definition
+ */
+#ifndef MIFARE_CLASSIC_CACHE_MAX_BLOCK
+    #define MIFARE_CLASSIC_CACHE_MAX_BLOCK    16        /**< max cached blocks */
+#endif
+
+/**
+ * @brief mifare classic cache line flag definition
+ */
+#define MIFARE_CLASSIC_CACHE_FLAG_VALID    0x01        /**< line holds a block */
+#define MIFARE_CLASSIC_CACHE_FLAG_DIRTY    0x02        /**< line is newer than the card */
+
+/**
+ * @brief mifare_classic cache line structure definition
+ */
+typedef struct mifare_classic_cache_line_s
+{
+    uint8_t flag;            /**< valid and dirty flags */
+    uint8_t block;           /**< block number */
+    uint8_t key_type;        /**< authentication key type of the block */
+    uint8_t key[6];          /**< key of the block */
+    uint8_t data[16];        /**< block data */
+    uint32_t age;            /**< last use */
+} mifare_classic_cache_line_t;
+
+/**
+ * @brief mifare_classic cache structure definition
+ */
+typedef struct mifare_classic_cache_s
+{
+    mifare_classic_handle_t *handle;                                     /**< mifare_classic handle */
+    uint8_t open;                                                        /**< card session open flag */
+    uint8_t id[4];                                                       /**< card id of the session */
+    mifare_classic_cache_line_t line[MIFARE_CLASSIC_CACHE_MAX_BLOCK];    /**< cache lines */
+    uint32_t clock;                                                      /**< use clock */
+    uint32_t hit;                                                        /**< read hit counter */
+    uint32_t miss;                                                       /**< read miss counter */
+    uint32_t rf_write;                                                   /**< card write counter */
+} mifare_classic_cache_t;
+
+/**
+ * @brief     cache init
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 cache or handle is NULL
+ * @note      the auth cache of the handle is enabled, so a sector is only authenticated again
+ *            when the key, the key type or the card changes
+ */
+uint8_t mifare_classic_cache_init(mifare_classic_cache_t *cache, mifare_classic_handle_t *handle);
+
+/**
+ * @brief     cache begin a card session
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      the card must be selected, the lines are kept for the same id and dropped for another id
+ */
+uint8_t mifare_classic_cache_begin(mifare_classic_cache_t *cache, uint8_t id[4]);
+
+/**
+ * @brief      cache read a block
+ * @param[in]  *cache pointer to a cache structure
+ * @param[in]  block read block
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[out] *data pointer to a data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 cache is NULL
+ *             - 3 no session is open
+ *             - 4 block is invalid, block 0 and the sector trailers can't be cached
+ *             - 5 card is lost
+ * @note       a cached block is served without any rf exchange, a missed block is read from the card
+ *             with one authentication when its sector is not authenticated yet
+ */
+uint8_t mifare_classic_cache_read(mifare_classic_cache_t *cache, uint8_t block,
+                                  mifare_classic_authentication_key_t key_type, uint8_t key[6], uint8_t data[16]);
+
+/**
+ * @brief     cache write a block
+ * @param[in] *cache pointer to a cache structure
+ * @param[in] block write block
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] *data pointer to a data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 4 block is invalid, block 0 and the sector trailers can't be cached
+ *            - 5 card is lost
+ * @note      the data is only buffered and the block is marked dirty, writing the card content again
+ *            marks nothing, the cache is flushed when all lines are dirty
+ */
+uint8_t mifare_classic_cache_write(mifare_classic_cache_t *cache, uint8_t block,
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6], uint8_t data[16]);
+
+/**
+ * @brief     cache flush the dirty blocks
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 5 card is lost
+ * @note      the dirty blocks are written in block order with one authentication per sector,
+ *            a block which can't be written stays dirty
+ */
+uint8_t mifare_classic_cache_flush(mifare_classic_cache_t *cache);
+
+/**
+ * @brief     cache abort the buffered writes
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      the dirty blocks are dropped and the clean blocks are kept
+ */
+uint8_t mifare_classic_cache_abort(mifare_classic_cache_t *cache);
+
+/**
+ * @brief     cache discard the card session
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 cache is NULL
+ * @note      all blocks are dropped, it runs by itself when the card is lost
+ */
+uint8_t mifare_classic_cache_discard(mifare_classic_cache_t *cache);
+
+/**
+ * @brief     cache flush and halt the card
+ * @param[in] *cache pointer to a cache structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 flush failed
+ *            - 2 cache is NULL
+ *            - 3 no session is open
+ *            - 5 card is lost
+ *            - 6 halt failed
+ * @note      the session ends after the halt, a failed flush keeps the session and the card
+ *            for another flush or an abort
+ */
+uint8_t mifare_classic_cache_halt(mifare_classic_cache_t *cache);
+
+/**
+ * @brief      cache get the statistics
+ * @param[in]  *cache pointer to a cache structure
+ * @param[out] *hit pointer to a read hit counter buffer
+ * @param[out] *miss pointer to a read miss counter buffer
+ * @param[out] *rf_write pointer to a card write counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 cache is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_cache_get_statistics(mifare_classic_cache_t *cache, uint32_t *hit, uint32_t *miss, uint32_t *rf_write);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
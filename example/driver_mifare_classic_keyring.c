@@ -0,0 +1,306 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_keyring.c
+ * @brief     driver mifare classic keyring source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_keyring.h"
+
+/**
+ * @brief     find the memo of a uid and sector
+ * @param[in] *ring pointer to a keyring structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] sector sector number
+ * @return    memo index or MIFARE_CLASSIC_KEYRING_MAX_MEMO if not found
+ * @note      none
+ */
+static uint8_t a_keyring_memo_find(mifare_classic_keyring_t *ring, uint8_t id[4], uint8_t sector)
+{
+    uint8_t i;
+    
+    for (i = 0; i < MIFARE_CLASSIC_KEYRING_MAX_MEMO; i++)
+    {
+        if ((ring->memo[i].valid != 0) && (ring->memo[i].sector == sector) &&
+            (memcmp(ring->memo[i].uid, id, 4) == 0))
+        {
+            return i;
+        }
+    }
+    
+    return MIFARE_CLASSIC_KEYRING_MAX_MEMO;
+}
+
+/**
+ * @brief     save the working key of a uid and sector
+ * @param[in] *ring pointer to a keyring structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] sector sector number
+ * @param[in] index key index
+ * @note      the oldest entry is replaced when the memo is full
+ */
+static void a_keyring_memo_save(mifare_classic_keyring_t *ring, uint8_t id[4], uint8_t sector, uint8_t index)
+{
+    uint8_t i;
+    
+    i = a_keyring_memo_find(ring, id, sector);
+    if (i == MIFARE_CLASSIC_KEYRING_MAX_MEMO)
+    {
+        i = ring->memo_next;
+        ring->memo_next = (uint8_t)((ring->memo_next + 1) % MIFARE_CLASSIC_KEYRING_MAX_MEMO);
+    }
+    ring->memo[i].valid = 1;
+    memcpy(ring->memo[i].uid, id, 4);
+    ring->memo[i].sector = sector;
+    ring->memo[i].index = index;
+}
+
+/**
+ * @brief      build the key order
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  first key index to try first or MIFARE_CLASSIC_KEYRING_MAX_KEY
+ * @param[out] *order pointer to an order buffer
+ * @note       the keys follow the first key by their hit counters
+ */
+static void a_keyring_order(mifare_classic_keyring_t *ring, uint8_t first, uint8_t *order)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t n;
+    uint8_t start;
+    uint8_t t;
+    
+    n = 0;
+    if (first < ring->key_count)
+    {
+        order[n++] = first;
+    }
+    start = n;
+    for (i = 0; i < ring->key_count; i++)
+    {
+        if (i == first)
+        {
+            continue;
+        }
+        
+        /* insertion by hit counter, equal counters keep the adding order */
+        order[n] = i;
+        for (j = n; j > start; j--)
+        {
+            if (ring->key[order[j - 1]].hit >= ring->key[order[j]].hit)
+            {
+                break;
+            }
+            t = order[j - 1];
+            order[j - 1] = order[j];
+            order[j] = t;
+        }
+        n++;
+    }
+}
+
+/**
+ * @brief      keyring init
+ * @param[out] *ring pointer to a keyring structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_keyring_init(mifare_classic_keyring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return 2;
+    }
+    
+    memset(ring, 0, sizeof(mifare_classic_keyring_t));
+    
+    return 0;
+}
+
+/**
+ * @brief     keyring add a key candidate
+ * @param[in] *ring pointer to a keyring structure
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 keyring is full
+ *            - 2 ring is NULL
+ * @note      none
+ */
+uint8_t mifare_classic_keyring_add(mifare_classic_keyring_t *ring, mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    if ((ring == NULL) || (key == NULL))
+    {
+        return 2;
+    }
+    if (ring->key_count >= MIFARE_CLASSIC_KEYRING_MAX_KEY)
+    {
+        return 1;
+    }
+    
+    ring->key[ring->key_count].key_type = (uint8_t)key_type;
+    memcpy(ring->key[ring->key_count].key, key, 6);
+    ring->key[ring->key_count].hit = 0;
+    ring->key_count++;
+    
+    return 0;
+}
+
+/**
+ * @brief      keyring authentication
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  block block of authentication
+ * @param[out] *index pointer to a key index buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no key works
+ *             - 2 handle or ring is NULL
+ *             - 4 reselect failed
+ * @note       the key which worked last time for this uid and sector is tried first,
+ *             then the other keys by their hit counters, the card is reselected with the
+ *             cached uid after each failed attempt
+ */
+uint8_t mifare_classic_keyring_authentication(mifare_classic_handle_t *handle, mifare_classic_keyring_t *ring,
+                                              uint8_t id[4], uint8_t block, uint8_t *index)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t k;
+    uint8_t m;
+    uint8_t sector;
+    uint8_t first;
+    uint8_t order[MIFARE_CLASSIC_KEYRING_MAX_KEY];
+    
+    if ((handle == NULL) || (ring == NULL))
+    {
+        return 2;
+    }
+    
+    /* get the sector */
+    res = mifare_classic_block_to_sector(handle, block, &sector);
+    if (res != 0)
+    {
+        return 1;
+    }
+    
+    /* the last working key first, then by hit counter */
+    m = a_keyring_memo_find(ring, id, sector);
+    first = (m != MIFARE_CLASSIC_KEYRING_MAX_MEMO) ? ring->memo[m].index : MIFARE_CLASSIC_KEYRING_MAX_KEY;
+    a_keyring_order(ring, first, order);
+    
+    for (i = 0; i < ring->key_count; i++)
+    {
+        k = order[i];
+        ring->attempt++;
+        
+        /* authentication */
+        res = mifare_classic_authentication(handle, id, block,
+                                            (mifare_classic_authentication_key_t)ring->key[k].key_type,
+                                            ring->key[k].key);
+        if (res == 0)
+        {
+            ring->key[k].hit++;
+            ring->success++;
+            a_keyring_memo_save(ring, id, sector, k);
+            *index = k;
+            
+            return 0;
+        }
+        
+        /* the card is idle after a failed authentication */
+        res = mifare_classic_reselect(handle, id);
+        if (res != 0)
+        {
+            return 4;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief      keyring get a key candidate
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  index key index
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 index is invalid
+ *             - 2 ring is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_keyring_get_key(mifare_classic_keyring_t *ring, uint8_t index,
+                                       mifare_classic_authentication_key_t *key_type, uint8_t key[6])
+{
+    if (ring == NULL)
+    {
+        return 2;
+    }
+    if (index >= ring->key_count)
+    {
+        return 1;
+    }
+    
+    *key_type = (mifare_classic_authentication_key_t)(ring->key[index].key_type);
+    memcpy(key, ring->key[index].key, 6);
+    
+    return 0;
+}
+
+/**
+ * @brief      keyring get the statistics
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[out] *attempt pointer to an attempt counter buffer
+ * @param[out] *success pointer to a success counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ * @note       attempt / success is the average authentication attempts per sector
+ */
+uint8_t mifare_classic_keyring_get_statistics(mifare_classic_keyring_t *ring, uint32_t *attempt, uint32_t *success)
+{
+    if (ring == NULL)
+    {
+        return 2;
+    }
+    
+    *attempt = ring->attempt;
+    *success = ring->success;
+    
+    return 0;
+}
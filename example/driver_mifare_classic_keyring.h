@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_keyring.h
+ * @brief     driver mifare classic keyring header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_MIFARE_CLASSIC_KEYRING_H
+#define DRIVER_MIFARE_CLASSIC_KEYRING_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_keyring_driver mifare classic keyring driver function
+ * @brief    mifare classic keyring driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare classic keyring size definition
+ */
+#ifndef MIFARE_CLASSIC_KEYRING_MAX_KEY
+    #define MIFARE_CLASSIC_KEYRING_MAX_KEY     16        /**< max key candidates */
+#endif
+#ifndef MIFARE_CLASSIC_KEYRING_MAX_MEMO
+    #define MIFARE_CLASSIC_KEYRING_MAX_MEMO    64        /**< max remembered uid and sector pairs */
+#endif
+
+/**
+ * @brief mifare_classic keyring key structure definition
+ */
+typedef struct mifare_classic_keyring_key_s
+{
+    uint8_t key_type;        /**< authentication key type */
+    uint8_t key[6];          /**< key */
+    uint32_t hit;            /**< successful authentication counter */
+} mifare_classic_keyring_key_t;
+
+/**
+ * @brief mifare_classic keyring memo structure definition
+ */
+typedef struct mifare_classic_keyring_memo_s
+{
+    uint8_t valid;           /**< valid flag */
+    uint8_t uid[4];          /**< card uid */
+    uint8_t sector;          /**< sector number */
+    uint8_t index;           /**< index of the key which worked last time */
+} mifare_classic_keyring_memo_t;
+
+/**
+ * @brief mifare_classic keyring structure definition
+ */
+typedef struct mifare_classic_keyring_s
+{
+    mifare_classic_keyring_key_t key[MIFARE_CLASSIC_KEYRING_MAX_KEY];        /**< key candidates */
+    uint8_t key_count;                                                       /**< key candidate number */
+    mifare_classic_keyring_memo_t memo[MIFARE_CLASSIC_KEYRING_MAX_MEMO];     /**< uid and sector memo */
+    uint8_t memo_next;                                                       /**< next memo entry to replace */
+    uint32_t attempt;                                                        /**< authentication attempt counter */
+    uint32_t success;                                                        /**< successful authentication counter */
+} mifare_classic_keyring_t;
+
+/**
+ * @brief      keyring init
+ * @param[out] *ring pointer to a keyring structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_keyring_init(mifare_classic_keyring_t *ring);
+
+/**
+ * @brief     keyring add a key candidate
+ * @param[in] *ring pointer to a keyring structure
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 keyring is full
+ *            - 2 ring is NULL
+ * @note      none
+ */
+uint8_t mifare_classic_keyring_add(mifare_classic_keyring_t *ring, mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief      keyring authentication
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  block block of authentication
+ * @param[out] *index pointer to a key index buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no key works
+ *             - 2 handle or ring is NULL
+ *             - 4 reselect failed
+ * @note       the key which worked last time for this uid and sector is tried first,
+ *             then the other keys by their hit counters, the card is reselected with the
+ *             cached uid after each failed attempt
+ */
+uint8_t mifare_classic_keyring_authentication(mifare_classic_handle_t *handle, mifare_classic_keyring_t *ring,
+                                              uint8_t id[4], uint8_t block, uint8_t *index);
+
+/**
+ * @brief      keyring get a key candidate
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[in]  index key index
+ * @param[out] *key_type pointer to an authentication key type buffer
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 index is invalid
+ *             - 2 ring is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_keyring_get_key(mifare_classic_keyring_t *ring, uint8_t index,
+                                       mifare_classic_authentication_key_t *key_type, uint8_t key[6]);
+
+/**
+ * @brief      keyring get the statistics
+ * @param[in]  *ring pointer to a keyring structure
+ * @param[out] *attempt pointer to an attempt counter buffer
+ * @param[out] *success pointer to a success counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 ring is NULL
+ * @note       attempt / success is the average authentication attempts per sector
+ */
+uint8_t mifare_classic_keyring_get_statistics(mifare_classic_keyring_t *ring, uint32_t *attempt, uint32_t *success);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,654 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_plan.c
+ * @brief     driver mifare classic plan source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_plan.h"
+
+/**
+ * @brief iso14443a 106 kbit/s cost model definition
+ */
+#define PLAN_BIT_NS                9440        /**< one bit is 128 / 13.56 MHz */
+#define PLAN_FDT_NS                86000       /**< frame delay time between the request and the answer */
+#define PLAN_EEPROM_WRITE_NS       2500000     /**< eeprom programming time of a write or transfer */
+
+/**
+ * @brief plan key mask definition
+ */
+#define PLAN_KEY_A                 (1 << 0)    /**< key a allows the operation */
+#define PLAN_KEY_B                 (1 << 1)    /**< key b allows the operation */
+
+/**
+ * @brief data block access condition table, indexed by c1_c2_c3
+ */
+static const uint8_t gsc_plan_read[8] = {3, 3, 3, 2, 3, 2, 3, 0};         /**< read */
+static const uint8_t gsc_plan_write[8] = {3, 0, 0, 2, 2, 0, 2, 0};        /**< write */
+static const uint8_t gsc_plan_increment[8] = {3, 0, 0, 0, 0, 0, 2, 0};    /**< increment and transfer */
+static const uint8_t gsc_plan_decrement[8] = {3, 3, 0, 0, 0, 0, 3, 0};    /**< decrement and transfer */
+
+/**
+ * @brief     get the air time of a frame
+ * @param[in] byte frame bytes with the crc
+ * @return    air time in ns
+ * @note      a byte is 9 bits with the parity bit, the start and the end of the frame are 2 bits
+ */
+static uint32_t a_plan_air_ns(uint32_t byte)
+{
+    return (9 * byte + 2) * PLAN_BIT_NS;
+}
+
+/**
+ * @brief     get the modeled time of an exchange
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] tx request bytes
+ * @param[in] rx answer bytes, 0 means no answer
+ * @return    time in ns
+ * @note      an answer of 1 byte is the 4 bits ack
+ */
+static uint32_t a_plan_frame_ns(mifare_classic_plan_t *plan, uint32_t tx, uint32_t rx)
+{
+    uint32_t ns;
+    
+    ns = plan->overhead_us * 1000 + a_plan_air_ns(tx);
+    if (rx == 0)
+    {
+        ns += plan->timeout_us * 1000;
+    }
+    else if (rx == 1)
+    {
+        ns += PLAN_FDT_NS + 6 * PLAN_BIT_NS;
+    }
+    else
+    {
+        ns += PLAN_FDT_NS + a_plan_air_ns(rx);
+    }
+    
+    return ns;
+}
+
+/**
+ * @brief      get the modeled cost of an operation
+ * @param[in]  *plan pointer to a plan structure
+ * @param[in]  type operation type
+ * @param[out] *ns pointer to a time buffer
+ * @return     frames
+ * @note       the authentication is 1 frame with both passes, increment and decrement are committed by a transfer
+ */
+static uint8_t a_plan_op_cost(mifare_classic_plan_t *plan, uint8_t type, uint32_t *ns)
+{
+    switch (type)
+    {
+        case MIFARE_CLASSIC_PLAN_OP_READ :
+        {
+            *ns = a_plan_frame_ns(plan, 4, 18);
+            
+            return 1;
+        }
+        case MIFARE_CLASSIC_PLAN_OP_WRITE :
+        {
+            *ns = a_plan_frame_ns(plan, 4, 1) + a_plan_frame_ns(plan, 18, 1) + PLAN_EEPROM_WRITE_NS;
+            
+            return 2;
+        }
+        case MIFARE_CLASSIC_PLAN_OP_INCREMENT :
+        case MIFARE_CLASSIC_PLAN_OP_DECREMENT :
+        {
+            *ns = a_plan_frame_ns(plan, 4, 1) + a_plan_frame_ns(plan, 6, 0) +
+                  a_plan_frame_ns(plan, 4, 1) + PLAN_EEPROM_WRITE_NS;
+            
+            return 3;
+        }
+        default :
+        {
+            /* the second pass sends nr and ar and gets at */
+            *ns = a_plan_frame_ns(plan, 4, 4) + PLAN_FDT_NS + a_plan_air_ns(8) + a_plan_air_ns(4);
+            
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief     find the sector entry
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] sector sector number
+ * @return    sector entry index, sector_count means not found
+ * @note      none
+ */
+static uint8_t a_plan_find_sector(mifare_classic_plan_t *plan, uint8_t sector)
+{
+    uint8_t i;
+    
+    for (i = 0; i < plan->sector_count; i++)
+    {
+        if (plan->sector[i].sector == sector)
+        {
+            break;
+        }
+    }
+    
+    return i;
+}
+
+/**
+ * @brief     get the keys which allow an operation
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] *s pointer to a sector entry
+ * @param[in] *op pointer to an operation
+ * @return    key mask
+ * @note      key b can't authenticate when the trailer access makes it readable
+ */
+static uint8_t a_plan_op_keys(mifare_classic_plan_t *plan, mifare_classic_plan_sector_t *s, mifare_classic_plan_op_t *op)
+{
+    uint8_t first;
+    uint8_t index;
+    uint8_t access;
+    uint8_t mask;
+    
+    (void)mifare_classic_sector_first_block(plan->handle, s->sector, &first);
+    index = op->block - first;
+    access = s->access[(s->sector < 32) ? index : (index / 5)] & 0x07;
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_PLAN_OP_READ :
+        {
+            mask = gsc_plan_read[access];
+            
+            break;
+        }
+        case MIFARE_CLASSIC_PLAN_OP_WRITE :
+        {
+            mask = gsc_plan_write[access];
+            
+            break;
+        }
+        case MIFARE_CLASSIC_PLAN_OP_INCREMENT :
+        {
+            mask = gsc_plan_increment[access];
+            
+            break;
+        }
+        default :
+        {
+            mask = gsc_plan_decrement[access];
+            
+            break;
+        }
+    }
+    if ((s->access[3] & 0x07) <= 2)
+    {
+        mask &= (uint8_t)(~PLAN_KEY_B);
+    }
+    
+    return mask & s->key_valid;
+}
+
+/**
+ * @brief     run an operation
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] *op pointer to an operation
+ * @return    status code
+ *            - 0 success
+ *            - others failed
+ * @note      none
+ */
+static uint8_t a_plan_op_run(mifare_classic_plan_t *plan, mifare_classic_plan_op_t *op)
+{
+    uint8_t res;
+    
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_PLAN_OP_READ :
+        {
+            return mifare_classic_read(plan->handle, op->block, op->data);
+        }
+        case MIFARE_CLASSIC_PLAN_OP_WRITE :
+        {
+            return mifare_classic_write(plan->handle, op->block, op->data);
+        }
+        case MIFARE_CLASSIC_PLAN_OP_INCREMENT :
+        {
+            res = mifare_classic_increment(plan->handle, op->block, op->value);
+            
+            break;
+        }
+        default :
+        {
+            res = mifare_classic_decrement(plan->handle, op->block, op->value);
+            
+            break;
+        }
+    }
+    if (res != 0)
+    {
+        return res;
+    }
+    
+    return mifare_classic_transfer(plan->handle, op->block);
+}
+
+/**
+ * @brief     plan init
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 plan or handle is NULL
+ * @note      overhead_us and timeout_us of the cost model can be changed after init,
+ *            the auth cache of the handle is enabled
+ */
+uint8_t mifare_classic_plan_init(mifare_classic_plan_t *plan, mifare_classic_handle_t *handle)
+{
+    if ((plan == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+    if (mifare_classic_set_auth_cache(handle, MIFARE_CLASSIC_BOOL_TRUE) != 0)
+    {
+        return 1;
+    }
+    
+    memset(plan, 0, sizeof(mifare_classic_plan_t));
+    plan->handle = handle;
+    plan->overhead_us = MIFARE_CLASSIC_PLAN_OVERHEAD_US;
+    plan->timeout_us = MIFARE_CLASSIC_PLAN_TIMEOUT_US;
+    
+    return 0;
+}
+
+/**
+ * @brief     plan add the keys and access conditions of a sector
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] sector sector number
+ * @param[in] *key_a pointer to a key a buffer, NULL means unknown
+ * @param[in] *key_b pointer to a key b buffer, NULL means unknown
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 block3(block15) permission
+ * @return    status code
+ *            - 0 success
+ *            - 1 sector list is full
+ *            - 2 plan is NULL
+ *            - 4 sector is invalid
+ * @note      the permissions are c1_c2_c3 like mifare_classic_get_sector_permission returns them,
+ *            the transport configuration is 0, 0, 0 and 1
+ */
+uint8_t mifare_classic_plan_add_sector(mifare_classic_plan_t *plan, uint8_t sector, uint8_t key_a[6], uint8_t key_b[6],
+                                       uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                       uint8_t block_2_10_14, uint8_t block_3_15)
+{
+    uint8_t i;
+    mifare_classic_plan_sector_t *s;
+    
+    if (plan == NULL)
+    {
+        return 2;
+    }
+    if (sector >= 40)
+    {
+        return 4;
+    }
+    
+    i = a_plan_find_sector(plan, sector);
+    if (i == MIFARE_CLASSIC_PLAN_MAX_SECTOR)
+    {
+        return 1;
+    }
+    s = &plan->sector[i];
+    memset(s, 0, sizeof(mifare_classic_plan_sector_t));
+    s->sector = sector;
+    if (key_a != NULL)
+    {
+        memcpy(s->key_a, key_a, 6);
+        s->key_valid |= PLAN_KEY_A;
+    }
+    if (key_b != NULL)
+    {
+        memcpy(s->key_b, key_b, 6);
+        s->key_valid |= PLAN_KEY_B;
+    }
+    s->access[0] = block_0_0_4;
+    s->access[1] = block_1_5_9;
+    s->access[2] = block_2_10_14;
+    s->access[3] = block_3_15;
+    if (i == plan->sector_count)
+    {
+        plan->sector_count++;
+    }
+    plan->built = 0;
+    
+    return 0;
+}
+
+/**
+ * @brief     plan add an operation
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] type operation type
+ * @param[in] block operation block
+ * @param[in] value increment or decrement value
+ * @param[in] *data pointer to a read or write data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 operation list is full
+ *            - 2 plan is NULL
+ *            - 4 block is invalid
+ * @note      sector trailers can't be planned
+ */
+uint8_t mifare_classic_plan_add(mifare_classic_plan_t *plan, mifare_classic_plan_op_type_t type,
+                                uint8_t block, uint32_t value, uint8_t *data)
+{
+    uint8_t sector;
+    uint8_t last;
+    mifare_classic_plan_op_t *op;
+    
+    if (plan == NULL)
+    {
+        return 2;
+    }
+    if (plan->op_count >= MIFARE_CLASSIC_PLAN_MAX_OP)
+    {
+        return 1;
+    }
+    if ((type > MIFARE_CLASSIC_PLAN_OP_DECREMENT) ||
+        ((type <= MIFARE_CLASSIC_PLAN_OP_WRITE) && (data == NULL)) ||
+        ((plan->handle->type == MIFARE_CLASSIC_TYPE_S50) && (block >= 64)))
+    {
+        return 4;
+    }
+    if ((mifare_classic_block_to_sector(plan->handle, block, &sector) != 0) ||
+        (mifare_classic_sector_last_block(plan->handle, sector, &last) != 0))
+    {
+        return 4;
+    }
+    if (block == last)
+    {
+        return 4;
+    }
+    
+    op = &plan->op[plan->op_count];
+    op->type = (uint8_t)type;
+    op->block = block;
+    op->value = value;
+    op->data = data;
+    op->status = MIFARE_CLASSIC_PLAN_STATUS_NOT_RUN;
+    op->res = 0;
+    plan->op_count++;
+    plan->built = 0;
+    
+    return 0;
+}
+
+/**
+ * @brief      plan build the run order and estimate the cost
+ * @param[in]  *plan pointer to a plan structure
+ * @param[out] *cost pointer to a cost structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 plan or cost is NULL
+ *             - 5 no key allows an operation, plan->denied is its index
+ * @note       the operations are grouped by sector and keep their submission order in a sector,
+ *             each sector gets the key which allows all of its operations, key a when both do,
+ *             the sector authenticated in the handle with a planned key runs first,
+ *             the cost counts the exchanges of the blocking transceiver on an iso14443a 106 kbit/s link
+ */
+uint8_t mifare_classic_plan_build(mifare_classic_plan_t *plan, mifare_classic_plan_cost_t *cost)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t k;
+    uint8_t sector;
+    uint8_t frame;
+    uint8_t auth_sector;
+    uint8_t auth_key[6];
+    uint8_t open;
+    uint8_t mask[MIFARE_CLASSIC_PLAN_MAX_SECTOR];
+    uint8_t entry[MIFARE_CLASSIC_PLAN_MAX_OP];
+    uint8_t done[MIFARE_CLASSIC_PLAN_MAX_SECTOR];
+    uint32_t ns;
+    uint32_t auth_ns;
+    uint64_t plan_ns;
+    uint64_t naive_ns;
+    mifare_classic_card_state_t state;
+    mifare_classic_authentication_key_t auth_key_type;
+    mifare_classic_plan_group_t *g;
+    
+    if ((plan == NULL) || (cost == NULL))
+    {
+        return 2;
+    }
+    
+    plan->built = 0;
+    plan->group_count = 0;
+    memset(mask, PLAN_KEY_A | PLAN_KEY_B, sizeof(mask));
+    memset(done, 0, sizeof(done));
+    memset(cost, 0, sizeof(mifare_classic_plan_cost_t));
+    
+    /* intersect the keys of all operations of a sector */
+    for (i = 0; i < plan->op_count; i++)
+    {
+        (void)mifare_classic_block_to_sector(plan->handle, plan->op[i].block, &sector);
+        entry[i] = a_plan_find_sector(plan, sector);
+        if (entry[i] == plan->sector_count)
+        {
+            plan->denied = i;
+            
+            return 5;
+        }
+        mask[entry[i]] &= a_plan_op_keys(plan, &plan->sector[entry[i]], &plan->op[i]);
+        if (mask[entry[i]] == 0)
+        {
+            plan->denied = i;
+            
+            return 5;
+        }
+    }
+    
+    /* the auth cache keeps the open session when the sector, the key type and the key match */
+    open = plan->sector_count;
+    if ((mifare_classic_get_state(plan->handle, &state, &auth_sector, &auth_key_type) == 0) &&
+        (state == MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED) &&
+        (mifare_classic_get_auth_key(plan->handle, auth_key) == 0))
+    {
+        open = a_plan_find_sector(plan, auth_sector);
+        if ((open == plan->sector_count) || ((plan->sector[open].key_valid & (1 << (uint8_t)auth_key_type)) == 0) ||
+            (memcmp(auth_key, (auth_key_type == MIFARE_CLASSIC_AUTHENTICATION_KEY_A) ?
+                    plan->sector[open].key_a : plan->sector[open].key_b, 6) != 0))
+        {
+            open = plan->sector_count;
+        }
+    }
+    
+    /* the open session runs first, then the sectors in ascending order */
+    k = 0;
+    while (1)
+    {
+        j = MIFARE_CLASSIC_PLAN_MAX_SECTOR;
+        for (i = 0; i < plan->op_count; i++)
+        {
+            if (done[entry[i]] != 0)
+            {
+                continue;
+            }
+            if (entry[i] == open)
+            {
+                j = entry[i];
+                
+                break;
+            }
+            if ((j == MIFARE_CLASSIC_PLAN_MAX_SECTOR) || (plan->sector[entry[i]].sector < plan->sector[j].sector))
+            {
+                j = entry[i];
+            }
+        }
+        if (j == MIFARE_CLASSIC_PLAN_MAX_SECTOR)
+        {
+            break;
+        }
+        done[j] = 1;
+        
+        g = &plan->group[plan->group_count];
+        g->sector = j;
+        if ((j == open) && ((mask[j] & (1 << (uint8_t)auth_key_type)) != 0))
+        {
+            g->key_type = (uint8_t)auth_key_type;
+        }
+        else
+        {
+            g->key_type = ((mask[j] & PLAN_KEY_A) != 0) ? MIFARE_CLASSIC_AUTHENTICATION_KEY_A : MIFARE_CLASSIC_AUTHENTICATION_KEY_B;
+        }
+        g->first = k;
+        for (i = 0; i < plan->op_count; i++)
+        {
+            if (entry[i] == j)
+            {
+                plan->order[k] = i;
+                k++;
+            }
+        }
+        g->count = k - g->first;
+        plan->group_count++;
+    }
+    
+    /* the cost of the plan against one authentication per operation */
+    frame = a_plan_op_cost(plan, 0xFF, &auth_ns);
+    plan_ns = 0;
+    naive_ns = 0;
+    for (i = 0; i < plan->group_count; i++)
+    {
+        g = &plan->group[i];
+        if ((g->sector != open) || (g->key_type != (uint8_t)auth_key_type))
+        {
+            cost->auth++;
+            cost->frame += frame;
+            plan_ns += auth_ns;
+        }
+    }
+    for (i = 0; i < plan->op_count; i++)
+    {
+        frame = a_plan_op_cost(plan, plan->op[i].type, &ns);
+        cost->frame += frame;
+        cost->naive_frame += (uint16_t)(frame + 1);
+        cost->naive_auth++;
+        plan_ns += ns;
+        naive_ns += (uint64_t)ns + auth_ns;
+    }
+    cost->time_us = (uint32_t)(plan_ns / 1000);
+    cost->naive_time_us = (uint32_t)(naive_ns / 1000);
+    plan->built = 1;
+    
+    return 0;
+}
+
+/**
+ * @brief      plan run
+ * @param[in]  *plan pointer to a plan structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[out] *failed pointer to a failed operation count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 run failed
+ *             - 2 plan or failed is NULL
+ *             - 3 plan is not built
+ * @note       the card must be selected, each sector is authenticated once, after a failed operation
+ *             the card is reselected and the sector is authenticated again, 1 is returned when
+ *             an operation failed or the card is lost
+ */
+uint8_t mifare_classic_plan_run(mifare_classic_plan_t *plan, uint8_t id[4], uint8_t *failed)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t res;
+    uint8_t lost;
+    mifare_classic_plan_op_t *op;
+    mifare_classic_plan_group_t *g;
+    mifare_classic_plan_sector_t *s;
+    
+    if ((plan == NULL) || (failed == NULL))
+    {
+        return 2;
+    }
+    if (plan->built == 0)
+    {
+        return 3;
+    }
+    
+    *failed = 0;
+    lost = 0;
+    for (i = 0; i < plan->op_count; i++)
+    {
+        plan->op[i].status = MIFARE_CLASSIC_PLAN_STATUS_NOT_RUN;
+        plan->op[i].res = 0;
+    }
+    for (i = 0; i < plan->group_count; i++)
+    {
+        g = &plan->group[i];
+        for (j = 0; j < g->count; j++)
+        {
+            op = &plan->op[plan->order[g->first + j]];
+            if (lost != 0)
+            {
+                op->status = MIFARE_CLASSIC_PLAN_STATUS_FAILED;
+                (*failed)++;
+                
+                continue;
+            }
+            s = &plan->sector[g->sector];
+            res = mifare_classic_authentication(plan->handle, id, op->block, (mifare_classic_authentication_key_t)g->key_type,
+                                                (g->key_type == MIFARE_CLASSIC_AUTHENTICATION_KEY_A) ? s->key_a : s->key_b);
+            if (res == 0)
+            {
+                res = a_plan_op_run(plan, op);
+            }
+            if (res == 0)
+            {
+                op->status = MIFARE_CLASSIC_PLAN_STATUS_DONE;
+                
+                continue;
+            }
+            op->status = MIFARE_CLASSIC_PLAN_STATUS_FAILED;
+            op->res = res;
+            (*failed)++;
+            
+            /* a failed command drops the session, the next operation needs the card again */
+            if (mifare_classic_reselect(plan->handle, id) != 0)
+            {
+                lost = 1;
+            }
+        }
+    }
+    
+    return (*failed != 0) ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_plan.h
+ * @brief     driver mifare classic plan header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_MIFARE_CLASSIC_PLAN_H
+#define DRIVER_MIFARE_CLASSIC_PLAN_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_plan_driver mifare classic plan driver function
+ * @brief    mifare classic plan driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare classic plan size definition
+ */
+#ifndef MIFARE_CLASSIC_PLAN_MAX_OP
+    #define MIFARE_CLASSIC_PLAN_MAX_OP        32        /**< max operations of a plan */
+#endif
+#ifndef MIFARE_CLASSIC_PLAN_MAX_SECTOR
+    #define MIFARE_CLASSIC_PLAN_MAX_SECTOR    16        /**< max sectors with keys */
+#endif
+
+/**
+ * @brief mifare classic plan cost model definition
+ */
+#define MIFARE_CLASSIC_PLAN_OVERHEAD_US    150         /**< default reader overhead of each frame */
+#define MIFARE_CLASSIC_PLAN_TIMEOUT_US     1000        /**< default reader timeout of a frame without an answer */
+
+/**
+ * @brief mifare_classic plan operation type enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_PLAN_OP_READ      = 0x00,        /**< read a block */
+    MIFARE_CLASSIC_PLAN_OP_WRITE     = 0x01,        /**< write a block */
+    MIFARE_CLASSIC_PLAN_OP_INCREMENT = 0x02,        /**< increment and transfer a value block */
+    MIFARE_CLASSIC_PLAN_OP_DECREMENT = 0x03,        /**< decrement and transfer a value block */
+} mifare_classic_plan_op_type_t;
+
+/**
+ * @brief mifare_classic plan operation status enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_PLAN_STATUS_NOT_RUN = 0x00,        /**< operation is not run */
+    MIFARE_CLASSIC_PLAN_STATUS_DONE    = 0x01,        /**< operation is done */
+    MIFARE_CLASSIC_PLAN_STATUS_FAILED  = 0x02,        /**< operation failed */
+} mifare_classic_plan_status_t;
+
+/**
+ * @brief mifare_classic plan operation structure definition
+ */
+typedef struct mifare_classic_plan_op_s
+{
+    uint8_t type;            /**< operation type */
+    uint8_t block;           /**< block */
+    uint32_t value;          /**< increment or decrement value */
+    uint8_t *data;           /**< read output or write input buffer */
+    uint8_t status;          /**< operation status of the last run */
+    uint8_t res;             /**< return code of the failed call */
+} mifare_classic_plan_op_t;
+
+/**
+ * @brief mifare_classic plan sector structure definition
+ */
+typedef struct mifare_classic_plan_sector_s
+{
+    uint8_t sector;          /**< sector number */
+    uint8_t key_valid;       /**< bit 0 key a is known, bit 1 key b is known */
+    uint8_t key_a[6];        /**< key a */
+    uint8_t key_b[6];        /**< key b */
+    uint8_t access[4];       /**< c1_c2_c3 of the three data block groups and the sector trailer */
+} mifare_classic_plan_sector_t;
+
+/**
+ * @brief mifare_classic plan group structure definition
+ */
+typedef struct mifare_classic_plan_group_s
+{
+    uint8_t sector;          /**< index of the sector entry */
+    uint8_t key_type;        /**< authentication key type */
+    uint8_t first;           /**< first position in the order */
+    uint8_t count;           /**< operation number */
+} mifare_classic_plan_group_t;
+
+/**
+ * @brief mifare_classic plan cost structure definition
+ */
+typedef struct mifare_classic_plan_cost_s
+{
+    uint16_t auth;                 /**< authentications of the plan */
+    uint16_t frame;                /**< frames of the plan */
+    uint32_t time_us;              /**< modeled rf time of the plan */
+    uint16_t naive_auth;           /**< authentications in submission order with one authentication per operation */
+    uint16_t naive_frame;          /**< frames in submission order */
+    uint32_t naive_time_us;        /**< modeled rf time in submission order */
+} mifare_classic_plan_cost_t;
+
+/**
+ * @brief mifare_classic plan structure definition
+ */
+typedef struct mifare_classic_plan_s
+{
+    mifare_classic_handle_t *handle;                                       /**< mifare_classic handle */
+    uint32_t overhead_us;                                                  /**< modeled reader overhead of each frame */
+    uint32_t timeout_us;                                                   /**< modeled reader timeout */
+    mifare_classic_plan_sector_t sector[MIFARE_CLASSIC_PLAN_MAX_SECTOR];   /**< sector keys and access conditions */
+    uint8_t sector_count;                                                  /**< sector entry number */
+    mifare_classic_plan_op_t op[MIFARE_CLASSIC_PLAN_MAX_OP];               /**< operations in submission order */
+    uint8_t op_count;                                                      /**< operation number */
+    uint8_t order[MIFARE_CLASSIC_PLAN_MAX_OP];                             /**< operation indexes in run order */
+    mifare_classic_plan_group_t group[MIFARE_CLASSIC_PLAN_MAX_SECTOR];     /**< one authentication group per sector */
+    uint8_t group_count;                                                   /**< group number */
+    uint8_t built;                                                         /**< built flag */
+    uint8_t denied;                                                        /**< index of the operation no key allows */
+} mifare_classic_plan_t;
+
+/**
+ * @brief     plan init
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 plan or handle is NULL
+ * @note      overhead_us and timeout_us of the cost model can be changed after init,
+ *            the auth cache of the handle is enabled
+ */
+uint8_t mifare_classic_plan_init(mifare_classic_plan_t *plan, mifare_classic_handle_t *handle);
+
+/**
+ * @brief     plan add the keys and access conditions of a sector
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] sector sector number
+ * @param[in] *key_a pointer to a key a buffer, NULL means unknown
+ * @param[in] *key_b pointer to a key b buffer, NULL means unknown
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 block3(block15) permission
+ * @return    status code
+ *            - 0 success
+ *            - 1 sector list is full
+ *            - 2 plan is NULL
+ *            - 4 sector is invalid
+ * @note      the permissions are c1_c2_c3 like mifare_classic_get_sector_permission returns them,
+ *            the transport configuration is 0, 0, 0 and 1
+ */
+uint8_t mifare_classic_plan_add_sector(mifare_classic_plan_t *plan, uint8_t sector, uint8_t key_a[6], uint8_t key_b[6],
+                                       uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                       uint8_t block_2_10_14, uint8_t block_3_15);
+
+/**
+ * @brief     plan add an operation
+ * @param[in] *plan pointer to a plan structure
+ * @param[in] type operation type
+ * @param[in] block operation block
+ * @param[in] value increment or decrement value
+ * @param[in] *data pointer to a read or write data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 operation list is full
+ *            - 2 plan is NULL
+ *            - 4 block is invalid
+ * @note      sector trailers can't be planned
+ */
+uint8_t mifare_classic_plan_add(mifare_classic_plan_t *plan, mifare_classic_plan_op_type_t type,
+                                uint8_t block, uint32_t value, uint8_t *data);
+
+/**
+ * @brief      plan build the run order and estimate the cost
+ * @param[in]  *plan pointer to a plan structure
+ * @param[out] *cost pointer to a cost structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 plan or cost is NULL
+ *             - 5 no key allows an operation, plan->denied is its index
+ * @note       the operations are grouped by sector and keep their submission order in a sector,
+ *             each sector gets the key which allows all of its operations, key a when both do,
+ *             the sector authenticated in the handle with a planned key runs first,
+ *             the cost counts the exchanges of the blocking transceiver on an iso14443a 106 kbit/s link
+ */
+uint8_t mifare_classic_plan_build(mifare_classic_plan_t *plan, mifare_classic_plan_cost_t *cost);
+
+/**
+ * @brief      plan run
+ * @param[in]  *plan pointer to a plan structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[out] *failed pointer to a failed operation count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 run failed
+ *             - 2 plan or failed is NULL
+ *             - 3 plan is not built
+ * @note       the card must be selected, each sector is authenticated once, after a failed operation
+ *             the card is reselected and the sector is authenticated again, 1 is returned when
+ *             an operation failed or the card is lost
+ */
+uint8_t mifare_classic_plan_run(mifare_classic_plan_t *plan, uint8_t id[4], uint8_t *failed);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
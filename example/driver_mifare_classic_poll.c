@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_poll.c
+ * @brief     driver mifare classic poll source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_poll.h"
+
+/**
+ * @brief      try to find and select one card
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 no card
+ * @note       none
+ */
+static uint8_t a_poll_once(mifare_classic_handle_t *handle, mifare_classic_type_t *type, mifare_classic_uid_t *uid)
+{
+    /* request */
+    if (mifare_classic_request(handle, type) != 0)
+    {
+        return 1;
+    }
+    
+    /* anti collision and select all cascade levels */
+    if (mifare_classic_select(handle, uid) != 0)
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     get the next wait interval
+ * @param[in] *poll pointer to a poll structure
+ * @return    interval in ms
+ * @note      none
+ */
+static uint32_t a_poll_next_interval(mifare_classic_poll_t *poll)
+{
+    if (poll->mode == MIFARE_CLASSIC_POLL_MODE_FIXED)
+    {
+        return poll->slow_ms;
+    }
+    
+    /* aggressive right after a card leaves */
+    if (poll->since_leave_ms < poll->fast_period_ms)
+    {
+        poll->interval_ms = poll->fast_ms;
+        
+        return poll->interval_ms;
+    }
+    
+    /* back off when idle */
+    if (poll->interval_ms < poll->fast_ms)
+    {
+        poll->interval_ms = poll->fast_ms;
+    }
+    else if (poll->interval_ms < poll->slow_ms)
+    {
+        poll->interval_ms = poll->interval_ms * 2;
+    }
+    else
+    {
+        /* keep the max */
+    }
+    if (poll->interval_ms > poll->slow_ms)
+    {
+        poll->interval_ms = poll->slow_ms;
+    }
+    
+    return poll->interval_ms;
+}
+
+/**
+ * @brief      poll init
+ * @param[out] *poll pointer to a poll structure
+ * @param[in]  mode poll mode
+ * @param[in]  fast_ms aggressive interval
+ * @param[in]  slow_ms max interval
+ * @param[in]  fast_period_ms aggressive period after a card leaves
+ * @return     status code
+ *             - 0 success
+ *             - 1 interval is invalid
+ *             - 2 poll is NULL
+ * @note       card_detect and timestamp_ms can be linked after init
+ */
+uint8_t mifare_classic_poll_init(mifare_classic_poll_t *poll, mifare_classic_poll_mode_t mode,
+                                 uint32_t fast_ms, uint32_t slow_ms, uint32_t fast_period_ms)
+{
+    if (poll == NULL)
+    {
+        return 2;
+    }
+    if ((fast_ms == 0) || (fast_ms > slow_ms))
+    {
+        return 1;
+    }
+    
+    memset(poll, 0, sizeof(mifare_classic_poll_t));
+    poll->mode = (uint8_t)mode;
+    poll->fast_ms = fast_ms;
+    poll->slow_ms = slow_ms;
+    poll->fast_period_ms = fast_period_ms;
+    poll->interval_ms = fast_ms;
+    poll->since_leave_ms = fast_period_ms;
+    
+    return 0;
+}
+
+/**
+ * @brief      poll search a card
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *poll pointer to a poll structure
+ * @param[out] *type pointer to a type buffer
+ * @param[out] *uid pointer to an uid structure
+ * @param[in]  timeout check times
+ * @return     status code
+ *             - 0 success
+ *             - 1 timeout
+ *             - 2 handle or poll is NULL
+ * @note       timeout counts the waits between two polls as before, -1 means never timeout
+ */
+uint8_t mifare_classic_poll_search(mifare_classic_handle_t *handle, mifare_classic_poll_t *poll,
+                                   mifare_classic_type_t *type, mifare_classic_uid_t *uid, int32_t timeout)
+{
+    uint8_t missed;
+    uint32_t wait;
+    uint32_t latency;
+    
+    if ((handle == NULL) || (poll == NULL))
+    {
+        return 2;
+    }
+    
+    missed = 0;
+    wait = 0;
+    
+    /* loop */
+    while (1)
+    {
+        if (a_poll_once(handle, type, uid) == 0)
+        {
+            /* the latency is bounded by the time since the last missed poll */
+            if (missed == 0)
+            {
+                latency = 0;
+            }
+            else if (poll->timestamp_ms != NULL)
+            {
+                latency = poll->timestamp_ms() - poll->last_miss_ms;
+            }
+            else
+            {
+                latency = wait;
+            }
+            poll->latency_last_ms = latency;
+            if (latency > poll->latency_max_ms)
+            {
+                poll->latency_max_ms = latency;
+            }
+            poll->latency_sum_ms += latency;
+            poll->detect_count++;
+            poll->present = 1;
+            poll->interval_ms = poll->fast_ms;
+            
+            return 0;
+        }
+        
+        /* the card has just left */
+        if (poll->present != 0)
+        {
+            poll->present = 0;
+            poll->since_leave_ms = 0;
+        }
+        missed = 1;
+        if (poll->timestamp_ms != NULL)
+        {
+            poll->last_miss_ms = poll->timestamp_ms();
+        }
+        
+        /* wait */
+        wait = a_poll_next_interval(poll);
+        if ((poll->mode == MIFARE_CLASSIC_POLL_MODE_IRQ) && (poll->card_detect != NULL))
+        {
+            (void)poll->card_detect(poll->slow_ms);
+            wait = poll->slow_ms;
+        }
+        else
+        {
+            handle->delay_ms(wait);
+        }
+        if (poll->since_leave_ms < poll->fast_period_ms)
+        {
+            poll->since_leave_ms += wait;
+        }
+        
+        /* check the timeout */
+        if (timeout < 0)
+        {
+            /* never timeout */
+            continue;
+        }
+        else
+        {
+            /* timeout */
+            if (timeout == 0)
+            {
+                return 1;
+            }
+            else
+            {
+                /* timout-- */
+                timeout--;
+            }
+        }
+    }
+}
+
+/**
+ * @brief      poll get the detection latency
+ * @param[in]  *poll pointer to a poll structure
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 poll is NULL
+ * @note       the latency is the time between the last missed poll and the detection,
+ *             the wait interval is used when timestamp_ms is not linked
+ */
+uint8_t mifare_classic_poll_get_latency(mifare_classic_poll_t *poll, uint32_t *last_ms, uint32_t *max_ms, uint32_t *avg_ms)
+{
+    if (poll == NULL)
+    {
+        return 2;
+    }
+    
+    *last_ms = poll->latency_last_ms;
+    *max_ms = poll->latency_max_ms;
+    *avg_ms = (poll->detect_count != 0) ? (poll->latency_sum_ms / poll->detect_count) : 0;
+    
+    return 0;
+}
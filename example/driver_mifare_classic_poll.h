@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_poll.h
+ * @brief     driver mifare classic poll header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_MIFARE_CLASSIC_POLL_H
+#define DRIVER_MIFARE_CLASSIC_POLL_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_poll_driver mifare classic poll driver function
+ * @brief    mifare classic poll driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare_classic poll mode enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_POLL_MODE_FIXED    = 0x00,        /**< always wait slow_ms */
+    MIFARE_CLASSIC_POLL_MODE_ADAPTIVE = 0x01,        /**< fast_ms after a card leaves, then back off to slow_ms */
+    MIFARE_CLASSIC_POLL_MODE_IRQ      = 0x02,        /**< wait for the reader card detect, adaptive if it is not linked */
+} mifare_classic_poll_mode_t;
+
+/**
+ * @brief mifare_classic poll structure definition
+ */
+typedef struct mifare_classic_poll_s
+{
+    uint8_t mode;                                      /**< poll mode */
+    uint32_t fast_ms;                                  /**< aggressive interval */
+    uint32_t slow_ms;                                  /**< max interval */
+    uint32_t fast_period_ms;                           /**< aggressive period after a card leaves */
+    uint8_t (*card_detect)(uint32_t timeout_ms);       /**< wait for the reader card detect, 0 means a card is detected */
+    uint32_t (*timestamp_ms)(void);                    /**< optional millisecond timestamp */
+    uint8_t present;                                   /**< card found by the last search flag */
+    uint32_t interval_ms;                              /**< current interval */
+    uint32_t since_leave_ms;                           /**< time since the card left */
+    uint32_t last_miss_ms;                             /**< timestamp of the last missed poll */
+    uint32_t latency_last_ms;                          /**< last detection latency */
+    uint32_t latency_max_ms;                           /**< max detection latency */
+    uint32_t latency_sum_ms;                           /**< detection latency sum */
+    uint32_t detect_count;                             /**< detection counter */
+} mifare_classic_poll_t;
+
+/**
+ * @brief      poll init
+ * @param[out] *poll pointer to a poll structure
+ * @param[in]  mode poll mode
+ * @param[in]  fast_ms aggressive interval
+ * @param[in]  slow_ms max interval
+ * @param[in]  fast_period_ms aggressive period after a card leaves
+ * @return     status code
+ *             - 0 success
+ *             - 1 interval is invalid
+ *             - 2 poll is NULL
+ * @note       card_detect and timestamp_ms can be linked after init
+ */
+uint8_t mifare_classic_poll_init(mifare_classic_poll_t *poll, mifare_classic_poll_mode_t mode,
+                                 uint32_t fast_ms, uint32_t slow_ms, uint32_t fast_period_ms);
+
+/**
+ * @brief      poll search a card
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *poll pointer to a poll structure
+ * @param[out] *type pointer to a type buffer
+ * @param[out] *uid pointer to an uid structure
+ * @param[in]  timeout check times
+ * @return     status code
+ *             - 0 success
+ *             - 1 timeout
+ *             - 2 handle or poll is NULL
+ * @note       timeout counts the waits between two polls as before, -1 means never timeout
+ */
+uint8_t mifare_classic_poll_search(mifare_classic_handle_t *handle, mifare_classic_poll_t *poll,
+                                   mifare_classic_type_t *type, mifare_classic_uid_t *uid, int32_t timeout);
+
+/**
+ * @brief      poll get the detection latency
+ * @param[in]  *poll pointer to a poll structure
+ * @param[out] *last_ms pointer to a last latency buffer
+ * @param[out] *max_ms pointer to a max latency buffer
+ * @param[out] *avg_ms pointer to an average latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 poll is NULL
+ * @note       the latency is the time between the last missed poll and the detection,
+ *             the wait interval is used when timestamp_ms is not linked
+ */
+uint8_t mifare_classic_poll_get_latency(mifare_classic_poll_t *poll, uint32_t *last_ms, uint32_t *max_ms, uint32_t *avg_ms);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_purse.c
+ * @brief     driver mifare classic purse source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#include "driver_mifare_classic_purse.h"
+
+/**
+ * @brief      decode a value block
+ * @param[in]  *data pointer to a block buffer
+ * @param[out] *value pointer to a value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 block is broken
+ * @note       the value and the address are stored three and four times, a torn write breaks the copies
+ */
+static uint8_t a_purse_decode(uint8_t data[16], int32_t *value)
+{
+    uint32_t v0;
+    uint32_t v1;
+    uint32_t v2;
+    
+    v0 = ((uint32_t)data[0] << 0) | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    v1 = ((uint32_t)data[4] << 0) | ((uint32_t)data[5] << 8) | ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+    v2 = ((uint32_t)data[8] << 0) | ((uint32_t)data[9] << 8) | ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);
+    if ((v0 != v2) || (v0 != (uint32_t)(~v1)))
+    {
+        return 1;
+    }
+    if ((data[12] != data[14]) || (data[13] != data[15]) || ((uint8_t)(data[12] ^ data[13]) != 0xFF))
+    {
+        return 1;
+    }
+    *value = (int32_t)v0;
+    
+    return 0;
+}
+
+/**
+ * @brief      open the purse
+ * @param[in]  *purse pointer to a purse structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *recovered pointer to a recovered flag buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 open failed
+ *             - 5 both blocks are broken
+ * @note       the blocks are read as data blocks, so a broken value block keeps the session
+ */
+static uint8_t a_purse_open(mifare_classic_purse_t *purse, uint8_t id[4],
+                            mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                            int32_t *value, mifare_classic_bool_t *recovered)
+{
+    uint8_t data[16];
+    
+    *recovered = MIFARE_CLASSIC_BOOL_FALSE;
+    if (mifare_classic_authentication(purse->handle, id, purse->block, key_type, key) != 0)
+    {
+        return 1;
+    }
+    if (mifare_classic_read(purse->handle, purse->block, data) != 0)
+    {
+        return 1;
+    }
+    if (a_purse_decode(data, value) == 0)
+    {
+        return 0;
+    }
+    
+    /* the primary block is torn, the backup holds the value before the torn debit */
+    if (mifare_classic_read(purse->handle, purse->backup, data) != 0)
+    {
+        return 1;
+    }
+    if (a_purse_decode(data, value) != 0)
+    {
+        return 5;
+    }
+    if ((mifare_classic_restore(purse->handle, purse->backup) != 0) ||
+        (mifare_classic_transfer(purse->handle, purse->block) != 0))
+    {
+        return 1;
+    }
+    *recovered = MIFARE_CLASSIC_BOOL_TRUE;
+    
+    return 0;
+}
+
+/**
+ * @brief     purse init
+ * @param[in] *purse pointer to a purse structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block primary value block
+ * @param[in] backup backup value block
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 purse or handle is NULL
+ *            - 4 block is invalid
+ * @note      both blocks must be different data blocks of the same sector,
+ *            the auth cache of the handle is enabled so that a debit after a read needs no authentication
+ */
+uint8_t mifare_classic_purse_init(mifare_classic_purse_t *purse, mifare_classic_handle_t *handle,
+                                  uint8_t block, uint8_t backup)
+{
+    uint8_t sector;
+    uint8_t backup_sector;
+    uint8_t last;
+    
+    if ((purse == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+    if ((mifare_classic_block_to_sector(handle, block, &sector) != 0) ||
+        (mifare_classic_block_to_sector(handle, backup, &backup_sector) != 0) ||
+        (mifare_classic_sector_last_block(handle, sector, &last) != 0))
+    {
+        return 4;
+    }
+    if ((block == backup) || (sector != backup_sector) || (block == 0) || (backup == 0) ||
+        (block == last) || (backup == last))
+    {
+        return 4;
+    }
+    if (mifare_classic_set_auth_cache(handle, MIFARE_CLASSIC_BOOL_TRUE) != 0)
+    {
+        return 1;
+    }
+    
+    purse->handle = handle;
+    purse->block = block;
+    purse->backup = backup;
+    
+    return 0;
+}
+
+/**
+ * @brief     purse format
+ * @param[in] *purse pointer to a purse structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] value init value
+ * @return    status code
+ *            - 0 success
+ *            - 1 format failed
+ *            - 2 purse is NULL
+ * @note      both blocks get the value and the address of the primary block
+ */
+uint8_t mifare_classic_purse_format(mifare_classic_purse_t *purse, uint8_t id[4],
+                                    mifare_classic_authentication_key_t key_type, uint8_t key[6], int32_t value)
+{
+    if ((purse == NULL) || (purse->handle == NULL))
+    {
+        return 2;
+    }
+    
+    if ((mifare_classic_authentication(purse->handle, id, purse->block, key_type, key) != 0) ||
+        (mifare_classic_value_init(purse->handle, purse->backup, value, purse->block) != 0) ||
+        (mifare_classic_value_init(purse->handle, purse->block, value, purse->block) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief      purse read
+ * @param[in]  *purse pointer to a purse structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *recovered pointer to a recovered flag buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 purse is NULL
+ *             - 5 both blocks are broken
+ * @note       only the primary block is read, a primary block broken by a tear is restored
+ *             from the backup block and recovered is set
+ */
+uint8_t mifare_classic_purse_read(mifare_classic_purse_t *purse, uint8_t id[4],
+                                  mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                  int32_t *value, mifare_classic_bool_t *recovered)
+{
+    if ((purse == NULL) || (purse->handle == NULL))
+    {
+        return 2;
+    }
+    
+    return a_purse_open(purse, id, key_type, key, value, recovered);
+}
+
+/**
+ * @brief      purse debit
+ * @param[in]  *purse pointer to a purse structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  amount debit amount
+ * @param[out] *balance pointer to a balance buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 debit failed
+ *             - 2 purse is NULL
+ *             - 5 both blocks are broken
+ *             - 6 value is not enough
+ * @note       the primary block is copied to the backup block with restore and transfer,
+ *             then it is decremented and transferred, a tear leaves either the old or the new
+ *             value in the primary block or a broken primary block with the old value in the backup,
+ *             mifare_classic_purse_read and this function recover it on the next tap
+ */
+uint8_t mifare_classic_purse_debit(mifare_classic_purse_t *purse, uint8_t id[4],
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                   uint32_t amount, int32_t *balance)
+{
+    uint8_t res;
+    int32_t value;
+    mifare_classic_bool_t recovered;
+    
+    if ((purse == NULL) || (purse->handle == NULL))
+    {
+        return 2;
+    }
+    
+    /* one read gives the value and finds a torn primary block */
+    res = a_purse_open(purse, id, key_type, key, &value, &recovered);
+    if (res != 0)
+    {
+        return res;
+    }
+    if ((value < 0) || ((uint32_t)value < amount))
+    {
+        return 6;
+    }
+    if (amount == 0)
+    {
+        *balance = value;
+        
+        return 0;
+    }
+    
+    /* save the old value, a recovered purse has it in the backup already */
+    if (recovered == MIFARE_CLASSIC_BOOL_FALSE)
+    {
+        if ((mifare_classic_restore(purse->handle, purse->block) != 0) ||
+            (mifare_classic_transfer(purse->handle, purse->backup) != 0))
+        {
+            return 1;
+        }
+    }
+    
+    /* commit the new value */
+    if ((mifare_classic_decrement(purse->handle, purse->block, amount) != 0) ||
+        (mifare_classic_transfer(purse->handle, purse->block) != 0))
+    {
+        return 1;
+    }
+    *balance = (int32_t)((uint32_t)value - amount);
+    
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_purse.h
+ * @brief     driver mifare classic purse header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#ifndef DRIVER_MIFARE_CLASSIC_PURSE_H
+#define DRIVER_MIFARE_CLASSIC_PURSE_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_purse_driver mifare classic purse driver function
+ * @brief    mifare classic purse driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare_classic purse structure definition
+ */
+typedef struct mifare_classic_purse_s
+{
+    mifare_classic_handle_t *handle;        /**< mifare_classic handle */
+    uint8_t block;                          /**< primary value block */
+    uint8_t backup;                         /**< backup value block */
+} mifare_classic_purse_t;
+
+/**
+ * @brief     purse init
+ * @param[in] *purse pointer to a purse structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block primary value block
+ * @param[in] backup backup value block
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 purse or handle is NULL
+ *            - 4 block is invalid
+ * @note      both blocks must be different data blocks of the same sector,
+ *            the auth cache of the handle is enabled so that a debit after a read needs no authentication
+ */
+uint8_t mifare_classic_purse_init(mifare_classic_purse_t *purse, mifare_classic_handle_t *handle,
+                                  uint8_t block, uint8_t backup);
+
+/**
+ * @brief     purse format
+ * @param[in] *purse pointer to a purse structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] value init value
+ * @return    status code
+ *            - 0 success
+ *            - 1 format failed
+ *            - 2 purse is NULL
+ * @note      both blocks get the value and the address of the primary block
+ */
+uint8_t mifare_classic_purse_format(mifare_classic_purse_t *purse, uint8_t id[4],
+                                    mifare_classic_authentication_key_t key_type, uint8_t key[6], int32_t value);
+
+/**
+ * @brief      purse read
+ * @param[in]  *purse pointer to a purse structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *recovered pointer to a recovered flag buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 purse is NULL
+ *             - 5 both blocks are broken
+ * @note       only the primary block is read, a primary block broken by a tear is restored
+ *             from the backup block and recovered is set
+ */
+uint8_t mifare_classic_purse_read(mifare_classic_purse_t *purse, uint8_t id[4],
+                                  mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                  int32_t *value, mifare_classic_bool_t *recovered);
+
+/**
+ * @brief      purse debit
+ * @param[in]  *purse pointer to a purse structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  amount debit amount
+ * @param[out] *balance pointer to a balance buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 debit failed
+ *             - 2 purse is NULL
+ *             - 5 both blocks are broken
+ *             - 6 value is not enough
+ * @note       the primary block is copied to the backup block with restore and transfer,
+ *             then it is decremented and transferred, a tear leaves either the old or the new
+ *             value in the primary block or a broken primary block with the old value in the backup,
+ *             mifare_classic_purse_read and this function recover it on the next tap
+ */
+uint8_t mifare_classic_purse_debit(mifare_classic_purse_t *purse, uint8_t id[4],
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                   uint32_t amount, int32_t *balance);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
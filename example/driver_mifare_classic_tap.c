@@ -0,0 +1,519 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_tap.c
+ * @brief     driver mifare classic tap source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#include "driver_mifare_classic_tap.h"
+
+/**
+ * @brief     get the timestamp
+ * @param[in] *tap pointer to a tap structure
+ * @return    timestamp in us or 0 when timestamp_us is not linked
+ * @note      none
+ */
+static uint32_t a_tap_timestamp(mifare_classic_tap_t *tap)
+{
+    return (tap->timestamp_us != NULL) ? tap->timestamp_us() : 0;
+}
+
+/**
+ * @brief     add a step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] op step operation
+ * @param[in] rule failure rule
+ * @return    pointer to the cleared step or NULL when the program is full
+ * @note      none
+ */
+static mifare_classic_tap_step_t *a_tap_add(mifare_classic_tap_t *tap, mifare_classic_tap_op_t op, mifare_classic_tap_rule_t rule)
+{
+    mifare_classic_tap_step_t *step;
+    
+    if (tap->step_count >= MIFARE_CLASSIC_TAP_MAX_STEP)
+    {
+        return NULL;
+    }
+    
+    step = &tap->step[tap->step_count];
+    memset(step, 0, sizeof(mifare_classic_tap_step_t));
+    step->op = (uint8_t)op;
+    step->rule = (uint8_t)rule;
+    tap->step_count++;
+    
+    return step;
+}
+
+/**
+ * @brief     run one step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] *step pointer to a step structure
+ * @param[in] *auth pointer to the last authentication step or NULL
+ * @return    status code
+ *            - 0 success
+ *            - other the return code of the failed call
+ * @note      none
+ */
+static uint8_t a_tap_step(mifare_classic_tap_t *tap, mifare_classic_tap_step_t *step, mifare_classic_tap_step_t *auth)
+{
+    uint8_t res;
+    uint8_t i;
+    int32_t value;
+    uint8_t addr;
+    
+    switch (step->op)
+    {
+        case MIFARE_CLASSIC_TAP_OP_SELECT :
+        {
+            res = mifare_classic_request(tap->handle, &tap->type);
+            if (res != 0)
+            {
+                return res;
+            }
+            res = mifare_classic_select(tap->handle, &tap->uid);
+            if (res != 0)
+            {
+                return res;
+            }
+            
+            return mifare_classic_uid_to_id(&tap->uid, tap->id);
+        }
+        case MIFARE_CLASSIC_TAP_OP_AUTHENTICATION :
+        {
+            return mifare_classic_authentication(tap->handle, tap->id, step->block,
+                                                 (mifare_classic_authentication_key_t)step->key_type, step->key);
+        }
+        case MIFARE_CLASSIC_TAP_OP_READ :
+        {
+            for (i = 0; i < step->count; i++)
+            {
+                res = mifare_classic_read(tap->handle, (uint8_t)(step->block + i), &step->data[i * 16]);
+                if (res != 0)
+                {
+                    return res;
+                }
+            }
+            
+            return 0;
+        }
+        case MIFARE_CLASSIC_TAP_OP_DEBIT :
+        {
+            if (step->backup != 0)
+            {
+                if (auth == NULL)
+                {
+                    return 1;
+                }
+                
+                return mifare_classic_purse_debit(&step->purse, tap->id, (mifare_classic_authentication_key_t)auth->key_type,
+                                                  auth->key, step->amount, &tap->balance);
+            }
+            res = mifare_classic_value_read(tap->handle, step->block, &value, &addr);
+            if (res != 0)
+            {
+                return res;
+            }
+            if ((value < 0) || ((uint32_t)value < step->amount))
+            {
+                return 6;
+            }
+            res = mifare_classic_decrement(tap->handle, step->block, step->amount);
+            if (res != 0)
+            {
+                return res;
+            }
+            res = mifare_classic_transfer(tap->handle, step->block);
+            if (res != 0)
+            {
+                return res;
+            }
+            tap->balance = (int32_t)((uint32_t)value - step->amount);
+            
+            return 0;
+        }
+        case MIFARE_CLASSIC_TAP_OP_WRITE :
+        {
+            return mifare_classic_write(tap->handle, step->block, step->data);
+        }
+        case MIFARE_CLASSIC_TAP_OP_HALT :
+        {
+            return mifare_classic_halt(tap->handle);
+        }
+        default :
+        {
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief     tap init
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 tap or handle is NULL
+ * @note      context and timestamp_us can be linked after init, the auth cache of the handle is enabled
+ */
+uint8_t mifare_classic_tap_init(mifare_classic_tap_t *tap, mifare_classic_handle_t *handle)
+{
+    if ((tap == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+    if (mifare_classic_set_auth_cache(handle, MIFARE_CLASSIC_BOOL_TRUE) != 0)
+    {
+        return 1;
+    }
+    
+    memset(tap, 0, sizeof(mifare_classic_tap_t));
+    tap->handle = handle;
+    
+    return 0;
+}
+
+/**
+ * @brief     tap add a select step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      it runs request, anti collision and select, the uid and id are saved in the tap
+ */
+uint8_t mifare_classic_tap_add_select(mifare_classic_tap_t *tap, mifare_classic_tap_rule_t rule)
+{
+    if (tap == NULL)
+    {
+        return 2;
+    }
+    
+    return (a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_SELECT, rule) != NULL) ? 0 : 1;
+}
+
+/**
+ * @brief     tap add an authentication step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] sector authentication sector
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 sector is invalid
+ * @note      the step authenticates the sector trailer block, the auth cache of the handle skips the frame
+ *            when the sector is already open with the same key
+ */
+uint8_t mifare_classic_tap_add_authentication(mifare_classic_tap_t *tap, uint8_t sector,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              mifare_classic_tap_rule_t rule)
+{
+    uint8_t block;
+    mifare_classic_tap_step_t *step;
+    
+    if ((tap == NULL) || (key == NULL))
+    {
+        return 2;
+    }
+    if (mifare_classic_sector_last_block(tap->handle, sector, &block) != 0)
+    {
+        return 4;
+    }
+    
+    step = a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_AUTHENTICATION, rule);
+    if (step == NULL)
+    {
+        return 1;
+    }
+    step->block = block;
+    step->key_type = (uint8_t)key_type;
+    memcpy(step->key, key, 6);
+    
+    return 0;
+}
+
+/**
+ * @brief     tap add a read step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block first read block
+ * @param[in] count read block count
+ * @param[in] *data pointer to a data buffer of count * 16 bytes
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 count is invalid
+ * @note      the blocks must be in the sector of the last authentication
+ */
+uint8_t mifare_classic_tap_add_read(mifare_classic_tap_t *tap, uint8_t block, uint8_t count, uint8_t *data,
+                                    mifare_classic_tap_rule_t rule)
+{
+    mifare_classic_tap_step_t *step;
+    
+    if ((tap == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+    if ((count == 0) || (count > 16))
+    {
+        return 4;
+    }
+    
+    step = a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_READ, rule);
+    if (step == NULL)
+    {
+        return 1;
+    }
+    step->block = block;
+    step->count = count;
+    step->data = data;
+    
+    return 0;
+}
+
+/**
+ * @brief     tap add a debit step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block value block
+ * @param[in] backup backup value block, 0 means none
+ * @param[in] amount debit amount
+ * @param[in] *condition pointer to a condition function, NULL means always
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 block or backup is invalid
+ * @note      the step fails without any write when the value is not enough, with a backup block
+ *            it runs mifare_classic_purse_debit with the key of the last authentication and the purse
+ *            is set up here once, so a run keeps the session of the authentication step
+ */
+uint8_t mifare_classic_tap_add_debit(mifare_classic_tap_t *tap, uint8_t block, uint8_t backup, uint32_t amount,
+                                     uint8_t (*condition)(mifare_classic_tap_t *tap, uint8_t step),
+                                     mifare_classic_tap_rule_t rule)
+{
+    mifare_classic_purse_t purse;
+    mifare_classic_tap_step_t *step;
+    
+    if (tap == NULL)
+    {
+        return 2;
+    }
+    memset(&purse, 0, sizeof(mifare_classic_purse_t));
+    if ((backup != 0) && (mifare_classic_purse_init(&purse, tap->handle, block, backup) != 0))
+    {
+        return 4;
+    }
+    
+    step = a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_DEBIT, rule);
+    if (step == NULL)
+    {
+        return 1;
+    }
+    step->block = block;
+    step->backup = backup;
+    step->purse = purse;
+    step->amount = amount;
+    step->condition = condition;
+    
+    return 0;
+}
+
+/**
+ * @brief     tap add a write step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block write block
+ * @param[in] *data pointer to a data buffer
+ * @param[in] *condition pointer to a condition function, NULL means always
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      data is read when the step runs, so a condition can fill it
+ */
+uint8_t mifare_classic_tap_add_write(mifare_classic_tap_t *tap, uint8_t block, uint8_t data[16],
+                                     uint8_t (*condition)(mifare_classic_tap_t *tap, uint8_t step),
+                                     mifare_classic_tap_rule_t rule)
+{
+    mifare_classic_tap_step_t *step;
+    
+    if ((tap == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+    
+    step = a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_WRITE, rule);
+    if (step == NULL)
+    {
+        return 1;
+    }
+    step->block = block;
+    step->data = data;
+    step->condition = condition;
+    
+    return 0;
+}
+
+/**
+ * @brief     tap add a halt step
+ * @param[in] *tap pointer to a tap structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      none
+ */
+uint8_t mifare_classic_tap_add_halt(mifare_classic_tap_t *tap)
+{
+    if (tap == NULL)
+    {
+        return 2;
+    }
+    
+    return (a_tap_add(tap, MIFARE_CLASSIC_TAP_OP_HALT, MIFARE_CLASSIC_TAP_RULE_CONTINUE) != NULL) ? 0 : 1;
+}
+
+/**
+ * @brief      tap run the program
+ * @param[in]  *tap pointer to a tap structure
+ * @param[out] *failed_step pointer to a first failed step buffer
+ * @param[out] *total_us pointer to a total time buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 a step failed
+ *             - 2 tap is NULL
+ * @note       failed_step is the step count when no step failed, the times are 0 when timestamp_us is not linked
+ */
+uint8_t mifare_classic_tap_run(mifare_classic_tap_t *tap, uint8_t *failed_step, uint32_t *total_us)
+{
+    uint8_t res;
+    uint8_t i;
+    uint32_t start;
+    uint32_t step_start;
+    mifare_classic_tap_step_t *step;
+    mifare_classic_tap_step_t *auth;
+    
+    if (tap == NULL)
+    {
+        return 2;
+    }
+    
+    memset(tap->report, 0, sizeof(tap->report));
+    *failed_step = tap->step_count;
+    auth = NULL;
+    start = a_tap_timestamp(tap);
+    i = 0;
+    while (i < tap->step_count)
+    {
+        step = &tap->step[i];
+        step_start = a_tap_timestamp(tap);
+        if ((step->condition != NULL) && (step->condition(tap, i) == 0))
+        {
+            tap->report[i].status = MIFARE_CLASSIC_TAP_STATUS_SKIPPED;
+            tap->report[i].time_us = a_tap_timestamp(tap) - step_start;
+            i++;
+            
+            continue;
+        }
+        res = a_tap_step(tap, step, auth);
+        tap->report[i].time_us = a_tap_timestamp(tap) - step_start;
+        if (res == 0)
+        {
+            tap->report[i].status = MIFARE_CLASSIC_TAP_STATUS_DONE;
+            if (step->op == MIFARE_CLASSIC_TAP_OP_AUTHENTICATION)
+            {
+                auth = step;
+            }
+            i++;
+            
+            continue;
+        }
+        
+        /* apply the failure rule */
+        tap->report[i].status = MIFARE_CLASSIC_TAP_STATUS_FAILED;
+        tap->report[i].res = res;
+        if (*failed_step == tap->step_count)
+        {
+            *failed_step = i;
+        }
+        if (step->rule == MIFARE_CLASSIC_TAP_RULE_ABORT)
+        {
+            break;
+        }
+        i++;
+        if (step->rule == MIFARE_CLASSIC_TAP_RULE_HALT)
+        {
+            while ((i < tap->step_count) && (tap->step[i].op != MIFARE_CLASSIC_TAP_OP_HALT))
+            {
+                i++;
+            }
+        }
+    }
+    tap->total_us = a_tap_timestamp(tap) - start;
+    *total_us = tap->total_us;
+    
+    return (*failed_step != tap->step_count) ? 1 : 0;
+}
+
+/**
+ * @brief      tap get the report of a step
+ * @param[in]  *tap pointer to a tap structure
+ * @param[in]  step step index
+ * @param[out] *report pointer to a report structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 step is invalid
+ *             - 2 tap is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_tap_get_report(mifare_classic_tap_t *tap, uint8_t step, mifare_classic_tap_report_t *report)
+{
+    if (tap == NULL)
+    {
+        return 2;
+    }
+    if (step >= tap->step_count)
+    {
+        return 1;
+    }
+    
+    *report = tap->report[step];
+    
+    return 0;
+}
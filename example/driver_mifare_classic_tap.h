@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_tap.h
+ * @brief     driver mifare classic tap header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+
+#ifndef DRIVER_MIFARE_CLASSIC_TAP_H
+#define DRIVER_MIFARE_CLASSIC_TAP_H
+
+#include "driver_mifare_classic_purse.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_tap_driver mifare classic tap driver function
+ * @brief    mifare classic tap driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare classic tap size definition
+ */
+#ifndef MIFARE_CLASSIC_TAP_MAX_STEP
+    #define MIFARE_CLASSIC_TAP_MAX_STEP    16        /**< max steps of a tap program */
+#endif
+
+/**
+ * @brief mifare_classic tap operation enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_TAP_OP_SELECT         = 0x00,        /**< request and select one card */
+    MIFARE_CLASSIC_TAP_OP_AUTHENTICATION = 0x01,        /**< authenticate one sector */
+    MIFARE_CLASSIC_TAP_OP_READ           = 0x02,        /**< read blocks */
+    MIFARE_CLASSIC_TAP_OP_DEBIT          = 0x03,        /**< debit a value block when the value is enough */
+    MIFARE_CLASSIC_TAP_OP_WRITE          = 0x04,        /**< write one block */
+    MIFARE_CLASSIC_TAP_OP_HALT           = 0x05,        /**< halt the card */
+} mifare_classic_tap_op_t;
+
+/**
+ * @brief mifare_classic tap rule enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_TAP_RULE_ABORT    = 0x00,        /**< a failed step ends the program */
+    MIFARE_CLASSIC_TAP_RULE_CONTINUE = 0x01,        /**< a failed step is recorded and the next step runs */
+    MIFARE_CLASSIC_TAP_RULE_HALT     = 0x02,        /**< a failed step jumps to the next halt step */
+} mifare_classic_tap_rule_t;
+
+/**
+ * @brief mifare_classic tap step status enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_TAP_STATUS_NOT_RUN = 0x00,        /**< step is not reached */
+    MIFARE_CLASSIC_TAP_STATUS_DONE    = 0x01,        /**< step is done */
+    MIFARE_CLASSIC_TAP_STATUS_FAILED  = 0x02,        /**< step failed */
+    MIFARE_CLASSIC_TAP_STATUS_SKIPPED = 0x03,        /**< step condition is false */
+} mifare_classic_tap_status_t;
+
+/**
+ * @brief mifare_classic tap structure declaration
+ */
+struct mifare_classic_tap_s;
+
+/**
+ * @brief mifare_classic tap step structure definition
+ */
+typedef struct mifare_classic_tap_step_s
+{
+    uint8_t op;                                                           /**< step operation */
+    uint8_t rule;                                                         /**< failure rule */
+    uint8_t block;                                                        /**< block, the sector trailer of an authentication */
+    uint8_t count;                                                        /**< read block count */
+    uint8_t backup;                                                       /**< backup block of the debit, 0 means none */
+    uint8_t key_type;                                                     /**< authentication key type */
+    uint8_t key[6];                                                       /**< authentication key */
+    uint32_t amount;                                                      /**< debit amount */
+    mifare_classic_purse_t purse;                                         /**< purse of a debit with a backup block */
+    uint8_t *data;                                                        /**< read output or write input buffer */
+    uint8_t (*condition)(struct mifare_classic_tap_s *tap, uint8_t step);  /**< the step only runs when it returns 1, NULL means always */
+} mifare_classic_tap_step_t;
+
+/**
+ * @brief mifare_classic tap report structure definition
+ */
+typedef struct mifare_classic_tap_report_s
+{
+    uint8_t status;          /**< step status */
+    uint8_t res;             /**< return code of the failed call */
+    uint32_t time_us;        /**< step time */
+} mifare_classic_tap_report_t;
+
+/**
+ * @brief mifare_classic tap structure definition
+ */
+typedef struct mifare_classic_tap_s
+{
+    mifare_classic_handle_t *handle;                                  /**< mifare_classic handle */
+    void *context;                                                    /**< user context for the conditions */
+    uint32_t (*timestamp_us)(void);                                   /**< optional microsecond timestamp */
+    mifare_classic_tap_step_t step[MIFARE_CLASSIC_TAP_MAX_STEP];      /**< program steps */
+    uint8_t step_count;                                               /**< program step number */
+    mifare_classic_tap_report_t report[MIFARE_CLASSIC_TAP_MAX_STEP];  /**< step reports of the last run */
+    uint32_t total_us;                                                /**< total time of the last run */
+    mifare_classic_type_t type;                                       /**< card type */
+    mifare_classic_uid_t uid;                                         /**< card uid */
+    uint8_t id[4];                                                    /**< card id */
+    int32_t balance;                                                  /**< balance after the last debit */
+} mifare_classic_tap_t;
+
+/**
+ * @brief     tap init
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 set auth cache failed
+ *            - 2 tap or handle is NULL
+ * @note      context and timestamp_us can be linked after init, the auth cache of the handle is enabled
+ */
+uint8_t mifare_classic_tap_init(mifare_classic_tap_t *tap, mifare_classic_handle_t *handle);
+
+/**
+ * @brief     tap add a select step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      it runs request, anti collision and select, the uid and id are saved in the tap
+ */
+uint8_t mifare_classic_tap_add_select(mifare_classic_tap_t *tap, mifare_classic_tap_rule_t rule);
+
+/**
+ * @brief     tap add an authentication step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] sector authentication sector
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 sector is invalid
+ * @note      the step authenticates the sector trailer block, the auth cache of the handle skips the frame
+ *            when the sector is already open with the same key
+ */
+uint8_t mifare_classic_tap_add_authentication(mifare_classic_tap_t *tap, uint8_t sector,
+                                              mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                              mifare_classic_tap_rule_t rule);
+
+/**
+ * @brief     tap add a read step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block first read block
+ * @param[in] count read block count
+ * @param[in] *data pointer to a data buffer of count * 16 bytes
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 count is invalid
+ * @note      the blocks must be in the sector of the last authentication
+ */
+uint8_t mifare_classic_tap_add_read(mifare_classic_tap_t *tap, uint8_t block, uint8_t count, uint8_t *data,
+                                    mifare_classic_tap_rule_t rule);
+
+/**
+ * @brief     tap add a debit step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block value block
+ * @param[in] backup backup value block, 0 means none
+ * @param[in] amount debit amount
+ * @param[in] *condition pointer to a condition function, NULL means always
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ *            - 4 block or backup is invalid
+ * @note      the step fails without any write when the value is not enough, with a backup block
+ *            it runs mifare_classic_purse_debit with the key of the last authentication and the purse
+ *            is set up here once, so a run keeps the session of the authentication step
+ */
+uint8_t mifare_classic_tap_add_debit(mifare_classic_tap_t *tap, uint8_t block, uint8_t backup, uint32_t amount,
+                                     uint8_t (*condition)(mifare_classic_tap_t *tap, uint8_t step),
+                                     mifare_classic_tap_rule_t rule);
+
+/**
+ * @brief     tap add a write step
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] block write block
+ * @param[in] *data pointer to a data buffer
+ * @param[in] *condition pointer to a condition function, NULL means always
+ * @param[in] rule failure rule
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      data is read when the step runs, so a condition can fill it
+ */
+uint8_t mifare_classic_tap_add_write(mifare_classic_tap_t *tap, uint8_t block, uint8_t data[16],
+                                     uint8_t (*condition)(mifare_classic_tap_t *tap, uint8_t step),
+                                     mifare_classic_tap_rule_t rule);
+
+/**
+ * @brief     tap add a halt step
+ * @param[in] *tap pointer to a tap structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 program is full
+ *            - 2 tap is NULL
+ * @note      none
+ */
+uint8_t mifare_classic_tap_add_halt(mifare_classic_tap_t *tap);
+
+/**
+ * @brief      tap run the program
+ * @param[in]  *tap pointer to a tap structure
+ * @param[out] *failed_step pointer to a first failed step buffer
+ * @param[out] *total_us pointer to a total time buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 a step failed
+ *             - 2 tap is NULL
+ * @note       failed_step is the step count when no step failed, the times are 0 when timestamp_us is not linked
+ */
+uint8_t mifare_classic_tap_run(mifare_classic_tap_t *tap, uint8_t *failed_step, uint32_t *total_us);
+
+/**
+ * @brief      tap get the report of a step
+ * @param[in]  *tap pointer to a tap structure
+ * @param[in]  step step index
+ * @param[out] *report pointer to a report structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 step is invalid
+ *             - 2 tap is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_tap_get_report(mifare_classic_tap_t *tap, uint8_t step, mifare_classic_tap_report_t *report);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,500 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_trace.c
+ * @brief     driver mifare classic trace source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_trace.h"
+
+/**
+ * @brief         trace run the wrapped transceiver
+ * @param[in]     *trace pointer to a trace structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 transceiver failed
+ * @note          the context variant is used when it was linked
+ */
+static uint8_t a_trace_wrapped_transceiver(mifare_classic_trace_t *trace, uint8_t *in_buf, uint8_t in_len,
+                                           uint8_t *out_buf, uint8_t *out_len)
+{
+    if (trace->transceiver_ctx != NULL)
+    {
+        return trace->transceiver_ctx(trace->context, in_buf, in_len, out_buf, out_len);
+    }
+    else
+    {
+        return trace->transceiver(in_buf, in_len, out_buf, out_len);
+    }
+}
+
+/**
+ * @brief         trace contactless transceiver
+ * @param[in]     *context pointer to a trace structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 transceiver failed
+ * @note          it runs the wrapped transceiver and records the exchange
+ */
+static uint8_t a_trace_transceiver(void *context, uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
+{
+    uint8_t res;
+    mifare_classic_trace_t *trace = (mifare_classic_trace_t *)context;
+    mifare_classic_trace_record_t *record;
+    
+    /* run the wrapped transceiver */
+    record = &trace->record[trace->head];
+    record->timestamp_ms = (trace->timestamp_ms != NULL) ? trace->timestamp_ms() : 0;
+    res = a_trace_wrapped_transceiver(trace, in_buf, in_len, out_buf, out_len);
+    
+    /* save the frames */
+    record->res = res;
+    record->in_len = (in_len > MIFARE_CLASSIC_TRACE_MAX_FRAME) ? MIFARE_CLASSIC_TRACE_MAX_FRAME : in_len;
+    record->out_len = (*out_len > MIFARE_CLASSIC_TRACE_MAX_FRAME) ? MIFARE_CLASSIC_TRACE_MAX_FRAME : *out_len;
+    memcpy(record->in_buf, in_buf, record->in_len);
+    memcpy(record->out_buf, out_buf, record->out_len);
+    
+    /* move the ring */
+    trace->head = (uint16_t)((trace->head + 1) % trace->size);
+    if (trace->count < trace->size)
+    {
+        trace->count++;
+    }
+    else
+    {
+        trace->dropped++;
+    }
+    
+    return res;
+}
+
+/**
+ * @brief         trace replay contactless transceiver
+ * @param[in]     *context pointer to a trace structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 transceiver failed
+ * @note          it answers with the next recorded reply, a reply longer than the output buffer fails
+ */
+static uint8_t a_trace_replay_transceiver(void *context, uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
+{
+    mifare_classic_trace_t *trace = (mifare_classic_trace_t *)context;
+    mifare_classic_trace_record_t record;
+    
+    /* no response after the last record */
+    if (mifare_classic_trace_get(trace, trace->replay_pos, &record) != 0)
+    {
+        trace->mismatch++;
+        *out_len = 0;
+        
+        return 1;
+    }
+    trace->replay_pos++;
+    
+    /* the driver must send the recorded request */
+    if ((record.in_len != in_len) || (memcmp(record.in_buf, in_buf, in_len) != 0))
+    {
+        trace->mismatch++;
+    }
+    
+    /* a decoded reply may not fit the buffer of the caller */
+    if (record.out_len > *out_len)
+    {
+        trace->mismatch++;
+        *out_len = 0;
+        
+        return 1;
+    }
+    memcpy(out_buf, record.out_buf, record.out_len);
+    *out_len = record.out_len;
+    
+    return record.res;
+}
+
+/**
+ * @brief     trace check whether a trace runs on a handle
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    1 if a trace is running, 0 otherwise
+ * @note      none
+ */
+static uint8_t a_trace_running(mifare_classic_handle_t *handle)
+{
+    return (uint8_t)((handle->contactless_transceiver_ctx == a_trace_transceiver) ||
+                     (handle->contactless_transceiver_ctx == a_trace_replay_transceiver));
+}
+
+/**
+ * @brief     trace check whether frames can bypass the transceiver
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    1 if another frame callback is linked, 0 otherwise
+ * @note      those frames would be missing from a recording and reach the reader during a replay
+ */
+static uint8_t a_trace_bypassed(mifare_classic_handle_t *handle)
+{
+    return (uint8_t)((handle->contactless_submit != NULL) || (handle->contactless_submit_ctx != NULL) ||
+                     (handle->contactless_batch != NULL) || (handle->contactless_batch_ctx != NULL) ||
+                     (handle->contactless_bit_transceiver != NULL) || (handle->contactless_bit_transceiver_ctx != NULL));
+}
+
+/**
+ * @brief     trace link a transceiver
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *trace pointer to a trace structure
+ * @param[in] *transceiver pointer to a trace transceiver
+ * @note      the trace is linked as the context, so every handle keeps its own trace
+ */
+static void a_trace_link(mifare_classic_handle_t *handle, mifare_classic_trace_t *trace,
+                         uint8_t (*transceiver)(void *context, uint8_t *in_buf, uint8_t in_len,
+                                                uint8_t *out_buf, uint8_t *out_len))
+{
+    trace->transceiver = handle->contactless_transceiver;
+    trace->transceiver_ctx = handle->contactless_transceiver_ctx;
+    trace->context = handle->context;
+    DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(handle, trace);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER_CTX(handle, transceiver);
+}
+
+/**
+ * @brief      trace init
+ * @param[out] *trace pointer to a trace structure
+ * @param[in]  *record pointer to a record ring buffer
+ * @param[in]  size ring buffer size
+ * @return     status code
+ *             - 0 success
+ *             - 1 size is invalid
+ *             - 2 trace or record is NULL
+ * @note       timestamp_ms can be linked after init
+ */
+uint8_t mifare_classic_trace_init(mifare_classic_trace_t *trace, mifare_classic_trace_record_t *record, uint16_t size)
+{
+    if ((trace == NULL) || (record == NULL))
+    {
+        return 2;
+    }
+    if (size == 0)
+    {
+        return 1;
+    }
+    
+    memset(trace, 0, sizeof(mifare_classic_trace_t));
+    trace->record = record;
+    trace->size = size;
+    
+    return 0;
+}
+
+/**
+ * @brief     trace start recording
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *trace pointer to a trace structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 a trace is running
+ *            - 2 handle or trace is NULL
+ *            - 3 contactless_transceiver is NULL
+ *            - 4 contactless_submit, contactless_batch or contactless_bit_transceiver is linked
+ * @note      the trace is linked as the user context with a context transceiver, so every handle keeps its own
+ *            trace, and the oldest record is overwritten when the ring is full
+ */
+uint8_t mifare_classic_trace_start(mifare_classic_handle_t *handle, mifare_classic_trace_t *trace)
+{
+    if ((handle == NULL) || (trace == NULL))
+    {
+        return 2;
+    }
+    if (a_trace_running(handle) != 0)
+    {
+        return 1;
+    }
+    if ((handle->contactless_transceiver == NULL) && (handle->contactless_transceiver_ctx == NULL))
+    {
+        return 3;
+    }
+    if (a_trace_bypassed(handle) != 0)
+    {
+        return 4;
+    }
+    
+    /* wrap the transceiver */
+    a_trace_link(handle, trace, a_trace_transceiver);
+    
+    return 0;
+}
+
+/**
+ * @brief     trace start replaying
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *trace pointer to a trace structure with the recorded frames
+ * @return    status code
+ *            - 0 success
+ *            - 1 a trace is running
+ *            - 2 handle or trace is NULL
+ *            - 4 contactless_submit, contactless_batch or contactless_bit_transceiver is linked
+ * @note      the recorded replies are fed back in order without a reader, a request which differs from the
+ *            recorded one is counted as a mismatch and there is no response after the last record
+ */
+uint8_t mifare_classic_trace_replay_start(mifare_classic_handle_t *handle, mifare_classic_trace_t *trace)
+{
+    if ((handle == NULL) || (trace == NULL))
+    {
+        return 2;
+    }
+    if (a_trace_running(handle) != 0)
+    {
+        return 1;
+    }
+    if (a_trace_bypassed(handle) != 0)
+    {
+        return 4;
+    }
+    
+    /* replace the transceiver */
+    trace->replay_pos = 0;
+    trace->mismatch = 0;
+    a_trace_link(handle, trace, a_trace_replay_transceiver);
+    
+    return 0;
+}
+
+/**
+ * @brief     trace stop recording or replaying
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 no trace is running
+ *            - 2 handle is NULL
+ * @note      the wrapped contactless_transceiver and the user context are linked again
+ */
+uint8_t mifare_classic_trace_stop(mifare_classic_handle_t *handle)
+{
+    mifare_classic_trace_t *trace;
+    
+    if (handle == NULL)
+    {
+        return 2;
+    }
+    if (a_trace_running(handle) == 0)
+    {
+        return 1;
+    }
+    
+    trace = (mifare_classic_trace_t *)handle->context;
+    DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(handle, trace->context);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER_CTX(handle, trace->transceiver_ctx);
+    
+    return 0;
+}
+
+/**
+ * @brief      trace get one record
+ * @param[in]  *trace pointer to a trace structure
+ * @param[in]  index record index, 0 is the oldest
+ * @param[out] *record pointer to a record buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 index is invalid
+ *             - 2 trace is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_trace_get(mifare_classic_trace_t *trace, uint16_t index, mifare_classic_trace_record_t *record)
+{
+    uint32_t pos;
+    
+    if (trace == NULL)
+    {
+        return 2;
+    }
+    if (index >= trace->count)
+    {
+        return 1;
+    }
+    
+    /* the oldest record is after the newest one */
+    pos = ((uint32_t)trace->head + trace->size - trace->count + index) % trace->size;
+    memcpy(record, &trace->record[pos], sizeof(mifare_classic_trace_record_t));
+    
+    return 0;
+}
+
+/**
+ * @brief      trace get the replay status
+ * @param[in]  *trace pointer to a trace structure
+ * @param[out] *pos pointer to a replayed record number buffer
+ * @param[out] *mismatch pointer to a mismatch counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 trace is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_trace_replay_get_status(mifare_classic_trace_t *trace, uint16_t *pos, uint16_t *mismatch)
+{
+    if (trace == NULL)
+    {
+        return 2;
+    }
+    
+    *pos = trace->replay_pos;
+    *mismatch = trace->mismatch;
+    
+    return 0;
+}
+
+/**
+ * @brief      trace encode all records
+ * @param[in]  *trace pointer to a trace structure
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len buffer length
+ * @param[out] *used pointer to an encoded length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 buffer is too small
+ *             - 2 trace is NULL
+ * @note       the oldest record is first, each record is a little endian timestamp, result, request length,
+ *             reply length and both frames, so a trace can be written to a file on one machine and read on another
+ */
+uint8_t mifare_classic_trace_encode(mifare_classic_trace_t *trace, uint8_t *buf, uint32_t len, uint32_t *used)
+{
+    uint16_t i;
+    uint32_t pos;
+    mifare_classic_trace_record_t record;
+    
+    if (trace == NULL)
+    {
+        return 2;
+    }
+    
+    pos = 0;
+    for (i = 0; i < trace->count; i++)
+    {
+        (void)mifare_classic_trace_get(trace, i, &record);
+        if ((pos + MIFARE_CLASSIC_TRACE_RECORD_HEADER + record.in_len + record.out_len) > len)
+        {
+            *used = pos;
+            
+            return 1;
+        }
+        
+        /* header */
+        buf[pos + 0] = (uint8_t)((record.timestamp_ms >> 0) & 0xFF);
+        buf[pos + 1] = (uint8_t)((record.timestamp_ms >> 8) & 0xFF);
+        buf[pos + 2] = (uint8_t)((record.timestamp_ms >> 16) & 0xFF);
+        buf[pos + 3] = (uint8_t)((record.timestamp_ms >> 24) & 0xFF);
+        buf[pos + 4] = record.res;
+        buf[pos + 5] = record.in_len;
+        buf[pos + 6] = record.out_len;
+        pos += MIFARE_CLASSIC_TRACE_RECORD_HEADER;
+        
+        /* frames */
+        memcpy(&buf[pos], record.in_buf, record.in_len);
+        pos += record.in_len;
+        memcpy(&buf[pos], record.out_buf, record.out_len);
+        pos += record.out_len;
+    }
+    *used = pos;
+    
+    return 0;
+}
+
+/**
+ * @brief     trace decode records
+ * @param[in] *trace pointer to an initialized trace structure
+ * @param[in] *buf pointer to an encoded data buffer
+ * @param[in] len encoded data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 data is invalid
+ *            - 2 trace is NULL
+ *            - 3 ring buffer is too small
+ * @note      the old records are cleared
+ */
+uint8_t mifare_classic_trace_decode(mifare_classic_trace_t *trace, uint8_t *buf, uint32_t len)
+{
+    uint32_t pos;
+    mifare_classic_trace_record_t *record;
+    
+    if (trace == NULL)
+    {
+        return 2;
+    }
+    
+    trace->head = 0;
+    trace->count = 0;
+    trace->dropped = 0;
+    pos = 0;
+    while (pos < len)
+    {
+        if (trace->count >= trace->size)
+        {
+            return 3;
+        }
+        if ((pos + MIFARE_CLASSIC_TRACE_RECORD_HEADER) > len)
+        {
+            return 1;
+        }
+        
+        /* header */
+        record = &trace->record[trace->count];
+        record->timestamp_ms = (uint32_t)buf[pos + 0] | ((uint32_t)buf[pos + 1] << 8) |
+                               ((uint32_t)buf[pos + 2] << 16) | ((uint32_t)buf[pos + 3] << 24);
+        record->res = buf[pos + 4];
+        record->in_len = buf[pos + 5];
+        record->out_len = buf[pos + 6];
+        pos += MIFARE_CLASSIC_TRACE_RECORD_HEADER;
+        if ((record->in_len > MIFARE_CLASSIC_TRACE_MAX_FRAME) || (record->out_len > MIFARE_CLASSIC_TRACE_MAX_FRAME) ||
+            ((pos + record->in_len + record->out_len) > len))
+        {
+            return 1;
+        }
+        
+        /* frames */
+        memcpy(record->in_buf, &buf[pos], record->in_len);
+        pos += record->in_len;
+        memcpy(record->out_buf, &buf[pos], record->out_len);
+        pos += record->out_len;
+        trace->count++;
+    }
+    trace->head = (uint16_t)(trace->count % trace->size);
+    
+    return 0;
+}
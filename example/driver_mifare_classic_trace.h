@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_trace.h
+ * @brief     driver mifare classic trace header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_MIFARE_CLASSIC_TRACE_H
+#define DRIVER_MIFARE_CLASSIC_TRACE_H
+
+#include "driver_mifare_classic.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_trace_driver mifare classic trace driver function
+ * @brief    mifare classic trace driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare_classic trace size definition
+ */
+#define MIFARE_CLASSIC_TRACE_MAX_FRAME          18                                           /**< max frame length */
+#define MIFARE_CLASSIC_TRACE_RECORD_HEADER      7                                            /**< encoded timestamp, result and lengths */
+#define MIFARE_CLASSIC_TRACE_MAX_RECORD_SIZE    (MIFARE_CLASSIC_TRACE_RECORD_HEADER + 36)    /**< max encoded record length */
+
+/**
+ * @brief mifare_classic trace record structure definition
+ */
+typedef struct mifare_classic_trace_record_s
+{
+    uint32_t timestamp_ms;                                 /**< time of the request */
+    uint8_t res;                                           /**< transceiver result */
+    uint8_t in_len;                                        /**< request length */
+    uint8_t out_len;                                       /**< reply length */
+    uint8_t in_buf[MIFARE_CLASSIC_TRACE_MAX_FRAME];        /**< request frame */
+    uint8_t out_buf[MIFARE_CLASSIC_TRACE_MAX_FRAME];       /**< reply frame */
+} mifare_classic_trace_record_t;
+
+/**
+ * @brief mifare_classic trace structure definition
+ */
+typedef struct mifare_classic_trace_s
+{
+    mifare_classic_trace_record_t *record;                             /**< ring buffer */
+    uint16_t size;                                                     /**< ring buffer size */
+    uint16_t head;                                                     /**< next write position */
+    uint16_t count;                                                    /**< valid record number */
+    uint32_t dropped;                                                  /**< overwritten record counter */
+    uint16_t replay_pos;                                               /**< next replayed record */
+    uint16_t mismatch;                                                 /**< replayed request mismatch counter */
+    uint32_t (*timestamp_ms)(void);                                    /**< optional millisecond timestamp */
+    uint8_t (*transceiver)(uint8_t *in_buf, uint8_t in_len,
+                           uint8_t *out_buf, uint8_t *out_len);        /**< wrapped contactless_transceiver */
+    uint8_t (*transceiver_ctx)(void *context, uint8_t *in_buf, uint8_t in_len,
+                               uint8_t *out_buf, uint8_t *out_len);    /**< wrapped contactless_transceiver_ctx */
+    void *context;                                                     /**< wrapped user context */
+} mifare_classic_trace_t;
+
+/**
+ * @brief      trace init
+ * @param[out] *trace pointer to a trace structure
+ * @param[in]  *record pointer to a record ring buffer
+ * @param[in]  size ring buffer size
+ * @return     status code
+ *             - 0 success
+ *             - 1 size is invalid
+ *             - 2 trace or record is NULL
+ * @note       timestamp_ms can be linked after init
+ */
+uint8_t mifare_classic_trace_init(mifare_classic_trace_t *trace, mifare_classic_trace_record_t *record, uint16_t size);
+
+/**
+ * @brief     trace start recording
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *trace pointer to a trace structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 a trace is running
+ *            - 2 handle or trace is NULL
+ *            - 3 contactless_transceiver is NULL
+ *            - 4 contactless_submit, contactless_batch or contactless_bit_transceiver is linked
+ * @note      the trace is linked as the user context with a context transceiver, so every handle keeps its own
+ *            trace, and the oldest record is overwritten when the ring is full
+ */
+uint8_t mifare_classic_trace_start(mifare_classic_handle_t *handle, mifare_classic_trace_t *trace);
+
+/**
+ * @brief     trace start replaying
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *trace pointer to a trace structure with the recorded frames
+ * @return    status code
+ *            - 0 success
+ *            - 1 a trace is running
+ *            - 2 handle or trace is NULL
+ *            - 4 contactless_submit, contactless_batch or contactless_bit_transceiver is linked
+ * @note      the recorded replies are fed back in order without a reader, a request which differs from the
+ *            recorded one is counted as a mismatch and there is no response after the last record
+ */
+uint8_t mifare_classic_trace_replay_start(mifare_classic_handle_t *handle, mifare_classic_trace_t *trace);
+
+/**
+ * @brief     trace stop recording or replaying
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 no trace is running
+ *            - 2 handle is NULL
+ * @note      the wrapped contactless_transceiver and the user context are linked again
+ */
+uint8_t mifare_classic_trace_stop(mifare_classic_handle_t *handle);
+
+/**
+ * @brief      trace get one record
+ * @param[in]  *trace pointer to a trace structure
+ * @param[in]  index record index, 0 is the oldest
+ * @param[out] *record pointer to a record buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 index is invalid
+ *             - 2 trace is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_trace_get(mifare_classic_trace_t *trace, uint16_t index, mifare_classic_trace_record_t *record);
+
+/**
+ * @brief      trace get the replay status
+ * @param[in]  *trace pointer to a trace structure
+ * @param[out] *pos pointer to a replayed record number buffer
+ * @param[out] *mismatch pointer to a mismatch counter buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 trace is NULL
+ * @note       none
+ */
+uint8_t mifare_classic_trace_replay_get_status(mifare_classic_trace_t *trace, uint16_t *pos, uint16_t *mismatch);
+
+/**
+ * @brief      trace encode all records
+ * @param[in]  *trace pointer to a trace structure
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len buffer length
+ * @param[out] *used pointer to an encoded length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 buffer is too small
+ *             - 2 trace is NULL
+ * @note       the oldest record is first, each record is a little endian timestamp, result, request length,
+ *             reply length and both frames, so a trace can be written to a file on one machine and read on another
+ */
+uint8_t mifare_classic_trace_encode(mifare_classic_trace_t *trace, uint8_t *buf, uint32_t len, uint32_t *used);
+
+/**
+ * @brief     trace decode records
+ * @param[in] *trace pointer to an initialized trace structure
+ * @param[in] *buf pointer to an encoded data buffer
+ * @param[in] len encoded data length
+ * @return    status code
+ *            - 0 success
+ *            - 1 data is invalid
+ *            - 2 trace is NULL
+ *            - 3 ring buffer is too small
+ * @note      the old records are cleared
+ */
+uint8_t mifare_classic_trace_decode(mifare_classic_trace_t *trace, uint8_t *buf, uint32_t len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
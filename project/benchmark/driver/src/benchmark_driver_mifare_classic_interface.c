@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      benchmark_driver_mifare_classic_interface.c
+ * @brief     benchmark driver mifare_classic interface source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_interface.h"
+#include "driver_mifare_classic_virtual_card.h"
+#include <stdarg.h>
+
+/**
+ * @brief iso14443a 106 kbit/s timing definition
+ */
+#define MODEL_BIT_NS                9440        /**< one bit is 128 / 13.56 MHz */
+#define MODEL_FDT_NS                86000       /**< frame delay time between the request and the answer */
+#define MODEL_AUTH_TX_BYTE          8           /**< nr and ar of the second authentication pass */
+#define MODEL_AUTH_RX_BYTE          4           /**< at of the second authentication pass */
+#define MODEL_EEPROM_WRITE_NS       2500000     /**< eeprom programming time of a write or transfer */
+
+uint64_t g_model_time_ns = 0;                   /**< modeled time */
+uint32_t g_model_frame_count = 0;               /**< modeled frame counter */
+uint32_t g_model_overhead_us = 150;             /**< reader overhead of each frame */
+uint32_t g_model_timeout_us = 1000;             /**< reader timeout of a frame without an answer */
+
+/**
+ * @brief     get the air time of a frame
+ * @param[in] bits frame bits without the start and end of the frame
+ * @return    air time in ns
+ * @note      none
+ */
+static uint64_t a_model_air_ns(uint32_t bits)
+{
+    return (uint64_t)(bits + 2) * MODEL_BIT_NS;
+}
+
+/**
+ * @brief  interface contactless init
+ * @return status code
+ *         - 0 success
+ *         - 1 contactless init failed
+ * @note   none
+ */
+uint8_t mifare_classic_interface_contactless_init(void)
+{
+    return mifare_classic_virtual_contactless_init();
+}
+
+/**
+ * @brief  interface contactless deinit
+ * @return status code
+ *         - 0 success
+ *         - 1 contactless deinit failed
+ * @note   none
+ */
+uint8_t mifare_classic_interface_contactless_deinit(void)
+{
+    return mifare_classic_virtual_contactless_deinit();
+}
+
+/**
+ * @brief         interface contactless transceiver
+ * @param[in]     *in_buf pointer to a input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to a output buffer
+ * @param[in,out] *out_len pointer to a output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 contactless transceiver failed
+ * @note          the virtual cards answer and the modeled time moves by the reader overhead, the air time of
+ *                both frames with parity bits, the frame delay time and the eeprom programming time
+ */
+uint8_t mifare_classic_interface_contactless_transceiver(uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
+{
+    uint8_t res;
+    
+    /* reader overhead and request */
+    g_model_frame_count++;
+    g_model_time_ns += (uint64_t)g_model_overhead_us * 1000;
+    if ((in_len == 1) && ((in_buf[0] == 0x26) || (in_buf[0] == 0x52)))
+    {
+        g_model_time_ns += a_model_air_ns(7);
+    }
+    else
+    {
+        g_model_time_ns += a_model_air_ns(9 * (uint32_t)in_len);
+    }
+    
+    /* the cards answer */
+    res = mifare_classic_virtual_contactless_transceiver(in_buf, in_len, out_buf, out_len);
+    if ((res != 0) || (*out_len == 0))
+    {
+        g_model_time_ns += (uint64_t)g_model_timeout_us * 1000;
+        
+        return res;
+    }
+    g_model_time_ns += MODEL_FDT_NS;
+    if ((*out_len == 1) && ((out_buf[0] & 0xF0) == 0))
+    {
+        g_model_time_ns += a_model_air_ns(4);
+    }
+    else
+    {
+        g_model_time_ns += a_model_air_ns(9 * (uint32_t)(*out_len));
+    }
+    
+    /* second pass of the three pass authentication */
+    if ((in_buf[0] == 0x60) || (in_buf[0] == 0x61))
+    {
+        g_model_time_ns += MODEL_FDT_NS + a_model_air_ns(9 * MODEL_AUTH_TX_BYTE) + a_model_air_ns(9 * MODEL_AUTH_RX_BYTE);
+    }
+    
+    /* eeprom programming before the ack of the data phase or the transfer */
+    if ((in_len == 18) || (in_buf[0] == 0xB0))
+    {
+        g_model_time_ns += MODEL_EEPROM_WRITE_NS;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     interface delay ms
+ * @param[in] ms time
+ * @note      it only moves the modeled time
+ */
+void mifare_classic_interface_delay_ms(uint32_t ms)
+{
+    g_model_time_ns += (uint64_t)ms * 1000000;
+    mifare_classic_virtual_delay_ms(ms);
+}
+
+/**
+ * @brief     interface print format data
+ * @param[in] fmt format data
+ * @note      it prints to stderr and keeps stdout for the results
+ */
+void mifare_classic_interface_debug_print(const char *const fmt, ...)
+{
+    char str[256];
+    va_list args;
+    
+    memset((char *)str, 0, sizeof(char) * 256); 
+    va_start(args, fmt);
+    vsnprintf((char *)str, 255, (char const *)fmt, args);
+    va_end(args);
+    
+    (void)fprintf(stderr, "%s", str);
+}
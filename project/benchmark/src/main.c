@@ -0,0 +1,680 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      main.c
+ * @brief     main source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_basic.h"
+#include "driver_mifare_classic_virtual_card.h"
+#include "driver_mifare_classic_virtual_test.h"
+#include "driver_mifare_classic_crc_test.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <time.h>
+
+extern uint64_t g_model_time_ns;                       /**< modeled time */
+extern uint32_t g_model_frame_count;                   /**< modeled frame counter */
+extern uint32_t g_model_overhead_us;                   /**< reader overhead of each frame */
+extern uint32_t g_model_timeout_us;                    /**< reader timeout of a frame without an answer */
+
+static mifare_classic_handle_t gs_handle;              /**< mifare_classic handle */
+static mifare_classic_virtual_card_t gs_card;          /**< virtual card */
+static uint8_t gs_key[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};        /**< transport key */
+static uint16_t gs_dump_block;                         /**< dumped block counter */
+
+/**
+ * @brief benchmark scenario structure definition
+ */
+typedef struct benchmark_scenario_s
+{
+    const char *name;                                  /**< scenario name */
+    mifare_classic_type_t type;                        /**< card type */
+    uint8_t (*run)(void);                              /**< run one iteration */
+} benchmark_scenario_t;
+
+#if (MIFARE_CLASSIC_STATS != 0)
+/**
+ * @brief  benchmark timestamp us
+ * @return modeled time in us
+ * @note   none
+ */
+static uint32_t a_benchmark_timestamp_us(void)
+{
+    return (uint32_t)(g_model_time_ns / 1000);
+}
+#endif
+
+/**
+ * @brief  get the host time
+ * @return host time in ns
+ * @note   none
+ */
+static uint64_t a_benchmark_host_ns(void)
+{
+    struct timespec t;
+    
+    (void)clock_gettime(CLOCK_MONOTONIC, &t);
+    
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/**
+ * @brief     put a fresh card into the field
+ * @param[in] type card type
+ * @note      block 4 is a value block, block 5 holds a pattern and the other blocks are zero
+ */
+static void a_benchmark_card(mifare_classic_type_t type)
+{
+    uint8_t i;
+    uint8_t uid[4] = {0xBE, 0x4C, 0x11, 0x17};
+    uint32_t v;
+    
+    (void)mifare_classic_virtual_card_init(&gs_card, type, uid);
+    
+    /* value 1000000 at block 4 */
+    v = 1000000;
+    for (i = 0; i < 4; i++)
+    {
+        gs_card.block[4][i] = (uint8_t)(v >> (8 * i));
+        gs_card.block[4][4 + i] = (uint8_t)(~v >> (8 * i));
+        gs_card.block[4][8 + i] = (uint8_t)(v >> (8 * i));
+    }
+    gs_card.block[4][12] = 4;
+    gs_card.block[4][13] = (uint8_t)(~4);
+    gs_card.block[4][14] = 4;
+    gs_card.block[4][15] = (uint8_t)(~4);
+    
+    /* pattern at block 5 */
+    for (i = 0; i < 16; i++)
+    {
+        gs_card.block[5][i] = i;
+    }
+    (void)mifare_classic_virtual_card_insert(&gs_card);
+}
+
+/**
+ * @brief      request and select the card
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 activate failed
+ * @note       none
+ */
+static uint8_t a_benchmark_activate(uint8_t id[4])
+{
+    mifare_classic_type_t type;
+    mifare_classic_uid_t uid;
+    
+    if ((mifare_classic_request(&gs_handle, &type) != 0) ||
+        (mifare_classic_select(&gs_handle, &uid) != 0) ||
+        (mifare_classic_uid_to_id(&uid, id) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     dump callback
+ * @param[in] sector sector number
+ * @param[in] block block number
+ * @param[in] res read result
+ * @param[in] *data pointer to a data buffer
+ * @note      none
+ */
+static void a_benchmark_dump_callback(uint8_t sector, uint8_t block, uint8_t res, uint8_t *data)
+{
+    (void)sector;
+    (void)block;
+    (void)data;
+    
+    if (res == 0)
+    {
+        gs_dump_block++;
+    }
+}
+
+/**
+ * @brief  dump the whole card
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   none
+ */
+static uint8_t a_benchmark_dump(void)
+{
+    uint8_t id[4];
+    uint8_t failed;
+    mifare_classic_key_t key;
+    
+    key.key_type = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;
+    memcpy(key.key, gs_key, 6);
+    gs_dump_block = 0;
+    if ((a_benchmark_activate(id) != 0) ||
+        (mifare_classic_dump(&gs_handle, id, &key, 1, a_benchmark_dump_callback, &failed) != 0) ||
+        (failed != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  run a purse decrement tap
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   select, authenticate, read the balance, decrement, transfer, check the balance and halt
+ */
+static uint8_t a_benchmark_purse(void)
+{
+    uint8_t id[4];
+    uint8_t addr;
+    int32_t before;
+    int32_t after;
+    
+    if ((a_benchmark_activate(id) != 0) ||
+        (mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key) != 0) ||
+        (mifare_classic_value_read(&gs_handle, 4, &before, &addr) != 0) ||
+        (mifare_classic_decrement(&gs_handle, 4, 150) != 0) ||
+        (mifare_classic_transfer(&gs_handle, 4) != 0) ||
+        (mifare_classic_value_read(&gs_handle, 4, &after, &addr) != 0) ||
+        (after != before - 150) ||
+        (mifare_classic_halt(&gs_handle) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  re-key all sectors
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   every sector trailer gets a new key a and key b with the transport access bits
+ */
+static uint8_t a_benchmark_rekey(void)
+{
+    uint8_t i;
+    uint8_t id[4];
+    uint8_t block;
+    uint8_t count;
+    uint8_t key_a[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+    uint8_t key_b[6] = {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5};
+    
+    if (a_benchmark_activate(id) != 0)
+    {
+        return 1;
+    }
+    count = (gs_handle.type == MIFARE_CLASSIC_TYPE_S70) ? 40 : 16;
+    for (i = 0; i < count; i++)
+    {
+        if ((mifare_classic_sector_last_block(&gs_handle, i, &block) != 0) ||
+            (mifare_classic_authentication(&gs_handle, id, block, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key) != 0) ||
+            (mifare_classic_set_sector_permission(&gs_handle, i, key_a, 0x0, 0x0, 0x0, 0x1, 0x69, key_b) != 0))
+        {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  run a tap with the basic layer
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   search, decrement the purse, read a block and halt
+ */
+static uint8_t a_benchmark_basic(void)
+{
+    uint8_t id[4];
+    uint8_t data[16];
+    mifare_classic_type_t type;
+    
+    if ((mifare_classic_basic_search(&type, id, 1) != 0) ||
+        (mifare_classic_basic_value_decrement(4, 150, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key) != 0) ||
+        (mifare_classic_basic_read(5, data, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key) != 0) ||
+        (data[15] != 15) ||
+        (mifare_classic_basic_halt() != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  call the other driver apis once
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   the config commands and the async apis are not run
+ */
+static uint8_t a_benchmark_api(void)
+{
+    uint8_t id[4];
+    uint8_t addr;
+    uint8_t count;
+    uint8_t crc[2];
+    uint8_t data[16];
+    uint8_t sector[64];
+    uint8_t block_0_0_4;
+    uint8_t block_1_5_9;
+    uint8_t block_2_10_14;
+    uint8_t block_3_15;
+    uint8_t user_data;
+    uint8_t key_b[6];
+    int32_t value;
+    mifare_classic_type_t type;
+    mifare_classic_uid_t uid[4];
+    
+    /* one sector with all block commands */
+    memset(data, 0x5A, 16);
+    if ((a_benchmark_activate(id) != 0) ||
+        (mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key) != 0) ||
+        (mifare_classic_read(&gs_handle, 5, data) != 0) ||
+        (mifare_classic_write(&gs_handle, 6, data) != 0) ||
+        (mifare_classic_value_init(&gs_handle, 6, 100, 6) != 0) ||
+        (mifare_classic_value_write(&gs_handle, 6, 200, 6) != 0) ||
+        (mifare_classic_increment(&gs_handle, 6, 5) != 0) ||
+        (mifare_classic_transfer(&gs_handle, 6) != 0) ||
+        (mifare_classic_restore(&gs_handle, 6) != 0) ||
+        (mifare_classic_transfer(&gs_handle, 5) != 0) ||
+        (mifare_classic_value_read(&gs_handle, 5, &value, &addr) != 0) ||
+        (value != 205) ||
+        (mifare_classic_get_sector_permission(&gs_handle, 1, &block_0_0_4, &block_1_5_9,
+                                              &block_2_10_14, &block_3_15, &user_data, key_b) != 0))
+    {
+        return 1;
+    }
+    
+    /* activation commands */
+    if ((mifare_classic_halt(&gs_handle) != 0) ||
+        (mifare_classic_wake_up(&gs_handle, &type) != 0) ||
+        (mifare_classic_anticollision_cl1(&gs_handle, id) != 0) ||
+        (mifare_classic_select_cl1(&gs_handle, id) != 0) ||
+        (mifare_classic_read_sector(&gs_handle, id, 2, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, gs_key,
+                                    MIFARE_CLASSIC_BOOL_FALSE, sector, &count) != 0) ||
+        (mifare_classic_halt(&gs_handle) != 0) ||
+        (mifare_classic_reselect(&gs_handle, id) != 0))
+    {
+        return 1;
+    }
+    
+    /* enumerate the field */
+    (void)mifare_classic_virtual_card_insert(&gs_card);
+    if ((mifare_classic_enumerate(&gs_handle, uid, 4, &count) != 0) || (count != 1) ||
+        (mifare_classic_crc(data, 16, crc) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief benchmark scenario list
+ */
+static const benchmark_scenario_t gs_scenario[] =
+{
+    {"dump_1k", MIFARE_CLASSIC_TYPE_S50, a_benchmark_dump},
+    {"dump_4k", MIFARE_CLASSIC_TYPE_S70, a_benchmark_dump},
+    {"purse_tap", MIFARE_CLASSIC_TYPE_S50, a_benchmark_purse},
+    {"rekey_1k", MIFARE_CLASSIC_TYPE_S50, a_benchmark_rekey},
+    {"basic_tap", MIFARE_CLASSIC_TYPE_S50, a_benchmark_basic},
+    {"api_sweep", MIFARE_CLASSIC_TYPE_S50, a_benchmark_api},
+};
+
+/**
+ * @brief     run one scenario and print one json line
+ * @param[in] *scenario pointer to a scenario structure
+ * @param[in] iterations iteration number
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      the card is put into the field again before each iteration and only the run is measured
+ */
+static uint8_t a_benchmark_scenario(const benchmark_scenario_t *scenario, uint32_t iterations)
+{
+    uint32_t i;
+    uint32_t frame;
+    uint64_t model_ns;
+    uint64_t host_ns;
+    uint64_t start;
+    uint64_t host_start;
+    double model_us;
+    
+    frame = 0;
+    model_ns = 0;
+    host_ns = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        a_benchmark_card(scenario->type);
+        start = g_model_time_ns;
+        frame -= g_model_frame_count;
+        host_start = a_benchmark_host_ns();
+        if (scenario->run() != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: %s failed at iteration %d.\n", scenario->name, i);
+            
+            return 1;
+        }
+        host_ns += a_benchmark_host_ns() - host_start;
+        frame += g_model_frame_count;
+        model_ns += g_model_time_ns - start;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    model_us = (double)model_ns / 1000.0 / iterations;
+    (void)printf("{\"scenario\":\"%s\",\"iterations\":%u,\"frames_per_op\":%.1f,"
+                 "\"modeled_us_per_op\":%.1f,\"modeled_ops_per_s\":%.2f,\"host_ns_per_op\":%.0f}\n",
+                 scenario->name, (unsigned int)iterations, (double)frame / iterations,
+                 model_us, 1000000.0 / model_us, (double)host_ns / iterations);
+    
+    return 0;
+}
+
+#if (MIFARE_CLASSIC_STATS != 0)
+/**
+ * @brief print the modeled latency of each command as json lines
+ * @note  none
+ */
+static void a_benchmark_print_commands(void)
+{
+    uint8_t i;
+    uint8_t j;
+    uint32_t failure;
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t p99_us;
+    mifare_classic_stats_t stats;
+    const char *const name[MIFARE_CLASSIC_STATS_COMMAND_MAX] =
+    {
+        "request", "anticollision", "select", "authentication", "read",
+        "write", "value", "halt", "other",
+    };
+    
+    (void)mifare_classic_get_stats(&gs_handle, &stats);
+    for (i = 0; i < MIFARE_CLASSIC_STATS_COMMAND_MAX; i++)
+    {
+        if (stats.command[i].count == 0)
+        {
+            continue;
+        }
+        failure = 0;
+        for (j = 1; j < MIFARE_CLASSIC_STATS_MAX_RES; j++)
+        {
+            failure += stats.command[i].failure[j];
+        }
+        (void)mifare_classic_stats_latency(&stats, (mifare_classic_stats_command_t)i, &min_us, &avg_us, &max_us, &p99_us);
+        (void)printf("{\"command\":\"%s\",\"count\":%u,\"failures\":%u,\"min_us\":%u,"
+                     "\"avg_us\":%u,\"max_us\":%u,\"p99_us\":%u}\n",
+                     name[i], (unsigned int)stats.command[i].count, (unsigned int)failure, (unsigned int)min_us,
+                     (unsigned int)avg_us, (unsigned int)max_us, (unsigned int)p99_us);
+    }
+    (void)printf("{\"crc_errors\":%u}\n", (unsigned int)stats.crc_error);
+}
+#endif
+
+/**
+ * @brief     run all scenarios
+ * @param[in] iterations iteration number of each scenario
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      none
+ */
+static uint8_t a_benchmark_run(uint32_t iterations)
+{
+    uint8_t i;
+    mifare_classic_info_t info;
+    
+    /* core driver */
+    DRIVER_MIFARE_CLASSIC_LINK_INIT(&gs_handle, mifare_classic_handle_t);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(&gs_handle, mifare_classic_interface_contactless_init);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(&gs_handle, mifare_classic_interface_contactless_deinit);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(&gs_handle, mifare_classic_interface_contactless_transceiver);
+    DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&gs_handle, mifare_classic_interface_delay_ms);
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_handle, mifare_classic_interface_debug_print);
+#if (MIFARE_CLASSIC_STATS != 0)
+    DRIVER_MIFARE_CLASSIC_LINK_TIMESTAMP_US(&gs_handle, a_benchmark_timestamp_us);
+#endif
+    if (mifare_classic_init(&gs_handle) != 0)
+    {
+        return 1;
+    }
+    
+    /* basic layer */
+    if (mifare_classic_basic_init() != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* header */
+    (void)mifare_classic_info(&info);
+    (void)printf("{\"benchmark\":\"mifare_classic\",\"driver_version\":%u,\"overhead_us\":%u,\"timeout_us\":%u}\n",
+                 (unsigned int)info.driver_version, (unsigned int)g_model_overhead_us, (unsigned int)g_model_timeout_us);
+    
+    /* scenarios */
+    for (i = 0; i < sizeof(gs_scenario) / sizeof(gs_scenario[0]); i++)
+    {
+        if (a_benchmark_scenario(&gs_scenario[i], iterations) != 0)
+        {
+            (void)mifare_classic_basic_deinit();
+            (void)mifare_classic_deinit(&gs_handle);
+            
+            return 1;
+        }
+    }
+#if (MIFARE_CLASSIC_STATS != 0)
+    a_benchmark_print_commands();
+#endif
+    (void)mifare_classic_basic_deinit();
+    (void)mifare_classic_deinit(&gs_handle);
+    
+    return 0;
+}
+
+/**
+ * @brief     mifare_classic benchmark function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *             - 0 success
+ *             - 1 run failed
+ *             - 5 param is invalid
+ * @note      none
+ */
+uint8_t mifare_classic_benchmark(uint8_t argc, char **argv)
+{
+    int c;
+    int longindex = 0;
+    const char short_options[] = "hn:o:t:";
+    const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"overhead", required_argument, NULL, 'o'},
+        {"test", required_argument, NULL, 't'},
+        {"timeout", required_argument, NULL, 1},
+        {NULL, 0, NULL, 0},
+    };
+    char test[33] = "none";
+    uint32_t iterations = 100;
+    
+    /* init 0 */
+    optind = 0;
+    
+    /* parse */
+    do
+    {
+        /* parse the args */
+        c = getopt_long(argc, argv, short_options, long_options, &longindex);
+        
+        /* judge the result */
+        switch (c)
+        {
+            /* help */
+            case 'h' :
+            {
+                mifare_classic_interface_debug_print("Usage:\n");
+                mifare_classic_interface_debug_print("  mifare_classic_benchmark [-n <iterations> | --iterations=<iterations>]\n");
+                mifare_classic_interface_debug_print("                           [-o <us> | --overhead=<us>] [--timeout=<us>]\n");
+                mifare_classic_interface_debug_print("  mifare_classic_benchmark (-t virtual | --test=virtual)\n");
+                mifare_classic_interface_debug_print("  mifare_classic_benchmark (-t crc | --test=crc)\n");
+                mifare_classic_interface_debug_print("  mifare_classic_benchmark (-h | --help)\n");
+                mifare_classic_interface_debug_print("\n");
+                mifare_classic_interface_debug_print("Options:\n");
+                mifare_classic_interface_debug_print("  -h, --help                        Show the help.\n");
+                mifare_classic_interface_debug_print("  -n <iterations>, --iterations=<iterations>\n");
+                mifare_classic_interface_debug_print("                                    Set the iterations of each scenario.([default: 100])\n");
+                mifare_classic_interface_debug_print("  -o <us>, --overhead=<us>          Set the modeled reader overhead of each frame.([default: 150])\n");
+                mifare_classic_interface_debug_print("  -t <virtual | crc>, --test=<virtual | crc>\n");
+                mifare_classic_interface_debug_print("                                    Run the virtual card test or the crc test instead.\n");
+                mifare_classic_interface_debug_print("  --timeout=<us>                    Set the modeled reader timeout of a frame without an answer.([default: 1000])\n");
+                
+                return 0;
+            }
+            
+            /* iterations */
+            case 'n' :
+            {
+                iterations = (uint32_t)atol(optarg);
+                
+                break;
+            }
+            
+            /* overhead */
+            case 'o' :
+            {
+                g_model_overhead_us = (uint32_t)atol(optarg);
+                
+                break;
+            }
+            
+            /* test */
+            case 't' :
+            {
+                memset(test, 0, sizeof(char) * 33);
+                strncpy(test, optarg, 32);
+                
+                break;
+            }
+            
+            /* timeout */
+            case 1 :
+            {
+                g_model_timeout_us = (uint32_t)atol(optarg);
+                
+                break;
+            }
+            
+            /* the end */
+            case -1 :
+            {
+                break;
+            }
+            
+            /* others */
+            default :
+            {
+                return 5;
+            }
+        }
+    } while (c != -1);
+    
+    /* run the function */
+    if (strcmp("virtual", test) == 0)
+    {
+        return mifare_classic_virtual_test();
+    }
+    else if (strcmp("crc", test) == 0)
+    {
+        return mifare_classic_crc_test(200000);
+    }
+    else if (strcmp("none", test) != 0)
+    {
+        return 5;
+    }
+    else if (iterations == 0)
+    {
+        return 5;
+    }
+    else
+    {
+        return a_benchmark_run(iterations);
+    }
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *             - 0 success
+ *             - 1 run failed
+ * @note      none
+ */
+int main(int argc, char **argv)
+{
+    uint8_t res;
+
+    res = mifare_classic_benchmark((uint8_t)argc, argv);
+    if (res == 0)
+    {
+        /* run success */
+    }
+    else if (res == 1)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: run failed.\n");
+    }
+    else if (res == 5)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: param is invalid.\n");
+    }
+    else
+    {
+        mifare_classic_interface_debug_print("mifare_classic: unknown status code.\n");
+    }
+
+    return (res == 0) ? 0 : 1;
+}
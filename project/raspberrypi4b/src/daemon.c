@@ -0,0 +1,984 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon.c
+ * @brief     daemon source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#define _GNU_SOURCE
+#include "driver_mifare_classic_basic.h"
+#include "daemon_protocol.h"
+#include "daemon_reader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * @brief daemon definition
+ */
+#define DAEMON_MAX_CLIENT            16                             /**< max connected clients */
+#define DAEMON_QUEUE_DEPTH           16                             /**< job queue depth of each reader */
+#define DAEMON_PRESENCE_MS           500                            /**< presence check period of an idle card */
+#define DAEMON_DEFAULT_SOCKET        "/run/mifare_classic.sock"     /**< default socket path */
+
+/**
+ * @brief daemon job structure definition
+ */
+typedef struct daemon_job_s
+{
+    uint8_t client;                                         /**< client slot */
+    uint32_t generation;                                    /**< client generation */
+    uint8_t type;                                           /**< job type */
+    uint16_t tag;                                           /**< client tag */
+    uint16_t len;                                           /**< payload length */
+    uint8_t payload[DAEMON_PROTOCOL_MAX_JOB_PAYLOAD];       /**< job payload */
+} daemon_job_t;
+
+/**
+ * @brief daemon worker structure definition
+ */
+typedef struct daemon_worker_s
+{
+    mifare_classic_basic_t basic;                                               /**< basic instance */
+    daemon_reader_t reader;                                                     /**< reader backend context */
+    pthread_t thread;                                                           /**< worker thread */
+    pthread_mutex_t mutex;                                                      /**< queue mutex */
+    pthread_cond_t cond;                                                        /**< queue condition */
+    daemon_job_t queue[DAEMON_QUEUE_DEPTH];                                     /**< job queue */
+    uint8_t head;                                                               /**< oldest job */
+    uint8_t count;                                                              /**< queued job number */
+    uint8_t present;                                                            /**< card present flag */
+    uint8_t tx_buf[DAEMON_PROTOCOL_HEADER_SIZE + DAEMON_PROTOCOL_MAX_PAYLOAD];  /**< result buffer */
+} daemon_worker_t;
+
+/**
+ * @brief daemon client structure definition
+ */
+typedef struct daemon_client_s
+{
+    int fd;                                                                         /**< socket, -1 when free */
+    uint32_t generation;                                                            /**< slot generation */
+    uint16_t rx_len;                                                                /**< received length */
+    uint8_t rx_buf[DAEMON_PROTOCOL_HEADER_SIZE + DAEMON_PROTOCOL_MAX_JOB_PAYLOAD];  /**< receive buffer */
+} daemon_client_t;
+
+static daemon_worker_t gs_worker[DAEMON_READER_MAX];                     /**< reader workers */
+static daemon_client_t gs_client[DAEMON_MAX_CLIENT];                     /**< client slots */
+static pthread_mutex_t gs_client_mutex = PTHREAD_MUTEX_INITIALIZER;     /**< client mutex */
+static volatile sig_atomic_t gs_running = 1;                             /**< running flag */
+static uint8_t gs_reader_count = 0;                                      /**< reader number */
+
+/**
+ * @brief     signal handler
+ * @param[in] signum signal number
+ * @note      none
+ */
+static void a_daemon_signal(int signum)
+{
+    (void)signum;
+
+    gs_running = 0;
+}
+
+/**
+ * @brief     fill a message header
+ * @param[in] *buf pointer to a message buffer
+ * @param[in] type message type
+ * @param[in] reader reader index
+ * @param[in] tag client tag
+ * @param[in] len payload length
+ * @return    message length
+ * @note      none
+ */
+static uint16_t a_daemon_header(uint8_t *buf, uint8_t type, uint8_t reader, uint16_t tag, uint16_t len)
+{
+    uint16_t total;
+
+    total = (uint16_t)(len + DAEMON_PROTOCOL_HEADER_SIZE - 2);
+    buf[0] = (uint8_t)(total & 0xFF);
+    buf[1] = (uint8_t)((total >> 8) & 0xFF);
+    buf[2] = type;
+    buf[3] = reader;
+    buf[4] = (uint8_t)(tag & 0xFF);
+    buf[5] = (uint8_t)((tag >> 8) & 0xFF);
+
+    return (uint16_t)(len + DAEMON_PROTOCOL_HEADER_SIZE);
+}
+
+/**
+ * @brief     write a whole message to a client
+ * @param[in] index client slot
+ * @param[in] *buf pointer to a message buffer
+ * @param[in] len message length
+ * @note      the client mutex must be held and the client socket is non-blocking, so a client which can not
+ *            take the whole message at once is closed instead of stalling the other clients
+ */
+static void a_daemon_write(uint8_t index, uint8_t *buf, uint16_t len)
+{
+    ssize_t n;
+
+    do
+    {
+        n = send(gs_client[index].fd, buf, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while ((n < 0) && (errno == EINTR));
+    if (n != (ssize_t)len)
+    {
+        (void)close(gs_client[index].fd);
+        gs_client[index].fd = -1;
+        gs_client[index].generation++;
+    }
+}
+
+/**
+ * @brief     send a message to the client of a job
+ * @param[in] client client slot
+ * @param[in] generation client generation
+ * @param[in] *buf pointer to a message buffer
+ * @param[in] len message length
+ * @note      the message is dropped when the client has left
+ */
+static void a_daemon_send(uint8_t client, uint32_t generation, uint8_t *buf, uint16_t len)
+{
+    (void)pthread_mutex_lock(&gs_client_mutex);
+    if ((gs_client[client].fd >= 0) && (gs_client[client].generation == generation))
+    {
+        a_daemon_write(client, buf, len);
+    }
+    (void)pthread_mutex_unlock(&gs_client_mutex);
+}
+
+/**
+ * @brief     send a message to all clients
+ * @param[in] *buf pointer to a message buffer
+ * @param[in] len message length
+ * @note      none
+ */
+static void a_daemon_broadcast(uint8_t *buf, uint16_t len)
+{
+    uint8_t i;
+
+    (void)pthread_mutex_lock(&gs_client_mutex);
+    for (i = 0; i < DAEMON_MAX_CLIENT; i++)
+    {
+        if (gs_client[i].fd >= 0)
+        {
+            a_daemon_write(i, buf, len);
+        }
+    }
+    (void)pthread_mutex_unlock(&gs_client_mutex);
+}
+
+/**
+ * @brief     publish a card event
+ * @param[in] *worker pointer to a worker structure
+ * @param[in] type event type
+ * @param[in] card_type card type
+ * @param[in] *uid pointer to an uid structure
+ * @note      uid is only used by the arrived event
+ */
+static void a_daemon_event(daemon_worker_t *worker, uint8_t type, mifare_classic_type_t card_type, mifare_classic_uid_t *uid)
+{
+    uint8_t buf[DAEMON_PROTOCOL_HEADER_SIZE + 9];
+    uint16_t len;
+
+    len = 0;
+    if (type == DAEMON_MESSAGE_EVENT_CARD_ARRIVED)
+    {
+        memset(&buf[DAEMON_PROTOCOL_HEADER_SIZE], 0, 9);
+        buf[DAEMON_PROTOCOL_HEADER_SIZE + 0] = (uint8_t)card_type;
+        buf[DAEMON_PROTOCOL_HEADER_SIZE + 1] = uid->len;
+        memcpy(&buf[DAEMON_PROTOCOL_HEADER_SIZE + 2], uid->uid, uid->len);
+        len = 9;
+    }
+    len = a_daemon_header(buf, type, worker->reader.index, 0, len);
+    a_daemon_broadcast(buf, len);
+}
+
+/**
+ * @brief      wait for the next job of a worker
+ * @param[in]  *worker pointer to a worker structure
+ * @param[out] *job pointer to a job buffer
+ * @param[in]  ms max wait time
+ * @return     status code
+ *             - 0 success
+ *             - 1 no job
+ * @note       none
+ */
+static uint8_t a_daemon_queue_wait(daemon_worker_t *worker, daemon_job_t *job, uint32_t ms)
+{
+    uint8_t res;
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    res = 1;
+    (void)pthread_mutex_lock(&worker->mutex);
+    while ((worker->count == 0) && (gs_running != 0))
+    {
+        if (pthread_cond_timedwait(&worker->cond, &worker->mutex, &ts) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    if (worker->count != 0)
+    {
+        memcpy(job, &worker->queue[worker->head], sizeof(daemon_job_t));
+        worker->head = (uint8_t)((worker->head + 1) % DAEMON_QUEUE_DEPTH);
+        worker->count--;
+        res = 0;
+    }
+    (void)pthread_mutex_unlock(&worker->mutex);
+
+    return res;
+}
+
+/**
+ * @brief      run a dump job
+ * @param[in]  *worker pointer to a worker structure
+ * @param[in]  *job pointer to a job structure
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     job result
+ * @note       the data blocks of the sectors are sent in order without the sector trailers
+ */
+static uint8_t a_daemon_job_dump(daemon_worker_t *worker, daemon_job_t *job, uint8_t *out, uint16_t *out_len)
+{
+    uint8_t i;
+    uint8_t count;
+    uint16_t pos;
+
+    pos = 0;
+    for (i = 0; i < job->payload[8]; i++)
+    {
+        if (pos + 15 * 16 > DAEMON_PROTOCOL_MAX_PAYLOAD - 1)
+        {
+            *out_len = pos;
+
+            return DAEMON_RESULT_FAILED;
+        }
+        if (mifare_classic_basic_read_sector_r(&worker->basic, (uint8_t)(job->payload[7] + i), out + pos, &count,
+                                               (mifare_classic_authentication_key_t)job->payload[0], &job->payload[1]) != 0)
+        {
+            *out_len = pos;
+
+            return DAEMON_RESULT_FAILED;
+        }
+        pos = (uint16_t)(pos + count * 16);
+    }
+    *out_len = pos;
+
+    return DAEMON_RESULT_OK;
+}
+
+/**
+ * @brief      run a debit job
+ * @param[in]  *worker pointer to a worker structure
+ * @param[in]  *job pointer to a job structure
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     job result
+ * @note       the balance after the debit is sent
+ */
+static uint8_t a_daemon_job_debit(daemon_worker_t *worker, daemon_job_t *job, uint8_t *out, uint16_t *out_len)
+{
+    uint8_t addr;
+    uint8_t block;
+    uint32_t amount;
+    int32_t balance;
+    mifare_classic_authentication_key_t key_type;
+
+    *out_len = 0;
+    block = job->payload[0];
+    key_type = (mifare_classic_authentication_key_t)job->payload[1];
+    amount = (uint32_t)job->payload[8] | ((uint32_t)job->payload[9] << 8) |
+             ((uint32_t)job->payload[10] << 16) | ((uint32_t)job->payload[11] << 24);
+    if (mifare_classic_basic_value_decrement_r(&worker->basic, block, amount, key_type, &job->payload[2]) != 0)
+    {
+        return DAEMON_RESULT_FAILED;
+    }
+    if (mifare_classic_basic_value_read_r(&worker->basic, block, &balance, &addr, key_type, &job->payload[2]) != 0)
+    {
+        return DAEMON_RESULT_FAILED;
+    }
+    out[0] = (uint8_t)((uint32_t)balance & 0xFF);
+    out[1] = (uint8_t)(((uint32_t)balance >> 8) & 0xFF);
+    out[2] = (uint8_t)(((uint32_t)balance >> 16) & 0xFF);
+    out[3] = (uint8_t)(((uint32_t)balance >> 24) & 0xFF);
+    *out_len = 4;
+
+    return DAEMON_RESULT_OK;
+}
+
+/**
+ * @brief      run a write set job
+ * @param[in]  *worker pointer to a worker structure
+ * @param[in]  *job pointer to a job structure
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     job result
+ * @note       the blocks are written in order and the written number is sent
+ */
+static uint8_t a_daemon_job_write(daemon_worker_t *worker, daemon_job_t *job, uint8_t *out, uint16_t *out_len)
+{
+    uint8_t i;
+    uint8_t *entry;
+
+    out[0] = 0;
+    *out_len = 1;
+    for (i = 0; i < job->payload[7]; i++)
+    {
+        entry = &job->payload[8 + i * 17];
+        if (mifare_classic_basic_write_r(&worker->basic, entry[0], &entry[1],
+                                         (mifare_classic_authentication_key_t)job->payload[0], &job->payload[1]) != 0)
+        {
+            return DAEMON_RESULT_FAILED;
+        }
+        out[0]++;
+    }
+
+    return DAEMON_RESULT_OK;
+}
+
+/**
+ * @brief     run a job on the card of a worker
+ * @param[in] *worker pointer to a worker structure
+ * @param[in] *job pointer to a job structure
+ * @note      the card is woken up for the job and halted after it
+ */
+static void a_daemon_job_run(daemon_worker_t *worker, daemon_job_t *job)
+{
+    uint8_t res;
+    uint16_t len;
+    uint8_t *out;
+
+    out = &worker->tx_buf[DAEMON_PROTOCOL_HEADER_SIZE + 1];
+    len = 0;
+    if (mifare_classic_reselect(&worker->basic.handle, worker->basic.id) != 0)
+    {
+        worker->present = 0;
+        a_daemon_event(worker, DAEMON_MESSAGE_EVENT_CARD_REMOVED, MIFARE_CLASSIC_TYPE_INVALID, NULL);
+        res = DAEMON_RESULT_CARD_REMOVED;
+    }
+    else
+    {
+        if (job->type == DAEMON_MESSAGE_JOB_DUMP)
+        {
+            res = a_daemon_job_dump(worker, job, out, &len);
+        }
+        else if (job->type == DAEMON_MESSAGE_JOB_DEBIT)
+        {
+            res = a_daemon_job_debit(worker, job, out, &len);
+        }
+        else
+        {
+            res = a_daemon_job_write(worker, job, out, &len);
+        }
+        (void)mifare_classic_basic_halt_r(&worker->basic);
+    }
+    worker->tx_buf[DAEMON_PROTOCOL_HEADER_SIZE] = res;
+    len = a_daemon_header(worker->tx_buf, DAEMON_MESSAGE_RESULT, worker->reader.index, job->tag, (uint16_t)(len + 1));
+    a_daemon_send(job->client, job->generation, worker->tx_buf, len);
+}
+
+/**
+ * @brief     worker thread
+ * @param[in] *arg pointer to a worker structure
+ * @return    NULL
+ * @note      a card is halted after its arrival and every job, so the poll only sees new cards
+ *            and the queued jobs wait for the next card
+ */
+static void *a_daemon_worker(void *arg)
+{
+    uint8_t id[4];
+    mifare_classic_type_t type;
+    mifare_classic_uid_t uid;
+    daemon_job_t job;
+    daemon_worker_t *worker = (daemon_worker_t *)arg;
+
+    while (gs_running != 0)
+    {
+        /* search a new card */
+        if (worker->present == 0)
+        {
+            if (mifare_classic_basic_search_r(&worker->basic, &type, id, 1) == 0)
+            {
+                worker->present = 1;
+                (void)mifare_classic_basic_get_uid_r(&worker->basic, &uid);
+                (void)mifare_classic_basic_halt_r(&worker->basic);
+                a_daemon_event(worker, DAEMON_MESSAGE_EVENT_CARD_ARRIVED, type, &uid);
+            }
+
+            continue;
+        }
+
+        /* run the queued jobs, check the presence when idle */
+        if (a_daemon_queue_wait(worker, &job, DAEMON_PRESENCE_MS) == 0)
+        {
+            a_daemon_job_run(worker, &job);
+        }
+        else if (gs_running != 0)
+        {
+            if (mifare_classic_reselect(&worker->basic.handle, worker->basic.id) != 0)
+            {
+                worker->present = 0;
+                a_daemon_event(worker, DAEMON_MESSAGE_EVENT_CARD_REMOVED, MIFARE_CLASSIC_TYPE_INVALID, NULL);
+            }
+            else
+            {
+                (void)mifare_classic_basic_halt_r(&worker->basic);
+            }
+        }
+        else
+        {
+            /* stop */
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief     check the payload length of a job
+ * @param[in] type job type
+ * @param[in] *payload pointer to a payload buffer
+ * @param[in] len payload length
+ * @return    status code
+ *            - 0 success
+ *            - 1 job is invalid
+ * @note      none
+ */
+static uint8_t a_daemon_job_check(uint8_t type, uint8_t *payload, uint16_t len)
+{
+    if (type == DAEMON_MESSAGE_JOB_DUMP)
+    {
+        return (len == 9) ? 0 : 1;
+    }
+    else if (type == DAEMON_MESSAGE_JOB_DEBIT)
+    {
+        return (len == 12) ? 0 : 1;
+    }
+    else if (type == DAEMON_MESSAGE_JOB_WRITE)
+    {
+        if ((len < 8) || (payload[7] > DAEMON_PROTOCOL_MAX_WRITE_BLOCK))
+        {
+            return 1;
+        }
+
+        return (len == 8 + payload[7] * 17) ? 0 : 1;
+    }
+    else
+    {
+        return 1;
+    }
+}
+
+/**
+ * @brief     queue a received job or reject it
+ * @param[in] index client slot
+ * @param[in] *msg pointer to a message buffer
+ * @param[in] len payload length
+ * @note      the client mutex must be held
+ */
+static void a_daemon_dispatch(uint8_t index, uint8_t *msg, uint16_t len)
+{
+    uint8_t reason;
+    uint8_t reader;
+    uint8_t buf[DAEMON_PROTOCOL_HEADER_SIZE + 1];
+    uint16_t tag;
+    daemon_job_t *job;
+    daemon_worker_t *worker;
+
+    reader = msg[3];
+    tag = (uint16_t)(msg[4] | (msg[5] << 8));
+    if (reader >= gs_reader_count)
+    {
+        reason = DAEMON_REJECT_READER_INVALID;
+    }
+    else if (a_daemon_job_check(msg[2], &msg[DAEMON_PROTOCOL_HEADER_SIZE], len) != 0)
+    {
+        reason = DAEMON_REJECT_MESSAGE_INVALID;
+    }
+    else
+    {
+        worker = &gs_worker[reader];
+        (void)pthread_mutex_lock(&worker->mutex);
+        if (worker->count < DAEMON_QUEUE_DEPTH)
+        {
+            job = &worker->queue[(worker->head + worker->count) % DAEMON_QUEUE_DEPTH];
+            job->client = index;
+            job->generation = gs_client[index].generation;
+            job->type = msg[2];
+            job->tag = tag;
+            job->len = len;
+            memcpy(job->payload, &msg[DAEMON_PROTOCOL_HEADER_SIZE], len);
+            worker->count++;
+            (void)pthread_cond_signal(&worker->cond);
+            reason = 0;
+        }
+        else
+        {
+            reason = DAEMON_REJECT_QUEUE_FULL;
+        }
+        (void)pthread_mutex_unlock(&worker->mutex);
+    }
+    if (reason != 0)
+    {
+        buf[DAEMON_PROTOCOL_HEADER_SIZE] = reason;
+        a_daemon_write(index, buf, a_daemon_header(buf, DAEMON_MESSAGE_REJECTED, reader, tag, 1));
+    }
+}
+
+/**
+ * @brief     receive from a client
+ * @param[in] index client slot
+ * @note      several jobs can arrive in one read, a client which breaks the framing is closed
+ */
+static void a_daemon_receive(uint8_t index)
+{
+    ssize_t n;
+    uint16_t len;
+    daemon_client_t *client = &gs_client[index];
+
+    (void)pthread_mutex_lock(&gs_client_mutex);
+    n = recv(client->fd, client->rx_buf + client->rx_len, sizeof(client->rx_buf) - client->rx_len, 0);
+    if (n <= 0)
+    {
+        if ((n < 0) && ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            (void)pthread_mutex_unlock(&gs_client_mutex);
+
+            return;
+        }
+        (void)close(client->fd);
+        client->fd = -1;
+        client->generation++;
+        (void)pthread_mutex_unlock(&gs_client_mutex);
+
+        return;
+    }
+    client->rx_len = (uint16_t)(client->rx_len + n);
+    while ((client->fd >= 0) && (client->rx_len >= DAEMON_PROTOCOL_HEADER_SIZE))
+    {
+        len = (uint16_t)(client->rx_buf[0] | (client->rx_buf[1] << 8));
+        if ((len < DAEMON_PROTOCOL_HEADER_SIZE - 2) ||
+            (len > DAEMON_PROTOCOL_HEADER_SIZE - 2 + DAEMON_PROTOCOL_MAX_JOB_PAYLOAD))
+        {
+            (void)close(client->fd);
+            client->fd = -1;
+            client->generation++;
+
+            break;
+        }
+        if (client->rx_len < len + 2)
+        {
+            break;
+        }
+        a_daemon_dispatch(index, client->rx_buf, (uint16_t)(len + 2 - DAEMON_PROTOCOL_HEADER_SIZE));
+        memmove(client->rx_buf, client->rx_buf + len + 2, client->rx_len - (len + 2));
+        client->rx_len = (uint16_t)(client->rx_len - (len + 2));
+    }
+    (void)pthread_mutex_unlock(&gs_client_mutex);
+}
+
+/**
+ * @brief     accept a client
+ * @param[in] fd listening socket
+ * @note      the client is closed at once when all slots are used or it can't be made non-blocking
+ */
+static void a_daemon_accept(int fd)
+{
+    int client;
+    int flags;
+    uint8_t i;
+
+    client = accept(fd, NULL, NULL);
+    if (client < 0)
+    {
+        return;
+    }
+    flags = fcntl(client, F_GETFL, 0);
+    if ((flags < 0) || (fcntl(client, F_SETFL, flags | O_NONBLOCK) < 0))
+    {
+        (void)close(client);
+
+        return;
+    }
+    (void)pthread_mutex_lock(&gs_client_mutex);
+    for (i = 0; i < DAEMON_MAX_CLIENT; i++)
+    {
+        if (gs_client[i].fd < 0)
+        {
+            gs_client[i].fd = client;
+            gs_client[i].rx_len = 0;
+
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&gs_client_mutex);
+    if (i == DAEMON_MAX_CLIENT)
+    {
+        (void)close(client);
+    }
+}
+
+/**
+ * @brief     serve the clients until a stop signal
+ * @param[in] fd listening socket
+ * @note      none
+ */
+static void a_daemon_serve(int fd)
+{
+    uint8_t i;
+    nfds_t n;
+    uint8_t slot[DAEMON_MAX_CLIENT];
+    struct pollfd pfd[DAEMON_MAX_CLIENT + 1];
+
+    while (gs_running != 0)
+    {
+        pfd[0].fd = fd;
+        pfd[0].events = POLLIN;
+        n = 1;
+        (void)pthread_mutex_lock(&gs_client_mutex);
+        for (i = 0; i < DAEMON_MAX_CLIENT; i++)
+        {
+            if (gs_client[i].fd >= 0)
+            {
+                pfd[n].fd = gs_client[i].fd;
+                pfd[n].events = POLLIN;
+                slot[n - 1] = i;
+                n++;
+            }
+        }
+        (void)pthread_mutex_unlock(&gs_client_mutex);
+        if (poll(pfd, n, 200) <= 0)
+        {
+            continue;
+        }
+        if ((pfd[0].revents & POLLIN) != 0)
+        {
+            a_daemon_accept(fd);
+        }
+        for (i = 1; i < n; i++)
+        {
+            if ((pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+            {
+                a_daemon_receive(slot[i - 1]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief     parse the chip select gpio list
+ * @param[in] *str pointer to a comma separated list
+ * @param[in] *gpio pointer to a gpio buffer
+ * @return    gpio number, 0 if the list is invalid
+ * @note      none
+ */
+static uint8_t a_daemon_parse_gpio(char *str, uint8_t *gpio)
+{
+    uint8_t count;
+    long value;
+    char *end;
+
+    count = 0;
+    while ((*str != '\0') && (count < DAEMON_READER_MAX))
+    {
+        value = strtol(str, &end, 10);
+        if ((end == str) || (value < 0) || (value > 255))
+        {
+            return 0;
+        }
+        gpio[count++] = (uint8_t)value;
+        str = (*end == ',') ? end + 1 : end;
+        if ((*end != ',') && (*end != '\0'))
+        {
+            return 0;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief     daemon
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ *            - 5 param is invalid
+ * @note      none
+ */
+static uint8_t mifare_classic_daemon(int argc, char **argv)
+{
+    int c;
+    int fd;
+    int longindex = 0;
+    long cpu;
+    long count;
+    char *end;
+    uint8_t i;
+    uint8_t res;
+    uint8_t gpio_count = 0;
+    uint8_t gpio[DAEMON_READER_MAX];
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)] = DAEMON_DEFAULT_SOCKET;
+    cpu_set_t set;
+    struct sockaddr_un addr;
+    const char short_options[] = "hn:s:g:";
+    const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"reader", required_argument, NULL, 'n'},
+        {"socket", required_argument, NULL, 's'},
+        {"cs-gpio", required_argument, NULL, 'g'},
+        {NULL, 0, NULL, 0},
+    };
+
+    /* init 1 reader */
+    gs_reader_count = 1;
+
+    /* set optind */
+    optind = 0;
+    opterr = 0;
+
+    /* parse */
+    do
+    {
+        c = getopt_long(argc, argv, short_options, long_options, &longindex);
+        switch (c)
+        {
+            case 'h' :
+            {
+                mifare_classic_interface_debug_print("Usage:\n");
+                mifare_classic_interface_debug_print("  mifare_classic_daemon [-n <count> | --reader=<count>] [-s <path> | --socket=<path>]\n");
+                mifare_classic_interface_debug_print("                        [-g <list> | --cs-gpio=<list>]\n");
+                mifare_classic_interface_debug_print("  mifare_classic_daemon (-h | --help)\n");
+                mifare_classic_interface_debug_print("\n");
+                mifare_classic_interface_debug_print("Options:\n");
+                mifare_classic_interface_debug_print("  -g <list>, --cs-gpio=<list>      Set the chip select bcm lines of the readers, e.g. 5,6,13,19.\n");
+                mifare_classic_interface_debug_print("  -h, --help                       Show the help.\n");
+                mifare_classic_interface_debug_print("  -n <count>, --reader=<count>     Set the reader number.([default: 1])\n");
+                mifare_classic_interface_debug_print("  -s <path>, --socket=<path>       Set the unix socket path.([default: %s])\n", DAEMON_DEFAULT_SOCKET);
+
+                return 0;
+            }
+            case 'n' :
+            {
+                count = strtol(optarg, &end, 10);
+                if ((end == optarg) || (*end != '\0') || (count < 1) || (count > DAEMON_READER_MAX))
+                {
+                    return 5;
+                }
+                gs_reader_count = (uint8_t)count;
+
+                break;
+            }
+            case 's' :
+            {
+                if (strlen(optarg) >= sizeof(path))
+                {
+                    return 5;
+                }
+                strcpy(path, optarg);
+
+                break;
+            }
+            case 'g' :
+            {
+                gpio_count = a_daemon_parse_gpio(optarg, gpio);
+                if (gpio_count == 0)
+                {
+                    return 5;
+                }
+
+                break;
+            }
+            case -1 :
+            {
+                break;
+            }
+            default :
+            {
+                return 5;
+            }
+        }
+    } while (c != -1);
+    if ((gs_reader_count == 0) || (gs_reader_count > DAEMON_READER_MAX) ||
+        ((gpio_count == 0) && (gs_reader_count != 1)) || ((gpio_count != 0) && (gpio_count != gs_reader_count)))
+    {
+        return 5;
+    }
+
+    /* socket */
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: socket failed.\n");
+
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    (void)unlink(path);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, DAEMON_MAX_CLIENT) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: bind %s failed.\n", path);
+        (void)close(fd);
+
+        return 1;
+    }
+    for (i = 0; i < DAEMON_MAX_CLIENT; i++)
+    {
+        gs_client[i].fd = -1;
+    }
+
+    /* readers */
+    if (daemon_reader_bus_init(gs_reader_count, (gpio_count != 0) ? gpio : NULL) != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: reader bus init failed.\n");
+        (void)close(fd);
+
+        return 1;
+    }
+    for (i = 0; i < gs_reader_count; i++)
+    {
+        gs_worker[i].reader.index = i;
+        res = mifare_classic_basic_init_r(&gs_worker[i].basic, &gs_worker[i].reader,
+                                          daemon_reader_contactless_init, daemon_reader_contactless_deinit,
+                                          daemon_reader_contactless_transceiver);
+        if (res != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d init failed.\n", i);
+            while (i > 0)
+            {
+                i--;
+                (void)mifare_classic_basic_deinit_r(&gs_worker[i].basic);
+            }
+            (void)daemon_reader_bus_deinit();
+            (void)close(fd);
+
+            return 1;
+        }
+    }
+
+    /* one worker for each reader, the first core is left to the socket */
+    (void)signal(SIGINT, a_daemon_signal);
+    (void)signal(SIGTERM, a_daemon_signal);
+    cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    for (i = 0; i < gs_reader_count; i++)
+    {
+        (void)pthread_mutex_init(&gs_worker[i].mutex, NULL);
+        (void)pthread_cond_init(&gs_worker[i].cond, NULL);
+        (void)pthread_create(&gs_worker[i].thread, NULL, a_daemon_worker, &gs_worker[i]);
+        if (cpu > 1)
+        {
+            CPU_ZERO(&set);
+            CPU_SET((i + 1) % cpu, &set);
+            (void)pthread_setaffinity_np(gs_worker[i].thread, sizeof(cpu_set_t), &set);
+        }
+    }
+    mifare_classic_interface_debug_print("mifare_classic: daemon serves %d readers on %s.\n", gs_reader_count, path);
+
+    /* serve */
+    a_daemon_serve(fd);
+
+    /* stop */
+    for (i = 0; i < gs_reader_count; i++)
+    {
+        (void)pthread_mutex_lock(&gs_worker[i].mutex);
+        (void)pthread_cond_broadcast(&gs_worker[i].cond);
+        (void)pthread_mutex_unlock(&gs_worker[i].mutex);
+        (void)pthread_join(gs_worker[i].thread, NULL);
+        (void)mifare_classic_basic_deinit_r(&gs_worker[i].basic);
+    }
+    (void)daemon_reader_bus_deinit();
+    for (i = 0; i < DAEMON_MAX_CLIENT; i++)
+    {
+        if (gs_client[i].fd >= 0)
+        {
+            (void)close(gs_client[i].fd);
+        }
+    }
+    (void)close(fd);
+    (void)unlink(path);
+
+    return 0;
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *             - 0 success
+ * @note      none
+ */
+int main(int argc, char **argv)
+{
+    uint8_t res;
+
+    res = mifare_classic_daemon(argc, argv);
+    if (res == 0)
+    {
+        /* run success */
+    }
+    else if (res == 1)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: run failed.\n");
+    }
+    else if (res == 5)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: param is invalid.\n");
+    }
+    else
+    {
+        mifare_classic_interface_debug_print("mifare_classic: unknown status code.\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon_protocol.h
+ * @brief     daemon protocol header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup daemon_protocol daemon protocol
+ * @brief    mifare classic daemon socket protocol
+ * @{
+ */
+
+/**
+ * @brief daemon protocol size definition
+ * @note  every message starts with a 6 bytes header in little endian,
+ *        len(2) type(1) reader(1) tag(2), len counts the bytes after the len field
+ */
+#define DAEMON_PROTOCOL_HEADER_SIZE         6           /**< header size */
+#define DAEMON_PROTOCOL_MAX_JOB_PAYLOAD     512         /**< max payload of a job message */
+#define DAEMON_PROTOCOL_MAX_PAYLOAD         4096        /**< max payload of a daemon message */
+#define DAEMON_PROTOCOL_MAX_WRITE_BLOCK     16          /**< max blocks of a write set */
+
+/**
+ * @brief daemon message type enumeration definition
+ */
+typedef enum
+{
+    DAEMON_MESSAGE_JOB_DUMP           = 0x01,        /**< key_type(1) key(6) sector(1) sector_count(1) */
+    DAEMON_MESSAGE_JOB_DEBIT          = 0x02,        /**< block(1) key_type(1) key(6) amount(4) */
+    DAEMON_MESSAGE_JOB_WRITE          = 0x03,        /**< key_type(1) key(6) count(1) count * (block(1) data(16)) */
+    DAEMON_MESSAGE_EVENT_CARD_ARRIVED = 0x81,        /**< type(1) uid_len(1) uid(7) */
+    DAEMON_MESSAGE_EVENT_CARD_REMOVED = 0x82,        /**< no payload */
+    DAEMON_MESSAGE_RESULT             = 0x83,        /**< res(1) and the job output, dump data, balance(4) or written count(1) */
+    DAEMON_MESSAGE_REJECTED           = 0x84,        /**< reason(1) */
+} daemon_message_type_t;
+
+/**
+ * @brief daemon reject reason enumeration definition
+ */
+typedef enum
+{
+    DAEMON_REJECT_READER_INVALID  = 0x01,        /**< reader index is invalid */
+    DAEMON_REJECT_QUEUE_FULL      = 0x02,        /**< job queue of the reader is full */
+    DAEMON_REJECT_MESSAGE_INVALID = 0x03,        /**< type or payload length is invalid */
+} daemon_reject_reason_t;
+
+/**
+ * @brief daemon job result enumeration definition
+ */
+typedef enum
+{
+    DAEMON_RESULT_OK           = 0x00,        /**< job done */
+    DAEMON_RESULT_FAILED       = 0x01,        /**< a card command failed, the output is partial */
+    DAEMON_RESULT_CARD_REMOVED = 0x02,        /**< the card has left before the job */
+} daemon_result_t;
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
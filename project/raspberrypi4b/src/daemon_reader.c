@@ -0,0 +1,237 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon_reader.c
+ * @brief     daemon reader source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "daemon_reader.h"
+#include "driver_mifare_classic_interface.h"
+#include <gpiod.h>
+#include <pthread.h>
+
+/**
+ * @brief daemon reader gpio definition
+ */
+#define DAEMON_READER_GPIO_CHIP        "gpiochip0"                 /**< gpio chip of the bcm lines */
+#define DAEMON_READER_GPIO_CONSUMER    "mifare_classic_daemon"     /**< gpio consumer name */
+
+static pthread_mutex_t gs_bus_mutex = PTHREAD_MUTEX_INITIALIZER;        /**< bus mutex */
+static struct gpiod_chip *gs_chip = NULL;                                /**< gpio chip */
+static struct gpiod_line *gs_cs[DAEMON_READER_MAX];                      /**< chip select lines */
+static uint8_t gs_count = 0;                                             /**< reader number */
+static uint8_t gs_selected = 0xFF;                                       /**< selected reader */
+static uint8_t gs_opened = 0;                                            /**< bus opened flag */
+static uint8_t gs_users = 0;                                             /**< inited reader number */
+
+/**
+ * @brief     select a reader on the bus
+ * @param[in] index reader index
+ * @note      all other chip selects are released, nothing is done without chip select lines
+ */
+static void a_reader_select(uint8_t index)
+{
+    uint8_t i;
+
+    if ((gs_chip == NULL) || (gs_selected == index))
+    {
+        return;
+    }
+    for (i = 0; i < gs_count; i++)
+    {
+        (void)gpiod_line_set_value(gs_cs[i], (i == index) ? 0 : 1);
+    }
+    gs_selected = index;
+}
+
+/**
+ * @brief     init the reader bus
+ * @param[in] count reader number
+ * @param[in] *cs_gpio pointer to a chip select gpio buffer, one bcm line for each reader
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      cs_gpio can be NULL with one reader, the reader then uses the chip select of the spi
+ */
+uint8_t daemon_reader_bus_init(uint8_t count, uint8_t *cs_gpio)
+{
+    uint8_t i;
+
+    if ((count == 0) || (count > DAEMON_READER_MAX))
+    {
+        return 1;
+    }
+    if (cs_gpio == NULL)
+    {
+        if (count != 1)
+        {
+            return 1;
+        }
+        gs_count = 1;
+
+        return 0;
+    }
+
+    /* every chip select idles high */
+    gs_chip = gpiod_chip_open_by_name(DAEMON_READER_GPIO_CHIP);
+    if (gs_chip == NULL)
+    {
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        gs_cs[i] = gpiod_chip_get_line(gs_chip, cs_gpio[i]);
+        if ((gs_cs[i] == NULL) || (gpiod_line_request_output(gs_cs[i], DAEMON_READER_GPIO_CONSUMER, 1) != 0))
+        {
+            gpiod_chip_close(gs_chip);
+            gs_chip = NULL;
+
+            return 1;
+        }
+    }
+    gs_count = count;
+    gs_selected = 0xFF;
+
+    return 0;
+}
+
+/**
+ * @brief  deinit the reader bus
+ * @return status code
+ *         - 0 success
+ *         - 1 deinit failed
+ * @note   none
+ */
+uint8_t daemon_reader_bus_deinit(void)
+{
+    uint8_t i;
+
+    if (gs_chip != NULL)
+    {
+        for (i = 0; i < gs_count; i++)
+        {
+            gpiod_line_release(gs_cs[i]);
+        }
+        gpiod_chip_close(gs_chip);
+        gs_chip = NULL;
+    }
+    gs_count = 0;
+
+    return 0;
+}
+
+/**
+ * @brief     reader contactless init
+ * @param[in] *context pointer to a daemon reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless init failed
+ * @note      the interface init configures the selected chip, so it runs again for every reader
+ *            and the chips keep their registers while the others are configured
+ */
+uint8_t daemon_reader_contactless_init(void *context)
+{
+    uint8_t res;
+    daemon_reader_t *reader = (daemon_reader_t *)context;
+
+    (void)pthread_mutex_lock(&gs_bus_mutex);
+    a_reader_select(reader->index);
+    if (gs_opened != 0)
+    {
+        (void)mifare_classic_interface_contactless_deinit();
+        gs_opened = 0;
+    }
+    res = mifare_classic_interface_contactless_init();
+    if (res == 0)
+    {
+        gs_opened = 1;
+        gs_users++;
+    }
+    (void)pthread_mutex_unlock(&gs_bus_mutex);
+
+    return (res != 0) ? 1 : 0;
+}
+
+/**
+ * @brief     reader contactless deinit
+ * @param[in] *context pointer to a daemon reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless deinit failed
+ * @note      the bus is closed with the last reader
+ */
+uint8_t daemon_reader_contactless_deinit(void *context)
+{
+    uint8_t res;
+
+    (void)context;
+    res = 0;
+    (void)pthread_mutex_lock(&gs_bus_mutex);
+    if (gs_users > 0)
+    {
+        gs_users--;
+    }
+    if ((gs_users == 0) && (gs_opened != 0))
+    {
+        res = mifare_classic_interface_contactless_deinit();
+        gs_opened = 0;
+    }
+    (void)pthread_mutex_unlock(&gs_bus_mutex);
+
+    return (res != 0) ? 1 : 0;
+}
+
+/**
+ * @brief         reader contactless transceiver
+ * @param[in]     *context pointer to a daemon reader structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 contactless transceiver failed
+ * @note          the exchange holds the bus and selects the chip of the reader
+ */
+uint8_t daemon_reader_contactless_transceiver(void *context, uint8_t *in_buf, uint8_t in_len,
+                                              uint8_t *out_buf, uint8_t *out_len)
+{
+    uint8_t res;
+    daemon_reader_t *reader = (daemon_reader_t *)context;
+
+    (void)pthread_mutex_lock(&gs_bus_mutex);
+    a_reader_select(reader->index);
+    res = mifare_classic_interface_contactless_transceiver(in_buf, in_len, out_buf, out_len);
+    (void)pthread_mutex_unlock(&gs_bus_mutex);
+
+    return (res != 0) ? 1 : 0;
+}
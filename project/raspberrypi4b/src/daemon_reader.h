@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      daemon_reader.h
+ * @brief     daemon reader header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DAEMON_READER_H
+#define DAEMON_READER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup daemon_reader daemon reader
+ * @brief    mifare classic daemon reader backend
+ * @{
+ */
+
+/**
+ * @brief daemon reader max number definition
+ */
+#define DAEMON_READER_MAX    8        /**< max readers on one bus */
+
+/**
+ * @brief daemon reader structure definition
+ */
+typedef struct daemon_reader_s
+{
+    uint8_t index;        /**< reader index on the bus */
+} daemon_reader_t;
+
+/**
+ * @brief     init the reader bus
+ * @param[in] count reader number
+ * @param[in] *cs_gpio pointer to a chip select gpio buffer, one bcm line for each reader
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      cs_gpio can be NULL with one reader, the reader then uses the chip select of the spi
+ */
+uint8_t daemon_reader_bus_init(uint8_t count, uint8_t *cs_gpio);
+
+/**
+ * @brief  deinit the reader bus
+ * @return status code
+ *         - 0 success
+ *         - 1 deinit failed
+ * @note   none
+ */
+uint8_t daemon_reader_bus_deinit(void);
+
+/**
+ * @brief     reader contactless init
+ * @param[in] *context pointer to a daemon reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless init failed
+ * @note      none
+ */
+uint8_t daemon_reader_contactless_init(void *context);
+
+/**
+ * @brief     reader contactless deinit
+ * @param[in] *context pointer to a daemon reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless deinit failed
+ * @note      none
+ */
+uint8_t daemon_reader_contactless_deinit(void *context);
+
+/**
+ * @brief         reader contactless transceiver
+ * @param[in]     *context pointer to a daemon reader structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 contactless transceiver failed
+ * @note          the exchange holds the bus and selects the chip of the reader
+ */
+uint8_t daemon_reader_contactless_transceiver(void *context, uint8_t *in_buf, uint8_t in_len,
+                                              uint8_t *out_buf, uint8_t *out_len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -36,6 +36,8 @@
 
 #include "driver_mifare_classic_basic.h"
 #include "driver_mifare_classic_card_test.h"
+#include "driver_mifare_classic_virtual_test.h"
+#include "driver_mifare_classic_crc_test.h"
 #include <getopt.h>
 #include <math.h>
 #include <stdlib.h>
@@ -436,6 +438,32 @@ uint8_t mifare_classic(uint8_t argc, char **argv)
         
         return 0;
     }
+    else if (strcmp("t_virtual", type) == 0)
+    {
+        uint8_t res;
+        
+        /* run the virtual test */
+        res = mifare_classic_virtual_test();
+        if (res != 0)
+        {
+            return 1;
+        }
+        
+        return 0;
+    }
+    else if (strcmp("t_crc", type) == 0)
+    {
+        uint8_t res;
+        
+        /* run the crc test */
+        res = mifare_classic_crc_test(1000000);
+        if (res != 0)
+        {
+            return 1;
+        }
+        
+        return 0;
+    }
     else if (strcmp("e_halt", type) == 0)
     {
         uint8_t res;
@@ -945,6 +973,8 @@ uint8_t mifare_classic(uint8_t argc, char **argv)
         mifare_classic_interface_debug_print("  mifare_classic (-h | --help)\n");
         mifare_classic_interface_debug_print("  mifare_classic (-p | --port)\n");
         mifare_classic_interface_debug_print("  mifare_classic (-t card | --test=card)\n");
+        mifare_classic_interface_debug_print("  mifare_classic (-t virtual | --test=virtual)\n");
+        mifare_classic_interface_debug_print("  mifare_classic (-t crc | --test=crc)\n");
         mifare_classic_interface_debug_print("  mifare_classic (-e halt | --example=halt)\n");
         mifare_classic_interface_debug_print("  mifare_classic (-e wake-up | --example=wake-up)\n");
         mifare_classic_interface_debug_print("  mifare_classic (-e read | --example=read) [--key-type=<A | B>] [--key=<authentication>]\n");
@@ -974,7 +1004,8 @@ uint8_t mifare_classic(uint8_t argc, char **argv)
         mifare_classic_interface_debug_print("      --key=<authentication>    Set the key of authentication and it is hexadecimal with 6 bytes(strlen=12).([default: 0xFFFFFFFFFFFF])\n");
         mifare_classic_interface_debug_print("      --key-type=<A | B>        Set the key type of authentication.([default: A])\n");
         mifare_classic_interface_debug_print("  -p, --port                    Display the pin connections of the current board.\n");
-        mifare_classic_interface_debug_print("  -t <card>, --test=<card>      Run the driver test.\n");
+        mifare_classic_interface_debug_print("  -t <card | virtual | crc>, --test=<card | virtual | crc>\n");
+        mifare_classic_interface_debug_print("                                Run the driver test.\n");
         mifare_classic_interface_debug_print("      --value=<dec>             Set the input value.([default: 0])\n");
 
         return 0;
@@ -70,13 +70,439 @@
 #define MIFARE_CLASSIC_COMMAND_MIFARE_TRANSFER                  0xB0           /**< transfer command */
 
 /**
- * @brief     crc calculation
- * @param[in] *p pointer to a data buffer
- * @param[in] len data length
- * @note      none
+ * @brief log text definition
+ */
+#define MIFARE_CLASSIC_LOG_TEXT_TRANSCEIVER_FAILED                  "mifare_classic: contactless transceiver failed.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_OUTPUT_LEN_INVALID                  "mifare_classic: output_len is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CRC_ERROR                           "mifare_classic: crc error.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_ACK_ERROR                           "mifare_classic: ack error.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_INVALID_OPERATION                   "mifare_classic: invalid operation.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_TYPE_INVALID                        "mifare_classic: type is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_SAK_ERROR                           "mifare_classic: sak error.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CHECK_ERROR                         "mifare_classic: check error.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_COLLISION_NOT_RESOLVED              "mifare_classic: collision is not resolved.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_AUTHENTICATION_FAILED               "mifare_classic: authentication failed.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_VALUE_INVALID                       "mifare_classic: value is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_BLOCK_INVALID                       "mifare_classic: block is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_DATA_INVALID                        "mifare_classic: data is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_STATE_INVALID                       "mifare_classic: state is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_UID_TOO_LONG                        "mifare_classic: uid is too long.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_MAX_INVALID                         "mifare_classic: max is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_SECTOR_INVALID                      "mifare_classic: sector is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_KEY_SET_INVALID                     "mifare_classic: key set is invalid.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_OPERATION_BUSY                      "mifare_classic: operation is busy.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_NO_OPERATION_BUSY                   "mifare_classic: no operation is busy.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_INIT_NULL               "mifare_classic: contactless_init is null.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_DEINIT_NULL             "mifare_classic: contactless_deinit is null.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_TRANSCEIVER_NULL        "mifare_classic: contactless_transceiver is null.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_DELAY_MS_NULL                       "mifare_classic: delay_ms is null.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_SUBMIT_NULL             "mifare_classic: contactless_submit is null.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_INIT_FAILED             "mifare_classic: contactless init failed.\n"
+#define MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_DEINIT_FAILED           "mifare_classic: contactless deinit failed.\n"
+
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+/**
+ * @brief log text table, indexed by the log event
+ */
+static const char *const gsc_mifare_classic_log_text[MIFARE_CLASSIC_EVENT_MAX] =
+{
+    "mifare_classic: unknown event.\n",
+    MIFARE_CLASSIC_LOG_TEXT_TRANSCEIVER_FAILED,
+    MIFARE_CLASSIC_LOG_TEXT_OUTPUT_LEN_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_CRC_ERROR,
+    MIFARE_CLASSIC_LOG_TEXT_ACK_ERROR,
+    MIFARE_CLASSIC_LOG_TEXT_INVALID_OPERATION,
+    MIFARE_CLASSIC_LOG_TEXT_TYPE_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_SAK_ERROR,
+    MIFARE_CLASSIC_LOG_TEXT_CHECK_ERROR,
+    MIFARE_CLASSIC_LOG_TEXT_COLLISION_NOT_RESOLVED,
+    MIFARE_CLASSIC_LOG_TEXT_AUTHENTICATION_FAILED,
+    MIFARE_CLASSIC_LOG_TEXT_VALUE_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_BLOCK_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_DATA_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_STATE_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_UID_TOO_LONG,
+    MIFARE_CLASSIC_LOG_TEXT_MAX_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_SECTOR_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_KEY_SET_INVALID,
+    MIFARE_CLASSIC_LOG_TEXT_OPERATION_BUSY,
+    MIFARE_CLASSIC_LOG_TEXT_NO_OPERATION_BUSY,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_INIT_NULL,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_DEINIT_NULL,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_TRANSCEIVER_NULL,
+    MIFARE_CLASSIC_LOG_TEXT_DELAY_MS_NULL,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_SUBMIT_NULL,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_INIT_FAILED,
+    MIFARE_CLASSIC_LOG_TEXT_CONTACTLESS_DEINIT_FAILED
+};
+#endif
+
+/**
+ * @brief log call definition
+ * @note  a call is left out with its string when the log level is lower than the call level,
+ *        the arguments are still cast to void so that every level builds without warnings
+ */
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+    #define MIFARE_CLASSIC_LOG_CALL(handle, event, arg)    a_mifare_classic_log_push((handle), MIFARE_CLASSIC_EVENT_##event, (uint8_t)(arg))
+#else
+    #define MIFARE_CLASSIC_LOG_CALL(handle, event, arg)    (handle)->debug_print(MIFARE_CLASSIC_LOG_TEXT_##event)
+#endif
+#if (MIFARE_CLASSIC_LOG_LEVEL >= MIFARE_CLASSIC_LOG_LEVEL_ERROR)
+    #define MIFARE_CLASSIC_LOG_ERROR(handle, event, arg)    MIFARE_CLASSIC_LOG_CALL(handle, event, arg)
+#else
+    #define MIFARE_CLASSIC_LOG_ERROR(handle, event, arg)    ((void)(handle), (void)(arg))
+#endif
+#if (MIFARE_CLASSIC_LOG_LEVEL >= MIFARE_CLASSIC_LOG_LEVEL_DEBUG)
+    #define MIFARE_CLASSIC_LOG_DEBUG(handle, event, arg)    MIFARE_CLASSIC_LOG_CALL(handle, event, arg)
+#else
+    #define MIFARE_CLASSIC_LOG_DEBUG(handle, event, arg)    ((void)(handle), (void)(arg))
+#endif
+
+#if (MIFARE_CLASSIC_CRC_ENGINE != MIFARE_CLASSIC_CRC_ENGINE_BITWISE)
+/**
+ * @brief crc_a lookup table, reflected polynomial 0x8408
+ */
+static const uint16_t gsc_mifare_classic_crc_table_0[256] =
+{
+    0x0000U, 0x1189U, 0x2312U, 0x329BU, 0x4624U, 0x57ADU, 0x6536U, 0x74BFU,
+    0x8C48U, 0x9DC1U, 0xAF5AU, 0xBED3U, 0xCA6CU, 0xDBE5U, 0xE97EU, 0xF8F7U,
+    0x1081U, 0x0108U, 0x3393U, 0x221AU, 0x56A5U, 0x472CU, 0x75B7U, 0x643EU,
+    0x9CC9U, 0x8D40U, 0xBFDBU, 0xAE52U, 0xDAEDU, 0xCB64U, 0xF9FFU, 0xE876U,
+    0x2102U, 0x308BU, 0x0210U, 0x1399U, 0x6726U, 0x76AFU, 0x4434U, 0x55BDU,
+    0xAD4AU, 0xBCC3U, 0x8E58U, 0x9FD1U, 0xEB6EU, 0xFAE7U, 0xC87CU, 0xD9F5U,
+    0x3183U, 0x200AU, 0x1291U, 0x0318U, 0x77A7U, 0x662EU, 0x54B5U, 0x453CU,
+    0xBDCBU, 0xAC42U, 0x9ED9U, 0x8F50U, 0xFBEFU, 0xEA66U, 0xD8FDU, 0xC974U,
+    0x4204U, 0x538DU, 0x6116U, 0x709FU, 0x0420U, 0x15A9U, 0x2732U, 0x36BBU,
+    0xCE4CU, 0xDFC5U, 0xED5EU, 0xFCD7U, 0x8868U, 0x99E1U, 0xAB7AU, 0xBAF3U,
+    0x5285U, 0x430CU, 0x7197U, 0x601EU, 0x14A1U, 0x0528U, 0x37B3U, 0x263AU,
+    0xDECDU, 0xCF44U, 0xFDDFU, 0xEC56U, 0x98E9U, 0x8960U, 0xBBFBU, 0xAA72U,
+    0x6306U, 0x728FU, 0x4014U, 0x519DU, 0x2522U, 0x34ABU, 0x0630U, 0x17B9U,
+    0xEF4EU, 0xFEC7U, 0xCC5CU, 0xDDD5U, 0xA96AU, 0xB8E3U, 0x8A78U, 0x9BF1U,
+    0x7387U, 0x620EU, 0x5095U, 0x411CU, 0x35A3U, 0x242AU, 0x16B1U, 0x0738U,
+    0xFFCFU, 0xEE46U, 0xDCDDU, 0xCD54U, 0xB9EBU, 0xA862U, 0x9AF9U, 0x8B70U,
+    0x8408U, 0x9581U, 0xA71AU, 0xB693U, 0xC22CU, 0xD3A5U, 0xE13EU, 0xF0B7U,
+    0x0840U, 0x19C9U, 0x2B52U, 0x3ADBU, 0x4E64U, 0x5FEDU, 0x6D76U, 0x7CFFU,
+    0x9489U, 0x8500U, 0xB79BU, 0xA612U, 0xD2ADU, 0xC324U, 0xF1BFU, 0xE036U,
+    0x18C1U, 0x0948U, 0x3BD3U, 0x2A5AU, 0x5EE5U, 0x4F6CU, 0x7DF7U, 0x6C7EU,
+    0xA50AU, 0xB483U, 0x8618U, 0x9791U, 0xE32EU, 0xF2A7U, 0xC03CU, 0xD1B5U,
+    0x2942U, 0x38CBU, 0x0A50U, 0x1BD9U, 0x6F66U, 0x7EEFU, 0x4C74U, 0x5DFDU,
+    0xB58BU, 0xA402U, 0x9699U, 0x8710U, 0xF3AFU, 0xE226U, 0xD0BDU, 0xC134U,
+    0x39C3U, 0x284AU, 0x1AD1U, 0x0B58U, 0x7FE7U, 0x6E6EU, 0x5CF5U, 0x4D7CU,
+    0xC60CU, 0xD785U, 0xE51EU, 0xF497U, 0x8028U, 0x91A1U, 0xA33AU, 0xB2B3U,
+    0x4A44U, 0x5BCDU, 0x6956U, 0x78DFU, 0x0C60U, 0x1DE9U, 0x2F72U, 0x3EFBU,
+    0xD68DU, 0xC704U, 0xF59FU, 0xE416U, 0x90A9U, 0x8120U, 0xB3BBU, 0xA232U,
+    0x5AC5U, 0x4B4CU, 0x79D7U, 0x685EU, 0x1CE1U, 0x0D68U, 0x3FF3U, 0x2E7AU,
+    0xE70EU, 0xF687U, 0xC41CU, 0xD595U, 0xA12AU, 0xB0A3U, 0x8238U, 0x93B1U,
+    0x6B46U, 0x7ACFU, 0x4854U, 0x59DDU, 0x2D62U, 0x3CEBU, 0x0E70U, 0x1FF9U,
+    0xF78FU, 0xE606U, 0xD49DU, 0xC514U, 0xB1ABU, 0xA022U, 0x92B9U, 0x8330U,
+    0x7BC7U, 0x6A4EU, 0x58D5U, 0x495CU, 0x3DE3U, 0x2C6AU, 0x1EF1U, 0x0F78U
+};
+#endif
+
+#if (MIFARE_CLASSIC_CRC_ENGINE == MIFARE_CLASSIC_CRC_ENGINE_SLICING_BY_4)
+/**
+ * @brief crc_a slicing by 4 lookup tables, table_n[i] = (table_n-1[i] >> 8) ^ table_0[table_n-1[i] & 0xFF]
+ */
+static const uint16_t gsc_mifare_classic_crc_table_1[256] =
+{
+    0x0000U, 0x19D8U, 0x33B0U, 0x2A68U, 0x6760U, 0x7EB8U, 0x54D0U, 0x4D08U,
+    0xCEC0U, 0xD718U, 0xFD70U, 0xE4A8U, 0xA9A0U, 0xB078U, 0x9A10U, 0x83C8U,
+    0x9591U, 0x8C49U, 0xA621U, 0xBFF9U, 0xF2F1U, 0xEB29U, 0xC141U, 0xD899U,
+    0x5B51U, 0x4289U, 0x68E1U, 0x7139U, 0x3C31U, 0x25E9U, 0x0F81U, 0x1659U,
+    0x2333U, 0x3AEBU, 0x1083U, 0x095BU, 0x4453U, 0x5D8BU, 0x77E3U, 0x6E3BU,
+    0xEDF3U, 0xF42BU, 0xDE43U, 0xC79BU, 0x8A93U, 0x934BU, 0xB923U, 0xA0FBU,
+    0xB6A2U, 0xAF7AU, 0x8512U, 0x9CCAU, 0xD1C2U, 0xC81AU, 0xE272U, 0xFBAAU,
+    0x7862U, 0x61BAU, 0x4BD2U, 0x520AU, 0x1F02U, 0x06DAU, 0x2CB2U, 0x356AU,
+    0x4666U, 0x5FBEU, 0x75D6U, 0x6C0EU, 0x2106U, 0x38DEU, 0x12B6U, 0x0B6EU,
+    0x88A6U, 0x917EU, 0xBB16U, 0xA2CEU, 0xEFC6U, 0xF61EU, 0xDC76U, 0xC5AEU,
+    0xD3F7U, 0xCA2FU, 0xE047U, 0xF99FU, 0xB497U, 0xAD4FU, 0x8727U, 0x9EFFU,
+    0x1D37U, 0x04EFU, 0x2E87U, 0x375FU, 0x7A57U, 0x638FU, 0x49E7U, 0x503FU,
+    0x6555U, 0x7C8DU, 0x56E5U, 0x4F3DU, 0x0235U, 0x1BEDU, 0x3185U, 0x285DU,
+    0xAB95U, 0xB24DU, 0x9825U, 0x81FDU, 0xCCF5U, 0xD52DU, 0xFF45U, 0xE69DU,
+    0xF0C4U, 0xE91CU, 0xC374U, 0xDAACU, 0x97A4U, 0x8E7CU, 0xA414U, 0xBDCCU,
+    0x3E04U, 0x27DCU, 0x0DB4U, 0x146CU, 0x5964U, 0x40BCU, 0x6AD4U, 0x730CU,
+    0x8CCCU, 0x9514U, 0xBF7CU, 0xA6A4U, 0xEBACU, 0xF274U, 0xD81CU, 0xC1C4U,
+    0x420CU, 0x5BD4U, 0x71BCU, 0x6864U, 0x256CU, 0x3CB4U, 0x16DCU, 0x0F04U,
+    0x195DU, 0x0085U, 0x2AEDU, 0x3335U, 0x7E3DU, 0x67E5U, 0x4D8DU, 0x5455U,
+    0xD79DU, 0xCE45U, 0xE42DU, 0xFDF5U, 0xB0FDU, 0xA925U, 0x834DU, 0x9A95U,
+    0xAFFFU, 0xB627U, 0x9C4FU, 0x8597U, 0xC89FU, 0xD147U, 0xFB2FU, 0xE2F7U,
+    0x613FU, 0x78E7U, 0x528FU, 0x4B57U, 0x065FU, 0x1F87U, 0x35EFU, 0x2C37U,
+    0x3A6EU, 0x23B6U, 0x09DEU, 0x1006U, 0x5D0EU, 0x44D6U, 0x6EBEU, 0x7766U,
+    0xF4AEU, 0xED76U, 0xC71EU, 0xDEC6U, 0x93CEU, 0x8A16U, 0xA07EU, 0xB9A6U,
+    0xCAAAU, 0xD372U, 0xF91AU, 0xE0C2U, 0xADCAU, 0xB412U, 0x9E7AU, 0x87A2U,
+    0x046AU, 0x1DB2U, 0x37DAU, 0x2E02U, 0x630AU, 0x7AD2U, 0x50BAU, 0x4962U,
+    0x5F3BU, 0x46E3U, 0x6C8BU, 0x7553U, 0x385BU, 0x2183U, 0x0BEBU, 0x1233U,
+    0x91FBU, 0x8823U, 0xA24BU, 0xBB93U, 0xF69BU, 0xEF43U, 0xC52BU, 0xDCF3U,
+    0xE999U, 0xF041U, 0xDA29U, 0xC3F1U, 0x8EF9U, 0x9721U, 0xBD49U, 0xA491U,
+    0x2759U, 0x3E81U, 0x14E9U, 0x0D31U, 0x4039U, 0x59E1U, 0x7389U, 0x6A51U,
+    0x7C08U, 0x65D0U, 0x4FB8U, 0x5660U, 0x1B68U, 0x02B0U, 0x28D8U, 0x3100U,
+    0xB2C8U, 0xAB10U, 0x8178U, 0x98A0U, 0xD5A8U, 0xCC70U, 0xE618U, 0xFFC0U
+};
+static const uint16_t gsc_mifare_classic_crc_table_2[256] =
+{
+    0x0000U, 0x5ADCU, 0xB5B8U, 0xEF64U, 0x6361U, 0x39BDU, 0xD6D9U, 0x8C05U,
+    0xC6C2U, 0x9C1EU, 0x737AU, 0x29A6U, 0xA5A3U, 0xFF7FU, 0x101BU, 0x4AC7U,
+    0x8595U, 0xDF49U, 0x302DU, 0x6AF1U, 0xE6F4U, 0xBC28U, 0x534CU, 0x0990U,
+    0x4357U, 0x198BU, 0xF6EFU, 0xAC33U, 0x2036U, 0x7AEAU, 0x958EU, 0xCF52U,
+    0x033BU, 0x59E7U, 0xB683U, 0xEC5FU, 0x605AU, 0x3A86U, 0xD5E2U, 0x8F3EU,
+    0xC5F9U, 0x9F25U, 0x7041U, 0x2A9DU, 0xA698U, 0xFC44U, 0x1320U, 0x49FCU,
+    0x86AEU, 0xDC72U, 0x3316U, 0x69CAU, 0xE5CFU, 0xBF13U, 0x5077U, 0x0AABU,
+    0x406CU, 0x1AB0U, 0xF5D4U, 0xAF08U, 0x230DU, 0x79D1U, 0x96B5U, 0xCC69U,
+    0x0676U, 0x5CAAU, 0xB3CEU, 0xE912U, 0x6517U, 0x3FCBU, 0xD0AFU, 0x8A73U,
+    0xC0B4U, 0x9A68U, 0x750CU, 0x2FD0U, 0xA3D5U, 0xF909U, 0x166DU, 0x4CB1U,
+    0x83E3U, 0xD93FU, 0x365BU, 0x6C87U, 0xE082U, 0xBA5EU, 0x553AU, 0x0FE6U,
+    0x4521U, 0x1FFDU, 0xF099U, 0xAA45U, 0x2640U, 0x7C9CU, 0x93F8U, 0xC924U,
+    0x054DU, 0x5F91U, 0xB0F5U, 0xEA29U, 0x662CU, 0x3CF0U, 0xD394U, 0x8948U,
+    0xC38FU, 0x9953U, 0x7637U, 0x2CEBU, 0xA0EEU, 0xFA32U, 0x1556U, 0x4F8AU,
+    0x80D8U, 0xDA04U, 0x3560U, 0x6FBCU, 0xE3B9U, 0xB965U, 0x5601U, 0x0CDDU,
+    0x461AU, 0x1CC6U, 0xF3A2U, 0xA97EU, 0x257BU, 0x7FA7U, 0x90C3U, 0xCA1FU,
+    0x0CECU, 0x5630U, 0xB954U, 0xE388U, 0x6F8DU, 0x3551U, 0xDA35U, 0x80E9U,
+    0xCA2EU, 0x90F2U, 0x7F96U, 0x254AU, 0xA94FU, 0xF393U, 0x1CF7U, 0x462BU,
+    0x8979U, 0xD3A5U, 0x3CC1U, 0x661DU, 0xEA18U, 0xB0C4U, 0x5FA0U, 0x057CU,
+    0x4FBBU, 0x1567U, 0xFA03U, 0xA0DFU, 0x2CDAU, 0x7606U, 0x9962U, 0xC3BEU,
+    0x0FD7U, 0x550BU, 0xBA6FU, 0xE0B3U, 0x6CB6U, 0x366AU, 0xD90EU, 0x83D2U,
+    0xC915U, 0x93C9U, 0x7CADU, 0x2671U, 0xAA74U, 0xF0A8U, 0x1FCCU, 0x4510U,
+    0x8A42U, 0xD09EU, 0x3FFAU, 0x6526U, 0xE923U, 0xB3FFU, 0x5C9BU, 0x0647U,
+    0x4C80U, 0x165CU, 0xF938U, 0xA3E4U, 0x2FE1U, 0x753DU, 0x9A59U, 0xC085U,
+    0x0A9AU, 0x5046U, 0xBF22U, 0xE5FEU, 0x69FBU, 0x3327U, 0xDC43U, 0x869FU,
+    0xCC58U, 0x9684U, 0x79E0U, 0x233CU, 0xAF39U, 0xF5E5U, 0x1A81U, 0x405DU,
+    0x8F0FU, 0xD5D3U, 0x3AB7U, 0x606BU, 0xEC6EU, 0xB6B2U, 0x59D6U, 0x030AU,
+    0x49CDU, 0x1311U, 0xFC75U, 0xA6A9U, 0x2AACU, 0x7070U, 0x9F14U, 0xC5C8U,
+    0x09A1U, 0x537DU, 0xBC19U, 0xE6C5U, 0x6AC0U, 0x301CU, 0xDF78U, 0x85A4U,
+    0xCF63U, 0x95BFU, 0x7ADBU, 0x2007U, 0xAC02U, 0xF6DEU, 0x19BAU, 0x4366U,
+    0x8C34U, 0xD6E8U, 0x398CU, 0x6350U, 0xEF55U, 0xB589U, 0x5AEDU, 0x0031U,
+    0x4AF6U, 0x102AU, 0xFF4EU, 0xA592U, 0x2997U, 0x734BU, 0x9C2FU, 0xC6F3U
+};
+static const uint16_t gsc_mifare_classic_crc_table_3[256] =
+{
+    0x0000U, 0x1CBBU, 0x3976U, 0x25CDU, 0x72ECU, 0x6E57U, 0x4B9AU, 0x5721U,
+    0xE5D8U, 0xF963U, 0xDCAEU, 0xC015U, 0x9734U, 0x8B8FU, 0xAE42U, 0xB2F9U,
+    0xC3A1U, 0xDF1AU, 0xFAD7U, 0xE66CU, 0xB14DU, 0xADF6U, 0x883BU, 0x9480U,
+    0x2679U, 0x3AC2U, 0x1F0FU, 0x03B4U, 0x5495U, 0x482EU, 0x6DE3U, 0x7158U,
+    0x8F53U, 0x93E8U, 0xB625U, 0xAA9EU, 0xFDBFU, 0xE104U, 0xC4C9U, 0xD872U,
+    0x6A8BU, 0x7630U, 0x53FDU, 0x4F46U, 0x1867U, 0x04DCU, 0x2111U, 0x3DAAU,
+    0x4CF2U, 0x5049U, 0x7584U, 0x693FU, 0x3E1EU, 0x22A5U, 0x0768U, 0x1BD3U,
+    0xA92AU, 0xB591U, 0x905CU, 0x8CE7U, 0xDBC6U, 0xC77DU, 0xE2B0U, 0xFE0BU,
+    0x16B7U, 0x0A0CU, 0x2FC1U, 0x337AU, 0x645BU, 0x78E0U, 0x5D2DU, 0x4196U,
+    0xF36FU, 0xEFD4U, 0xCA19U, 0xD6A2U, 0x8183U, 0x9D38U, 0xB8F5U, 0xA44EU,
+    0xD516U, 0xC9ADU, 0xEC60U, 0xF0DBU, 0xA7FAU, 0xBB41U, 0x9E8CU, 0x8237U,
+    0x30CEU, 0x2C75U, 0x09B8U, 0x1503U, 0x4222U, 0x5E99U, 0x7B54U, 0x67EFU,
+    0x99E4U, 0x855FU, 0xA092U, 0xBC29U, 0xEB08U, 0xF7B3U, 0xD27EU, 0xCEC5U,
+    0x7C3CU, 0x6087U, 0x454AU, 0x59F1U, 0x0ED0U, 0x126BU, 0x37A6U, 0x2B1DU,
+    0x5A45U, 0x46FEU, 0x6333U, 0x7F88U, 0x28A9U, 0x3412U, 0x11DFU, 0x0D64U,
+    0xBF9DU, 0xA326U, 0x86EBU, 0x9A50U, 0xCD71U, 0xD1CAU, 0xF407U, 0xE8BCU,
+    0x2D6EU, 0x31D5U, 0x1418U, 0x08A3U, 0x5F82U, 0x4339U, 0x66F4U, 0x7A4FU,
+    0xC8B6U, 0xD40DU, 0xF1C0U, 0xED7BU, 0xBA5AU, 0xA6E1U, 0x832CU, 0x9F97U,
+    0xEECFU, 0xF274U, 0xD7B9U, 0xCB02U, 0x9C23U, 0x8098U, 0xA555U, 0xB9EEU,
+    0x0B17U, 0x17ACU, 0x3261U, 0x2EDAU, 0x79FBU, 0x6540U, 0x408DU, 0x5C36U,
+    0xA23DU, 0xBE86U, 0x9B4BU, 0x87F0U, 0xD0D1U, 0xCC6AU, 0xE9A7U, 0xF51CU,
+    0x47E5U, 0x5B5EU, 0x7E93U, 0x6228U, 0x3509U, 0x29B2U, 0x0C7FU, 0x10C4U,
+    0x619CU, 0x7D27U, 0x58EAU, 0x4451U, 0x1370U, 0x0FCBU, 0x2A06U, 0x36BDU,
+    0x8444U, 0x98FFU, 0xBD32U, 0xA189U, 0xF6A8U, 0xEA13U, 0xCFDEU, 0xD365U,
+    0x3BD9U, 0x2762U, 0x02AFU, 0x1E14U, 0x4935U, 0x558EU, 0x7043U, 0x6CF8U,
+    0xDE01U, 0xC2BAU, 0xE777U, 0xFBCCU, 0xACEDU, 0xB056U, 0x959BU, 0x8920U,
+    0xF878U, 0xE4C3U, 0xC10EU, 0xDDB5U, 0x8A94U, 0x962FU, 0xB3E2U, 0xAF59U,
+    0x1DA0U, 0x011BU, 0x24D6U, 0x386DU, 0x6F4CU, 0x73F7U, 0x563AU, 0x4A81U,
+    0xB48AU, 0xA831U, 0x8DFCU, 0x9147U, 0xC666U, 0xDADDU, 0xFF10U, 0xE3ABU,
+    0x5152U, 0x4DE9U, 0x6824U, 0x749FU, 0x23BEU, 0x3F05U, 0x1AC8U, 0x0673U,
+    0x772BU, 0x6B90U, 0x4E5DU, 0x52E6U, 0x05C7U, 0x197CU, 0x3CB1U, 0x200AU,
+    0x92F3U, 0x8E48U, 0xAB85U, 0xB73EU, 0xE01FU, 0xFCA4U, 0xD969U, 0xC5D2U
+};
+#endif
+
+#if ((MIFARE_CLASSIC_LOG_DEFERRED != 0) && (MIFARE_CLASSIC_LOG_LEVEL != MIFARE_CLASSIC_LOG_LEVEL_NONE))
+/**
+ * @brief     record a log event
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] event log event
+ * @param[in] arg event argument
+ * @note      only two bytes are stored, the text is looked up when the log is flushed
+ */
+static void a_mifare_classic_log_push(mifare_classic_handle_t *handle, mifare_classic_log_event_t event, uint8_t arg)
+{
+    uint8_t pos;
+    
+    if (handle->log_count == MIFARE_CLASSIC_LOG_DEPTH)                                     /* check the ring */
+    {
+        handle->log_head = (uint8_t)((handle->log_head + 1) % MIFARE_CLASSIC_LOG_DEPTH);   /* drop the oldest event */
+        handle->log_count--;                                                               /* one less event */
+        handle->log_dropped++;                                                             /* dropped counter */
+    }
+    pos = (uint8_t)((handle->log_head + handle->log_count) % MIFARE_CLASSIC_LOG_DEPTH);    /* get the tail */
+    handle->log[pos].event = (uint8_t)event;                                               /* set the event */
+    handle->log[pos].arg = arg;                                                            /* set the argument */
+    handle->log_count++;                                                                   /* one more event */
+}
+#endif
+
+/**
+ * @brief     run the contactless init
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_init(mifare_classic_handle_t *handle)
+{
+    if (handle->contactless_init_ctx != NULL)                        /* check the context variant */
+    {
+        return handle->contactless_init_ctx(handle->context);        /* init with the context */
+    }
+    else
+    {
+        return handle->contactless_init();                           /* init */
+    }
+}
+
+/**
+ * @brief     run the contactless deinit
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 deinit failed
+ * @note      the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_deinit(mifare_classic_handle_t *handle)
+{
+    if (handle->contactless_deinit_ctx != NULL)                        /* check the context variant */
+    {
+        return handle->contactless_deinit_ctx(handle->context);        /* deinit with the context */
+    }
+    else
+    {
+        return handle->contactless_deinit();                           /* deinit */
+    }
+}
+
+/**
+ * @brief         run the contactless transceiver
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 transceiver failed
+ * @note          the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_transceiver(mifare_classic_handle_t *handle, uint8_t *in_buf, uint8_t in_len,
+                                                        uint8_t *out_buf, uint8_t *out_len)
+{
+    if (handle->contactless_transceiver_ctx != NULL)                                                          /* check the context variant */
+    {
+        return handle->contactless_transceiver_ctx(handle->context, in_buf, in_len, out_buf, out_len);        /* transceiver with the context */
+    }
+    else
+    {
+        return handle->contactless_transceiver(in_buf, in_len, out_buf, out_len);                             /* transceiver */
+    }
+}
+
+/**
+ * @brief     run the contactless submit
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *in_buf pointer to an input buffer
+ * @param[in] in_len input length
+ * @param[in] *out_buf pointer to an output buffer
+ * @param[in] out_len output buffer length
+ * @return    status code
+ *            - 0 success
+ *            - 1 submit failed
+ * @note      the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_submit(mifare_classic_handle_t *handle, uint8_t *in_buf, uint8_t in_len,
+                                                   uint8_t *out_buf, uint8_t out_len)
+{
+    if (handle->contactless_submit_ctx != NULL)                                                          /* check the context variant */
+    {
+        return handle->contactless_submit_ctx(handle->context, in_buf, in_len, out_buf, out_len);        /* submit with the context */
+    }
+    else
+    {
+        return handle->contactless_submit(in_buf, in_len, out_buf, out_len);                             /* submit */
+    }
+}
+
+/**
+ * @brief         run the contactless batch
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *frame pointer to a frame array
+ * @param[in]     count frame number
+ * @return        status code
+ *                - 0 success
+ *                - 1 batch failed
+ * @note          the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_batch(mifare_classic_handle_t *handle, mifare_classic_frame_t *frame, uint8_t count)
+{
+    if (handle->contactless_batch_ctx != NULL)                                      /* check the context variant */
+    {
+        return handle->contactless_batch_ctx(handle->context, frame, count);        /* batch with the context */
+    }
+    else
+    {
+        return handle->contactless_batch(frame, count);                             /* batch */
+    }
+}
+
+/**
+ * @brief      run the contactless bit transceiver
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_bits input bit length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[out] *out_bits pointer to a received bit length buffer
+ * @param[out] *collision pointer to a collision position buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 transceiver failed
+ * @note       the context variant is used when it is linked
+ */
+static uint8_t a_mifare_classic_contactless_bit_transceiver(mifare_classic_handle_t *handle, uint8_t *in_buf, uint8_t in_bits,
+                                                            uint8_t *out_buf, uint8_t *out_bits, uint8_t *collision)
+{
+    if (handle->contactless_bit_transceiver_ctx != NULL)                                                  /* check the context variant */
+    {
+        return handle->contactless_bit_transceiver_ctx(handle->context, in_buf, in_bits,
+                                                       out_buf, out_bits, collision);                     /* transceiver with the context */
+    }
+    else
+    {
+        return handle->contactless_bit_transceiver(in_buf, in_bits, out_buf, out_bits, collision);        /* transceiver */
+    }
+}
+
+/**
+ * @brief     run the async callback
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] type operation type
+ * @param[in] res operation result
+ * @note      the context variant is used when it is linked and nothing is run when neither is linked
+ */
+static void a_mifare_classic_async_callback(mifare_classic_handle_t *handle, mifare_classic_operation_type_t type, uint8_t res)
+{
+    if (handle->async_callback_ctx != NULL)                            /* check the context variant */
+    {
+        handle->async_callback_ctx(handle->context, type, res);        /* run the callback with the context */
+    }
+    else if (handle->async_callback != NULL)                           /* check the callback */
+    {
+        handle->async_callback(type, res);                             /* run the callback */
+    }
+}
+
+/**
+ * @brief      crc calculation
+ * @param[in]  *p pointer to a data buffer
+ * @param[in]  len data length
+ * @param[out] *output pointer to an output buffer
+ * @note       the engine is chosen by MIFARE_CLASSIC_CRC_ENGINE at compile time
  */
 static void a_mifare_classic_iso14443a_crc(uint8_t *p, uint8_t len, uint8_t output[2])
 {
+#if (MIFARE_CLASSIC_CRC_ENGINE == MIFARE_CLASSIC_CRC_ENGINE_BITWISE)
     uint32_t w_crc = 0x6363;
     
     do 
@@ -88,1632 +514,4261 @@ static void a_mifare_classic_iso14443a_crc(uint8_t *p, uint8_t len, uint8_t outp
         bt = (bt ^ (bt << 4));                                                                            /* xor */
         w_crc = (w_crc >> 8) ^ ((uint32_t) bt << 8) ^ ((uint32_t) bt << 3) ^ ((uint32_t) bt >> 4);        /* get the crc */
     } while (--len);                                                                                      /* len-- */
+#else
+    uint16_t w_crc = 0x6363;
+    
+#if (MIFARE_CLASSIC_CRC_ENGINE == MIFARE_CLASSIC_CRC_ENGINE_SLICING_BY_4)
+    while (len >= 4)                                                                                      /* 4 bytes per loop */
+    {
+        uint16_t x;
+        
+        x = w_crc ^ (uint16_t)(p[0] | ((uint16_t)p[1] << 8));                                             /* xor the first 2 bytes */
+        w_crc = gsc_mifare_classic_crc_table_3[x & 0xFF] ^ gsc_mifare_classic_crc_table_2[x >> 8] ^
+                gsc_mifare_classic_crc_table_1[p[2]] ^ gsc_mifare_classic_crc_table_0[p[3]];              /* get the crc */
+        p += 4;                                                                                           /* next 4 bytes */
+        len -= 4;                                                                                         /* len -= 4 */
+    }
+#endif
+    while (len != 0)                                                                                      /* 1 byte per loop */
+    {
+        w_crc = (w_crc >> 8) ^ gsc_mifare_classic_crc_table_0[(w_crc ^ *p++) & 0xFF];                     /* get the crc */
+        len--;                                                                                            /* len-- */
+    }
+#endif
 
     output[0] = (uint8_t)(w_crc & 0xFF);                                                                  /* lsb */
     output[1] = (uint8_t)((w_crc >> 8) & 0xFF);                                                           /* msb */
 }
 
 /**
- * @brief     initialize the chip
+ * @brief         append the crc to a frame
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *buf pointer to a frame buffer
+ * @param[in]     len frame length without the crc
+ * @return        frame length to send
+ * @note          the crc is left to the reader when the crc offload is enabled
+ */
+static uint8_t a_mifare_classic_crc_append(mifare_classic_handle_t *handle, uint8_t *buf, uint8_t len)
+{
+    if (handle->crc_offload == MIFARE_CLASSIC_BOOL_TRUE)               /* reader appends the crc */
+    {
+        return len;                                                    /* frame without crc */
+    }
+    a_mifare_classic_iso14443a_crc(buf, len, buf + len);               /* get the crc */
+    
+    return (uint8_t)(len + 2);                                         /* frame with crc */
+}
+
+/**
+ * @brief     get the expected reply length
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] len reply length without the crc
+ * @return    reply length to receive
+ * @note      the reader strips the crc when the crc offload is enabled
+ */
+static uint8_t a_mifare_classic_crc_reply_len(mifare_classic_handle_t *handle, uint8_t len)
+{
+    if (handle->crc_offload == MIFARE_CLASSIC_BOOL_TRUE)               /* reader checks the crc */
+    {
+        return len;                                                    /* reply without crc */
+    }
+    
+    return (uint8_t)(len + 2);                                         /* reply with crc */
+}
+
+/**
+ * @brief     check the crc of a reply
  * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *buf pointer to a reply buffer
+ * @param[in] len reply length without the crc
  * @return    status code
  *            - 0 success
- *            - 1 contactless initialization failed
- *            - 2 handle is NULL
- *            - 3 linked functions is NULL
- * @note      none
+ *            - 1 crc error
+ * @note      the reader has checked the crc when the crc offload is enabled
  */
-uint8_t mifare_classic_init(mifare_classic_handle_t *handle)
+static uint8_t a_mifare_classic_crc_check(mifare_classic_handle_t *handle, uint8_t *buf, uint8_t len)
 {
-    uint8_t res;
+    uint8_t crc_buf[2];
     
-    if (handle == NULL)                                                                   /* check handle */
+    if (handle->crc_offload == MIFARE_CLASSIC_BOOL_TRUE)               /* reader checks the crc */
     {
-        return 2;                                                                         /* return error */
+        return 0;                                                      /* success return 0 */
     }
-    if (handle->debug_print == NULL)                                                      /* check debug_print */
+    a_mifare_classic_iso14443a_crc(buf, len, crc_buf);                 /* get the crc */
+    if ((buf[len] == crc_buf[0]) && (buf[len + 1] == crc_buf[1]))      /* check the crc */
     {
-        return 3;                                                                         /* return error */
+        return 0;                                                      /* success return 0 */
     }
-    if (handle->contactless_init == NULL)                                                 /* check contactless_init */
+#if (MIFARE_CLASSIC_STATS != 0)
+    handle->stats.crc_error++;                                         /* count the crc error */
+#endif
+    
+    return 1;                                                          /* return error */
+}
+
+/**
+ * @brief      initialize an operation
+ * @param[out] *op pointer to an operation structure
+ * @param[in]  type operation type
+ * @param[in]  block block or command argument
+ * @note       none
+ */
+static void a_mifare_classic_operation_init(mifare_classic_operation_t *op, mifare_classic_operation_type_t type, uint8_t block)
+{
+    memset(op, 0, sizeof(mifare_classic_operation_t));        /* clear the operation */
+    op->type = (uint8_t)type;                                 /* set the type */
+    op->block = block;                                        /* set the block */
+}
+
+/**
+ * @brief      encode a value block
+ * @param[in]  value value
+ * @param[in]  addr address
+ * @param[out] *data pointer to a data buffer
+ * @note       none
+ */
+static void a_mifare_classic_value_encode(int32_t value, uint8_t addr, uint8_t data[16])
+{
+    uint32_t v;
+    uint32_t v_r;
+    
+    v = (uint32_t)(value);                          /* convert the value */
+    v_r = (uint32_t)(~value);                       /* revert the value */
+    data[0] = (uint8_t)((v >> 0) & 0xFF);           /* set the value */
+    data[1] = (uint8_t)((v >> 8) & 0xFF);           /* set the value */
+    data[2] = (uint8_t)((v >> 16) & 0xFF);          /* set the value */
+    data[3] = (uint8_t)((v >> 24) & 0xFF);          /* set the value */
+    data[4] = (uint8_t)((v_r >> 0) & 0xFF);         /* set the value */
+    data[5] = (uint8_t)((v_r >> 8) & 0xFF);         /* set the value */
+    data[6] = (uint8_t)((v_r >> 16) & 0xFF);        /* set the value */
+    data[7] = (uint8_t)((v_r >> 24) & 0xFF);        /* set the value */
+    data[8] = (uint8_t)((v >> 0) & 0xFF);           /* set the value */
+    data[9] = (uint8_t)((v >> 8) & 0xFF);           /* set the value */
+    data[10] = (uint8_t)((v >> 16) & 0xFF);         /* set the value */
+    data[11] = (uint8_t)((v >> 24) & 0xFF);         /* set the value */
+    data[12] = addr;                                /* set the address */
+    data[13] = (uint8_t)(~addr);                    /* set the address */
+    data[14] = addr;                                /* set the address */
+    data[15] = (uint8_t)(~addr);                    /* set the address */
+}
+
+/**
+ * @brief      encode a sector trailer
+ * @param[in]  *key_a pointer to a key a buffer
+ * @param[in]  block_0_0_4 block0(block0-4) permission
+ * @param[in]  block_1_5_9 block1(block5-9) permission
+ * @param[in]  block_2_10_14 block2(block10-14) permission
+ * @param[in]  block_3_15 is block3(block15) permission
+ * @param[in]  user_data user data
+ * @param[in]  *key_b pointer to a key b buffer
+ * @param[out] *data pointer to a data buffer
+ * @note       none
+ */
+static void a_mifare_classic_trailer_encode(uint8_t key_a[6], uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                            uint8_t block_2_10_14, uint8_t block_3_15,
+                                            uint8_t user_data, uint8_t key_b[6], uint8_t data[16])
+{
+    uint8_t i;
+    uint8_t part_1, part_2, part_3;
+    uint8_t access_bits[4];
+    
+    part_1 = (((block_3_15 >> 2) & 0x1) << 3) | (((block_2_10_14 >> 2) & 0x1) << 2) |
+             (((block_1_5_9 >> 2) & 0x1) << 1) | (((block_0_0_4 >> 2) & 0x1) << 0);        /* set part 1 */
+    part_2 = (((block_3_15 >> 1) & 0x1) << 3) | (((block_2_10_14 >> 1) & 0x1) << 2) |
+             (((block_1_5_9 >> 1) & 0x1) << 1) | (((block_0_0_4 >> 1) & 0x1) << 0);        /* set part 2 */
+    part_3 = (((block_3_15 >> 0) & 0x1) << 3) | (((block_2_10_14 >> 0) & 0x1) << 2) |
+             (((block_1_5_9 >> 0) & 0x1) << 1) | (((block_0_0_4 >> 0) & 0x1) << 0);        /* set part 3 */
+    access_bits[0] = ((0xF - part_2) << 4) | ((0xF - part_1) << 0);                        /* set the access bits */
+    access_bits[1] = ((part_1 & 0xF) << 4) | ((0xF - part_3) << 0);                        /* set the access bits */
+    access_bits[2] = ((part_3 & 0xF) << 4) | ((part_2 & 0xF) << 0);                        /* set the access bits */
+    access_bits[3] = user_data;                                                            /* set the user data */
+    for (i = 0; i < 6; i++)                                                                /* 6 times */
     {
-        handle->debug_print("mifare_classic: contactless_init is null.\n");               /* contactless_init is null */
-        
-        return 3;                                                                         /* return error */
+        data[i] = key_a[i];                                                                /* copy the key a */
     }
-    if (handle->contactless_deinit == NULL)                                               /* check contactless_deinit */
+    for (i = 0; i < 4; i++)                                                                /* 4 times */
     {
-        handle->debug_print("mifare_classic: contactless_deinit is null.\n");             /* contactless_deinit is null */
-        
-        return 3;                                                                         /* return error */
+        data[i + 6] = access_bits[i];                                                      /* copy the access bits */
     }
-    if (handle->contactless_transceiver == NULL)                                          /* check contactless_transceiver */
+    for (i = 0; i < 6; i++)                                                                /* 6 times */
     {
-        handle->debug_print("mifare_classic: contactless_transceiver is null.\n");        /* contactless_transceiver is null */
-        
-        return 3;                                                                         /* return error */
+        data[i + 10] = key_b[i];                                                           /* copy the key b */
+    }
+}
+
+/**
+ * @brief     get the sector of a block
+ * @param[in] block block number
+ * @return    sector number
+ * @note      none
+ */
+static uint8_t a_mifare_classic_sector(uint8_t block)
+{
+    if (block < 32 * 4)                                          /* check the size */
+    {
+        return block / 4;                                        /* s50 */
+    }
+    else
+    {
+        return (uint8_t)(32 + ((block - (32 * 4)) / 16));        /* s70 */
     }
-    if (handle->delay_ms == NULL)                                                         /* check delay_ms */
+}
+
+/**
+ * @brief     get the first block of a sector
+ * @param[in] sector sector number
+ * @return    first block number
+ * @note      none
+ */
+static uint8_t a_mifare_classic_sector_first_block(uint8_t sector)
+{
+    if (sector < 32)                                             /* check the size */
+    {
+        return (uint8_t)(sector * 4);                            /* s50 */
+    }
+    else
+    {
+        return (uint8_t)(32 * 4 + (sector - 32) * 16);           /* s70 */
+    }
+}
+
+/**
+ * @brief     get the block count of a sector
+ * @param[in] sector sector number
+ * @return    block count
+ * @note      none
+ */
+static uint8_t a_mifare_classic_sector_block_count(uint8_t sector)
+{
+    return (sector < 32) ? 4 : 16;                               /* 4 blocks or 16 blocks */
+}
+
+/**
+ * @brief     get the trailer block of a sector
+ * @param[in] sector sector number
+ * @return    trailer block number
+ * @note      none
+ */
+static uint8_t a_mifare_classic_trailer_block(uint8_t sector)
+{
+    return (uint8_t)(a_mifare_classic_sector_first_block(sector) +
+                     a_mifare_classic_sector_block_count(sector) - 1);        /* get the last block */
+}
+
+/**
+ * @brief     check a sector against the card type
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] sector sector number
+ * @return    status code
+ *            - 0 sector is valid
+ *            - 1 sector is invalid
+ * @note      s50 has 16 sectors and s70 has 40 sectors, an unknown type allows all 40 sectors
+ */
+static uint8_t a_mifare_classic_sector_check(mifare_classic_handle_t *handle, uint8_t sector)
+{
+    if (sector > 39)                                                                  /* check the sector */
     {
-        handle->debug_print("mifare_classic: delay_ms is null.\n");                       /* delay_ms is null */
+        MIFARE_CLASSIC_LOG_ERROR(handle, SECTOR_INVALID, sector);                     /* sector is invalid */
         
-        return 3;                                                                         /* return error */
+        return 1;                                                                     /* return error */
     }
-    
-    res = handle->contactless_init();                                                     /* contactless init */
-    if (res != 0)                                                                         /* check the result */
+    if ((handle->type == MIFARE_CLASSIC_TYPE_S50) && (sector > 15))                   /* check the s50 sector */
     {
-        handle->debug_print("mifare_classic: contactless init failed.\n");                /* contactless init failed */
+        MIFARE_CLASSIC_LOG_ERROR(handle, SECTOR_INVALID, sector);                     /* sector is invalid */
         
-        return 1;                                                                         /* return error */
+        return 1;                                                                     /* return error */
     }
-    handle->type = MIFARE_CLASSIC_TYPE_INVALID;                                           /* set the invalid type */
-    handle->inited = 1;                                                                   /* flag inited */
     
-    return 0;                                                                             /* success return 0 */
+    return 0;                                                                         /* success return 0 */
 }
 
 /**
- * @brief     close the chip
+ * @brief     compare two blocks
+ * @param[in] *a pointer to a block buffer
+ * @param[in] *b pointer to a block buffer
+ * @return    1 if the blocks are equal, 0 if not
+ * @note      it compares four 32 bits words
+ */
+static uint8_t a_mifare_classic_block_equal(const uint8_t *a, const uint8_t *b)
+{
+    uint32_t wa[4];
+    uint32_t wb[4];
+    
+    memcpy(wa, a, 16);                                                  /* copy to aligned words */
+    memcpy(wb, b, 16);                                                  /* copy to aligned words */
+    
+    return (((wa[0] ^ wb[0]) | (wa[1] ^ wb[1]) |
+             (wa[2] ^ wb[2]) | (wa[3] ^ wb[3])) == 0) ? 1 : 0;          /* xor all words */
+}
+
+/**
+ * @brief         open a sector with a key set
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in]     *id pointer to an id buffer
+ * @param[in]     block first block of the sector
+ * @param[in]     *key pointer to a key set
+ * @param[in]     key_count key set length
+ * @param[in,out] *last_key pointer to a last working key index buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 no key works
+ *                - 2 card is lost
+ * @note          the last working key is tried first and the card is reselected after each failed key
+ */
+static uint8_t a_mifare_classic_sector_open(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t block,
+                                            mifare_classic_key_t *key, uint8_t key_count, uint8_t *last_key)
+{
+    uint8_t i;
+    uint8_t k;
+    
+    for (i = 0; i < key_count; i++)                                          /* try the keys */
+    {
+        k = (uint8_t)((*last_key + i) % key_count);                          /* last working key first */
+        if (mifare_classic_authentication(handle, id, block,
+                                          (mifare_classic_authentication_key_t)key[k].key_type,
+                                          key[k].key) == 0)                  /* authentication */
+        {
+            *last_key = k;                                                   /* save the key */
+            
+            return 0;                                                        /* success return 0 */
+        }
+        if (mifare_classic_reselect(handle, id) != 0)                        /* the card is idle now */
+        {
+            return 2;                                                        /* return error */
+        }
+    }
+    
+    return 1;                                                                /* return error */
+}
+
+/**
+ * @brief         build the frame of the current phase
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *op pointer to an operation structure
+ * @note          it sets in_buf, in_len and the expected out_len
+ */
+static void a_mifare_classic_operation_frame(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t i;
+    
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_OPERATION_REQUEST :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_REQUEST;                                /* set the command */
+            op->in_len = 1;                                                                /* set the input length */
+            op->out_len = 2;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_WAKE_UP :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_WAKE_UP;                                /* set the command */
+            op->in_len = 1;                                                                /* set the input length */
+            op->out_len = 2;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_HALT :
+        {
+            op->in_buf[0] = (MIFARE_CLASSIC_COMMAND_HALT >> 8) & 0xFF;                     /* set the command */
+            op->in_buf[1] = (MIFARE_CLASSIC_COMMAND_HALT >> 0) & 0xFF;                     /* set the command */
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);               /* append the crc */
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_SET_MODULATION :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_SET_MOD_TYPE;                           /* set the command */
+            op->in_buf[1] = op->block;                                                     /* set the mod */
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);               /* append the crc */
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_PERSONALIZE_UID_USAGE;                  /* set the command */
+            op->in_buf[1] = op->block;                                                     /* set the type */
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);               /* append the crc */
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1 :
+        {
+            op->in_buf[0] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL1 >> 8) & 0xFF;        /* set the command */
+            op->in_buf[1] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL1 >> 0) & 0xFF;        /* set the command */
+            op->in_len = 2;                                                                /* set the input length */
+            op->out_len = 5;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2 :
+        {
+            op->in_buf[0] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL2 >> 8) & 0xFF;        /* set the command */
+            op->in_buf[1] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL2 >> 0) & 0xFF;        /* set the command */
+            op->in_len = 2;                                                                /* set the input length */
+            op->out_len = 5;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL2 :
+        {
+            if (op->type == MIFARE_CLASSIC_OPERATION_SELECT_CL1)                           /* cl1 */
+            {
+                op->in_buf[0] = (MIFARE_CLASSIC_COMMAND_SELECT_CL1 >> 8) & 0xFF;           /* set the command */
+                op->in_buf[1] = (MIFARE_CLASSIC_COMMAND_SELECT_CL1 >> 0) & 0xFF;           /* set the command */
+            }
+            else                                                                           /* cl2 */
+            {
+                op->in_buf[0] = (MIFARE_CLASSIC_COMMAND_SELECT_CL2 >> 8) & 0xFF;           /* set the command */
+                op->in_buf[1] = (MIFARE_CLASSIC_COMMAND_SELECT_CL2 >> 0) & 0xFF;           /* set the command */
+            }
+            op->in_buf[6] = 0;                                                             /* init 0 */
+            for (i = 0; i < 4; i++)                                                        /* run 4 times */
+            {
+                op->in_buf[2 + i] = op->data[i];                                           /* get one id */
+                op->in_buf[6] ^= op->data[i];                                              /* xor */
+            }
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 7);               /* append the crc */
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_AUTHENTICATION :
+        {
+            if (op->arg == MIFARE_CLASSIC_AUTHENTICATION_KEY_A)                            /* key a */
+            {
+                op->in_buf[0] = MIFARE_CLASSIC_COMMAND_AUTHENTICATION_WITH_KEY_A;          /* set the command */
+            }
+            else                                                                           /* key b */
+            {
+                op->in_buf[0] = MIFARE_CLASSIC_COMMAND_AUTHENTICATION_WITH_KEY_B;          /* set the command */
+            }
+            op->in_buf[1] = op->block;                                                     /* set the block */
+            for (i = 0; i < 10; i++)                                                       /* 10 times */
+            {
+                op->in_buf[2 + i] = op->data[i];                                           /* copy the keys and the id */
+            }
+            op->in_len = 12;                                                               /* set the input length */
+            op->out_len = 0;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_READ :
+        case MIFARE_CLASSIC_OPERATION_VALUE_READ :
+        case MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_READ;                            /* set the command */
+            op->in_buf[1] = op->block;                                                     /* set the block */
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);               /* append the crc */
+            op->out_len = a_mifare_classic_crc_reply_len(handle, 16);                      /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_WRITE :
+        case MIFARE_CLASSIC_OPERATION_VALUE_INIT :
+        case MIFARE_CLASSIC_OPERATION_VALUE_WRITE :
+        case MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION :
+        {
+            if (op->phase == 0)                                                            /* command phase */
+            {
+                op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_WRITE;                       /* set the command */
+                op->in_buf[1] = op->block;                                                 /* set the block */
+                op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);           /* append the crc */
+            }
+            else                                                                           /* data phase */
+            {
+                memcpy(op->in_buf, op->data, 16);                                          /* copy data */
+                op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 16);          /* append the crc */
+            }
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_INCREMENT :
+        case MIFARE_CLASSIC_OPERATION_DECREMENT :
+        case MIFARE_CLASSIC_OPERATION_RESTORE :
+        {
+            if (op->phase == 0)                                                            /* command phase */
+            {
+                if (op->type == MIFARE_CLASSIC_OPERATION_INCREMENT)                        /* increment */
+                {
+                    op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_INCREMENT;               /* set the command */
+                }
+                else if (op->type == MIFARE_CLASSIC_OPERATION_DECREMENT)                   /* decrement */
+                {
+                    op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_DECREMENT;               /* set the command */
+                }
+                else                                                                       /* restore */
+                {
+                    op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_RESTORE;                 /* set the command */
+                }
+                op->in_buf[1] = op->block;                                                 /* set the block */
+                op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);           /* append the crc */
+                op->out_len = 1;                                                           /* set the output length */
+            }
+            else                                                                           /* operand phase */
+            {
+                memcpy(op->in_buf, op->data, 4);                                           /* set the data */
+                op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 4);           /* append the crc */
+                op->out_len = 0;                                                           /* set the output length */
+            }
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_TRANSFER :
+        {
+            op->in_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_TRANSFER;                        /* set the command */
+            op->in_buf[1] = op->block;                                                     /* set the block */
+            op->in_len = a_mifare_classic_crc_append(handle, op->in_buf, 2);               /* append the crc */
+            op->out_len = 1;                                                               /* set the output length */
+            
+            break;
+        }
+        default :
+        {
+            op->in_len = 0;                                                                /* nothing to send */
+            op->out_len = 0;                                                               /* nothing to receive */
+            
+            break;
+        }
+    }
+}
+
+/**
+ * @brief     check an ack reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @param[in] res transceiver result
+ * @param[in] check_len check the output length
+ * @param[in] check_invalid check the invalid operation nak
+ * @return    status code
+ *            - 0 success
+ *            - 1 transceiver failed
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ *            - 6 invalid operation
+ * @note      none
+ */
+static uint8_t a_mifare_classic_reply_ack(mifare_classic_handle_t *handle, mifare_classic_operation_t *op,
+                                          uint8_t res, uint8_t check_len, uint8_t check_invalid)
+{
+    if (res != 0)                                                                        /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, op->type);                  /* contactless transceiver failed */
+        
+        return 1;                                                                        /* return error */
+    }
+    if ((check_len != 0) && (op->out_len != 1))                                          /* check the output_len */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, op->type);                  /* output_len is invalid */
+        
+        return 4;                                                                        /* return error */
+    }
+    if ((check_invalid != 0) && (op->out_buf[0] == 0x4))                                 /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, INVALID_OPERATION, op->type);                   /* invalid operation */
+        
+        return 6;                                                                        /* return error */
+    }
+    if (op->out_buf[0] != 0xA)                                                           /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, ACK_ERROR, op->type);                           /* ack error */
+        
+        return 5;                                                                        /* return error */
+    }
+    
+    return 0;                                                                            /* success return 0 */
+}
+
+/**
+ * @brief     check a 16 bytes read reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @param[in] res transceiver result
+ * @return    status code
+ *            - 0 success
+ *            - 1 transceiver failed
+ *            - 4 output_len is invalid
+ *            - 5 crc error
+ * @note      none
+ */
+static uint8_t a_mifare_classic_reply_read(mifare_classic_handle_t *handle, mifare_classic_operation_t *op, uint8_t res)
+{
+    if (res != 0)                                                                        /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, op->type);                  /* contactless transceiver failed */
+        
+        return 1;                                                                        /* return error */
+    }
+    if (op->out_len != a_mifare_classic_crc_reply_len(handle, 16))                       /* check the output_len */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, op->type);                  /* output_len is invalid */
+        
+        return 4;                                                                        /* return error */
+    }
+    if (a_mifare_classic_crc_check(handle, op->out_buf, 16) != 0)                        /* check the crc */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, CRC_ERROR, op->type);                           /* crc error */
+        
+        return 5;                                                                        /* return error */
+    }
+    
+    return 0;                                                                            /* success return 0 */
+}
+
+/**
+ * @brief     check a type reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @param[in] res transceiver result
+ * @return    status code
+ *            - 0 success
+ *            - 1 transceiver failed
+ *            - 4 output_len is invalid
+ *            - 5 type is invalid
+ * @note      the uid size bits of the atqa are ignored
+ */
+static uint8_t a_mifare_classic_reply_type(mifare_classic_handle_t *handle, mifare_classic_operation_t *op, uint8_t res)
+{
+    mifare_classic_type_t *type;
+    
+    type = (mifare_classic_type_t *)op->output[0];                                       /* get the type buffer */
+    if (res != 0)                                                                        /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, op->type);                  /* contactless transceiver failed */
+        
+        return 1;                                                                        /* return error */
+    }
+    if (op->out_len != 2)                                                                /* check the output_len */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, op->type);                  /* output_len is invalid */
+        
+        return 4;                                                                        /* return error */
+    }
+    if (((op->out_buf[0] & 0x3F) == 0x04) && (op->out_buf[1] == 0x00))                   /* check classic type */
+    {
+        *type = MIFARE_CLASSIC_TYPE_S50;                                                 /* s50 */
+        handle->type = *type;                                                            /* save the type */
+        
+        return 0;                                                                        /* success return 0 */
+    }
+    else if (((op->out_buf[0] & 0x3F) == 0x02) && (op->out_buf[1] == 0x00))              /* check classic type */
+    {
+        *type = MIFARE_CLASSIC_TYPE_S70;                                                 /* s70 */
+        handle->type = *type;                                                            /* save the type */
+        
+        return 0;                                                                        /* success return 0 */
+    }
+    else
+    {
+        *type = MIFARE_CLASSIC_TYPE_INVALID;                                             /* invalid */
+        handle->type = *type;                                                            /* save the type */
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TYPE_INVALID, op->type);                        /* type is invalid */
+        
+        return 5;                                                                        /* return error */
+    }
+}
+
+/**
+ * @brief     check an anti collision reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @param[in] res transceiver result
+ * @return    status code
+ *            - 0 success
+ *            - 1 transceiver failed
+ *            - 4 output_len is invalid
+ *            - 5 check error
+ * @note      none
+ */
+static uint8_t a_mifare_classic_reply_uid(mifare_classic_handle_t *handle, mifare_classic_operation_t *op, uint8_t res)
+{
+    uint8_t i;
+    uint8_t check;
+    uint8_t *id;
+    
+    id = (uint8_t *)op->output[0];                                                       /* get the id buffer */
+    if (res != 0)                                                                        /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, op->type);                  /* contactless transceiver failed */
+        
+        return 1;                                                                        /* return error */
+    }
+    if (op->out_len != 5)                                                                /* check the output_len */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, op->type);                  /* output_len is invalid */
+        
+        return 4;                                                                        /* return error */
+    }
+    check = 0;                                                                           /* init 0 */
+    for (i = 0; i < 4; i++)                                                              /* run 4 times */
+    {
+        id[i] = op->out_buf[i];                                                          /* get one id */
+        check ^= op->out_buf[i];                                                         /* xor */
+    }
+    if (check != op->out_buf[4])                                                         /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, CHECK_ERROR, op->type);                         /* check error */
+        
+        return 5;                                                                        /* return error */
+    }
+    
+    return 0;                                                                            /* success return 0 */
+}
+
+/**
+ * @brief     check a select reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @param[in] res transceiver result
+ * @return    status code
+ *            - 0 success
+ *            - 1 transceiver failed
+ *            - 4 output_len is invalid
+ *            - 5 sak error
+ * @note      the cascade bit is accepted when arg is set
+ */
+static uint8_t a_mifare_classic_reply_sak(mifare_classic_handle_t *handle, mifare_classic_operation_t *op, uint8_t res)
+{
+    if (res != 0)                                                                        /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, op->type);                  /* contactless transceiver failed */
+        
+        return 1;                                                                        /* return error */
+    }
+    if (op->out_len != 1)                                                                /* check the output_len */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, op->type);                  /* output_len is invalid */
+        
+        return 4;                                                                        /* return error */
+    }
+    if (op->output[0] != NULL)                                                           /* check the sak buffer */
+    {
+        *((uint8_t *)op->output[0]) = op->out_buf[0];                                    /* save the sak */
+    }
+    if ((op->out_buf[0] == 0x08) || (op->out_buf[0] == 0x18))                            /* check the sak */
+    {
+        return 0;                                                                        /* success return 0 */
+    }
+    else if ((op->arg != 0) && ((op->out_buf[0] & 0x04) != 0))                           /* uid is not complete */
+    {
+        return 0;                                                                        /* success return 0 */
+    }
+    else
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, SAK_ERROR, op->type);                           /* sak error */
+        
+        return 5;                                                                        /* return error */
+    }
+}
+
+/**
+ * @brief     decode a value block reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @return    status code
+ *            - 0 success
+ *            - 6 value is invalid
+ *            - 7 block is invalid
+ * @note      none
+ */
+static uint8_t a_mifare_classic_reply_value(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t *data;
+    uint32_t value_0;
+    uint32_t value_1;
+    uint32_t value_2;
+    uint8_t address_0;
+    uint8_t address_1;
+    uint8_t address_2;
+    uint8_t address_3;
+    
+    data = op->out_buf;                                                       /* get the data */
+    value_0 = ((uint32_t)data[0] << 0) | ((uint32_t)data[1] << 8) | 
+              ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);          /* get the value 0 */
+    value_1 = ((uint32_t)data[4] << 0) | ((uint32_t)data[5] << 8) | 
+              ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);          /* get the value 1 */
+    value_2 = ((uint32_t)data[8] << 0) | ((uint32_t)data[9] << 8) | 
+              ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);        /* get the value 2 */
+    address_0 = data[12];                                                     /* get the address 0 */
+    address_1 = (uint8_t)(~data[13]);                                         /* get the address 1 */
+    address_2 = data[14];                                                     /* get the address 2 */
+    address_3 = (uint8_t)(~data[15]);                                         /* get the address 3 */
+    if ((value_0 != value_2) || (value_0 != (uint32_t)(~value_1)))            /* check the value */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, VALUE_INVALID, op->type);            /* value is invalid */
+        
+        return 6;                                                             /* return error */
+    }
+    if ((address_0 != address_2) ||
+        (address_1 != address_3) ||
+        (address_0 != (uint8_t)(address_1))                                   /* check the address */
+        )
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, BLOCK_INVALID, op->type);            /* block is invalid */
+        
+        return 7;                                                             /* return error */
+    }
+    *((int32_t *)op->output[0]) = (int32_t)(value_0);                         /* set the value */
+    *((uint8_t *)op->output[1]) = address_0;                                  /* set the address */
+    
+    return 0;                                                                 /* success return 0 */
+}
+
+/**
+ * @brief     decode a sector trailer reply
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @return    status code
+ *            - 0 success
+ *            - 6 data is invalid
+ * @note      none
+ */
+static uint8_t a_mifare_classic_reply_permission(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t i;
+    uint8_t part_1;
+    uint8_t part_2;
+    uint8_t part_3;
+    uint8_t part_1_r;
+    uint8_t part_2_r;
+    uint8_t part_3_r;
+    uint8_t *access_bits;
+    uint8_t *key_b;
+    
+    access_bits = &op->out_buf[6];                                        /* get the access bits */
+    part_2_r = (access_bits[0] >> 4) & 0xF;                               /* get the part2 revert */
+    part_1_r = (access_bits[0] >> 0) & 0xF;                               /* get the part1 revert */
+    part_1 = (access_bits[1] >> 4) & 0xF;                                 /* get the part1 */
+    part_3_r = (access_bits[1] >> 0) & 0xF;                               /* get the part3 revert */
+    part_3 = (access_bits[2] >> 4) & 0xF;                                 /* get the part3 */
+    part_2 = (access_bits[2] >> 0) & 0xF;                                 /* get the part2 */
+    key_b = (uint8_t *)op->output[5];                                     /* get the key b buffer */
+    for (i = 0; i < 6; i++)                                               /* 6 times */
+    {
+        key_b[i] = op->out_buf[10 + i];                                   /* copy the key b */
+    }
+    if (((part_1 + part_1_r) != 0xF) ||
+        ((part_2 + part_2_r) != 0xF) ||
+        ((part_3 + part_3_r) != 0xF))                                     /* check the param */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, DATA_INVALID, op->type);         /* data is invalid */
+        
+        return 6;                                                         /* return error */
+    }
+    *((uint8_t *)op->output[0]) = (((part_1 >> 0) & 0x01) << 2) | (((part_2 >> 0) & 0x01) << 1) |
+                                  (((part_3 >> 0) & 0x01) << 0);          /* get the block_0_0_4 */
+    *((uint8_t *)op->output[1]) = (((part_1 >> 1) & 0x01) << 2) | (((part_2 >> 1) & 0x01) << 1) |
+                                  (((part_3 >> 1) & 0x01) << 0);          /* get the block_1_5_9 */
+    *((uint8_t *)op->output[2]) = (((part_1 >> 2) & 0x01) << 2) | (((part_2 >> 2) & 0x01) << 1) |
+                                  (((part_3 >> 2) & 0x01) << 0);          /* get the block_2_10_14 */
+    *((uint8_t *)op->output[3]) = (((part_1 >> 3) & 0x01) << 2) | (((part_2 >> 3) & 0x01) << 1) |
+                                  (((part_3 >> 3) & 0x01) << 0);          /* get the block_3_15 */
+    *((uint8_t *)op->output[4]) = access_bits[3];                         /* get the user data */
+    
+    return 0;                                                             /* success return 0 */
+}
+
+/**
+ * @brief         handle the reply of the current phase
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *op pointer to an operation structure
+ * @param[in]     res transceiver result
+ * @return        1 if the operation is finished and op->res is set, 0 if the next phase must run
+ * @note          none
+ */
+static uint8_t a_mifare_classic_operation_reply(mifare_classic_handle_t *handle, mifare_classic_operation_t *op, uint8_t res)
+{
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_OPERATION_REQUEST :
+        case MIFARE_CLASSIC_OPERATION_WAKE_UP :
+        {
+            op->res = a_mifare_classic_reply_type(handle, op, res);                       /* check the type */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_HALT :
+        {
+            op->res = 0;                                                                  /* the card never answers */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_SET_MODULATION :
+        case MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID :
+        {
+            op->res = a_mifare_classic_reply_ack(handle, op, res, 1, 0);                  /* check the ack */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1 :
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2 :
+        {
+            op->res = a_mifare_classic_reply_uid(handle, op, res);                        /* check the uid */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL2 :
+        {
+            op->res = a_mifare_classic_reply_sak(handle, op, res);                        /* check the sak */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_AUTHENTICATION :
+        {
+            if (res != 0)                                                                 /* check the result */
+            {
+                MIFARE_CLASSIC_LOG_DEBUG(handle, AUTHENTICATION_FAILED, op->type);        /* authentication failed */
+                op->res = 1;                                                              /* set error */
+            }
+            else
+            {
+                op->res = 0;                                                              /* set success */
+            }
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_READ :
+        {
+            op->res = a_mifare_classic_reply_read(handle, op, res);                       /* check the reply */
+            if (op->res == 0)                                                             /* check the result */
+            {
+                memcpy(op->output[0], op->out_buf, 16);                                   /* copy the data */
+            }
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_VALUE_READ :
+        {
+            op->res = a_mifare_classic_reply_read(handle, op, res);                       /* check the reply */
+            if (op->res == 0)                                                             /* check the result */
+            {
+                op->res = a_mifare_classic_reply_value(handle, op);                       /* decode the value */
+            }
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION :
+        {
+            op->res = a_mifare_classic_reply_read(handle, op, res);                       /* check the reply */
+            if (op->res == 0)                                                             /* check the result */
+            {
+                op->res = a_mifare_classic_reply_permission(handle, op);                  /* decode the permission */
+            }
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_WRITE :
+        case MIFARE_CLASSIC_OPERATION_VALUE_INIT :
+        case MIFARE_CLASSIC_OPERATION_VALUE_WRITE :
+        case MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION :
+        {
+            if (op->phase == 0)                                                           /* command phase */
+            {
+                op->res = a_mifare_classic_reply_ack(handle, op, res, 1, 0);              /* check the ack */
+                
+                return (op->res != 0) ? 1 : 0;                                            /* send the data if ok */
+            }
+            op->res = a_mifare_classic_reply_ack(handle, op, res, 0, 0);                  /* check the ack */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_INCREMENT :
+        case MIFARE_CLASSIC_OPERATION_DECREMENT :
+        case MIFARE_CLASSIC_OPERATION_RESTORE :
+        {
+            if (op->phase == 0)                                                           /* command phase */
+            {
+                op->res = a_mifare_classic_reply_ack(handle, op, res, 1, 1);              /* check the ack */
+                
+                return (op->res != 0) ? 1 : 0;                                            /* send the operand if ok */
+            }
+            op->res = 0;                                                                  /* the card never answers */
+            
+            return 1;                                                                     /* finished */
+        }
+        case MIFARE_CLASSIC_OPERATION_TRANSFER :
+        {
+            op->res = a_mifare_classic_reply_ack(handle, op, res, 1, 1);                  /* check the ack */
+            
+            return 1;                                                                     /* finished */
+        }
+        default :
+        {
+            op->res = 1;                                                                  /* unknown operation */
+            
+            return 1;                                                                     /* finished */
+        }
+    }
+}
+
+/**
+ * @brief     update the authentication session after an operation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to a finished operation structure
+ * @note      any error or any operation which resets the card state closes the session
+ */
+static void a_mifare_classic_session_update(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    if (op->res != 0)                                                                       /* check the result */
+    {
+        handle->auth_valid = 0;                                                             /* close the session */
+        if ((op->type != MIFARE_CLASSIC_OPERATION_REQUEST) ||
+            (handle->state != MIFARE_CLASSIC_CARD_STATE_HALT))                              /* a halted card ignores the request */
+        {
+            handle->state = MIFARE_CLASSIC_CARD_STATE_IDLE;                                 /* the card is dropped */
+        }
+        
+        return;
+    }
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_OPERATION_REQUEST :
+        case MIFARE_CLASSIC_OPERATION_WAKE_UP :
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1 :
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2 :
+        {
+            handle->auth_valid = 0;                                                         /* close the session */
+            handle->state = MIFARE_CLASSIC_CARD_STATE_READY;                                /* ready */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_HALT :
+        {
+            handle->auth_valid = 0;                                                         /* close the session */
+            handle->state = MIFARE_CLASSIC_CARD_STATE_HALT;                                 /* halt */
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL2 :
+        {
+            handle->auth_valid = 0;                                                         /* close the session */
+            if ((op->type == MIFARE_CLASSIC_OPERATION_SELECT_CL1) && (op->arg == 0))        /* single size uid select */
+            {
+                memcpy(handle->uid.uid, op->data, 4);                                       /* cache the uid */
+                handle->uid.len = 4;                                                        /* set the length */
+                handle->uid.sak = op->out_buf[0];                                           /* save the sak */
+            }
+            if ((op->arg != 0) && ((op->out_buf[0] & 0x04) != 0))                           /* uid is not complete */
+            {
+                handle->state = MIFARE_CLASSIC_CARD_STATE_READY;                            /* next cascade level */
+            }
+            else
+            {
+                handle->state = MIFARE_CLASSIC_CARD_STATE_ACTIVE;                           /* active */
+            }
+            
+            break;
+        }
+        case MIFARE_CLASSIC_OPERATION_AUTHENTICATION :
+        {
+            handle->auth_sector = a_mifare_classic_sector(op->block);                       /* save the sector */
+            handle->auth_key_type = op->arg;                                                /* save the key type */
+            memcpy(handle->auth_key, &op->data[0], 6);                                      /* save the key */
+            memcpy(handle->auth_id, &op->data[6], 4);                                       /* save the id */
+            handle->auth_valid = 1;                                                         /* open the session */
+            handle->state = MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED;                        /* authenticated */
+            
+            break;
+        }
+        default :
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief     check if an authentication is covered by the open session
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an authentication operation structure
+ * @return    1 if the exchange can be skipped, 0 if it must run
+ * @note      none
+ */
+static uint8_t a_mifare_classic_session_hit(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    if ((handle->auth_cache == 0) || (handle->auth_valid == 0))        /* check the session */
+    {
+        return 0;                                                      /* miss */
+    }
+    if ((handle->auth_sector != a_mifare_classic_sector(op->block)) ||
+        (handle->auth_key_type != op->arg) ||
+        (memcmp(handle->auth_key, &op->data[0], 6) != 0) ||
+        (memcmp(handle->auth_id, &op->data[6], 4) != 0))               /* check the sector, key and id */
+    {
+        return 0;                                                      /* miss */
+    }
+    
+    return 1;                                                          /* hit */
+}
+
+/**
+ * @brief     check an operation against the card state
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *op pointer to an operation structure
+ * @return    status code
+ *            - 0 the operation can run
+ *            - 1 the card can't accept the operation
+ * @note      the request, wake up and halt can always run
+ */
+static uint8_t a_mifare_classic_state_check(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t state;
+    
+    state = handle->state;                                                                       /* get the state */
+    if (state == MIFARE_CLASSIC_CARD_STATE_UNKNOWN)                                              /* nothing is known */
+    {
+        return 0;                                                                                /* run */
+    }
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_OPERATION_REQUEST :
+        case MIFARE_CLASSIC_OPERATION_WAKE_UP :
+        case MIFARE_CLASSIC_OPERATION_HALT :
+        {
+            return 0;                                                                            /* run */
+        }
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1 :
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL2 :
+        {
+            return (state == MIFARE_CLASSIC_CARD_STATE_READY) ? 0 : 1;                           /* only a ready card */
+        }
+        case MIFARE_CLASSIC_OPERATION_AUTHENTICATION :
+        case MIFARE_CLASSIC_OPERATION_SET_MODULATION :
+        case MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID :
+        {
+            return ((state == MIFARE_CLASSIC_CARD_STATE_ACTIVE) ||
+                    (state == MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED)) ? 0 : 1;                 /* only a selected card */
+        }
+        default :
+        {
+            return ((state == MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED) &&
+                    (handle->auth_sector == a_mifare_classic_sector(op->block))) ? 0 : 1;        /* only the authenticated sector */
+        }
+    }
+}
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief     get the statistics command of an operation
+ * @param[in] type operation type
+ * @return    statistics command
+ * @note      none
+ */
+static uint8_t a_mifare_classic_stats_command(uint8_t type)
+{
+    switch (type)
+    {
+        case MIFARE_CLASSIC_OPERATION_REQUEST :
+        case MIFARE_CLASSIC_OPERATION_WAKE_UP :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_REQUEST;               /* request */
+        }
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1 :
+        case MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2 :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_ANTICOLLISION;         /* anti collision */
+        }
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+        case MIFARE_CLASSIC_OPERATION_SELECT_CL2 :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_SELECT;                /* select */
+        }
+        case MIFARE_CLASSIC_OPERATION_AUTHENTICATION :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_AUTHENTICATION;        /* authentication */
+        }
+        case MIFARE_CLASSIC_OPERATION_READ :
+        case MIFARE_CLASSIC_OPERATION_VALUE_READ :
+        case MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_READ;                  /* read */
+        }
+        case MIFARE_CLASSIC_OPERATION_WRITE :
+        case MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_WRITE;                 /* write */
+        }
+        case MIFARE_CLASSIC_OPERATION_VALUE_INIT :
+        case MIFARE_CLASSIC_OPERATION_VALUE_WRITE :
+        case MIFARE_CLASSIC_OPERATION_INCREMENT :
+        case MIFARE_CLASSIC_OPERATION_DECREMENT :
+        case MIFARE_CLASSIC_OPERATION_TRANSFER :
+        case MIFARE_CLASSIC_OPERATION_RESTORE :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_VALUE;                 /* value */
+        }
+        case MIFARE_CLASSIC_OPERATION_HALT :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_HALT;                  /* halt */
+        }
+        default :
+        {
+            return MIFARE_CLASSIC_STATS_COMMAND_OTHER;                 /* other */
+        }
+    }
+}
+
+/**
+ * @brief     get the start time of a command
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    timestamp in us
+ * @note      it is 0 when timestamp_us is not linked
+ */
+static uint32_t a_mifare_classic_stats_timestamp(mifare_classic_handle_t *handle)
+{
+    if (handle->timestamp_us == NULL)        /* check timestamp_us */
+    {
+        return 0;                            /* no timestamp */
+    }
+    
+    return handle->timestamp_us();           /* get the time */
+}
+
+/**
+ * @brief     record a finished command
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] type operation type
+ * @param[in] res command result
+ * @param[in] start start time of the command
+ * @note      the latency is only recorded when timestamp_us is linked
+ */
+static void a_mifare_classic_stats_record(mifare_classic_handle_t *handle, uint8_t type, uint8_t res, uint32_t start)
+{
+    uint8_t bucket;
+    uint32_t latency;
+    mifare_classic_stats_entry_t *entry;
+    
+    entry = &handle->stats.command[a_mifare_classic_stats_command(type)];                                         /* get the entry */
+    entry->count++;                                                                                               /* count the call */
+    if (res != 0)                                                                                                 /* check the result */
+    {
+        entry->failure[(res < MIFARE_CLASSIC_STATS_MAX_RES) ? res : (MIFARE_CLASSIC_STATS_MAX_RES - 1)]++;        /* count the failure */
+    }
+    if (handle->timestamp_us == NULL)                                                                             /* check timestamp_us */
+    {
+        return;                                                                                                   /* no latency */
+    }
+    latency = handle->timestamp_us() - start;                                                                     /* get the latency */
+    if ((entry->timed == 0) || (latency < entry->min_us))                                                         /* check the min */
+    {
+        entry->min_us = latency;                                                                                  /* set the min */
+    }
+    if (latency > entry->max_us)                                                                                  /* check the max */
+    {
+        entry->max_us = latency;                                                                                  /* set the max */
+    }
+    entry->sum_us += latency;                                                                                     /* add the latency */
+    entry->timed++;                                                                                               /* count the timed call */
+    bucket = 0;                                                                                                   /* init 0 */
+    while ((latency != 0) && (bucket < (MIFARE_CLASSIC_STATS_HISTOGRAM - 1)))                                     /* bit length of the latency */
+    {
+        latency >>= 1;                                                                                            /* right shift 1 */
+        bucket++;                                                                                                 /* next bucket */
+    }
+    entry->histogram[bucket]++;                                                                                   /* count in the bucket */
+}
+
+#endif
+
+/**
+ * @brief     get the phase number of an operation
+ * @param[in] *op pointer to an operation structure
+ * @return    phase number
+ * @note      none
+ */
+static uint8_t a_mifare_classic_operation_phases(mifare_classic_operation_t *op)
+{
+    switch (op->type)
+    {
+        case MIFARE_CLASSIC_OPERATION_WRITE :
+        case MIFARE_CLASSIC_OPERATION_VALUE_INIT :
+        case MIFARE_CLASSIC_OPERATION_VALUE_WRITE :
+        case MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION :
+        case MIFARE_CLASSIC_OPERATION_INCREMENT :
+        case MIFARE_CLASSIC_OPERATION_DECREMENT :
+        case MIFARE_CLASSIC_OPERATION_RESTORE :
+        {
+            return 2;        /* command and data */
+        }
+        default :
+        {
+            return 1;        /* one frame */
+        }
+    }
+}
+
+/**
+ * @brief         run all phases of an operation with the batch transceiver
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *op pointer to an operation structure
+ * @return        operation result
+ * @note          the replies are checked in order after the whole chain is finished
+ */
+static uint8_t a_mifare_classic_operation_run_batch(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t i;
+    uint8_t count;
+    uint8_t in_buf[MIFARE_CLASSIC_BATCH_MAX_FRAME][18];
+    uint8_t out_buf[MIFARE_CLASSIC_BATCH_MAX_FRAME][18];
+    mifare_classic_frame_t frame[MIFARE_CLASSIC_BATCH_MAX_FRAME];
+    
+    count = a_mifare_classic_operation_phases(op);                                  /* get the phase number */
+    for (i = 0; i < count; i++)                                                     /* build all frames */
+    {
+        op->phase = i;                                                              /* set the phase */
+        a_mifare_classic_operation_frame(handle, op);                               /* build the frame */
+        memcpy(in_buf[i], op->in_buf, op->in_len);                                  /* copy the frame */
+        frame[i].in_buf = in_buf[i];                                                /* set the input buffer */
+        frame[i].in_len = op->in_len;                                               /* set the input length */
+        frame[i].out_buf = out_buf[i];                                              /* set the output buffer */
+        frame[i].out_len = op->out_len;                                             /* set the output length */
+        frame[i].res = 1;                                                           /* not run */
+    }
+    if (a_mifare_classic_contactless_batch(handle, frame, count) != 0)              /* run the chain */
+    {
+        for (i = 0; i < count; i++)                                                 /* all frames */
+        {
+            frame[i].res = 1;                                                       /* set failed */
+        }
+    }
+    for (i = 0; i < count; i++)                                                     /* check all replies */
+    {
+        op->phase = i;                                                              /* set the phase */
+        op->out_len = frame[i].out_len;                                             /* get the output length */
+        if (op->out_len > 18)                                                       /* check the output length */
+        {
+            op->out_len = 18;                                                       /* limit the length */
+        }
+        memcpy(op->out_buf, out_buf[i], op->out_len);                               /* copy the reply */
+        if (a_mifare_classic_operation_reply(handle, op, frame[i].res) != 0)        /* handle the reply */
+        {
+            break;                                                                  /* finished */
+        }
+    }
+    
+    return op->res;                                                                 /* return the result */
+}
+
+/**
+ * @brief         exchange the frames of an operation with the blocking transceiver
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *op pointer to an operation structure
+ * @return        operation result
+ * @note          multi-phase operations use the batch transceiver when it is linked
+ */
+static uint8_t a_mifare_classic_operation_exchange(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+    uint8_t res;
+    
+    if (a_mifare_classic_state_check(handle, op) != 0)                                                                    /* check the card state */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, STATE_INVALID, op->type);                                                        /* state is invalid */
+        op->res = 1;                                                                                                      /* fail without a frame */
+        
+        return 1;                                                                                                         /* return error */
+    }
+    if (((handle->contactless_batch != NULL) || (handle->contactless_batch_ctx != NULL)) &&
+        (a_mifare_classic_operation_phases(op) > 1))                                                                      /* check the batch transceiver */
+    {
+        res = a_mifare_classic_operation_run_batch(handle, op);                                                           /* run in one submission */
+        a_mifare_classic_session_update(handle, op);                                                                      /* update the session */
+        
+        return res;                                                                                                       /* return the result */
+    }
+    while (1)                                                                                                             /* run all phases */
+    {
+        a_mifare_classic_operation_frame(handle, op);                                                                     /* build the frame */
+        res = a_mifare_classic_contactless_transceiver(handle, op->in_buf, op->in_len, op->out_buf, &op->out_len);        /* transceiver */
+        if (a_mifare_classic_operation_reply(handle, op, res) != 0)                                                       /* handle the reply */
+        {
+            a_mifare_classic_session_update(handle, op);                                                                  /* update the session */
+            
+            return op->res;                                                                                               /* return the result */
+        }
+        op->phase++;                                                                                                      /* next phase */
+    }
+}
+
+/**
+ * @brief         run an operation with the blocking transceiver
+ * @param[in]     *handle pointer to a mifare_classic handle structure
+ * @param[in,out] *op pointer to an operation structure
+ * @return        operation result
+ * @note          the operation is recorded when the instrumentation is built
+ */
+static uint8_t a_mifare_classic_operation_run(mifare_classic_handle_t *handle, mifare_classic_operation_t *op)
+{
+#if (MIFARE_CLASSIC_STATS != 0)
+    uint32_t start;
+    
+    start = a_mifare_classic_stats_timestamp(handle);                       /* get the start time */
+    (void)a_mifare_classic_operation_exchange(handle, op);                  /* run the operation */
+    a_mifare_classic_stats_record(handle, op->type, op->res, start);        /* record the operation */
+    
+    return op->res;                                                         /* return the result */
+#else
+    return a_mifare_classic_operation_exchange(handle, op);                 /* run the operation */
+#endif
+}
+
+/**
+ * @brief     finish the async operation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @note      none
+ */
+static void a_mifare_classic_async_finish(mifare_classic_handle_t *handle)
+{
+    a_mifare_classic_session_update(handle, &handle->async_operation);                         /* update the session */
+#if (MIFARE_CLASSIC_STATS != 0)
+    a_mifare_classic_stats_record(handle, handle->async_operation.type,
+                                  handle->async_operation.res, handle->stats_start_us);        /* record the operation */
+#endif
+    handle->async_status = MIFARE_CLASSIC_ASYNC_STATUS_DONE;                                   /* set done */
+    a_mifare_classic_async_callback(handle, (mifare_classic_operation_type_t)handle->async_operation.type,
+                                    handle->async_operation.res);                              /* run the callback */
+}
+
+/**
+ * @brief     submit the current phase of the async operation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @note      the operation is finished at once if it can't be submitted
+ */
+static void a_mifare_classic_async_submit(mifare_classic_handle_t *handle)
+{
+    mifare_classic_operation_t *op;
+    
+    op = &handle->async_operation;                                                                                     /* get the operation */
+    while (1)                                                                                                          /* until a frame is in flight */
+    {
+        a_mifare_classic_operation_frame(handle, op);                                                                  /* build the frame */
+        if (a_mifare_classic_contactless_submit(handle, op->in_buf, op->in_len, op->out_buf, op->out_len) == 0)        /* submit */
+        {
+            return;                                                                                                    /* wait for the completion */
+        }
+        if (a_mifare_classic_operation_reply(handle, op, 1) != 0)                                                      /* handle as a transceiver failure */
+        {
+            break;                                                                                                     /* finished */
+        }
+        op->phase++;                                                                                                   /* next phase */
+    }
+    a_mifare_classic_async_finish(handle);                                                                             /* finish the operation */
+}
+
+/**
+ * @brief     check the handle before starting an async operation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      none
+ */
+static uint8_t a_mifare_classic_async_check(mifare_classic_handle_t *handle)
+{
+    if (handle == NULL)                                                                          /* check handle */
+    {
+        return 2;                                                                                /* return error */
+    }
+    if (handle->inited != 1)                                                                     /* check handle initialization */
+    {
+        return 3;                                                                                /* return error */
+    }
+    if (handle->async_status == MIFARE_CLASSIC_ASYNC_STATUS_BUSY)                                /* check the status */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, OPERATION_BUSY, 0);                                     /* operation is busy */
+        
+        return 4;                                                                                /* return error */
+    }
+    if ((handle->contactless_submit == NULL) && (handle->contactless_submit_ctx == NULL))        /* check contactless_submit */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_SUBMIT_NULL, 0);                            /* contactless_submit is null */
+        
+        return 5;                                                                                /* return error */
+    }
+    
+    return 0;                                                                                    /* success return 0 */
+}
+
+/**
+ * @brief     start the prepared async operation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+static uint8_t a_mifare_classic_async_start(mifare_classic_handle_t *handle)
+{
+    if (a_mifare_classic_state_check(handle, &handle->async_operation) != 0)                                      /* check the card state */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, STATE_INVALID, handle->async_operation.type);                            /* state is invalid */
+        handle->async_operation.res = 1;                                                                          /* fail without a frame */
+#if (MIFARE_CLASSIC_STATS != 0)
+        a_mifare_classic_stats_record(handle, handle->async_operation.type, 1,
+                                      a_mifare_classic_stats_timestamp(handle));                                  /* record the operation */
+#endif
+        handle->async_status = MIFARE_CLASSIC_ASYNC_STATUS_DONE;                                                  /* set done */
+        a_mifare_classic_async_callback(handle,
+                                        (mifare_classic_operation_type_t)handle->async_operation.type, 1);        /* run the callback */
+        
+        return 0;                                                                                                 /* success return 0 */
+    }
+#if (MIFARE_CLASSIC_STATS != 0)
+    handle->stats_start_us = a_mifare_classic_stats_timestamp(handle);                                            /* get the start time */
+#endif
+    handle->async_status = MIFARE_CLASSIC_ASYNC_STATUS_BUSY;                                                      /* set busy */
+    a_mifare_classic_async_submit(handle);                                                                        /* submit the first phase */
+    
+    return 0;                                                                                                     /* success return 0 */
+}
+
+/**
+ * @brief      run the bit oriented anti collision frames of one cascade level
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sel select code of the cascade level
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision failed
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       a collided bit is resolved as 1 and the card with this bit goes on
+ */
+static uint8_t a_mifare_classic_anticollision_bit_loop(mifare_classic_handle_t *handle, uint8_t sel, uint8_t id[4])
+{
+    uint8_t i;
+    uint8_t loop;
+    uint8_t known;
+    uint8_t pos;
+    uint8_t bits;
+    uint8_t collision;
+    uint8_t check;
+    uint8_t uid[5];
+    uint8_t in_buf[7];
+    uint8_t out_buf[7];
+    
+    if ((handle->state != MIFARE_CLASSIC_CARD_STATE_READY) &&
+        (handle->state != MIFARE_CLASSIC_CARD_STATE_UNKNOWN))                                     /* only a ready card */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, STATE_INVALID, 0);                                       /* state is invalid */
+        
+        return 1;                                                                                 /* return error */
+    }
+    handle->auth_valid = 0;                                                                       /* close the session */
+    handle->state = MIFARE_CLASSIC_CARD_STATE_IDLE;                                               /* dropped until the end */
+    memset(uid, 0, 5);                                                                            /* clear the uid */
+    known = 0;                                                                                    /* no known bit */
+    for (loop = 0; loop < 40; loop++)                                                             /* at least one new bit each loop */
+    {
+        in_buf[0] = sel;                                                                          /* set the select code */
+        in_buf[1] = (uint8_t)((((known / 8) + 2) << 4) | (known % 8));                            /* set the nvb */
+        memcpy(&in_buf[2], uid, (known + 7) / 8);                                                 /* copy the known bits */
+        memset(out_buf, 0, 7);                                                                    /* clear the buffer */
+        bits = 0;                                                                                 /* init 0 */
+        collision = 0;                                                                            /* init 0 */
+        if (a_mifare_classic_contactless_bit_transceiver(handle, in_buf, (uint8_t)(16 + known),
+                                                         out_buf, &bits, &collision) != 0)        /* transceiver data */
+        {
+            MIFARE_CLASSIC_LOG_DEBUG(handle, TRANSCEIVER_FAILED, 0);                              /* contactless transceiver failed */
+            
+            return 1;                                                                             /* return error */
+        }
+        if ((bits == 0) || ((known + bits) > 40))                                                 /* check the bits */
+        {
+            MIFARE_CLASSIC_LOG_DEBUG(handle, OUTPUT_LEN_INVALID, 0);                              /* output_len is invalid */
+            
+            return 4;                                                                             /* return error */
+        }
+        if (collision < bits)                                                                     /* check the collision */
+        {
+            bits = (uint8_t)(collision + 1);                                                      /* keep the bits before the collision */
+        }
+        for (i = 0; i < bits; i++)                                                                /* merge the received bits */
+        {
+            pos = (uint8_t)((known % 8) + i);                                                     /* received bit position */
+            if ((i == collision) || (((out_buf[pos / 8] >> (pos % 8)) & 0x01) != 0))              /* collided bit is 1 */
+            {
+                uid[(known + i) / 8] |= (uint8_t)(1 << ((known + i) % 8));                        /* set the bit */
+            }
+        }
+        known = (uint8_t)(known + bits);                                                          /* add the known bits */
+        if (known == 40)                                                                          /* uid and bcc are known */
+        {
+            break;                                                                                /* break */
+        }
+    }
+    if (known != 40)                                                                              /* check the loop */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, COLLISION_NOT_RESOLVED, 0);                              /* collision is not resolved */
+        
+        return 6;                                                                                 /* return error */
+    }
+    check = 0;                                                                                    /* init 0 */
+    for (i = 0; i < 4; i++)                                                                       /* run 4 times */
+    {
+        check ^= uid[i];                                                                          /* xor */
+    }
+    if (check != uid[4])                                                                          /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, CHECK_ERROR, 0);                                         /* check error */
+        
+        return 5;                                                                                 /* return error */
+    }
+    memcpy(id, uid, 4);                                                                           /* copy the id */
+    handle->state = MIFARE_CLASSIC_CARD_STATE_READY;                                              /* ready */
+    
+    return 0;                                                                                     /* success return 0 */
+}
+
+/**
+ * @brief      run the bit oriented anti collision loop of one cascade level
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sel select code of the cascade level
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision failed
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       the loop is recorded as one anti collision when the instrumentation is built
+ */
+static uint8_t a_mifare_classic_anticollision_bit(mifare_classic_handle_t *handle, uint8_t sel, uint8_t id[4])
+{
+#if (MIFARE_CLASSIC_STATS != 0)
+    uint8_t res;
+    uint32_t start;
+    
+    start = a_mifare_classic_stats_timestamp(handle);                                                     /* get the start time */
+    res = a_mifare_classic_anticollision_bit_loop(handle, sel, id);                                       /* run the loop */
+    a_mifare_classic_stats_record(handle, MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1, res, start);        /* record the loop */
+    
+    return res;                                                                                           /* return the result */
+#else
+    return a_mifare_classic_anticollision_bit_loop(handle, sel, id);                                      /* run the loop */
+#endif
+}
+
+/**
+ * @brief      select one cascade level and get the sak
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  level cascade level
+ * @param[in]  *id pointer to an id buffer
+ * @param[out] *sak pointer to a sak buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 select failed
+ *             - 4 output_len is invalid
+ *             - 5 sak error
+ * @note       the sak with the cascade bit is a success
+ */
+static uint8_t a_mifare_classic_select_level(mifare_classic_handle_t *handle, uint8_t level, uint8_t id[4], uint8_t *sak)
+{
+    mifare_classic_operation_t op;
+    
+    a_mifare_classic_operation_init(&op, (level == 0) ? MIFARE_CLASSIC_OPERATION_SELECT_CL1 :
+                                    MIFARE_CLASSIC_OPERATION_SELECT_CL2, 0);        /* init the operation */
+    memcpy(op.data, id, 4);                                                         /* copy the id */
+    op.arg = 1;                                                                     /* accept the cascade bit */
+    op.output[0] = sak;                                                             /* set the sak buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                             /* run the operation */
+}
+
+/**
+ * @brief     initialize the chip
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless initialization failed
+ *            - 2 handle is NULL
+ *            - 3 linked functions is NULL
+ * @note      none
+ */
+uint8_t mifare_classic_init(mifare_classic_handle_t *handle)
+{
+    uint8_t res;
+    
+    if (handle == NULL)                                                                                    /* check handle */
+    {
+        return 2;                                                                                          /* return error */
+    }
+    if (handle->debug_print == NULL)                                                                       /* check debug_print */
+    {
+        return 3;                                                                                          /* return error */
+    }
+    if ((handle->contactless_init == NULL) && (handle->contactless_init_ctx == NULL))                      /* check contactless_init */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_INIT_NULL, 0);                                        /* contactless_init is null */
+        
+        return 3;                                                                                          /* return error */
+    }
+    if ((handle->contactless_deinit == NULL) && (handle->contactless_deinit_ctx == NULL))                  /* check contactless_deinit */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_DEINIT_NULL, 0);                                      /* contactless_deinit is null */
+        
+        return 3;                                                                                          /* return error */
+    }
+    if ((handle->contactless_transceiver == NULL) && (handle->contactless_transceiver_ctx == NULL))        /* check contactless_transceiver */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_TRANSCEIVER_NULL, 0);                                 /* contactless_transceiver is null */
+        
+        return 3;                                                                                          /* return error */
+    }
+    if (handle->delay_ms == NULL)                                                                          /* check delay_ms */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, DELAY_MS_NULL, 0);                                                /* delay_ms is null */
+        
+        return 3;                                                                                          /* return error */
+    }
+    
+    res = a_mifare_classic_contactless_init(handle);                                                       /* contactless init */
+    if (res != 0)                                                                                          /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_INIT_FAILED, 0);                                      /* contactless init failed */
+        
+        return 1;                                                                                          /* return error */
+    }
+    handle->type = MIFARE_CLASSIC_TYPE_INVALID;                                                            /* set the invalid type */
+    handle->async_status = MIFARE_CLASSIC_ASYNC_STATUS_IDLE;                                               /* set the idle status */
+    handle->auth_valid = 0;                                                                                /* no session */
+    handle->uid.len = 0;                                                                                   /* no selected card */
+    handle->state = MIFARE_CLASSIC_CARD_STATE_IDLE;                                                        /* idle */
+#if (MIFARE_CLASSIC_STATS != 0)
+    memset(&handle->stats, 0, sizeof(mifare_classic_stats_t));                                             /* clear the statistics */
+#endif
+    handle->inited = 1;                                                                                    /* flag inited */
+    
+    return 0;                                                                                              /* success return 0 */
+}
+
+/**
+ * @brief     close the chip
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 contactless deinit failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      none
+ */
+uint8_t mifare_classic_deinit(mifare_classic_handle_t *handle)
+{
+    uint8_t res;
+    
+    if (handle == NULL)                                                        /* check handle */
+    {
+        return 2;                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                   /* check handle initialization */
+    {
+        return 3;                                                              /* return error */
+    }
+    
+    res = a_mifare_classic_contactless_deinit(handle);                         /* contactless deinit */
+    if (res != 0)                                                              /* check the result */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, CONTACTLESS_DEINIT_FAILED, 0);        /* contactless deinit failed */
+        
+        return 1;                                                              /* return error */
+    }
+    handle->inited = 0;                                                        /* flag closed */
+    
+    return 0;                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      mifare request
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 request failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 type is invalid
+ * @note       none
+ */
+uint8_t mifare_classic_request(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                               /* check handle */
+    {
+        return 2;                                                                     /* return error */
+    }
+    if (handle->inited != 1)                                                          /* check handle initialization */
+    {
+        return 3;                                                                     /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_REQUEST, 0);        /* init the operation */
+    op.output[0] = type;                                                              /* set the type buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                               /* run the operation */
+}
+
+/**
+ * @brief      mifare wake up
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 wake up failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 type is invalid
+ * @note       none
+ */
+uint8_t mifare_classic_wake_up(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                               /* check handle */
+    {
+        return 2;                                                                     /* return error */
+    }
+    if (handle->inited != 1)                                                          /* check handle initialization */
+    {
+        return 3;                                                                     /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_WAKE_UP, 0);        /* init the operation */
+    op.output[0] = type;                                                              /* set the type buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                               /* run the operation */
+}
+
+/**
+ * @brief      mifare halt
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 halt failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t mifare_classic_halt(mifare_classic_handle_t *handle)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                            /* check handle */
+    {
+        return 2;                                                                  /* return error */
+    }
+    if (handle->inited != 1)                                                       /* check handle initialization */
+    {
+        return 3;                                                                  /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_HALT, 0);        /* init the operation */
+    
+    return a_mifare_classic_operation_run(handle, &op);                            /* run the operation */
+}
+
+/**
+ * @brief     mifare set the load modulation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] mod load modulation
+ * @return    status code
+ *            - 0 success
+ *            - 1 set modulation failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ * @note      none
+ */
+uint8_t mifare_classic_set_modulation(mifare_classic_handle_t *handle, mifare_classic_load_modulation_t mod)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                                 /* check handle */
+    {
+        return 2;                                                                                       /* return error */
+    }
+    if (handle->inited != 1)                                                                            /* check handle initialization */
+    {
+        return 3;                                                                                       /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_SET_MODULATION, (uint8_t)mod);        /* init the operation */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                                 /* run the operation */
+}
+
+/**
+ * @brief     mifare set the personalized uid
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] type personalized uid type
+ * @return    status code
+ *            - 0 success
+ *            - 1 set personalized uid failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ * @note      none
+ */
+uint8_t mifare_classic_set_personalized_uid(mifare_classic_handle_t *handle, mifare_classic_personalized_uid_t type)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                                        /* check handle */
+    {
+        return 2;                                                                                              /* return error */
+    }
+    if (handle->inited != 1)                                                                                   /* check handle initialization */
+    {
+        return 3;                                                                                              /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID, (uint8_t)type);        /* init the operation */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                                        /* run the operation */
+}
+
+/**
+ * @brief      mifare anti collision cl1
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl1 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ * @note       none
+ */
+uint8_t mifare_classic_anticollision_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                         /* check handle */
+    {
+        return 2;                                                                               /* return error */
+    }
+    if (handle->inited != 1)                                                                    /* check handle initialization */
+    {
+        return 3;                                                                               /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1, 0);        /* init the operation */
+    op.output[0] = id;                                                                          /* set the id buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                         /* run the operation */
+}
+
+/**
+ * @brief      mifare anti collision cl2
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl2 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ * @note       none
+ */
+uint8_t mifare_classic_anticollision_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                         /* check handle */
+    {
+        return 2;                                                                               /* return error */
+    }
+    if (handle->inited != 1)                                                                    /* check handle initialization */
+    {
+        return 3;                                                                               /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2, 0);        /* init the operation */
+    op.output[0] = id;                                                                          /* set the id buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                         /* run the operation */
+}
+
+/**
+ * @brief     mifare select cl1
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 select cl1 failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 sak error
+ * @note      none
+ */
+uint8_t mifare_classic_select_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                  /* check handle */
+    {
+        return 2;                                                                        /* return error */
+    }
+    if (handle->inited != 1)                                                             /* check handle initialization */
+    {
+        return 3;                                                                        /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_SELECT_CL1, 0);        /* init the operation */
+    memcpy(op.data, id, 4);                                                              /* copy the id */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                  /* run the operation */
+}
+
+/**
+ * @brief     mifare select cl2
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 select cl2 failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 sak error
+ * @note      none
+ */
+uint8_t mifare_classic_select_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                  /* check handle */
+    {
+        return 2;                                                                        /* return error */
+    }
+    if (handle->inited != 1)                                                             /* check handle initialization */
+    {
+        return 3;                                                                        /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_SELECT_CL2, 0);        /* init the operation */
+    memcpy(op.data, id, 4);                                                              /* copy the id */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                  /* run the operation */
+}
+
+/**
+ * @brief      mifare bit oriented anti collision cl1
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl1 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       it resolves the collisions of several cards when contactless_bit_transceiver is linked,
+ *             otherwise it is the same as mifare_classic_anticollision_cl1
+ */
+uint8_t mifare_classic_anticollision_bit_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    if (handle == NULL)                                                                                                   /* check handle */
+    {
+        return 2;                                                                                                         /* return error */
+    }
+    if (handle->inited != 1)                                                                                              /* check handle initialization */
+    {
+        return 3;                                                                                                         /* return error */
+    }
+    if ((handle->contactless_bit_transceiver == NULL) && (handle->contactless_bit_transceiver_ctx == NULL))               /* check contactless_bit_transceiver */
+    {
+        return mifare_classic_anticollision_cl1(handle, id);                                                              /* byte oriented anti collision */
+    }
+    
+    return a_mifare_classic_anticollision_bit(handle, (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL1 >> 8) & 0xFF, id);        /* run the loop */
+}
+
+/**
+ * @brief      mifare bit oriented anti collision cl2
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl2 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       it resolves the collisions of several cards when contactless_bit_transceiver is linked,
+ *             otherwise it is the same as mifare_classic_anticollision_cl2
+ */
+uint8_t mifare_classic_anticollision_bit_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    if (handle == NULL)                                                                                                   /* check handle */
+    {
+        return 2;                                                                                                         /* return error */
+    }
+    if (handle->inited != 1)                                                                                              /* check handle initialization */
+    {
+        return 3;                                                                                                         /* return error */
+    }
+    if ((handle->contactless_bit_transceiver == NULL) && (handle->contactless_bit_transceiver_ctx == NULL))               /* check contactless_bit_transceiver */
+    {
+        return mifare_classic_anticollision_cl2(handle, id);                                                              /* byte oriented anti collision */
+    }
+    
+    return a_mifare_classic_anticollision_bit(handle, (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL2 >> 8) & 0xFF, id);        /* run the loop */
+}
+
+/**
+ * @brief      mifare select a card with all cascade levels
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 select failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check or sak error
+ *             - 6 collision is not resolved
+ *             - 7 uid is too long
+ * @note       run it after mifare_classic_request or mifare_classic_wake_up,
+ *             it follows the cascade bit of the sak and reads 4 or 7 bytes uid in one pass,
+ *             the uid is cached for mifare_classic_reselect
+ */
+uint8_t mifare_classic_select(mifare_classic_handle_t *handle, mifare_classic_uid_t *uid)
+{
+    uint8_t res;
+    uint8_t level;
+    uint8_t sak;
+    uint8_t id[4];
+    
+    if (handle == NULL)                                                      /* check handle */
+    {
+        return 2;                                                            /* return error */
+    }
+    if (handle->inited != 1)                                                 /* check handle initialization */
+    {
+        return 3;                                                            /* return error */
+    }
+    
+    uid->len = 0;                                                            /* init 0 */
+    for (level = 0; level < 2; level++)                                      /* cl1 and cl2 */
+    {
+        if (level == 0)                                                      /* cl1 */
+        {
+            res = mifare_classic_anticollision_bit_cl1(handle, id);          /* anti collision cl1 */
+        }
+        else                                                                 /* cl2 */
+        {
+            res = mifare_classic_anticollision_bit_cl2(handle, id);          /* anti collision cl2 */
+        }
+        if (res != 0)                                                        /* check the result */
+        {
+            return res;                                                      /* return error */
+        }
+        res = a_mifare_classic_select_level(handle, level, id, &sak);        /* select the level */
+        if (res != 0)                                                        /* check the result */
+        {
+            return res;                                                      /* return error */
+        }
+        uid->sak = sak;                                                      /* save the sak */
+        if ((sak & 0x04) == 0)                                               /* uid is complete */
+        {
+            memcpy(&uid->uid[uid->len], id, 4);                              /* copy the last part */
+            uid->len = (uint8_t)(uid->len + 4);                              /* add the length */
+            memcpy(&handle->uid, uid, sizeof(mifare_classic_uid_t));         /* cache the uid */
+            
+            return 0;                                                        /* success return 0 */
+        }
+        if (id[0] != MIFARE_CLASSIC_CASCADE_TAG)                             /* check the cascade tag */
+        {
+            MIFARE_CLASSIC_LOG_DEBUG(handle, SAK_ERROR, 0);                  /* sak error */
+            
+            return 5;                                                        /* return error */
+        }
+        memcpy(&uid->uid[uid->len], &id[1], 3);                              /* skip the cascade tag */
+        uid->len = (uint8_t)(uid->len + 3);                                  /* add the length */
+    }
+    MIFARE_CLASSIC_LOG_ERROR(handle, UID_TOO_LONG, 0);                       /* uid is too long */
+    
+    return 7;                                                                /* return error */
+}
+
+/**
+ * @brief      mifare get the authentication id of an uid
+ * @param[in]  *uid pointer to an uid structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 uid length is invalid
+ * @note       a 4 bytes uid is used as it is and a 7 bytes uid uses its last 4 bytes
+ */
+uint8_t mifare_classic_uid_to_id(mifare_classic_uid_t *uid, uint8_t id[4])
+{
+    if ((uid == NULL) || (uid->len < 4) || (uid->len > 10))        /* check the uid */
+    {
+        return 1;                                                  /* return error */
+    }
+    
+    memcpy(id, &uid->uid[uid->len - 4], 4);                        /* copy the last 4 bytes */
+    
+    return 0;                                                      /* success return 0 */
+}
+
+/**
+ * @brief     mifare reselect a known card
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 reselect failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      it runs wake up and select with the cached uid and skips the anti collision,
+ *            id is the authentication id and a cached 7 bytes uid with the same id is selected in both cascade levels
+ */
+uint8_t mifare_classic_reselect(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    uint8_t sak;
+    uint8_t level_id[4];
+    mifare_classic_type_t type;
+    
+    if (handle == NULL)                                                                  /* check handle */
+    {
+        return 2;                                                                        /* return error */
+    }
+    if (handle->inited != 1)                                                             /* check handle initialization */
+    {
+        return 3;                                                                        /* return error */
+    }
+    
+    if (mifare_classic_wake_up(handle, &type) != 0)                                      /* wake up */
+    {
+        return 1;                                                                        /* return error */
+    }
+    if ((handle->uid.len != 7) || (memcmp(&handle->uid.uid[3], id, 4) != 0))             /* single size uid */
+    {
+        if (mifare_classic_select_cl1(handle, id) != 0)                                  /* select */
+        {
+            return 1;                                                                    /* return error */
+        }
+        
+        return 0;                                                                        /* success return 0 */
+    }
+    level_id[0] = MIFARE_CLASSIC_CASCADE_TAG;                                            /* set the cascade tag */
+    memcpy(&level_id[1], handle->uid.uid, 3);                                            /* copy the first part */
+    if (a_mifare_classic_select_level(handle, 0, level_id, &sak) != 0)                   /* select cl1 */
+    {
+        return 1;                                                                        /* return error */
+    }
+    if (a_mifare_classic_select_level(handle, 1, &handle->uid.uid[3], &sak) != 0)        /* select cl2 */
+    {
+        return 1;                                                                        /* return error */
+    }
+    if ((sak & 0x04) != 0)                                                               /* check the sak */
+    {
+        MIFARE_CLASSIC_LOG_DEBUG(handle, SAK_ERROR, 0);                                  /* sak error */
+        
+        return 1;                                                                        /* return error */
+    }
+    
+    return 0;                                                                            /* success return 0 */
+}
+
+/**
+ * @brief      mifare enumerate all cards in the field
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *uid pointer to an uid structure array
+ * @param[in]  max max card number
+ * @param[out] *count pointer to a card number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 max is invalid
+ * @note       each found card is selected and halted, so the next request only wakes the others,
+ *             use mifare_classic_wake_up and the select commands with the saved uid to talk to one card afterwards
+ */
+uint8_t mifare_classic_enumerate(mifare_classic_handle_t *handle, mifare_classic_uid_t *uid, uint8_t max, uint8_t *count)
+{
+    mifare_classic_type_t type;
+    
+    if (handle == NULL)                                                  /* check handle */
+    {
+        return 2;                                                        /* return error */
+    }
+    if (handle->inited != 1)                                             /* check handle initialization */
+    {
+        return 3;                                                        /* return error */
+    }
+    if (max == 0)                                                        /* check the max */
+    {
+        MIFARE_CLASSIC_LOG_ERROR(handle, MAX_INVALID, 0);                /* max is invalid */
+        
+        return 4;                                                        /* return error */
+    }
+    
+    *count = 0;                                                          /* init 0 */
+    while (*count < max)                                                 /* until the field is quiet */
+    {
+        if (mifare_classic_request(handle, &type) != 0)                  /* no idle card answers */
+        {
+            break;                                                       /* break */
+        }
+        if (mifare_classic_select(handle, &uid[*count]) != 0)            /* pick and select one card */
+        {
+            break;                                                       /* break */
+        }
+        (*count)++;                                                      /* save the card */
+        (void)mifare_classic_halt(handle);                               /* halt the card */
+    }
+    
+    return 0;                                                            /* success return 0 */
+}
+
+/**
+ * @brief     mifare authentication
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] block block of authentication
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 authentication failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      none
+ */
+uint8_t mifare_classic_authentication(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t block,
+                                      mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                          /* check handle */
+    {
+        return 2;                                                                                /* return error */
+    }
+    if (handle->inited != 1)                                                                     /* check handle initialization */
+    {
+        return 3;                                                                                /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_AUTHENTICATION, block);        /* init the operation */
+    op.arg = (uint8_t)key_type;                                                                  /* set the key type */
+    memcpy(&op.data[0], key, 6);                                                                 /* copy the keys */
+    memcpy(&op.data[6], id, 4);                                                                  /* copy the id */
+    if (a_mifare_classic_session_hit(handle, &op) != 0)                                          /* check the session */
+    {
+        return 0;                                                                                /* already authenticated */
+    }
+    
+    return a_mifare_classic_operation_run(handle, &op);                                          /* run the operation */
+}
+
+/**
+ * @brief      mifare read
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  block block of read
+ * @param[out] *data pointer to a data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 crc error
+ * @note       none
+ */
+uint8_t mifare_classic_read(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                /* check handle */
+    {
+        return 2;                                                                      /* return error */
+    }
+    if (handle->inited != 1)                                                           /* check handle initialization */
+    {
+        return 3;                                                                      /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_READ, block);        /* init the operation */
+    op.output[0] = data;                                                               /* set the data buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                /* run the operation */
+}
+
+/**
+ * @brief     mifare write
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of write
+ * @param[in] *data pointer to a data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ * @note      none
+ */
+uint8_t mifare_classic_write(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                 /* check handle */
+    {
+        return 2;                                                                       /* return error */
+    }
+    if (handle->inited != 1)                                                            /* check handle initialization */
+    {
+        return 3;                                                                       /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_WRITE, block);        /* init the operation */
+    memcpy(op.data, data, 16);                                                          /* copy the data */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                 /* run the operation */
+}
+
+/**
+ * @brief     mifare init one block as a value block
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value inited value
+ * @param[in] addr address
+ * @return    status code
+ *            - 0 success
+ *            - 1 value init failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ * @note      none
+ */
+uint8_t mifare_classic_value_init(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                      /* check handle */
+    {
+        return 2;                                                                            /* return error */
+    }
+    if (handle->inited != 1)                                                                 /* check handle initialization */
+    {
+        return 3;                                                                            /* return error */
+    }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_VALUE_INIT, block);        /* init the operation */
+    a_mifare_classic_value_encode(value, addr, op.data);                                     /* encode the value */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                      /* run the operation */
+}
+
+/**
+ * @brief     mifare value write
  * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value written value
+ * @param[in] addr address
  * @return    status code
  *            - 0 success
- *            - 1 contactless deinit failed
+ *            - 1 value write failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
  * @note      none
  */
-uint8_t mifare_classic_deinit(mifare_classic_handle_t *handle)
+uint8_t mifare_classic_value_write(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
 {
-    uint8_t res;
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                             /* check handle */
+    if (handle == NULL)                                                                       /* check handle */
     {
-        return 2;                                                                   /* return error */
+        return 2;                                                                             /* return error */
     }
-    if (handle->inited != 1)                                                        /* check handle initialization */
+    if (handle->inited != 1)                                                                  /* check handle initialization */
     {
-        return 3;                                                                   /* return error */
+        return 3;                                                                             /* return error */
     }
     
-    res = handle->contactless_deinit();                                             /* contactless deinit */
-    if (res != 0)                                                                   /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless deinit failed.\n");        /* contactless deinit failed */
-        
-        return 1;                                                                   /* return error */
-    }
-    handle->inited = 0;                                                             /* flag closed */
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_VALUE_WRITE, block);        /* init the operation */
+    a_mifare_classic_value_encode(value, addr, op.data);                                      /* encode the value */
     
-    return 0;                                                                       /* success return 0 */
+    return a_mifare_classic_operation_run(handle, &op);                                       /* run the operation */
 }
 
 /**
- * @brief      mifare request
+ * @brief      mifare value read
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[out] *type pointer to a type buffer
+ * @param[in]  block block of read
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *addr pointer to an address buffer
  * @return     status code
  *             - 0 success
- *             - 1 request failed
+ *             - 1 value read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
  *             - 4 output_len is invalid
- *             - 5 type is invalid
+ *             - 5 crc error
+ *             - 6 value is invalid
+ *             - 7 block is invalid
  * @note       none
  */
-uint8_t mifare_classic_request(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
+uint8_t mifare_classic_value_read(mifare_classic_handle_t *handle, uint8_t block, int32_t *value, uint8_t *addr)
 {
-    uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[1];
-    uint8_t output_len;
-    uint8_t output_buf[2];
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                      /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                            /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                                 /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                            /* return error */
     }
     
-    input_len = 1;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_REQUEST;                                               /* set the command */
-    output_len = 2;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 2)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if ((output_buf[0] == 0x04) && (output_buf[1] == 0x00))                                      /* check classic type */
-    {
-        *type = MIFARE_CLASSIC_TYPE_S50;                                                         /* s50 */
-        handle->type = *type;                                                                    /* save the type */
-        
-        return 0;                                                                                /* success return 0 */
-    }
-    else if ((output_buf[0] == 0x02) && (output_buf[1] == 0x00))                                 /* check classic type */
-    {
-        *type = MIFARE_CLASSIC_TYPE_S70;                                                         /* s70 */
-        handle->type = *type;                                                                    /* save the type */
-        
-        return 0;                                                                                /* success return 0 */
-    }
-    else
-    {
-        *type = MIFARE_CLASSIC_TYPE_INVALID;                                                     /* invalid */
-        handle->type = *type;                                                                    /* save the type */
-        handle->debug_print("mifare_classic: type is invalid.\n");                               /* type is invalid */
-        
-        return 5;                                                                                /* return error */
-    }
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_VALUE_READ, block);        /* init the operation */
+    op.output[0] = value;                                                                    /* set the value buffer */
+    op.output[1] = addr;                                                                     /* set the address buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                      /* run the operation */
 }
 
 /**
- * @brief      mifare wake up
- * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[out] *type pointer to a type buffer
- * @return     status code
- *             - 0 success
- *             - 1 wake up failed
- *             - 2 handle is NULL
- *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 type is invalid
- * @note       none
+ * @brief     mifare increment
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of increment
+ * @param[in] value increment value
+ * @return    status code
+ *            - 0 success
+ *            - 1 increment failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ *            - 6 invalid operation
+ * @note      none
  */
-uint8_t mifare_classic_wake_up(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
+uint8_t mifare_classic_increment(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
 {
-    uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[1];
-    uint8_t output_len;
-    uint8_t output_buf[2];
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                     /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                           /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                                /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                           /* return error */
     }
     
-    input_len = 1;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_WAKE_UP;                                               /* set the command */
-    output_len = 2;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 2)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if ((output_buf[0] == 0x04) && (output_buf[1] == 0x00))                                      /* check classic type */
-    {
-        *type = MIFARE_CLASSIC_TYPE_S50;                                                         /* s50 */
-        handle->type = *type;                                                                    /* save the type */
-        
-        return 0;                                                                                /* success return 0 */
-    }
-    else if ((output_buf[0] == 0x02) && (output_buf[1] == 0x00))                                 /* check classic type */
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_INCREMENT, block);        /* init the operation */
+    op.data[0] = (value >> 0) & 0xFF;                                                       /* set the data */
+    op.data[1] = (value >> 8) & 0xFF;                                                       /* set the data */
+    op.data[2] = (value >> 16) & 0xFF;                                                      /* set the data */
+    op.data[3] = (value >> 24) & 0xFF;                                                      /* set the data */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                     /* run the operation */
+}
+
+/**
+ * @brief     mifare decrement
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of decrement
+ * @param[in] value decrement value
+ * @return    status code
+ *            - 0 success
+ *            - 1 decrement failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ *            - 6 invalid operation
+ * @note      none
+ */
+uint8_t mifare_classic_decrement(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                                     /* check handle */
     {
-        *type = MIFARE_CLASSIC_TYPE_S70;                                                         /* s70 */
-        handle->type = *type;                                                                    /* save the type */
-        
-        return 0;                                                                                /* success return 0 */
+        return 2;                                                                           /* return error */
     }
-    else
+    if (handle->inited != 1)                                                                /* check handle initialization */
     {
-        *type = MIFARE_CLASSIC_TYPE_INVALID;                                                     /* invalid */
-        handle->type = *type;                                                                    /* save the type */
-        handle->debug_print("mifare_classic: type is invalid.\n");                               /* type is invalid */
-        
-        return 5;                                                                                /* return error */
+        return 3;                                                                           /* return error */
     }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_DECREMENT, block);        /* init the operation */
+    op.data[0] = (value >> 0) & 0xFF;                                                       /* set the data */
+    op.data[1] = (value >> 8) & 0xFF;                                                       /* set the data */
+    op.data[2] = (value >> 16) & 0xFF;                                                      /* set the data */
+    op.data[3] = (value >> 24) & 0xFF;                                                      /* set the data */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                     /* run the operation */
 }
 
 /**
- * @brief      mifare halt
- * @param[in]  *handle pointer to a mifare_classic handle structure
- * @return     status code
- *             - 0 success
- *             - 1 halt failed
- *             - 2 handle is NULL
- *             - 3 handle is not initialized
- * @note       none
+ * @brief     mifare transfer
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of transfer
+ * @return    status code
+ *            - 0 success
+ *            - 1 transfer failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 output_len is invalid
+ *            - 5 ack error
+ *            - 6 invalid operation
+ * @note      none
  */
-uint8_t mifare_classic_halt(mifare_classic_handle_t *handle)
+uint8_t mifare_classic_transfer(mifare_classic_handle_t *handle, uint8_t block)
 {
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                    /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                          /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                               /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                          /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = (MIFARE_CLASSIC_COMMAND_HALT >> 8) & 0xFF;                                    /* set the command */
-    input_buf[1] = (MIFARE_CLASSIC_COMMAND_HALT >> 0) & 0xFF;                                    /* set the command */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    (void)handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    
-    return 0;                                                                                    /* success return 0 */
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_TRANSFER, block);        /* init the operation */
     
+    return a_mifare_classic_operation_run(handle, &op);                                    /* run the operation */
 }
 
 /**
- * @brief     mifare set the load modulation
+ * @brief     mifare restore
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] mod load modulation
+ * @param[in] block block of restore
  * @return    status code
  *            - 0 success
- *            - 1 set modulation failed
+ *            - 1 restore failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
  *            - 4 output_len is invalid
  *            - 5 ack error
+ *            - 6 invalid operation
  * @note      none
  */
-uint8_t mifare_classic_set_modulation(mifare_classic_handle_t *handle, mifare_classic_load_modulation_t mod)
+uint8_t mifare_classic_restore(mifare_classic_handle_t *handle, uint8_t block)
 {
-    uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                   /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                         /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                              /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                         /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_SET_MOD_TYPE;                                          /* set the command */
-    input_buf[1] = mod;                                                                          /* set the mod */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_RESTORE, block);        /* init the operation */
+    
+    return a_mifare_classic_operation_run(handle, &op);                                   /* run the operation */
+}
+
+/**
+ * @brief      mifare block number to sector number
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  block block number
+ * @param[out] *sector pointer to a sector number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t mifare_classic_block_to_sector(mifare_classic_handle_t *handle, uint8_t block, uint8_t *sector)
+{
+    if (handle == NULL)                                  /* check handle */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 2;                                        /* return error */
     }
-    if (output_len != 1)                                                                         /* check the output_len */
+    if (handle->inited != 1)                             /* check handle initialization */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        return 3;                                        /* return error */
     }
-    if (output_buf[0] == 0xA)                                                                    /* check the result */
+    
+    *sector = a_mifare_classic_sector(block);            /* get the sector */
+    
+    return 0;                                            /* success return 0 */
+}
+
+/**
+ * @brief      mifare get the sector's block counter
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sector sector number
+ * @param[out] *count pointer to a count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 sector is invalid
+ * @note       none
+ */
+uint8_t mifare_classic_sector_block_count(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *count)
+{
+    if (handle == NULL)                                            /* check handle */
     {
-        return 0;                                                                                /* success return 0 */
+        return 2;                                                  /* return error */
     }
-    else
+    if (handle->inited != 1)                                       /* check handle initialization */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 3;                                                  /* return error */
+    }
+    if (a_mifare_classic_sector_check(handle, sector) != 0)        /* check the sector */
+    {
+        return 4;                                                  /* return error */
     }
     
+    *count = a_mifare_classic_sector_block_count(sector);          /* get the block count */
+    
+    return 0;                                                      /* success return 0 */
 }
 
 /**
- * @brief     mifare set the personalized uid
- * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] type personalized uid type
- * @return    status code
- *            - 0 success
- *            - 1 set personalized uid failed
- *            - 2 handle is NULL
- *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- * @note      none
+ * @brief      mifare get the sector's first block
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sector sector number
+ * @param[out] *block pointer to a block number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 sector is invalid
+ * @note       none
  */
-uint8_t mifare_classic_set_personalized_uid(mifare_classic_handle_t *handle, mifare_classic_personalized_uid_t type)
+uint8_t mifare_classic_sector_first_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block)
 {
-    uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                            /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                  /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                       /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                  /* return error */
     }
-    
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_PERSONALIZE_UID_USAGE;                                          /* set the command */
-    input_buf[1] = type;                                                                          /* set the mod */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (a_mifare_classic_sector_check(handle, sector) != 0)        /* check the sector */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 4;                                                  /* return error */
     }
-    if (output_len != 1)                                                                         /* check the output_len */
+    
+    *block = a_mifare_classic_sector_first_block(sector);          /* get the first block */
+    
+    return 0;                                                      /* success return 0 */
+}
+
+/**
+ * @brief      mifare get the sector's last block
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sector sector number
+ * @param[out] *block pointer to a block number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 sector is invalid
+ * @note       none
+ */
+uint8_t mifare_classic_sector_last_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block)
+{
+    if (handle == NULL)                                            /* check handle */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        return 2;                                                  /* return error */
     }
-    if (output_buf[0] == 0xA)                                                                    /* check the result */
+    if (handle->inited != 1)                                       /* check handle initialization */
     {
-        return 0;                                                                                /* success return 0 */
+        return 3;                                                  /* return error */
     }
-    else
+    if (a_mifare_classic_sector_check(handle, sector) != 0)        /* check the sector */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 4;                                                  /* return error */
     }
     
+    *block = a_mifare_classic_trailer_block(sector);               /* get the last block */
+    
+    return 0;                                                      /* success return 0 */
 }
 
 /**
- * @brief      mifare anti collision cl1
+ * @brief      mifare read all blocks of a sector
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[out] *id pointer to an id buffer
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  sector read sector
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  trailer bool value, read the sector trailer too
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
  * @return     status code
  *             - 0 success
- *             - 1 anti collision cl1 failed
+ *             - 1 read sector failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 check error
- * @note       none
+ *             - 4 sector is invalid
+ * @note       it authenticates once and reads the blocks in order,
+ *             data must hold 16 * 16 bytes for the large sectors of s70
  */
-uint8_t mifare_classic_anticollision_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+uint8_t mifare_classic_read_sector(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t sector,
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                   mifare_classic_bool_t trailer, uint8_t *data, uint8_t *block_count)
 {
     uint8_t res;
     uint8_t i;
-    uint8_t check;
-    uint8_t input_len;
-    uint8_t input_buf[2];
-    uint8_t output_len;
-    uint8_t output_buf[5];
+    uint8_t first;
+    uint8_t count;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                      /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                           /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                      /* return error */
     }
-    
-    input_len = 2;                                                                               /* set the input length */
-    input_buf[0] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL1 >> 8) & 0xFF;                       /* set the command */
-    input_buf[1] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL1 >> 0) & 0xFF;                       /* set the command */
-    output_len = 5;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (a_mifare_classic_sector_check(handle, sector) != 0)                            /* check the sector */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 4;                                                                      /* return error */
     }
-    if (output_len != 5)                                                                         /* check the output_len */
+    
+    first = a_mifare_classic_sector_first_block(sector);                               /* get the first block */
+    count = a_mifare_classic_sector_block_count(sector);                               /* get the block count */
+    if (trailer == MIFARE_CLASSIC_BOOL_FALSE)                                          /* skip the trailer */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        count--;                                                                       /* data blocks only */
     }
-    check = 0;                                                                                   /* init 0 */
-    for (i = 0; i < 4; i++)                                                                      /* run 4 times */
+    *block_count = 0;                                                                  /* init 0 */
+    res = mifare_classic_authentication(handle, id, first, key_type, key);             /* authentication once */
+    if (res != 0)                                                                      /* check the result */
     {
-        id[i] = output_buf[i];                                                                   /* get one id */
-        check ^= output_buf[i];                                                                  /* xor */
+        return 1;                                                                      /* return error */
     }
-    if (check != output_buf[4])                                                                  /* check the result */
+    for (i = 0; i < count; i++)                                                        /* read all blocks */
     {
-        handle->debug_print("mifare_classic: check error.\n");                                   /* check error */
-        
-        return 5;                                                                                /* return error */
+        res = mifare_classic_read(handle, (uint8_t)(first + i), &data[i * 16]);        /* read one block */
+        if (res != 0)                                                                  /* check the result */
+        {
+            return 1;                                                                  /* return error */
+        }
+        (*block_count)++;                                                              /* count the block */
     }
     
-    return 0;                                                                                    /* success return 0 */
+    return 0;                                                                          /* success return 0 */
 }
 
 /**
- * @brief      mifare anti collision cl2
+ * @brief      mifare dump the whole card
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[out] *id pointer to an id buffer
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  *key pointer to a key set
+ * @param[in]  key_count key set length
+ * @param[in]  *callback pointer to a block callback
+ * @param[out] *failed_sector pointer to a failed sector count buffer
  * @return     status code
  *             - 0 success
- *             - 1 anti collision cl2 failed
+ *             - 1 dump failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 check error
- * @note       none
+ *             - 4 type is invalid
+ *             - 5 key set is invalid
+ * @note       the card must be selected and handle->type must be set by request or wake up,
+ *             every block is passed to the callback with res 0 as soon as it is read,
+ *             a failed block is passed with res 1 and data NULL, a sector without any working key
+ *             is passed once with its first block, res 1 and data NULL,
+ *             the key which opened the last sector is tried first
  */
-uint8_t mifare_classic_anticollision_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+uint8_t mifare_classic_dump(mifare_classic_handle_t *handle, uint8_t id[4],
+                            mifare_classic_key_t *key, uint8_t key_count,
+                            void (*callback)(uint8_t sector, uint8_t block, uint8_t res, uint8_t *data),
+                            uint8_t *failed_sector)
 {
     uint8_t res;
-    uint8_t i;
-    uint8_t check;
-    uint8_t input_len;
-    uint8_t input_buf[2];
-    uint8_t output_len;
-    uint8_t output_buf[5];
+    uint8_t j;
+    uint8_t sector;
+    uint8_t sector_count;
+    uint8_t first;
+    uint8_t count;
+    uint8_t last_key;
+    uint8_t data[16];
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                           /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                 /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                      /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                 /* return error */
     }
-    
-    input_len = 2;                                                                               /* set the input length */
-    input_buf[0] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL2 >> 8) & 0xFF;                       /* set the command */
-    input_buf[1] = (MIFARE_CLASSIC_COMMAND_ANTICOLLISION_CL2 >> 0) & 0xFF;                       /* set the command */
-    output_len = 5;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (handle->type == MIFARE_CLASSIC_TYPE_S50)                                  /* s50 */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        sector_count = 16;                                                        /* 16 sectors */
     }
-    if (output_len != 5)                                                                         /* check the output_len */
+    else if (handle->type == MIFARE_CLASSIC_TYPE_S70)                             /* s70 */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        sector_count = 40;                                                        /* 40 sectors */
     }
-    check = 0;                                                                                   /* init 0 */
-    for (i = 0; i < 4; i++)                                                                      /* run 4 times */
+    else
     {
-        id[i] = output_buf[i];                                                                   /* get one id */
-        check ^= output_buf[i];                                                                  /* xor */
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TYPE_INVALID, 0);                        /* type is invalid */
+        
+        return 4;                                                                 /* return error */
     }
-    if (check != output_buf[4])                                                                  /* check the result */
+    if ((key == NULL) || (key_count == 0) || (callback == NULL))                  /* check the key set */
     {
-        handle->debug_print("mifare_classic: check error.\n");                                   /* check error */
+        MIFARE_CLASSIC_LOG_ERROR(handle, KEY_SET_INVALID, 0);                     /* key set is invalid */
         
-        return 5;                                                                                /* return error */
+        return 5;                                                                 /* return error */
     }
     
-    return 0;                                                                                    /* success return 0 */
+    *failed_sector = 0;                                                           /* init 0 */
+    last_key = 0;                                                                 /* start with the first key */
+    for (sector = 0; sector < sector_count; sector++)                             /* all sectors */
+    {
+        first = a_mifare_classic_sector_first_block(sector);                      /* get the first block */
+        count = a_mifare_classic_sector_block_count(sector);                      /* get the block count */
+        res = a_mifare_classic_sector_open(handle, id, first, key,
+                                           key_count, &last_key);                 /* open the sector */
+        if (res == 2)                                                             /* card is lost */
+        {
+            return 1;                                                             /* return error */
+        }
+        if (res != 0)                                                             /* no key works */
+        {
+            (*failed_sector)++;                                                   /* count the sector */
+            callback(sector, first, 1, NULL);                                     /* report the sector */
+            
+            continue;                                                             /* next sector */
+        }
+        for (j = 0; j < count; j++)                                               /* all blocks */
+        {
+            res = mifare_classic_read(handle, (uint8_t)(first + j), data);        /* read one block */
+            if (res == 0)                                                         /* check the result */
+            {
+                callback(sector, (uint8_t)(first + j), 0, data);                  /* stream the block */
+                
+                continue;                                                         /* next block */
+            }
+            callback(sector, (uint8_t)(first + j), 1, NULL);                      /* report the block */
+            res = mifare_classic_reselect(handle, id);                            /* the card is idle now */
+            if (res != 0)                                                         /* check the result */
+            {
+                return 1;                                                         /* return error */
+            }
+            res = mifare_classic_authentication(handle, id, first,
+                                                (mifare_classic_authentication_key_t)key[last_key].key_type,
+                                                key[last_key].key);               /* authentication again */
+            if (res != 0)                                                         /* check the result */
+            {
+                return 1;                                                         /* return error */
+            }
+        }
+    }
+    
+    return 0;                                                                     /* success return 0 */
 }
 
 /**
- * @brief     mifare select cl1
- * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] *id pointer to an id buffer
- * @return    status code
- *            - 0 success
- *            - 1 select cl1 failed
- *            - 2 handle is NULL
- *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 sak error
- * @note      none
+ * @brief      mifare write the changed blocks of an image
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  *key pointer to a key set
+ * @param[in]  key_count key set length
+ * @param[in]  block first block of the image
+ * @param[in]  block_count block number of the image
+ * @param[in]  *image pointer to a target image buffer
+ * @param[in]  *last_image pointer to a last known card image buffer
+ * @param[out] *outcome pointer to a per block outcome buffer
+ * @param[out] *written pointer to a written block count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 update failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 type is invalid
+ *             - 5 key set is invalid
+ *             - 6 block is invalid
+ * @note       the card must be selected and handle->type must be set by request or wake up,
+ *             image and last_image hold block_count * 16 bytes and last_image can be NULL to write all blocks,
+ *             only the blocks which differ from last_image are written, sector by sector with one authentication,
+ *             the written blocks are copied into last_image, outcome holds one mifare_classic_update_outcome_t
+ *             per block, 1 is returned when a block failed or the card is lost
  */
-uint8_t mifare_classic_select_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+uint8_t mifare_classic_update(mifare_classic_handle_t *handle, uint8_t id[4],
+                              mifare_classic_key_t *key, uint8_t key_count,
+                              uint8_t block, uint16_t block_count,
+                              uint8_t *image, uint8_t *last_image,
+                              uint8_t *outcome, uint16_t *written)
 {
     uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[9];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    uint8_t b;
+    uint8_t sector;
+    uint8_t last_key;
+    uint8_t pending;
+    uint8_t failed;
+    uint16_t total;
+    uint16_t i;
+    uint16_t j;
+    uint16_t k;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                      /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                            /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                                 /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                            /* return error */
     }
-    
-    input_len = 9;                                                                               /* set the input length */
-    input_buf[0] = (MIFARE_CLASSIC_COMMAND_SELECT_CL1 >> 8) & 0xFF;                              /* set the command */
-    input_buf[1] = (MIFARE_CLASSIC_COMMAND_SELECT_CL1 >> 0) & 0xFF;                              /* set the command */
-    input_buf[6] = 0;                                                                            /* init 0 */
-    for (i = 0; i < 4; i++)                                                                      /* run 4 times */
+    if (handle->type == MIFARE_CLASSIC_TYPE_S50)                                             /* s50 */
     {
-        input_buf[2 + i] = id[i];                                                                /* get one id */
-        input_buf[6] ^= id[i];                                                                   /* xor */
+        total = 64;                                                                          /* 64 blocks */
     }
-    a_mifare_classic_iso14443a_crc(input_buf, 7, input_buf + 7);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    else if (handle->type == MIFARE_CLASSIC_TYPE_S70)                                        /* s70 */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        total = 256;                                                                         /* 256 blocks */
     }
-    if (output_len != 1)                                                                         /* check the output_len */
+    else
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
+        MIFARE_CLASSIC_LOG_DEBUG(handle, TYPE_INVALID, 0);                                   /* type is invalid */
         
-        return 4;                                                                                /* return error */
+        return 4;                                                                            /* return error */
     }
-    if ((output_buf[0] == 0x08) || (output_buf[0] == 0x18))                                      /* check the sak */
+    if ((key == NULL) || (key_count == 0))                                                   /* check the key set */
     {
-        return 0;                                                                                /* success return 0 */
+        MIFARE_CLASSIC_LOG_ERROR(handle, KEY_SET_INVALID, 0);                                /* key set is invalid */
+        
+        return 5;                                                                            /* return error */
     }
-    else
+    if ((block_count == 0) || (((uint32_t)block + block_count) > total))                    /* check the range */
     {
-        handle->debug_print("mifare_classic: sak error.\n");                                     /* sak error */
+        MIFARE_CLASSIC_LOG_ERROR(handle, BLOCK_INVALID, 0);                                  /* block is invalid */
         
-        return 5;                                                                                /* return error */
+        return 6;                                                                            /* return error */
     }
+    
+    *written = 0;                                                                            /* init 0 */
+    for (i = 0; i < block_count; i++)                                                        /* diff all blocks */
+    {
+        b = (uint8_t)(block + i);                                                            /* get the block */
+        if ((b == 0) || (b == a_mifare_classic_trailer_block(a_mifare_classic_sector(b))))   /* check the block */
+        {
+            outcome[i] = MIFARE_CLASSIC_UPDATE_SKIPPED;                                      /* never written */
+        }
+        else if ((last_image != NULL) &&
+                 (a_mifare_classic_block_equal(&image[i * 16], &last_image[i * 16]) != 0))   /* compare the block */
+        {
+            outcome[i] = MIFARE_CLASSIC_UPDATE_UNCHANGED;                                    /* unchanged */
+        }
+        else
+        {
+            outcome[i] = MIFARE_CLASSIC_UPDATE_FAILED;                                       /* failed until it is written */
+        }
+    }
+    
+    failed = 0;                                                                              /* init 0 */
+    last_key = 0;                                                                            /* start with the first key */
+    i = 0;                                                                                   /* first block */
+    while (i < block_count)                                                                  /* sector by sector */
+    {
+        sector = a_mifare_classic_sector((uint8_t)(block + i));                              /* get the sector */
+        pending = 0;                                                                         /* init 0 */
+        for (j = i; (j < block_count) &&
+             (a_mifare_classic_sector((uint8_t)(block + j)) == sector); j++)                 /* find the sector end */
+        {
+            if (outcome[j] == MIFARE_CLASSIC_UPDATE_FAILED)                                  /* changed block */
+            {
+                pending = 1;                                                                 /* the sector has work */
+            }
+        }
+        if (pending == 0)                                                                    /* nothing changed */
+        {
+            i = j;                                                                           /* next sector */
+            
+            continue;                                                                        /* skip the authentication */
+        }
+        res = a_mifare_classic_sector_open(handle, id, (uint8_t)(block + i), key,
+                                           key_count, &last_key);                            /* open the sector */
+        if (res == 2)                                                                        /* card is lost */
+        {
+            return 1;                                                                        /* return error */
+        }
+        if (res != 0)                                                                        /* no key works */
+        {
+            failed = 1;                                                                      /* the blocks stay failed */
+            i = j;                                                                           /* next sector */
+            
+            continue;                                                                        /* next sector */
+        }
+        for (k = i; k < j; k++)                                                              /* all blocks of the sector */
+        {
+            if (outcome[k] != MIFARE_CLASSIC_UPDATE_FAILED)                                  /* check the block */
+            {
+                continue;                                                                    /* nothing to write */
+            }
+            res = mifare_classic_write(handle, (uint8_t)(block + k), &image[k * 16]);        /* write one block */
+            if (res == 0)                                                                    /* check the result */
+            {
+                outcome[k] = MIFARE_CLASSIC_UPDATE_WRITTEN;                                  /* written */
+                (*written)++;                                                                /* count the block */
+                if (last_image != NULL)                                                      /* check the last image */
+                {
+                    memcpy(&last_image[k * 16], &image[k * 16], 16);                         /* the card holds it now */
+                }
+                
+                continue;                                                                    /* next block */
+            }
+            failed = 1;                                                                      /* the block failed */
+            res = mifare_classic_reselect(handle, id);                                       /* the card is idle now */
+            if (res != 0)                                                                    /* check the result */
+            {
+                return 1;                                                                    /* return error */
+            }
+            res = mifare_classic_authentication(handle, id, (uint8_t)(block + i),
+                                                (mifare_classic_authentication_key_t)key[last_key].key_type,
+                                                key[last_key].key);                          /* authentication again */
+            if (res != 0)                                                                    /* check the result */
+            {
+                return 1;                                                                    /* return error */
+            }
+        }
+        i = j;                                                                               /* next sector */
+    }
+    
+    return (failed != 0) ? 1 : 0;                                                            /* return the result */
 }
 
 /**
- * @brief     mifare select cl2
+ * @brief     mifare set the sector permission
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] *id pointer to an id buffer
+ * @param[in] sector set sector
+ * @param[in] *key_a pointer to a key a buffer
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 is block3(block15) permission
+ * @param[in] user_data user data
+ * @param[in] *key_b pointer to a key b buffer
  * @return    status code
  *            - 0 success
- *            - 1 select cl2 failed
+ *            - 1 set sector permission failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
  *            - 4 output_len is invalid
- *            - 5 sak error
- * @note      none
+ *            - 5 ack error
+ *            - 6 sector is invalid
+ * @note      block_0_0_4, block_1_5_9, block_2_10_14, permission(c1_c2_c3) definition is below
+ *            c1  c2  c3        read        write        increment        decrement/transfer/restore
+ *            0   0   0        keya|b       keya|b         keya|b                  keya|b
+ *            0   1   0        keya|b       never          never                   never
+ *            1   0   0        keya|b       keyb           never                   never
+ *            1   1   0        keya|b       keyb           keyb                    keya|b
+ *            0   0   1        keya|b       never          never                   keya|b
+ *            0   1   1        keyb         keyb           never                   never
+ *            1   0   1        keyb         never          never                   never
+ *            1   1   1        never        never          never                   never
+ *                                                                                      
+ *            block_3_15 permission(c1_c2_c3) definition is below
+ *            c1  c2  c3    keya_read    keya_write    access_read    access_write    keyb_read    keyb_write
+ *            0   0   0      never        keya            keya           never          keya          keya
+ *            0   1   0      never        never           keya           never          keya          never
+ *            1   0   0      never        keyb           keya|b          never          never         keyb
+ *            1   1   0      never        never          keya|b          never          never         never
+ *            0   0   1      never        keya            keya           keya           keya          keya
+ *            0   1   1      never        keyb           keya|b          keyb           never         keyb
+ *            1   0   1      never        never          keya|b          keyb           never         never
+ *            1   1   1      never        never          keya|b          never          never         never
  */
-uint8_t mifare_classic_select_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+uint8_t mifare_classic_set_sector_permission(mifare_classic_handle_t *handle,
+                                             uint8_t sector, uint8_t key_a[6], 
+                                             uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                             uint8_t block_2_10_14, uint8_t block_3_15,
+                                             uint8_t user_data, uint8_t key_b[6])
 {
-    uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[9];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    mifare_classic_operation_t op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                             /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                   /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                        /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                   /* return error */
     }
     
-    input_len = 9;                                                                               /* set the input length */
-    input_buf[0] = (MIFARE_CLASSIC_COMMAND_SELECT_CL2 >> 8) & 0xFF;                              /* set the command */
-    input_buf[1] = (MIFARE_CLASSIC_COMMAND_SELECT_CL2 >> 0) & 0xFF;                              /* set the command */
-    input_buf[6] = 0;                                                                            /* init 0 */
-    for (i = 0; i < 4; i++)                                                                      /* run 4 times */
-    {
-        input_buf[2 + i] = id[i];                                                                /* get one id */
-        input_buf[6] ^= id[i];                                                                   /* xor */
-    }
-    a_mifare_classic_iso14443a_crc(input_buf, 7, input_buf + 7);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (a_mifare_classic_sector_check(handle, sector) != 0)                         /* check the sector */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 6;                                                                   /* return error */
     }
-    if (output_len != 1)                                                                         /* check the output_len */
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION,
+                                    a_mifare_classic_trailer_block(sector));        /* init the operation */
+    a_mifare_classic_trailer_encode(key_a, block_0_0_4, block_1_5_9, block_2_10_14,
+                                    block_3_15, user_data, key_b, op.data);         /* encode the trailer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                             /* run the operation */
+}
+
+/**
+ * @brief      mifare get the sector permission
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sector get sector
+ * @param[out] *block_0_0_4 pointer to a block0(block0-4) permission buffer
+ * @param[out] *block_1_5_9 pointer to a block1(block5-9) permission buffer
+ * @param[out] *block_2_10_14 pointer to a block2(block10-14) permission buffer
+ * @param[out] *block_3_15 pointer to a block3(block15) permission buffer
+ * @param[out] *user_data pointer to a user data buffer
+ * @param[out] *key_b pointer to a key b buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get sector permission failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 crc error
+ *             - 6 data is invalid
+ *             - 7 sector is invalid
+ * @note       none
+ */
+uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
+                                             uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                             uint8_t *block_2_10_14, uint8_t *block_3_15,
+                                             uint8_t *user_data, uint8_t key_b[6])
+{
+    mifare_classic_operation_t op;
+    
+    if (handle == NULL)                                                             /* check handle */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        return 2;                                                                   /* return error */
     }
-    if ((output_buf[0] == 0x08) || (output_buf[0] == 0x18))                                      /* check the sak */
+    if (handle->inited != 1)                                                        /* check handle initialization */
     {
-        return 0;                                                                                /* success return 0 */
+        return 3;                                                                   /* return error */
     }
-    else
+    
+    if (a_mifare_classic_sector_check(handle, sector) != 0)                         /* check the sector */
     {
-        handle->debug_print("mifare_classic: sak error.\n");                                     /* sak error */
-        
-        return 5;                                                                                /* return error */
+        return 7;                                                                   /* return error */
     }
+    
+    a_mifare_classic_operation_init(&op, MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION,
+                                    a_mifare_classic_trailer_block(sector));        /* init the operation */
+    op.output[0] = block_0_0_4;                                                     /* set the block_0_0_4 buffer */
+    op.output[1] = block_1_5_9;                                                     /* set the block_1_5_9 buffer */
+    op.output[2] = block_2_10_14;                                                   /* set the block_2_10_14 buffer */
+    op.output[3] = block_3_15;                                                      /* set the block_3_15 buffer */
+    op.output[4] = user_data;                                                       /* set the user data buffer */
+    op.output[5] = key_b;                                                           /* set the key b buffer */
+    
+    return a_mifare_classic_operation_run(handle, &op);                             /* run the operation */
 }
 
 /**
- * @brief     mifare authentication
+ * @brief     enable or disable the reader crc offload
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] *id pointer to an id buffer
- * @param[in] block block of authentication
- * @param[in] key_type authentication key type
- * @param[in] *key pointer to a key buffer
+ * @param[in] enable bool value
  * @return    status code
  *            - 0 success
- *            - 1 authentication failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- * @note      none
+ * @note      when it is enabled, the contactless_transceiver must append the crc to the frames with crc,
+ *            check and strip the crc of the 16 bytes read replies
  */
-uint8_t mifare_classic_authentication(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t block,
-                                      mifare_classic_authentication_key_t key_type, uint8_t key[6])
+uint8_t mifare_classic_set_crc_offload(mifare_classic_handle_t *handle, mifare_classic_bool_t enable)
 {
-    uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[12];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                      /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                           /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                      /* return error */
     }
     
-    input_len = 12;                                                                              /* set the input length */
-    if (key_type == MIFARE_CLASSIC_AUTHENTICATION_KEY_A)                                         /* key a */
+    handle->crc_offload = (uint8_t)enable;                             /* set the offload */
+    
+    return 0;                                                          /* success return 0 */
+}
+
+/**
+ * @brief      get the reader crc offload status
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *enable pointer to a bool value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t mifare_classic_get_crc_offload(mifare_classic_handle_t *handle, mifare_classic_bool_t *enable)
+{
+    if (handle == NULL)                                                /* check handle */
     {
-        input_buf[0] = MIFARE_CLASSIC_COMMAND_AUTHENTICATION_WITH_KEY_A;                         /* set the command */
+        return 2;                                                      /* return error */
     }
-    else                                                                                         /* key b */
+    if (handle->inited != 1)                                           /* check handle initialization */
     {
-        input_buf[0] = MIFARE_CLASSIC_COMMAND_AUTHENTICATION_WITH_KEY_B;                         /* set the command */
+        return 3;                                                      /* return error */
     }
-    input_buf[1] = block;                                                                        /* set the block */
-    for (i = 0; i < 6; i++)                                                                      /* 6 times */
+    
+    *enable = (mifare_classic_bool_t)(handle->crc_offload);            /* get the offload */
+    
+    return 0;                                                          /* success return 0 */
+}
+
+/**
+ * @brief     enable or disable the authentication session cache
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] enable bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      when it is enabled, mifare_classic_authentication returns at once if the same id, sector,
+ *            key type and key are already authenticated, halt, wake up, request, anti collision, select,
+ *            raw transceiver, any error and disabling the cache close the session, enabling it keeps an open
+ *            session so helpers can enable it without a new authentication
+ */
+uint8_t mifare_classic_set_auth_cache(mifare_classic_handle_t *handle, mifare_classic_bool_t enable)
+{
+    if (handle == NULL)                          /* check handle */
     {
-        input_buf[2 + i] = key[i];                                                               /* copy the keys */
+        return 2;                                /* return error */
     }
-    for (i = 0; i < 4; i++)                                                                      /* 4 times */
+    if (handle->inited != 1)                     /* check handle initialization */
     {
-        input_buf[8 + i] = id[i];                                                                /* copy the id */
+        return 3;                                /* return error */
     }
     
-    output_len = 0;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    handle->auth_cache = (uint8_t)enable;        /* set the cache */
+    if (enable == MIFARE_CLASSIC_BOOL_FALSE)     /* check the cache */
     {
-        handle->debug_print("mifare_classic: authentication failed.\n");                         /* authentication failed */
-        
-        return 1;                                                                                /* return error */
+        handle->auth_valid = 0;                  /* close the session */
     }
     
-    return 0;                                                                                    /* success return 0 */
+    return 0;                                    /* success return 0 */
 }
 
 /**
- * @brief      mifare read
+ * @brief      get the authentication session cache status
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  block block of read
- * @param[out] *data pointer to a data buffer
+ * @param[out] *enable pointer to a bool value buffer
  * @return     status code
  *             - 0 success
- *             - 1 read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 crc error
  * @note       none
  */
-uint8_t mifare_classic_read(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
+uint8_t mifare_classic_get_auth_cache(mifare_classic_handle_t *handle, mifare_classic_bool_t *enable)
 {
-    uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[18];
-    uint8_t crc_buf[2];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                           /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                 /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                      /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                 /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_READ;                                           /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf , 2, input_buf + 2);                                /* get the crc */
-    output_len = 18;                                                                             /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 18)                                                                        /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    a_mifare_classic_iso14443a_crc(output_buf, 16, crc_buf);                                     /* get the crc */
-    if ((output_buf[16] == crc_buf[0]) && (output_buf[17] == crc_buf[1]))                        /* check the crc */
-    {
-        memcpy(data, output_buf, 16);                                                            /* copy the data */
-        
-        return 0;                                                                                /* success return 0 */
-    }
-    else
-    {
-        handle->debug_print("mifare_classic: crc error.\n");                                     /* crc error */
-        
-        return 5;                                                                                /* return error */
-    }
+    *enable = (mifare_classic_bool_t)(handle->auth_cache);        /* get the cache */
+    
+    return 0;                                                     /* success return 0 */
 }
 
 /**
- * @brief     mifare write
- * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block block of write
- * @param[in] *data pointer to a data buffer
- * @return    status code
- *            - 0 success
- *            - 1 write failed
- *            - 2 handle is NULL
- *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- * @note      none
+ * @brief      get the card state
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *state pointer to a card state buffer
+ * @param[out] *sector pointer to an authenticated sector buffer
+ * @param[out] *key_type pointer to an authenticated key type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       the state follows the result of every command, sector and key_type are only valid
+ *             in the authenticated state, the raw mifare_classic_transceiver sets the unknown state
+ *             and a request or wake up leaves it
  */
-uint8_t mifare_classic_write(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
+uint8_t mifare_classic_get_state(mifare_classic_handle_t *handle, mifare_classic_card_state_t *state,
+                                 uint8_t *sector, mifare_classic_authentication_key_t *key_type)
 {
-    uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[18];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                              /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                    /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                                         /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                                    /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_WRITE;                                          /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    *state = (mifare_classic_card_state_t)(handle->state);                           /* get the state */
+    *sector = handle->auth_sector;                                                   /* get the sector */
+    *key_type = (mifare_classic_authentication_key_t)(handle->auth_key_type);        /* get the key type */
+    
+    return 0;                                                                        /* success return 0 */
+}
+
+/**
+ * @brief      get the key of the open authentication session
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 no session is open
+ * @note       it is the key which the auth cache compares, sector and key_type of the session
+ *             are given by mifare_classic_get_state
+ */
+uint8_t mifare_classic_get_auth_key(mifare_classic_handle_t *handle, uint8_t key[6])
+{
+    if (handle == NULL)                      /* check handle */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 2;                            /* return error */
     }
-    if (output_len != 1)                                                                         /* check the output_len */
+    if (handle->inited != 1)                 /* check handle initialization */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        return 3;                            /* return error */
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    if (handle->auth_valid == 0)             /* check the session */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 4;                            /* return error */
     }
     
-    for (i = 0; i < 16; i ++)                                                                    /* 16 times */
-    {
-        input_buf[i] = data[i];                                                                  /* copy data */
-    }
-    a_mifare_classic_iso14443a_crc(input_buf, 16, input_buf + 16);                               /* get the crc */
-    input_len = 18;                                                                              /* set the input length */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    memcpy(key, handle->auth_key, 6);        /* get the key */
+    
+    return 0;                                /* success return 0 */
+}
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief      get a snapshot of the latency statistics
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *stats pointer to a statistics structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       every blocking and async command is counted once with all its frames,
+ *             a command rejected by the card state is counted as a failure with code 1
+ */
+uint8_t mifare_classic_get_stats(mifare_classic_handle_t *handle, mifare_classic_stats_t *stats)
+{
+    if (handle == NULL)                                                   /* check handle */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 2;                                                         /* return error */
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    if (handle->inited != 1)                                              /* check handle initialization */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 3;                                                         /* return error */
     }
     
-    return 0;                                                                                    /* success return 0 */
+    memcpy(stats, &handle->stats, sizeof(mifare_classic_stats_t));        /* copy the statistics */
+    
+    return 0;                                                             /* success return 0 */
 }
 
 /**
- * @brief     mifare init one block as a value block
+ * @brief     reset the latency statistics
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block set block
- * @param[in] value inited value
- * @param[in] addr address
  * @return    status code
  *            - 0 success
- *            - 1 value init failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
  * @note      none
  */
-uint8_t mifare_classic_value_init(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
+uint8_t mifare_classic_reset_stats(mifare_classic_handle_t *handle)
 {
-    uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[18];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    uint32_t v;
-    uint32_t v_r;
-    uint8_t data[16];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                               /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                     /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->inited != 1)                                          /* check handle initialization */
     {
-        return 3;                                                                                /* return error */
+        return 3;                                                     /* return error */
     }
     
-    v = (uint32_t)(value);                                                                       /* convert the value */
-    v_r = (uint32_t)(~value);                                                                    /* revert the value */
-    data[0] = (uint8_t)((v >> 0) & 0xFF);                                                        /* set the value */
-    data[1] = (uint8_t)((v >> 8) & 0xFF);                                                        /* set the value */
-    data[2] = (uint8_t)((v >> 16) & 0xFF);                                                       /* set the value */
-    data[3] = (uint8_t)((v >> 24) & 0xFF);                                                       /* set the value */
-    data[4] = (uint8_t)((v_r >> 0) & 0xFF);                                                      /* set the value */
-    data[5] = (uint8_t)((v_r >> 8) & 0xFF);                                                      /* set the value */
-    data[6] = (uint8_t)((v_r >> 16) & 0xFF);                                                     /* set the value */
-    data[7] = (uint8_t)((v_r >> 24) & 0xFF);                                                     /* set the value */
-    data[8] = (uint8_t)((v >> 0) & 0xFF);                                                        /* set the value */
-    data[9] = (uint8_t)((v >> 8) & 0xFF);                                                        /* set the value */
-    data[10] = (uint8_t)((v >> 16) & 0xFF);                                                      /* set the value */
-    data[11] = (uint8_t)((v >> 24) & 0xFF);                                                      /* set the value */
-    data[12] = addr;                                                                             /* set the address */
-    data[13] = (uint8_t)(~addr);                                                                 /* set the address */
-    data[14] = addr;                                                                             /* set the address */
-    data[15] = (uint8_t)(~addr);                                                                 /* set the address */
-    
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_WRITE;                                          /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
+    memset(&handle->stats, 0, sizeof(mifare_classic_stats_t));        /* clear the statistics */
+    
+    return 0;                                                         /* success return 0 */
+}
+
+/**
+ * @brief      get the latency summary of one command from a snapshot
+ * @param[in]  *stats pointer to a statistics structure
+ * @param[in]  command statistics command
+ * @param[out] *min_us pointer to a min latency buffer
+ * @param[out] *avg_us pointer to an average latency buffer
+ * @param[out] *max_us pointer to a max latency buffer
+ * @param[out] *p99_us pointer to a p99 latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 stats is NULL
+ *             - 4 command is invalid
+ * @note       p99 is the upper bound of the histogram bucket and never exceeds the max,
+ *             all outputs are 0 when no call has a latency
+ */
+uint8_t mifare_classic_stats_latency(mifare_classic_stats_t *stats, mifare_classic_stats_command_t command,
+                                     uint32_t *min_us, uint32_t *avg_us, uint32_t *max_us, uint32_t *p99_us)
+{
+    uint8_t i;
+    uint32_t sum;
+    mifare_classic_stats_entry_t *entry;
+    
+    if (stats == NULL)                                                 /* check stats */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        return 2;                                                      /* return error */
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    if (command >= MIFARE_CLASSIC_STATS_COMMAND_MAX)                   /* check the command */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 4;                                                      /* return error */
     }
     
-    for (i = 0; i < 16; i ++)                                                                    /* 16 times */
+    entry = &stats->command[command];                                  /* get the entry */
+    *min_us = 0;                                                       /* init 0 */
+    *avg_us = 0;                                                       /* init 0 */
+    *max_us = 0;                                                       /* init 0 */
+    *p99_us = 0;                                                       /* init 0 */
+    if (entry->timed == 0)                                             /* check the timed calls */
     {
-        input_buf[i] = data[i];                                                                  /* copy data */
+        return 0;                                                      /* success return 0 */
     }
-    a_mifare_classic_iso14443a_crc(input_buf, 16, input_buf + 16);                               /* get the crc */
-    input_len = 18;                                                                              /* set the input length */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    *min_us = entry->min_us;                                           /* get the min */
+    *avg_us = (uint32_t)(entry->sum_us / entry->timed);                /* get the average */
+    *max_us = entry->max_us;                                           /* get the max */
+    sum = 0;                                                           /* init 0 */
+    for (i = 0; i < MIFARE_CLASSIC_STATS_HISTOGRAM; i++)               /* find the p99 bucket */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        sum += entry->histogram[i];                                    /* add the bucket */
+        if ((uint64_t)sum * 100 >= (uint64_t)entry->timed * 99)        /* check 99 percent */
+        {
+            break;                                                     /* break */
+        }
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    if (i >= (MIFARE_CLASSIC_STATS_HISTOGRAM - 1))                     /* last bucket has no upper bound */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        *p99_us = entry->max_us;                                       /* use the max */
+    }
+    else
+    {
+        *p99_us = (uint32_t)((1UL << i) - 1);                          /* bucket upper bound */
+        if (*p99_us > entry->max_us)                                   /* check the max */
+        {
+            *p99_us = entry->max_us;                                   /* limit to the max */
+        }
     }
     
-    return 0;                                                                                    /* success return 0 */
+    return 0;                                                          /* success return 0 */
 }
 
+#endif
+
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+
 /**
- * @brief     mifare value write
- * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block set block
- * @param[in] value written value
- * @param[in] addr address
- * @return    status code
- *            - 0 success
- *            - 1 value write failed
- *            - 2 handle is NULL
- *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- * @note      none
+ * @brief      read the oldest event of the deferred log
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *entry pointer to a log entry buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 log is empty
+ *             - 2 handle is NULL
+ * @note       the event is removed from the ring, the log works before the handle is initialized
+ *             so that the errors of mifare_classic_init can be read
  */
-uint8_t mifare_classic_value_write(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
+uint8_t mifare_classic_log_read(mifare_classic_handle_t *handle, mifare_classic_log_entry_t *entry)
 {
-    uint8_t res;
-    uint8_t i;
-    uint8_t input_len;
-    uint8_t input_buf[18];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    uint32_t v;
-    uint32_t v_r;
-    uint8_t data[16];
-    
-    if (handle == NULL)                                                                          /* check handle */
+    if (handle == NULL)                                                                     /* check handle */
     {
-        return 2;                                                                                /* return error */
+        return 2;                                                                           /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    if (handle->log_count == 0)                                                             /* check the ring */
     {
-        return 3;                                                                                /* return error */
+        return 1;                                                                           /* return empty */
     }
     
-    v = (uint32_t)(value);                                                                       /* convert the value */
-    v_r = (uint32_t)(~value);                                                                    /* revert the value */
-    data[0] = (uint8_t)((v >> 0) & 0xFF);                                                        /* set the value */
-    data[1] = (uint8_t)((v >> 8) & 0xFF);                                                        /* set the value */
-    data[2] = (uint8_t)((v >> 16) & 0xFF);                                                       /* set the value */
-    data[3] = (uint8_t)((v >> 24) & 0xFF);                                                       /* set the value */
-    data[4] = (uint8_t)((v_r >> 0) & 0xFF);                                                      /* set the value */
-    data[5] = (uint8_t)((v_r >> 8) & 0xFF);                                                      /* set the value */
-    data[6] = (uint8_t)((v_r >> 16) & 0xFF);                                                     /* set the value */
-    data[7] = (uint8_t)((v_r >> 24) & 0xFF);                                                     /* set the value */
-    data[8] = (uint8_t)((v >> 0) & 0xFF);                                                        /* set the value */
-    data[9] = (uint8_t)((v >> 8) & 0xFF);                                                        /* set the value */
-    data[10] = (uint8_t)((v >> 16) & 0xFF);                                                      /* set the value */
-    data[11] = (uint8_t)((v >> 24) & 0xFF);                                                      /* set the value */
-    data[12] = addr;                                                                             /* set the address */
-    data[13] = (uint8_t)(~addr);                                                                 /* set the address */
-    data[14] = addr;                                                                             /* set the address */
-    data[15] = (uint8_t)(~addr);                                                                 /* set the address */
-    
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_WRITE;                                          /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
-    }
+    *entry = handle->log[handle->log_head];                                                 /* get the oldest event */
+    handle->log_head = (uint8_t)((handle->log_head + 1) % MIFARE_CLASSIC_LOG_DEPTH);        /* next event */
+    handle->log_count--;                                                                    /* one less event */
+    
+    return 0;                                                                               /* success return 0 */
+}
+
+/**
+ * @brief      print and remove all events of the deferred log
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *dropped pointer to a dropped event number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 debug_print is NULL
+ * @note       every event is printed with the same text as the immediate log of the same level,
+ *             dropped is the number of events overwritten since the last flush
+ */
+uint8_t mifare_classic_log_flush(mifare_classic_handle_t *handle, uint32_t *dropped)
+{
+    mifare_classic_log_entry_t entry;
     
-    for (i = 0; i < 16; i ++)                                                                    /* 16 times */
+    if (handle == NULL)                                                       /* check handle */
     {
-        input_buf[i] = data[i];                                                                  /* copy data */
+        return 2;                                                             /* return error */
     }
-    a_mifare_classic_iso14443a_crc(input_buf, 16, input_buf + 16);                               /* get the crc */
-    input_len = 18;                                                                              /* set the input length */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (handle->debug_print == NULL)                                          /* check debug_print */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
+        return 3;                                                             /* return error */
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    
+    while (mifare_classic_log_read(handle, &entry) == 0)                      /* read all events */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        if (entry.event >= MIFARE_CLASSIC_EVENT_MAX)                          /* check the event */
+        {
+            entry.event = 0;                                                  /* unknown event */
+        }
+        handle->debug_print(gsc_mifare_classic_log_text[entry.event]);        /* print the text */
     }
+    *dropped = handle->log_dropped;                                           /* get the dropped counter */
+    handle->log_dropped = 0;                                                  /* clear the dropped counter */
     
-    return 0;                                                                                    /* success return 0 */
+    return 0;                                                                 /* success return 0 */
 }
 
+#endif
+
 /**
- * @brief      mifare value read
+ * @brief      mifare async request
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  block block of read
- * @param[out] *value pointer to a value buffer
- * @param[out] *addr pointer to an address buffer
+ * @param[out] *type pointer to a type buffer
  * @return     status code
  *             - 0 success
- *             - 1 value read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 crc error
- *             - 6 value is invalid
- *             - 7 block is invalid
- * @note       none
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_value_read(mifare_classic_handle_t *handle, uint8_t block, int32_t *value, uint8_t *addr)
+uint8_t mifare_classic_async_request(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
 {
     uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[18];
-    uint8_t crc_buf[2];
-    uint8_t data[16];
-    uint32_t value_0;
-    uint32_t value_1;
-    uint32_t value_2;
-    uint8_t address_0;
-    uint8_t address_1;
-    uint8_t address_2;
-    uint8_t address_3;
-    uint32_t v;
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    res = a_mifare_classic_async_check(handle);                                      /* check the handle */
+    if (res != 0)                                                                    /* check the result */
     {
-        return 3;                                                                                /* return error */
+        return res;                                                                  /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_READ;                                           /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf , 2, input_buf + 2);                                /* get the crc */
-    output_len = 18;                                                                             /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 18)                                                                        /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    a_mifare_classic_iso14443a_crc(output_buf, 16, crc_buf);                                     /* get the crc */
-    if ((output_buf[16] == crc_buf[0]) && (output_buf[17] == crc_buf[1]))                        /* check the crc */
-    {
-        uint8_t i;
-        
-        for (i = 0; i < 16; i++)                                                                 /* 16 times */
-        {
-            data[i] = output_buf[i];                                                             /* copy the data */
-        }
-        value_0 = ((uint32_t)data[0] << 0) | ((uint32_t)data[1] << 8) | 
-                  ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);                         /* get the value 0 */
-        value_1 = ((uint32_t)data[4] << 0) | ((uint32_t)data[5] << 8) | 
-                  ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);                         /* get the value 1 */
-        value_2 = ((uint32_t)data[8] << 0) | ((uint32_t)data[9] << 8) | 
-                  ((uint32_t)data[10] << 16) | ((uint32_t)data[11] << 24);                       /* get the value 2 */
-        address_0 = data[12];                                                                    /* get the address 0 */
-        address_1 = (uint8_t)(~data[13]);                                                        /* get the address 1 */
-        address_2 = data[14];                                                                    /* get the address 2 */
-        address_3 = (uint8_t)(~data[15]);                                                        /* get the address 3 */
-        
-        if ((value_0 != value_2) || (value_0 != (uint32_t)(~value_1)))                           /* check the value */
-        {
-            handle->debug_print("mifare_classic: value is invalid.\n");                          /* value is invalid */
-            
-            return 6;                                                                            /* return error */
-        }
-        if ((address_0 != address_2) ||
-            (address_1 != address_3) ||
-            (address_0 != (uint8_t)(address_1))                                                  /* check the address */
-            )
-        {
-            handle->debug_print("mifare_classic: block is invalid.\n");                          /* block is invalid */
-            
-            return 7;                                                                            /* return error */
-        }
-        v = value_0;                                                                             /* get the value */
-        *value = (int32_t)(v);                                                                   /* set the value */
-        *addr = address_0;                                                                       /* set the address */
-        
-        return 0;                                                                                /* success return 0 */
-    }
-    else
+    op = &handle->async_operation;                                                   /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_REQUEST, 0);        /* init the operation */
+    op->output[0] = type;                                                            /* set the type buffer */
+    
+    return a_mifare_classic_async_start(handle);                                     /* start the operation */
+}
+
+/**
+ * @brief      mifare async wake up
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_wake_up(mifare_classic_handle_t *handle, mifare_classic_type_t *type)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                      /* check the handle */
+    if (res != 0)                                                                    /* check the result */
     {
-        handle->debug_print("mifare_classic: crc error.\n");                                     /* crc error */
-        
-        return 5;                                                                                /* return error */
+        return res;                                                                  /* return error */
     }
+    
+    op = &handle->async_operation;                                                   /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_WAKE_UP, 0);        /* init the operation */
+    op->output[0] = type;                                                            /* set the type buffer */
+    
+    return a_mifare_classic_async_start(handle);                                     /* start the operation */
 }
 
 /**
- * @brief     mifare increment
+ * @brief     mifare async halt
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block block of increment
- * @param[in] value increment value
  * @return    status code
  *            - 0 success
- *            - 1 increment failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- *            - 6 invalid operation
- * @note      none
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_increment(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
+uint8_t mifare_classic_async_halt(mifare_classic_handle_t *handle)
 {
     uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[6];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    uint32_t v;
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    res = a_mifare_classic_async_check(handle);                                   /* check the handle */
+    if (res != 0)                                                                 /* check the result */
     {
-        return 3;                                                                                /* return error */
+        return res;                                                               /* return error */
     }
+    
+    op = &handle->async_operation;                                                /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_HALT, 0);        /* init the operation */
+    
+    return a_mifare_classic_async_start(handle);                                  /* start the operation */
+}
 
-    v = value;                                                                                   /* set the value */
+/**
+ * @brief     mifare async set the load modulation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] mod load modulation
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_set_modulation(mifare_classic_handle_t *handle, mifare_classic_load_modulation_t mod)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_INCREMENT;                                      /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
+    res = a_mifare_classic_async_check(handle);                                                        /* check the handle */
+    if (res != 0)                                                                                      /* check the result */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] == 0x4)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: invalid operation.\n");                             /* invalid operation */
-        
-        return 6;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return res;                                                                                    /* return error */
     }
     
-    input_len = 6;                                                                               /* set the input length */
-    input_buf[0] = (v >> 0) & 0xFF;                                                              /* set the data */
-    input_buf[1] = (v >> 8) & 0xFF;                                                              /* set the data */
-    input_buf[2] = (v >> 16) & 0xFF;                                                             /* set the data */
-    input_buf[3] = (v >> 24) & 0xFF;                                                             /* set the data */
-    a_mifare_classic_iso14443a_crc(input_buf, 4, input_buf + 4);                                 /* get the crc */
-    output_len = 0;                                                                              /* set the output length */
-    (void)handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
+    op = &handle->async_operation;                                                                     /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_SET_MODULATION, (uint8_t)mod);        /* init the operation */
     
-    return 0;                                                                                    /* success return 0 */
+    return a_mifare_classic_async_start(handle);                                                       /* start the operation */
 }
 
 /**
- * @brief     mifare decrement
+ * @brief     mifare async set the personalized uid
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block block of decrement
- * @param[in] value decrement value
+ * @param[in] type personalized uid type
  * @return    status code
  *            - 0 success
- *            - 1 decrement failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- *            - 6 invalid operation
- * @note      none
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_decrement(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
+uint8_t mifare_classic_async_set_personalized_uid(mifare_classic_handle_t *handle, mifare_classic_personalized_uid_t type)
 {
     uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[6];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    uint32_t v;
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    res = a_mifare_classic_async_check(handle);                                                               /* check the handle */
+    if (res != 0)                                                                                             /* check the result */
     {
-        return 3;                                                                                /* return error */
+        return res;                                                                                           /* return error */
     }
+    
+    op = &handle->async_operation;                                                                            /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID, (uint8_t)type);        /* init the operation */
+    
+    return a_mifare_classic_async_start(handle);                                                              /* start the operation */
+}
 
-    v = value;                                                                                   /* set the value */
+/**
+ * @brief      mifare async anti collision cl1
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_anticollision_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_DECREMENT;                                      /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    res = a_mifare_classic_async_check(handle);                                                /* check the handle */
+    if (res != 0)                                                                              /* check the result */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] == 0x4)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: invalid operation.\n");                             /* invalid operation */
-        
-        return 6;                                                                                /* return error */
+        return res;                                                                            /* return error */
     }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    
+    op = &handle->async_operation;                                                             /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1, 0);        /* init the operation */
+    op->output[0] = id;                                                                        /* set the id buffer */
+    
+    return a_mifare_classic_async_start(handle);                                               /* start the operation */
+}
+
+/**
+ * @brief      mifare async anti collision cl2
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_anticollision_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                                /* check the handle */
+    if (res != 0)                                                                              /* check the result */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return res;                                                                            /* return error */
     }
     
-    input_len = 6;                                                                               /* set the input length */
-    input_buf[0] = (v >> 0) & 0xFF;                                                              /* set the data */
-    input_buf[1] = (v >> 8) & 0xFF;                                                              /* set the data */
-    input_buf[2] = (v >> 16) & 0xFF;                                                             /* set the data */
-    input_buf[3] = (v >> 24) & 0xFF;                                                             /* set the data */
-    a_mifare_classic_iso14443a_crc(input_buf, 4, input_buf + 4);                                 /* get the crc */
-    output_len = 0;                                                                              /* set the output length */
-    (void)handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
+    op = &handle->async_operation;                                                             /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2, 0);        /* init the operation */
+    op->output[0] = id;                                                                        /* set the id buffer */
     
-    return 0;                                                                                    /* success return 0 */
+    return a_mifare_classic_async_start(handle);                                               /* start the operation */
 }
 
 /**
- * @brief     mifare transfer
+ * @brief     mifare async select cl1
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block block of transfer
+ * @param[in] *id pointer to an id buffer
  * @return    status code
  *            - 0 success
- *            - 1 transfer failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- *            - 6 invalid operation
- * @note      none
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_transfer(mifare_classic_handle_t *handle, uint8_t block)
+uint8_t mifare_classic_async_select_cl1(mifare_classic_handle_t *handle, uint8_t id[4])
 {
     uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    res = a_mifare_classic_async_check(handle);                                         /* check the handle */
+    if (res != 0)                                                                       /* check the result */
     {
-        return 3;                                                                                /* return error */
+        return res;                                                                     /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_TRANSFER;                                          /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] == 0x4)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: invalid operation.\n");                             /* invalid operation */
-        
-        return 6;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
-    }
+    op = &handle->async_operation;                                                      /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_SELECT_CL1, 0);        /* init the operation */
+    memcpy(op->data, id, 4);                                                            /* copy the id */
     
-    return 0;                                                                                    /* success return 0 */
+    return a_mifare_classic_async_start(handle);                                        /* start the operation */
 }
 
 /**
- * @brief     mifare restore
+ * @brief     mifare async select cl2
  * @param[in] *handle pointer to a mifare_classic handle structure
- * @param[in] block block of restore
+ * @param[in] *id pointer to an id buffer
  * @return    status code
  *            - 0 success
- *            - 1 restore failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- *            - 6 invalid operation
- * @note      none
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_restore(mifare_classic_handle_t *handle, uint8_t block)
+uint8_t mifare_classic_async_select_cl2(mifare_classic_handle_t *handle, uint8_t id[4])
 {
     uint8_t res;
-    uint8_t input_len;
-    uint8_t input_buf[6];
-    uint8_t output_len;
-    uint8_t output_buf[1];
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    res = a_mifare_classic_async_check(handle);                                         /* check the handle */
+    if (res != 0)                                                                       /* check the result */
     {
-        return 3;                                                                                /* return error */
+        return res;                                                                     /* return error */
     }
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_RESTORE;                                        /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] == 0x4)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: invalid operation.\n");                             /* invalid operation */
-        
-        return 6;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    op = &handle->async_operation;                                                      /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_SELECT_CL2, 0);        /* init the operation */
+    memcpy(op->data, id, 4);                                                            /* copy the id */
+    
+    return a_mifare_classic_async_start(handle);                                        /* start the operation */
+}
+
+/**
+ * @brief     mifare async authentication
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] block block of authentication
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_authentication(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t block,
+                                            mifare_classic_authentication_key_t key_type, uint8_t key[6])
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                                 /* check the handle */
+    if (res != 0)                                                                               /* check the result */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return res;                                                                             /* return error */
     }
     
-    input_len = 6;                                                                               /* set the input length */
-    input_buf[0] = 0x00;                                                                         /* set the data */
-    input_buf[1] = 0x00;                                                                         /* set the data */
-    input_buf[2] = 0x00;                                                                         /* set the data */
-    input_buf[3] = 0x00;                                                                         /* set the data */
-    a_mifare_classic_iso14443a_crc(input_buf, 4, input_buf + 4);                                 /* get the crc */
-    output_len = 0;                                                                              /* set the output length */
-    (void)handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
+    op = &handle->async_operation;                                                              /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_AUTHENTICATION, block);        /* init the operation */
+    op->arg = (uint8_t)key_type;                                                                /* set the key type */
+    memcpy(&op->data[0], key, 6);                                                               /* copy the keys */
+    memcpy(&op->data[6], id, 4);                                                                /* copy the id */
     
-    return 0;                                                                                    /* success return 0 */
+    return a_mifare_classic_async_start(handle);                                                /* start the operation */
 }
 
 /**
- * @brief      mifare block number to sector number
+ * @brief      mifare async read
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  block block number
- * @param[out] *sector pointer to a sector number buffer
+ * @param[in]  block block of read
+ * @param[out] *data pointer to a data buffer
  * @return     status code
  *             - 0 success
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- * @note       none
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_block_to_sector(mifare_classic_handle_t *handle, uint8_t block, uint8_t *sector)
+uint8_t mifare_classic_async_read(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
 {
-    if (handle == NULL)                                  /* check handle */
-    {
-        return 2;                                        /* return error */
-    }
-    if (handle->inited != 1)                             /* check handle initialization */
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                       /* check the handle */
+    if (res != 0)                                                                     /* check the result */
     {
-        return 3;                                        /* return error */
+        return res;                                                                   /* return error */
     }
     
-    if (block < 32 * 4)                                  /* check the size*/
+    op = &handle->async_operation;                                                    /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_READ, block);        /* init the operation */
+    op->output[0] = data;                                                             /* set the data buffer */
+    
+    return a_mifare_classic_async_start(handle);                                      /* start the operation */
+}
+
+/**
+ * @brief     mifare async write
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of write
+ * @param[in] *data pointer to a data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_write(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16])
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                        /* check the handle */
+    if (res != 0)                                                                      /* check the result */
     {
-        *sector = block / 4;                             /* s50 */
+        return res;                                                                    /* return error */
     }
-    else
+    
+    op = &handle->async_operation;                                                     /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_WRITE, block);        /* init the operation */
+    memcpy(op->data, data, 16);                                                        /* copy the data */
+    
+    return a_mifare_classic_async_start(handle);                                       /* start the operation */
+}
+
+/**
+ * @brief     mifare async init one block as a value block
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value inited value
+ * @param[in] addr address
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_value_init(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                             /* check the handle */
+    if (res != 0)                                                                           /* check the result */
     {
-        *sector = 32 + ((block - (32 * 4)) / 16);        /* s70 */
+        return res;                                                                         /* return error */
     }
     
-    return 0;                                            /* success return 0 */
+    op = &handle->async_operation;                                                          /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_VALUE_INIT, block);        /* init the operation */
+    a_mifare_classic_value_encode(value, addr, op->data);                                   /* encode the value */
+    
+    return a_mifare_classic_async_start(handle);                                            /* start the operation */
 }
 
 /**
- * @brief      mifare get the sector's block counter
- * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  sector sector number
- * @param[out] *count pointer to a count buffer
- * @return     status code
- *             - 0 success
- *             - 2 handle is NULL
- *             - 3 handle is not initialized
- * @note       none
+ * @brief     mifare async value write
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value written value
+ * @param[in] addr address
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_sector_block_count(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *count)
+uint8_t mifare_classic_async_value_write(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr)
 {
-    if (handle == NULL)             /* check handle */
-    {
-        return 2;                   /* return error */
-    }
-    if (handle->inited != 1)        /* check handle initialization */
-    {
-        return 3;                   /* return error */
-    }
+    uint8_t res;
+    mifare_classic_operation_t *op;
     
-    if (sector < 32)                /* check the size*/
-    {
-        *count = 4;                 /* s50 */
-    }
-    else
+    res = a_mifare_classic_async_check(handle);                                              /* check the handle */
+    if (res != 0)                                                                            /* check the result */
     {
-        *count = 16;                /* s70 */
+        return res;                                                                          /* return error */
     }
     
-    return 0;                       /* success return 0 */
+    op = &handle->async_operation;                                                           /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_VALUE_WRITE, block);        /* init the operation */
+    a_mifare_classic_value_encode(value, addr, op->data);                                    /* encode the value */
+    
+    return a_mifare_classic_async_start(handle);                                             /* start the operation */
 }
 
 /**
- * @brief      mifare get the sector's first block
+ * @brief      mifare async value read
  * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  sector sector number
- * @param[out] *block pointer to a block number buffer
+ * @param[in]  block block of read
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *addr pointer to an address buffer
  * @return     status code
  *             - 0 success
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- * @note       none
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_sector_first_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block)
+uint8_t mifare_classic_async_value_read(mifare_classic_handle_t *handle, uint8_t block, int32_t *value, uint8_t *addr)
 {
-    if (handle == NULL)                              /* check handle */
-    {
-        return 2;                                    /* return error */
-    }
-    if (handle->inited != 1)                         /* check handle initialization */
-    {
-        return 3;                                    /* return error */
-    }
+    uint8_t res;
+    mifare_classic_operation_t *op;
     
-    if (sector < 32)                                 /* check the size*/
-    {
-        *block = sector * 4;                         /* s50 */
-    }
-    else
+    res = a_mifare_classic_async_check(handle);                                             /* check the handle */
+    if (res != 0)                                                                           /* check the result */
     {
-        *block = 32 * 4 + (sector - 32) * 16;        /* s70 */
+        return res;                                                                         /* return error */
     }
     
-    return 0;                                        /* success return 0 */
+    op = &handle->async_operation;                                                          /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_VALUE_READ, block);        /* init the operation */
+    op->output[0] = value;                                                                  /* set the value buffer */
+    op->output[1] = addr;                                                                   /* set the address buffer */
+    
+    return a_mifare_classic_async_start(handle);                                            /* start the operation */
 }
 
 /**
- * @brief      mifare get the sector's last block
- * @param[in]  *handle pointer to a mifare_classic handle structure
- * @param[in]  sector sector number
- * @param[out] *block pointer to a block number buffer
- * @return     status code
- *             - 0 success
- *             - 2 handle is NULL
- *             - 3 handle is not initialized
- * @note       none
+ * @brief     mifare async increment
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of increment
+ * @param[in] value increment value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_sector_last_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block)
+uint8_t mifare_classic_async_increment(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
 {
-    if (handle == NULL)                                    /* check handle */
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                            /* check the handle */
+    if (res != 0)                                                                          /* check the result */
     {
-        return 2;                                          /* return error */
+        return res;                                                                        /* return error */
     }
-    if (handle->inited != 1)                               /* check handle initialization */
+    
+    op = &handle->async_operation;                                                         /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_INCREMENT, block);        /* init the operation */
+    op->data[0] = (value >> 0) & 0xFF;                                                     /* set the data */
+    op->data[1] = (value >> 8) & 0xFF;                                                     /* set the data */
+    op->data[2] = (value >> 16) & 0xFF;                                                    /* set the data */
+    op->data[3] = (value >> 24) & 0xFF;                                                    /* set the data */
+    
+    return a_mifare_classic_async_start(handle);                                           /* start the operation */
+}
+
+/**
+ * @brief     mifare async decrement
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of decrement
+ * @param[in] value decrement value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_decrement(mifare_classic_handle_t *handle, uint8_t block, uint32_t value)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                            /* check the handle */
+    if (res != 0)                                                                          /* check the result */
     {
-        return 3;                                          /* return error */
+        return res;                                                                        /* return error */
     }
     
-    if (sector < 32)                                       /* check the size*/
+    op = &handle->async_operation;                                                         /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_DECREMENT, block);        /* init the operation */
+    op->data[0] = (value >> 0) & 0xFF;                                                     /* set the data */
+    op->data[1] = (value >> 8) & 0xFF;                                                     /* set the data */
+    op->data[2] = (value >> 16) & 0xFF;                                                    /* set the data */
+    op->data[3] = (value >> 24) & 0xFF;                                                    /* set the data */
+    
+    return a_mifare_classic_async_start(handle);                                           /* start the operation */
+}
+
+/**
+ * @brief     mifare async transfer
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of transfer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_transfer(mifare_classic_handle_t *handle, uint8_t block)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                           /* check the handle */
+    if (res != 0)                                                                         /* check the result */
     {
-        *block = sector * 4;                               /* s50 */
+        return res;                                                                       /* return error */
     }
-    else
+    
+    op = &handle->async_operation;                                                        /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_TRANSFER, block);        /* init the operation */
+    
+    return a_mifare_classic_async_start(handle);                                          /* start the operation */
+}
+
+/**
+ * @brief     mifare async restore
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of restore
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_restore(mifare_classic_handle_t *handle, uint8_t block)
+{
+    uint8_t res;
+    mifare_classic_operation_t *op;
+    
+    res = a_mifare_classic_async_check(handle);                                          /* check the handle */
+    if (res != 0)                                                                        /* check the result */
     {
-        *block = 32 * 4 + (sector - 32) * 16;              /* s70 */
+        return res;                                                                      /* return error */
     }
-    *block = *block + ((sector < 32) ? 4 : 16) - 1;        /* get the last block */
     
-    return 0;                                              /* success return 0 */
+    op = &handle->async_operation;                                                       /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_RESTORE, block);        /* init the operation */
+    
+    return a_mifare_classic_async_start(handle);                                         /* start the operation */
 }
 
 /**
- * @brief     mifare set the sector permission
+ * @brief     mifare async set the sector permission
  * @param[in] *handle pointer to a mifare_classic handle structure
  * @param[in] sector set sector
  * @param[in] *key_a pointer to a key a buffer
@@ -1725,143 +4780,45 @@ uint8_t mifare_classic_sector_last_block(mifare_classic_handle_t *handle, uint8_
  * @param[in] *key_b pointer to a key b buffer
  * @return    status code
  *            - 0 success
- *            - 1 set sector permission failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
- *            - 4 output_len is invalid
- *            - 5 ack error
- * @note      block_0_0_4, block_1_5_9, block_2_10_14, permission(c1_c2_c3) definition is below
- *            c1  c2  c3        read        write        increment        decrement/transfer/restore
- *            0   0   0        keya|b       keya|b         keya|b                  keya|b
- *            0   1   0        keya|b       never          never                   never
- *            1   0   0        keya|b       keyb           never                   never
- *            1   1   0        keya|b       keyb           keyb                    keya|b
- *            0   0   1        keya|b       never          never                   keya|b
- *            0   1   1        keyb         keyb           never                   never
- *            1   0   1        keyb         never          never                   never
- *            1   1   1        never        never          never                   never
- *                                                                                      
- *            block_3_15 permission(c1_c2_c3) definition is below
- *            c1  c2  c3    keya_read    keya_write    access_read    access_write    keyb_read    keyb_write
- *            0   0   0      never        keya            keya           never          keya          keya
- *            0   1   0      never        never           keya           never          keya          never
- *            1   0   0      never        keyb           keya|b          never          never         keyb
- *            1   1   0      never        never          keya|b          never          never         never
- *            0   0   1      never        keya            keya           keya           keya          keya
- *            0   1   1      never        keyb           keya|b          keyb           never         keyb
- *            1   0   1      never        never          keya|b          keyb           never         never
- *            1   1   1      never        never          keya|b          never          never         never
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ *            - 6 sector is invalid
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_set_sector_permission(mifare_classic_handle_t *handle,
-                                             uint8_t sector, uint8_t key_a[6], 
-                                             uint8_t block_0_0_4, uint8_t block_1_5_9,
-                                             uint8_t block_2_10_14, uint8_t block_3_15,
-                                             uint8_t user_data, uint8_t key_b[6])
+uint8_t mifare_classic_async_set_sector_permission(mifare_classic_handle_t *handle,
+                                                   uint8_t sector, uint8_t key_a[6], 
+                                                   uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                                   uint8_t block_2_10_14, uint8_t block_3_15,
+                                                   uint8_t user_data, uint8_t key_b[6])
 {
     uint8_t res;
-    uint8_t block;
-    uint8_t i;
-    uint8_t part_1, part_2, part_3;
-    uint8_t input_len;
-    uint8_t input_buf[18];
-    uint8_t output_len;
-    uint8_t output_buf[1];
-    uint8_t access_bits[4];
-    uint8_t data[16];
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
-    {
-        return 2;                                                                                /* return error */
-    }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
-    {
-        return 3;                                                                                /* return error */
-    }
-    
-    part_1 = (((block_3_15 >> 2) & 0x1) << 3) | (((block_2_10_14 >> 2) & 0x1) << 2) |
-             (((block_1_5_9 >> 2) & 0x1) << 1) | (((block_0_0_4 >> 2) & 0x1) << 0);              /* set part 1 */
-    part_2 = (((block_3_15 >> 1) & 0x1) << 3) | (((block_2_10_14 >> 1) & 0x1) << 2) |
-             (((block_1_5_9 >> 1) & 0x1) << 1) | (((block_0_0_4 >> 1) & 0x1) << 0);              /* set part 2 */
-    part_3 = (((block_3_15 >> 0) & 0x1) << 3) | (((block_2_10_14 >> 0) & 0x1) << 2) |
-             (((block_1_5_9 >> 0) & 0x1) << 1) | (((block_0_0_4 >> 0) & 0x1) << 0);              /* set part 3 */
-    access_bits[0] = ((0xF - part_2) << 4) | ((0xF - part_1) << 0);                              /* set the access bits */
-    access_bits[1] = ((part_1 & 0xF) << 4) | ((0xF - part_3) << 0);                              /* set the access bits */
-    access_bits[2] = ((part_3 & 0xF) << 4) | ((part_2 & 0xF) << 0);                              /* set the access bits */
-    access_bits[3] = user_data;                                                                  /* set the user data */
-    for (i = 0; i < 6; i++)                                                                      /* 6 times */
-    {
-        data[i] = key_a[i];                                                                      /* copy the key a */
-    }
-    for (i = 0; i < 4; i++)                                                                      /* 4 times */
-    {
-        data[i + 6] = access_bits[i];                                                            /* copy the access bits */
-    }
-    for (i = 0; i < 6; i++)                                                                      /* 6 times */
-    {
-        data[i + 10] = key_b[i];                                                                 /* copy the key b */
-    }
-    
-    if (sector < 32)                                                                             /* check the size*/
-    {
-        block = sector * 4;                                                                      /* s50 */
-    }
-    else
+    res = a_mifare_classic_async_check(handle);                                     /* check the handle */
+    if (res != 0)                                                                   /* check the result */
     {
-        block = 32 * 4 + (sector - 32) * 16;                                                     /* s70 */
+        return res;                                                                 /* return error */
     }
-    block = block + ((sector < 32) ? 4 : 16) - 1;                                                /* get the last block */
     
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_WRITE;                                          /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf, 2, input_buf + 2);                                 /* get the crc */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_len != 1)                                                                         /* check the output_len */
-    {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
+    if (a_mifare_classic_sector_check(handle, sector) != 0)                         /* check the sector */
     {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
+        return 6;                                                                   /* return error */
     }
     
-    for (i = 0; i < 16; i ++)                                                                    /* 16 times */
-    {
-        input_buf[i] = data[i];                                                                  /* copy data */
-    }
-    a_mifare_classic_iso14443a_crc(input_buf, 16, input_buf + 16);                               /* get the crc */
-    input_len = 18;                                                                              /* set the input length */
-    output_len = 1;                                                                              /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
-    {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
-        
-        return 1;                                                                                /* return error */
-    }
-    if (output_buf[0] != 0xA)                                                                    /* check the result */
-    {
-        handle->debug_print("mifare_classic: ack error.\n");                                     /* ack error */
-        
-        return 5;                                                                                /* return error */
-    }
+    op = &handle->async_operation;                                                  /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION,
+                                    a_mifare_classic_trailer_block(sector));        /* init the operation */
+    a_mifare_classic_trailer_encode(key_a, block_0_0_4, block_1_5_9, block_2_10_14,
+                                    block_3_15, user_data, key_b, op->data);        /* encode the trailer */
     
-    return 0;                                                                                    /* success return 0 */
+    return a_mifare_classic_async_start(handle);                                    /* start the operation */
 }
 
 /**
- * @brief      mifare get the sector permission
+ * @brief      mifare async get the sector permission
  * @param[in]  *handle pointer to a mifare_classic handle structure
  * @param[in]  sector get sector
  * @param[out] *block_0_0_4 pointer to a block0(block0-4) permission buffer
@@ -1872,119 +4829,119 @@ uint8_t mifare_classic_set_sector_permission(mifare_classic_handle_t *handle,
  * @param[out] *key_b pointer to a key b buffer
  * @return     status code
  *             - 0 success
- *             - 1 get sector permission failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- *             - 4 output_len is invalid
- *             - 5 crc error
- *             - 6 data is invalid
- * @note       none
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ *             - 6 sector is invalid
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
  */
-uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
-                                             uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
-                                             uint8_t *block_2_10_14, uint8_t *block_3_15,
-                                             uint8_t *user_data, uint8_t key_b[6])
+uint8_t mifare_classic_async_get_sector_permission(mifare_classic_handle_t *handle,
+                                                   uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                                   uint8_t *block_2_10_14, uint8_t *block_3_15,
+                                                   uint8_t *user_data, uint8_t key_b[6])
 {
     uint8_t res;
-    uint8_t i;
-    uint8_t block;
-    uint8_t input_len;
-    uint8_t input_buf[4];
-    uint8_t output_len;
-    uint8_t output_buf[18];
-    uint8_t crc_buf[2];
-    uint8_t data[16];
-    uint8_t access_bits[4];
+    mifare_classic_operation_t *op;
     
-    if (handle == NULL)                                                                          /* check handle */
+    res = a_mifare_classic_async_check(handle);                                     /* check the handle */
+    if (res != 0)                                                                   /* check the result */
     {
-        return 2;                                                                                /* return error */
+        return res;                                                                 /* return error */
     }
-    if (handle->inited != 1)                                                                     /* check handle initialization */
+    
+    if (a_mifare_classic_sector_check(handle, sector) != 0)                         /* check the sector */
     {
-        return 3;                                                                                /* return error */
+        return 6;                                                                   /* return error */
     }
     
-    if (sector < 32)                                                                             /* check the size*/
+    op = &handle->async_operation;                                                  /* get the operation */
+    a_mifare_classic_operation_init(op, MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION,
+                                    a_mifare_classic_trailer_block(sector));        /* init the operation */
+    op->output[0] = block_0_0_4;                                                    /* set the block_0_0_4 buffer */
+    op->output[1] = block_1_5_9;                                                    /* set the block_1_5_9 buffer */
+    op->output[2] = block_2_10_14;                                                  /* set the block_2_10_14 buffer */
+    op->output[3] = block_3_15;                                                     /* set the block_3_15 buffer */
+    op->output[4] = user_data;                                                      /* set the user data buffer */
+    op->output[5] = key_b;                                                          /* set the key b buffer */
+    
+    return a_mifare_classic_async_start(handle);                                    /* start the operation */
+}
+
+/**
+ * @brief     mifare async complete
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] res transceiver result
+ * @param[in] out_len received length
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 no operation is busy
+ * @note      call it when the exchange started by contactless_submit is finished,
+ *            res is 0 when the card answered and out_len is the received length
+ */
+uint8_t mifare_classic_async_complete(mifare_classic_handle_t *handle, uint8_t res, uint8_t out_len)
+{
+    mifare_classic_operation_t *op;
+    
+    if (handle == NULL)                                                        /* check handle */
     {
-        block = sector * 4;                                                                      /* s50 */
+        return 2;                                                              /* return error */
     }
-    else
+    if (handle->inited != 1)                                                   /* check handle initialization */
     {
-        block = 32 * 4 + (sector - 32) * 16;                                                     /* s70 */
+        return 3;                                                              /* return error */
     }
-    block = block + ((sector < 32) ? 4 : 16) - 1;                                                /* get the last block */
-    
-    input_len = 4;                                                                               /* set the input length */
-    input_buf[0] = MIFARE_CLASSIC_COMMAND_MIFARE_READ;                                           /* set the command */
-    input_buf[1] = block;                                                                        /* set the block */
-    a_mifare_classic_iso14443a_crc(input_buf , 2, input_buf + 2);                                /* get the crc */
-    output_len = 18;                                                                             /* set the output length */
-    res = handle->contactless_transceiver(input_buf, input_len, output_buf, &output_len);        /* transceiver */
-    if (res != 0)                                                                                /* check the result */
+    if (handle->async_status != MIFARE_CLASSIC_ASYNC_STATUS_BUSY)              /* check the status */
     {
-        handle->debug_print("mifare_classic: contactless transceiver failed.\n");                /* contactless transceiver failed */
+        MIFARE_CLASSIC_LOG_ERROR(handle, NO_OPERATION_BUSY, 0);                /* no operation is busy */
         
-        return 1;                                                                                /* return error */
+        return 4;                                                              /* return error */
     }
-    if (output_len != 18)                                                                        /* check the output_len */
+    
+    op = &handle->async_operation;                                             /* get the operation */
+    op->out_len = out_len;                                                     /* set the received length */
+    if (a_mifare_classic_operation_reply(handle, op, res) != 0)                /* handle the reply */
     {
-        handle->debug_print("mifare_classic: output_len is invalid.\n");                         /* output_len is invalid */
-        
-        return 4;                                                                                /* return error */
+        a_mifare_classic_async_finish(handle);                                 /* finish the operation */
     }
-    a_mifare_classic_iso14443a_crc(output_buf, 16, crc_buf);                                     /* get the crc */
-    if ((output_buf[16] == crc_buf[0]) && (output_buf[17] == crc_buf[1]))                        /* check the crc */
+    else
     {
-        uint8_t part_1;
-        uint8_t part_2;
-        uint8_t part_3;
-        uint8_t part_1_r;
-        uint8_t part_2_r;
-        uint8_t part_3_r;
-        
-        memcpy(data, output_buf, 16);                                                            /* copy the data */
-        
-        for (i = 0; i < 6; i++)                                                                  /* 6 times */
-        {
-            key_b[i] = data[10 + i];                                                             /* copy the key b */
-        }
-        for (i = 0; i < 4; i++)                                                                  /* 4 times */
-        {
-            access_bits[i] = data[6 + i];                                                        /* copy the access bits */
-        }
-        part_2_r = (access_bits[0] >> 4) & 0xF;                                                  /* get the part2 revert */
-        part_1_r = (access_bits[0] >> 0) & 0xF;                                                  /* get the part1 revert */
-        part_1 = (access_bits[1] >> 4) & 0xF;                                                    /* get the part1 */
-        part_3_r = (access_bits[1] >> 0) & 0xF;                                                  /* get the part3 revert */
-        part_3 = (access_bits[2] >> 4) & 0xF;                                                    /* get the part3 */
-        part_2 = (access_bits[2] >> 0) & 0xF;                                                    /* get the part2 */
-        if (((part_1 + part_1_r) != 0xF) ||
-            ((part_2 + part_2_r) != 0xF) ||
-            ((part_3 + part_3_r) != 0xF))                                                        /* check the param */
-        {
-            handle->debug_print("mifare_classic: data is invalid.\n");                           /* data is invalid */
-            
-            return 6;                                                                            /* return error */
-        }
-        *block_0_0_4 = (((part_1 >> 0) & 0x01) << 2) | (((part_2 >> 0) & 0x01) << 1) |
-                       (((part_3 >> 0) & 0x01) << 0);                                            /* get the block_0_0_4 */
-        *block_1_5_9 = (((part_1 >> 1) & 0x01) << 2) | (((part_2 >> 1) & 0x01) << 1) |
-                       (((part_3 >> 1) & 0x01) << 0);                                            /* get the block_1_5_9 */
-        *block_2_10_14 = (((part_1 >> 2) & 0x01) << 2) | (((part_2 >> 2) & 0x01) << 1) |
-                         (((part_3 >> 2) & 0x01) << 0);                                          /* get the block_2_10_14 */
-        *block_3_15 = (((part_1 >> 3) & 0x01) << 2) | (((part_2 >> 3) & 0x01) << 1) |
-                      (((part_3 >> 3) & 0x01) << 0);                                             /* get the block_3_15 */
-        *user_data = access_bits[3];                                                             /* get the access bits */
-        
-        return 0;                                                                                /* success return 0 */
+        op->phase++;                                                           /* next phase */
+        a_mifare_classic_async_submit(handle);                                 /* submit the next phase */
     }
-    else
+    
+    return 0;                                                                  /* success return 0 */
+}
+
+/**
+ * @brief      mifare async poll
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *status pointer to a status buffer
+ * @param[out] *result pointer to a result buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       result is the status code of the sync function and is valid when status is done
+ */
+uint8_t mifare_classic_async_poll(mifare_classic_handle_t *handle, mifare_classic_async_status_t *status, uint8_t *result)
+{
+    if (handle == NULL)                                                     /* check handle */
     {
-        handle->debug_print("mifare_classic: crc error.\n");                                     /* crc error */
-        
-        return 5;                                                                                /* return error */
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
     }
+    
+    *status = (mifare_classic_async_status_t)(handle->async_status);        /* get the status */
+    *result = handle->async_operation.res;                                  /* get the result */
+    
+    return 0;                                                               /* success return 0 */
 }
 
 /**
@@ -2001,24 +4958,53 @@ uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
  */
 uint8_t mifare_classic_transceiver(mifare_classic_handle_t *handle, uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
 {
-    if (handle == NULL)                                                /* check handle */
+    if (handle == NULL)                                                         /* check handle */
     {
-        return 2;                                                      /* return error */
+        return 2;                                                               /* return error */
     }
-    if (handle->inited != 1)                                           /* check handle initialization */
+    if (handle->inited != 1)                                                    /* check handle initialization */
     {
-        return 3;                                                      /* return error */
+        return 3;                                                               /* return error */
     }
     
-    if (handle->contactless_transceiver(in_buf, in_len, 
-                                        out_buf, out_len) != 0)        /* transceiver data */
+    handle->auth_valid = 0;                                                     /* the card state is unknown */
+    handle->state = MIFARE_CLASSIC_CARD_STATE_UNKNOWN;                          /* no local check */
+    if (a_mifare_classic_contactless_transceiver(handle, in_buf, in_len, 
+                                                 out_buf, out_len) != 0)        /* transceiver data */
     {
-        return 1;                                                      /* return error */
+        return 1;                                                               /* return error */
     }
     else
     {
-        return 0;                                                      /* success return 0 */
+        return 0;                                                               /* success return 0 */
+    }
+}
+
+/**
+ * @brief      calculate the iso14443a crc
+ * @param[in]  *buf pointer to a data buffer
+ * @param[in]  len data length
+ * @param[out] *crc pointer to a crc buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 len is invalid
+ *             - 2 buf is NULL
+ * @note       crc[0] is the lsb and crc[1] is the msb
+ */
+uint8_t mifare_classic_crc(uint8_t *buf, uint8_t len, uint8_t crc[2])
+{
+    if ((buf == NULL) || (crc == NULL))                                /* check buf */
+    {
+        return 2;                                                      /* return error */
+    }
+    if (len == 0)                                                      /* check len */
+    {
+        return 1;                                                      /* return error */
     }
+    
+    a_mifare_classic_iso14443a_crc(buf, len, crc);                     /* get the crc */
+    
+    return 0;                                                          /* success return 0 */
 }
 
 /**
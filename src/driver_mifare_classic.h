@@ -56,6 +56,77 @@ extern "C"{
  * @{
  */
 
+/**
+ * @brief mifare_classic crc engine definition
+ */
+#define MIFARE_CLASSIC_CRC_ENGINE_BITWISE         0        /**< one byte per loop with shift and xor */
+#define MIFARE_CLASSIC_CRC_ENGINE_TABLE           1        /**< one byte per loop with a 256 entries table */
+#define MIFARE_CLASSIC_CRC_ENGINE_SLICING_BY_4    2        /**< four bytes per loop with four 256 entries tables */
+
+/**
+ * @brief mifare_classic crc engine selection
+ * @note  define it before including this file or in the compiler options to change the engine
+ */
+#ifndef MIFARE_CLASSIC_CRC_ENGINE
+    #define MIFARE_CLASSIC_CRC_ENGINE    MIFARE_CLASSIC_CRC_ENGINE_TABLE        /**< table engine by default */
+#endif
+#if ((MIFARE_CLASSIC_CRC_ENGINE != MIFARE_CLASSIC_CRC_ENGINE_BITWISE) && \
+     (MIFARE_CLASSIC_CRC_ENGINE != MIFARE_CLASSIC_CRC_ENGINE_TABLE) && \
+     (MIFARE_CLASSIC_CRC_ENGINE != MIFARE_CLASSIC_CRC_ENGINE_SLICING_BY_4))
+    #error "MIFARE_CLASSIC_CRC_ENGINE must be 0, 1 or 2"
+#endif
+
+/**
+ * @brief mifare_classic latency instrumentation selection
+ * @note  define it as 1 before including this file or in the compiler options to build the instrumentation,
+ *        all instrumentation code and fields are left out when it is 0
+ */
+#ifndef MIFARE_CLASSIC_STATS
+    #define MIFARE_CLASSIC_STATS    0        /**< disabled by default */
+#endif
+
+/**
+ * @brief mifare_classic log level definition
+ */
+#define MIFARE_CLASSIC_LOG_LEVEL_NONE     0        /**< no log, all log calls and strings are left out */
+#define MIFARE_CLASSIC_LOG_LEVEL_ERROR    1        /**< only the usage errors of the api */
+#define MIFARE_CLASSIC_LOG_LEVEL_DEBUG    2        /**< usage errors and card errors */
+
+/**
+ * @brief mifare_classic log level selection
+ * @note  define it before including this file or in the compiler options to change the level,
+ *        the log calls above the level and their strings are left out of the build
+ */
+#ifndef MIFARE_CLASSIC_LOG_LEVEL
+    #define MIFARE_CLASSIC_LOG_LEVEL    MIFARE_CLASSIC_LOG_LEVEL_DEBUG        /**< debug level by default */
+#endif
+
+/**
+ * @brief mifare_classic deferred log selection
+ * @note  define it as 1 before including this file or in the compiler options to record the log events
+ *        in the handle instead of printing them, they are printed later by mifare_classic_log_flush
+ */
+#ifndef MIFARE_CLASSIC_LOG_DEFERRED
+    #define MIFARE_CLASSIC_LOG_DEFERRED    0        /**< disabled by default */
+#endif
+
+/**
+ * @brief mifare_classic deferred log depth
+ * @note  the oldest event is overwritten when the ring is full, the depth must be less than 256
+ */
+#ifndef MIFARE_CLASSIC_LOG_DEPTH
+    #define MIFARE_CLASSIC_LOG_DEPTH    16        /**< 16 events by default */
+#endif
+
+/**
+ * @brief mifare_classic bool enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_BOOL_FALSE = 0x00,        /**< false */
+    MIFARE_CLASSIC_BOOL_TRUE  = 0x01,        /**< true */
+} mifare_classic_bool_t;
+
 /**
  * @brief mifare_classic type enumeration definition
  */
@@ -99,19 +170,280 @@ typedef enum
     MIFARE_CLASSIC_AUTHENTICATION_KEY_B = 0x01,        /**< authentication key b */
 } mifare_classic_authentication_key_t;
 
+/**
+ * @brief mifare_classic key structure definition
+ */
+typedef struct mifare_classic_key_s
+{
+    uint8_t key_type;        /**< authentication key type */
+    uint8_t key[6];          /**< key */
+} mifare_classic_key_t;
+
+/**
+ * @brief mifare_classic cascade tag definition
+ */
+#define MIFARE_CLASSIC_CASCADE_TAG    0x88        /**< first byte of an incomplete cascade level */
+
+/**
+ * @brief mifare_classic uid structure definition
+ */
+typedef struct mifare_classic_uid_s
+{
+    uint8_t uid[10];        /**< uid */
+    uint8_t len;            /**< uid length, 4 or 7 */
+    uint8_t sak;            /**< sak of the last cascade level */
+} mifare_classic_uid_t;
+
+/**
+ * @brief mifare_classic operation type enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_OPERATION_NONE                  = 0x00,        /**< no operation */
+    MIFARE_CLASSIC_OPERATION_REQUEST               = 0x01,        /**< request */
+    MIFARE_CLASSIC_OPERATION_WAKE_UP               = 0x02,        /**< wake up */
+    MIFARE_CLASSIC_OPERATION_HALT                  = 0x03,        /**< halt */
+    MIFARE_CLASSIC_OPERATION_SET_MODULATION        = 0x04,        /**< set modulation */
+    MIFARE_CLASSIC_OPERATION_SET_PERSONALIZED_UID  = 0x05,        /**< set personalized uid */
+    MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL1     = 0x06,        /**< anti collision cl1 */
+    MIFARE_CLASSIC_OPERATION_ANTICOLLISION_CL2     = 0x07,        /**< anti collision cl2 */
+    MIFARE_CLASSIC_OPERATION_SELECT_CL1            = 0x08,        /**< select cl1 */
+    MIFARE_CLASSIC_OPERATION_SELECT_CL2            = 0x09,        /**< select cl2 */
+    MIFARE_CLASSIC_OPERATION_AUTHENTICATION        = 0x0A,        /**< authentication */
+    MIFARE_CLASSIC_OPERATION_READ                  = 0x0B,        /**< read */
+    MIFARE_CLASSIC_OPERATION_WRITE                 = 0x0C,        /**< write */
+    MIFARE_CLASSIC_OPERATION_VALUE_INIT            = 0x0D,        /**< value init */
+    MIFARE_CLASSIC_OPERATION_VALUE_WRITE           = 0x0E,        /**< value write */
+    MIFARE_CLASSIC_OPERATION_VALUE_READ            = 0x0F,        /**< value read */
+    MIFARE_CLASSIC_OPERATION_INCREMENT             = 0x10,        /**< increment */
+    MIFARE_CLASSIC_OPERATION_DECREMENT             = 0x11,        /**< decrement */
+    MIFARE_CLASSIC_OPERATION_TRANSFER              = 0x12,        /**< transfer */
+    MIFARE_CLASSIC_OPERATION_RESTORE               = 0x13,        /**< restore */
+    MIFARE_CLASSIC_OPERATION_SET_SECTOR_PERMISSION = 0x14,        /**< set sector permission */
+    MIFARE_CLASSIC_OPERATION_GET_SECTOR_PERMISSION = 0x15,        /**< get sector permission */
+} mifare_classic_operation_type_t;
+
+/**
+ * @brief mifare_classic update outcome enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_UPDATE_UNCHANGED = 0x00,        /**< block equals the last image and is not written */
+    MIFARE_CLASSIC_UPDATE_WRITTEN   = 0x01,        /**< block is written */
+    MIFARE_CLASSIC_UPDATE_FAILED    = 0x02,        /**< no key opens the sector or the write failed */
+    MIFARE_CLASSIC_UPDATE_SKIPPED   = 0x03,        /**< manufacturer block or sector trailer is never written */
+} mifare_classic_update_outcome_t;
+
+/**
+ * @brief mifare_classic async status enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_ASYNC_STATUS_IDLE = 0x00,        /**< no operation */
+    MIFARE_CLASSIC_ASYNC_STATUS_BUSY = 0x01,        /**< operation is running */
+    MIFARE_CLASSIC_ASYNC_STATUS_DONE = 0x02,        /**< operation is done */
+} mifare_classic_async_status_t;
+
+/**
+ * @brief mifare_classic card state enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_CARD_STATE_IDLE          = 0x00,        /**< no selected card */
+    MIFARE_CLASSIC_CARD_STATE_READY         = 0x01,        /**< card answered the request */
+    MIFARE_CLASSIC_CARD_STATE_ACTIVE        = 0x02,        /**< card is selected */
+    MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED = 0x03,        /**< one sector is authenticated */
+    MIFARE_CLASSIC_CARD_STATE_HALT          = 0x04,        /**< card is halted */
+    MIFARE_CLASSIC_CARD_STATE_UNKNOWN       = 0x05,        /**< raw frames are sent and nothing is checked */
+} mifare_classic_card_state_t;
+
+/**
+ * @brief mifare_classic operation structure definition
+ */
+typedef struct mifare_classic_operation_s
+{
+    uint8_t type;              /**< operation type */
+    uint8_t phase;             /**< current phase */
+    uint8_t block;             /**< block or command argument */
+    uint8_t arg;               /**< extra argument */
+    uint8_t data[16];          /**< payload, key and id or uid */
+    uint8_t in_buf[18];        /**< frame buffer */
+    uint8_t in_len;            /**< frame length */
+    uint8_t out_buf[18];       /**< reply buffer */
+    uint8_t out_len;           /**< reply length */
+    void *output[6];           /**< caller output buffers */
+    uint8_t res;               /**< operation result */
+} mifare_classic_operation_t;
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief mifare_classic statistics size definition
+ */
+#define MIFARE_CLASSIC_STATS_MAX_RES      8         /**< failures are counted by return code, larger codes are counted as 7 */
+#define MIFARE_CLASSIC_STATS_HISTOGRAM    24        /**< latency buckets, bucket n holds 2^(n-1) us to 2^n - 1 us */
+
+/**
+ * @brief mifare_classic statistics command enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_STATS_COMMAND_REQUEST        = 0x00,        /**< request and wake up */
+    MIFARE_CLASSIC_STATS_COMMAND_ANTICOLLISION  = 0x01,        /**< anti collision of all cascade levels */
+    MIFARE_CLASSIC_STATS_COMMAND_SELECT         = 0x02,        /**< select of all cascade levels */
+    MIFARE_CLASSIC_STATS_COMMAND_AUTHENTICATION = 0x03,        /**< authentication */
+    MIFARE_CLASSIC_STATS_COMMAND_READ           = 0x04,        /**< read, value read and get sector permission */
+    MIFARE_CLASSIC_STATS_COMMAND_WRITE          = 0x05,        /**< write and set sector permission */
+    MIFARE_CLASSIC_STATS_COMMAND_VALUE          = 0x06,        /**< value init, value write, increment, decrement, transfer and restore */
+    MIFARE_CLASSIC_STATS_COMMAND_HALT           = 0x07,        /**< halt */
+    MIFARE_CLASSIC_STATS_COMMAND_OTHER          = 0x08,        /**< set modulation and set personalized uid */
+    MIFARE_CLASSIC_STATS_COMMAND_MAX            = 0x09,        /**< command number */
+} mifare_classic_stats_command_t;
+
+/**
+ * @brief mifare_classic statistics entry structure definition
+ */
+typedef struct mifare_classic_stats_entry_s
+{
+    uint32_t count;                                              /**< call counter */
+    uint32_t failure[MIFARE_CLASSIC_STATS_MAX_RES];              /**< failure counter by return code, failure[0] is unused */
+    uint32_t timed;                                              /**< counter of the calls with a latency */
+    uint32_t min_us;                                             /**< min latency */
+    uint32_t max_us;                                             /**< max latency */
+    uint64_t sum_us;                                             /**< latency sum */
+    uint32_t histogram[MIFARE_CLASSIC_STATS_HISTOGRAM];          /**< latency histogram */
+} mifare_classic_stats_entry_t;
+
+/**
+ * @brief mifare_classic statistics structure definition
+ */
+typedef struct mifare_classic_stats_s
+{
+    mifare_classic_stats_entry_t command[MIFARE_CLASSIC_STATS_COMMAND_MAX];        /**< entry of each command */
+    uint32_t crc_error;                                                            /**< crc error counter */
+} mifare_classic_stats_t;
+
+#endif
+
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+
+/**
+ * @brief mifare_classic log event enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_EVENT_TRANSCEIVER_FAILED           = 0x01,        /**< contactless transceiver failed */
+    MIFARE_CLASSIC_EVENT_OUTPUT_LEN_INVALID           = 0x02,        /**< output_len is invalid */
+    MIFARE_CLASSIC_EVENT_CRC_ERROR                    = 0x03,        /**< crc error */
+    MIFARE_CLASSIC_EVENT_ACK_ERROR                    = 0x04,        /**< ack error */
+    MIFARE_CLASSIC_EVENT_INVALID_OPERATION            = 0x05,        /**< invalid operation */
+    MIFARE_CLASSIC_EVENT_TYPE_INVALID                 = 0x06,        /**< type is invalid */
+    MIFARE_CLASSIC_EVENT_SAK_ERROR                    = 0x07,        /**< sak error */
+    MIFARE_CLASSIC_EVENT_CHECK_ERROR                  = 0x08,        /**< check error */
+    MIFARE_CLASSIC_EVENT_COLLISION_NOT_RESOLVED       = 0x09,        /**< collision is not resolved */
+    MIFARE_CLASSIC_EVENT_AUTHENTICATION_FAILED        = 0x0A,        /**< authentication failed */
+    MIFARE_CLASSIC_EVENT_VALUE_INVALID                = 0x0B,        /**< value is invalid */
+    MIFARE_CLASSIC_EVENT_BLOCK_INVALID                = 0x0C,        /**< block is invalid */
+    MIFARE_CLASSIC_EVENT_DATA_INVALID                 = 0x0D,        /**< data is invalid */
+    MIFARE_CLASSIC_EVENT_STATE_INVALID                = 0x0E,        /**< state is invalid */
+    MIFARE_CLASSIC_EVENT_UID_TOO_LONG                 = 0x0F,        /**< uid is too long */
+    MIFARE_CLASSIC_EVENT_MAX_INVALID                  = 0x10,        /**< max is invalid */
+    MIFARE_CLASSIC_EVENT_SECTOR_INVALID               = 0x11,        /**< sector is invalid */
+    MIFARE_CLASSIC_EVENT_KEY_SET_INVALID              = 0x12,        /**< key set is invalid */
+    MIFARE_CLASSIC_EVENT_OPERATION_BUSY               = 0x13,        /**< operation is busy */
+    MIFARE_CLASSIC_EVENT_NO_OPERATION_BUSY            = 0x14,        /**< no operation is busy */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_INIT_NULL        = 0x15,        /**< contactless_init is null */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_DEINIT_NULL      = 0x16,        /**< contactless_deinit is null */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_TRANSCEIVER_NULL = 0x17,        /**< contactless_transceiver is null */
+    MIFARE_CLASSIC_EVENT_DELAY_MS_NULL                = 0x18,        /**< delay_ms is null */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_SUBMIT_NULL      = 0x19,        /**< contactless_submit is null */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_INIT_FAILED      = 0x1A,        /**< contactless init failed */
+    MIFARE_CLASSIC_EVENT_CONTACTLESS_DEINIT_FAILED    = 0x1B,        /**< contactless deinit failed */
+    MIFARE_CLASSIC_EVENT_MAX                          = 0x1C,        /**< event number */
+} mifare_classic_log_event_t;
+
+/**
+ * @brief mifare_classic log entry structure definition
+ */
+typedef struct mifare_classic_log_entry_s
+{
+    uint8_t event;        /**< log event */
+    uint8_t arg;          /**< event argument, the operation type in the command paths */
+} mifare_classic_log_entry_t;
+
+#endif
+
+/**
+ * @brief mifare_classic batch max frame definition
+ */
+#define MIFARE_CLASSIC_BATCH_MAX_FRAME    2        /**< command and data frame */
+
+/**
+ * @brief mifare_classic frame structure definition
+ */
+typedef struct mifare_classic_frame_s
+{
+    uint8_t *in_buf;         /**< input buffer */
+    uint8_t in_len;          /**< input length */
+    uint8_t *out_buf;        /**< output buffer */
+    uint8_t out_len;         /**< expected length before the run, received length after the run */
+    uint8_t res;             /**< frame result, 0 means answered or no answer is expected */
+} mifare_classic_frame_t;
+
 /**
  * @brief mifare_classic handle structure definition
  */
 typedef struct mifare_classic_handle_s
 {
-    uint8_t (*contactless_init)(void);                                             /**< point to a contactless_init function address */
-    uint8_t (*contactless_deinit)(void);                                           /**< point to a contactless_deinit function address */
+    uint8_t (*contactless_init)(void);                                                                      /**< point to a contactless_init function address */
+    uint8_t (*contactless_deinit)(void);                                                                    /**< point to a contactless_deinit function address */
     uint8_t (*contactless_transceiver)(uint8_t *in_buf, uint8_t in_len, 
-                                       uint8_t *out_buf, uint8_t *out_len);        /**< point to a contactless_transceiver function address */
-    void (*delay_ms)(uint32_t ms);                                                 /**< point to a delay_ms function address */
-    void (*debug_print)(const char *const fmt, ...);                               /**< point to a debug_print function address */
-    uint8_t type;                                                                  /**< classic type */
-    uint8_t inited;                                                                /**< inited flag */
+                                       uint8_t *out_buf, uint8_t *out_len);                                 /**< point to a contactless_transceiver function address */
+    void (*delay_ms)(uint32_t ms);                                                                          /**< point to a delay_ms function address */
+    void (*debug_print)(const char *const fmt, ...);                                                        /**< point to a debug_print function address */
+    uint8_t (*contactless_submit)(uint8_t *in_buf, uint8_t in_len, 
+                                  uint8_t *out_buf, uint8_t out_len);                                       /**< point to a contactless_submit function address */
+    uint8_t (*contactless_batch)(mifare_classic_frame_t *frame, uint8_t count);                             /**< point to a contactless_batch function address */
+    uint8_t (*contactless_bit_transceiver)(uint8_t *in_buf, uint8_t in_bits, 
+                                           uint8_t *out_buf, uint8_t *out_bits, uint8_t *collision);        /**< point to a contactless_bit_transceiver function address */
+    void (*async_callback)(mifare_classic_operation_type_t type, uint8_t res);                              /**< point to an async_callback function address */
+    void *context;                                                                                          /**< user context passed to the context callbacks */
+    uint8_t (*contactless_init_ctx)(void *context);                                                         /**< point to a contactless_init_ctx function address */
+    uint8_t (*contactless_deinit_ctx)(void *context);                                                       /**< point to a contactless_deinit_ctx function address */
+    uint8_t (*contactless_transceiver_ctx)(void *context, uint8_t *in_buf, uint8_t in_len, 
+                                           uint8_t *out_buf, uint8_t *out_len);                             /**< point to a contactless_transceiver_ctx function address */
+    uint8_t (*contactless_submit_ctx)(void *context, uint8_t *in_buf, uint8_t in_len, 
+                                      uint8_t *out_buf, uint8_t out_len);                                   /**< point to a contactless_submit_ctx function address */
+    uint8_t (*contactless_batch_ctx)(void *context, mifare_classic_frame_t *frame, uint8_t count);          /**< point to a contactless_batch_ctx function address */
+    uint8_t (*contactless_bit_transceiver_ctx)(void *context, uint8_t *in_buf, uint8_t in_bits, uint8_t *out_buf, 
+                                               uint8_t *out_bits, uint8_t *collision);                      /**< point to a contactless_bit_transceiver_ctx function address */
+    void (*async_callback_ctx)(void *context, mifare_classic_operation_type_t type, uint8_t res);           /**< point to an async_callback_ctx function address */
+#if (MIFARE_CLASSIC_STATS != 0)
+    uint32_t (*timestamp_us)(void);                                                                         /**< point to a timestamp_us function address */
+#endif
+    uint8_t type;                                                                                           /**< classic type */
+    uint8_t inited;                                                                                         /**< inited flag */
+    uint8_t crc_offload;                                                                                    /**< reader crc offload flag */
+    uint8_t async_status;                                                                                   /**< async status */
+    uint8_t state;                                                                                          /**< iso14443 card state */
+    uint8_t auth_cache;                                                                                     /**< authentication session cache flag */
+    uint8_t auth_valid;                                                                                     /**< authentication session valid flag */
+    uint8_t auth_sector;                                                                                    /**< authenticated sector */
+    uint8_t auth_key_type;                                                                                  /**< authenticated key type */
+    uint8_t auth_key[6];                                                                                    /**< authenticated key */
+    uint8_t auth_id[4];                                                                                     /**< authenticated card id */
+    mifare_classic_uid_t uid;                                                                               /**< last selected uid */
+    mifare_classic_operation_t async_operation;                                                             /**< async operation */
+#if (MIFARE_CLASSIC_STATS != 0)
+    uint32_t stats_start_us;                                                                                /**< start time of the async operation */
+    mifare_classic_stats_t stats;                                                                           /**< latency statistics */
+#endif
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+    mifare_classic_log_entry_t log[MIFARE_CLASSIC_LOG_DEPTH];                                               /**< deferred log ring */
+    uint8_t log_head;                                                                                       /**< index of the oldest event */
+    uint8_t log_count;                                                                                      /**< event number in the ring */
+    uint32_t log_dropped;                                                                                   /**< overwritten event counter */
+#endif
 } mifare_classic_handle_t;
 
 /**
@@ -147,7 +479,7 @@ typedef struct mifare_classic_info_s
  * @param[in] STRUCTURE mifare_classic_handle_t
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_INIT(HANDLE, STRUCTURE)                  memset(HANDLE, 0, sizeof(STRUCTURE))
+#define DRIVER_MIFARE_CLASSIC_LINK_INIT(HANDLE, STRUCTURE)                         memset(HANDLE, 0, sizeof(STRUCTURE))
 
 /**
  * @brief     link contactless_init function
@@ -155,7 +487,7 @@ typedef struct mifare_classic_info_s
  * @param[in] FUC pointer to a contactless_init function address
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(HANDLE, FUC)           (HANDLE)->contactless_init = FUC
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(HANDLE, FUC)                   (HANDLE)->contactless_init = FUC
 
 /**
  * @brief     link contactless_deinit function
@@ -163,7 +495,7 @@ typedef struct mifare_classic_info_s
  * @param[in] FUC pointer to a contactless_deinit function address
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(HANDLE, FUC)         (HANDLE)->contactless_deinit = FUC
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(HANDLE, FUC)                 (HANDLE)->contactless_deinit = FUC
 
 /**
  * @brief     link contactless_transceiver function
@@ -171,7 +503,7 @@ typedef struct mifare_classic_info_s
  * @param[in] FUC pointer to a contactless_transceiver function address
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(HANDLE, FUC)    (HANDLE)->contactless_transceiver = FUC
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(HANDLE, FUC)            (HANDLE)->contactless_transceiver = FUC
 
 /**
  * @brief     link delay_ms function
@@ -179,7 +511,7 @@ typedef struct mifare_classic_info_s
  * @param[in] FUC pointer to a delay_ms function address
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(HANDLE, FUC)                   (HANDLE)->delay_ms = FUC
+#define DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(HANDLE, FUC)                           (HANDLE)->delay_ms = FUC
 
 /**
  * @brief     link debug_print function
@@ -187,7 +519,117 @@ typedef struct mifare_classic_info_s
  * @param[in] FUC pointer to a debug_print function address
  * @note      none
  */
-#define DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(HANDLE, FUC)                (HANDLE)->debug_print = FUC
+#define DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(HANDLE, FUC)                        (HANDLE)->debug_print = FUC
+
+/**
+ * @brief     link contactless_submit function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_submit function address
+ * @note      it starts an exchange and returns at once, the port calls mifare_classic_async_complete when it ends
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_SUBMIT(HANDLE, FUC)                 (HANDLE)->contactless_submit = FUC
+
+/**
+ * @brief     link contactless_batch function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_batch function address
+ * @note      it is optional, the multi-phase commands send all frames in one submission when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BATCH(HANDLE, FUC)                  (HANDLE)->contactless_batch = FUC
+
+/**
+ * @brief     link contactless_bit_transceiver function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_bit_transceiver function address
+ * @note      it is optional and sends in_bits bits, the received bits continue the last sent byte,
+ *            collision is the index of the first collided received bit and equals out_bits without collision
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER(HANDLE, FUC)        (HANDLE)->contactless_bit_transceiver = FUC
+
+/**
+ * @brief     link the user context
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] CONTEXT pointer to a user context
+ * @note      it is passed to every context callback, so one set of callbacks can serve several readers
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(HANDLE, CONTEXT)                        (HANDLE)->context = CONTEXT
+
+/**
+ * @brief     link contactless_init_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_init_ctx function address
+ * @note      it is used instead of contactless_init when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT_CTX(HANDLE, FUC)               (HANDLE)->contactless_init_ctx = FUC
+
+/**
+ * @brief     link contactless_deinit_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_deinit_ctx function address
+ * @note      it is used instead of contactless_deinit when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT_CTX(HANDLE, FUC)             (HANDLE)->contactless_deinit_ctx = FUC
+
+/**
+ * @brief     link contactless_transceiver_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_transceiver_ctx function address
+ * @note      it is used instead of contactless_transceiver when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER_CTX(HANDLE, FUC)        (HANDLE)->contactless_transceiver_ctx = FUC
+
+/**
+ * @brief     link contactless_submit_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_submit_ctx function address
+ * @note      it is used instead of contactless_submit when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_SUBMIT_CTX(HANDLE, FUC)             (HANDLE)->contactless_submit_ctx = FUC
+
+/**
+ * @brief     link contactless_batch_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_batch_ctx function address
+ * @note      it is used instead of contactless_batch when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BATCH_CTX(HANDLE, FUC)              (HANDLE)->contactless_batch_ctx = FUC
+
+/**
+ * @brief     link contactless_bit_transceiver_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a contactless_bit_transceiver_ctx function address
+ * @note      it is used instead of contactless_bit_transceiver when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER_CTX(HANDLE, FUC)    (HANDLE)->contactless_bit_transceiver_ctx = FUC
+
+/**
+ * @brief     link async_callback function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to an async_callback function address
+ * @note      none
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_ASYNC_CALLBACK(HANDLE, FUC)                     (HANDLE)->async_callback = FUC
+
+/**
+ * @brief     link async_callback_ctx function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to an async_callback_ctx function address
+ * @note      it is used instead of async_callback when it is linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_ASYNC_CALLBACK_CTX(HANDLE, FUC)                 (HANDLE)->async_callback_ctx = FUC
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief     link timestamp_us function
+ * @param[in] HANDLE pointer to a mifare_classic handle structure
+ * @param[in] FUC pointer to a timestamp_us function address
+ * @note      it is optional and returns a free running microsecond counter, only the counters are kept
+ *            when it is not linked
+ */
+#define DRIVER_MIFARE_CLASSIC_LINK_TIMESTAMP_US(HANDLE, FUC)                       (HANDLE)->timestamp_us = FUC
+
+#endif
 
 /**
  * @}
@@ -366,6 +808,100 @@ uint8_t mifare_classic_select_cl1(mifare_classic_handle_t *handle, uint8_t id[4]
  */
 uint8_t mifare_classic_select_cl2(mifare_classic_handle_t *handle, uint8_t id[4]);
 
+/**
+ * @brief      mifare bit oriented anti collision cl1
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl1 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       it resolves the collisions of several cards when contactless_bit_transceiver is linked,
+ *             otherwise it is the same as mifare_classic_anticollision_cl1
+ */
+uint8_t mifare_classic_anticollision_bit_cl1(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief      mifare bit oriented anti collision cl2
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 anti collision cl2 failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check error
+ *             - 6 collision is not resolved
+ * @note       it resolves the collisions of several cards when contactless_bit_transceiver is linked,
+ *             otherwise it is the same as mifare_classic_anticollision_cl2
+ */
+uint8_t mifare_classic_anticollision_bit_cl2(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief      mifare select a card with all cascade levels
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *uid pointer to an uid structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 select failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 output_len is invalid
+ *             - 5 check or sak error
+ *             - 6 collision is not resolved
+ *             - 7 uid is too long
+ * @note       run it after mifare_classic_request or mifare_classic_wake_up,
+ *             it follows the cascade bit of the sak and reads 4 or 7 bytes uid in one pass,
+ *             the uid is cached for mifare_classic_reselect
+ */
+uint8_t mifare_classic_select(mifare_classic_handle_t *handle, mifare_classic_uid_t *uid);
+
+/**
+ * @brief      mifare get the authentication id of an uid
+ * @param[in]  *uid pointer to an uid structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 uid length is invalid
+ * @note       a 4 bytes uid is used as it is and a 7 bytes uid uses its last 4 bytes
+ */
+uint8_t mifare_classic_uid_to_id(mifare_classic_uid_t *uid, uint8_t id[4]);
+
+/**
+ * @brief     mifare reselect a known card
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 reselect failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      it runs wake up and select with the cached uid and skips the anti collision,
+ *            id is the authentication id and a cached 7 bytes uid with the same id is selected in both cascade levels
+ */
+uint8_t mifare_classic_reselect(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief      mifare enumerate all cards in the field
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *uid pointer to an uid structure array
+ * @param[in]  max max card number
+ * @param[out] *count pointer to a card number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 max is invalid
+ * @note       each found card is selected and halted, so the next request only wakes the others,
+ *             use mifare_classic_wake_up and the select commands with the saved uid to talk to one card afterwards
+ */
+uint8_t mifare_classic_enumerate(mifare_classic_handle_t *handle, mifare_classic_uid_t *uid, uint8_t max, uint8_t *count);
+
 /**
  * @brief     mifare authentication
  * @param[in] *handle pointer to a mifare_classic handle structure
@@ -556,6 +1092,7 @@ uint8_t mifare_classic_block_to_sector(mifare_classic_handle_t *handle, uint8_t
  *             - 0 success
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 sector is invalid
  * @note       none
  */
 uint8_t mifare_classic_sector_block_count(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *count);
@@ -569,6 +1106,7 @@ uint8_t mifare_classic_sector_block_count(mifare_classic_handle_t *handle, uint8
  *             - 0 success
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 sector is invalid
  * @note       none
  */
 uint8_t mifare_classic_sector_first_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block);
@@ -582,10 +1120,92 @@ uint8_t mifare_classic_sector_first_block(mifare_classic_handle_t *handle, uint8
  *             - 0 success
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 sector is invalid
  * @note       none
  */
 uint8_t mifare_classic_sector_last_block(mifare_classic_handle_t *handle, uint8_t sector, uint8_t *block);
 
+/**
+ * @brief      mifare read all blocks of a sector
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  sector read sector
+ * @param[in]  key_type authentication key type
+ * @param[in]  *key pointer to a key buffer
+ * @param[in]  trailer bool value, read the sector trailer too
+ * @param[out] *data pointer to a data buffer
+ * @param[out] *block_count pointer to a read block count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read sector failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 sector is invalid
+ * @note       it authenticates once and reads the blocks in order,
+ *             data must hold 16 * 16 bytes for the large sectors of s70
+ */
+uint8_t mifare_classic_read_sector(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t sector,
+                                   mifare_classic_authentication_key_t key_type, uint8_t key[6],
+                                   mifare_classic_bool_t trailer, uint8_t *data, uint8_t *block_count);
+
+/**
+ * @brief      mifare dump the whole card
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  *key pointer to a key set
+ * @param[in]  key_count key set length
+ * @param[in]  *callback pointer to a block callback
+ * @param[out] *failed_sector pointer to a failed sector count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 dump failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 type is invalid
+ *             - 5 key set is invalid
+ * @note       the card must be selected and handle->type must be set by request or wake up,
+ *             every block is passed to the callback with res 0 as soon as it is read,
+ *             a failed block is passed with res 1 and data NULL, a sector without any working key
+ *             is passed once with its first block, res 1 and data NULL,
+ *             the key which opened the last sector is tried first
+ */
+uint8_t mifare_classic_dump(mifare_classic_handle_t *handle, uint8_t id[4],
+                            mifare_classic_key_t *key, uint8_t key_count,
+                            void (*callback)(uint8_t sector, uint8_t block, uint8_t res, uint8_t *data),
+                            uint8_t *failed_sector);
+
+/**
+ * @brief      mifare write the changed blocks of an image
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  *id pointer to an id buffer
+ * @param[in]  *key pointer to a key set
+ * @param[in]  key_count key set length
+ * @param[in]  block first block of the image
+ * @param[in]  block_count block number of the image
+ * @param[in]  *image pointer to a target image buffer
+ * @param[in]  *last_image pointer to a last known card image buffer
+ * @param[out] *outcome pointer to a per block outcome buffer
+ * @param[out] *written pointer to a written block count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 update failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 type is invalid
+ *             - 5 key set is invalid
+ *             - 6 block is invalid
+ * @note       the card must be selected and handle->type must be set by request or wake up,
+ *             image and last_image hold block_count * 16 bytes and last_image can be NULL to write all blocks,
+ *             only the blocks which differ from last_image are written, sector by sector with one authentication,
+ *             the written blocks are copied into last_image, outcome holds one mifare_classic_update_outcome_t
+ *             per block, 1 is returned when a block failed or the card is lost
+ */
+uint8_t mifare_classic_update(mifare_classic_handle_t *handle, uint8_t id[4],
+                              mifare_classic_key_t *key, uint8_t key_count,
+                              uint8_t block, uint16_t block_count,
+                              uint8_t *image, uint8_t *last_image,
+                              uint8_t *outcome, uint16_t *written);
+
 /**
  * @brief     mifare set the sector permission
  * @param[in] *handle pointer to a mifare_classic handle structure
@@ -604,6 +1224,7 @@ uint8_t mifare_classic_sector_last_block(mifare_classic_handle_t *handle, uint8_
  *            - 3 handle is not initialized
  *            - 4 output_len is invalid
  *            - 5 ack error
+ *            - 6 sector is invalid
  * @note      block_0_0_4, block_1_5_9, block_2_10_14, permission(c1_c2_c3) definition is below
  *            c1  c2  c3        read        write        increment        decrement/transfer/restore
  *            0   0   0        keya|b       keya|b         keya|b                  keya|b
@@ -650,6 +1271,7 @@ uint8_t mifare_classic_set_sector_permission(mifare_classic_handle_t *handle,
  *             - 4 output_len is invalid
  *             - 5 crc error
  *             - 6 data is invalid
+ *             - 7 sector is invalid
  * @note       none
  */
 uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
@@ -658,15 +1280,563 @@ uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
                                              uint8_t *user_data, uint8_t key_b[6]);
 
 /**
- * @}
+ * @brief     enable or disable the reader crc offload
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] enable bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      when it is enabled, the contactless_transceiver must append the crc to the frames with crc,
+ *            check and strip the crc of the 16 bytes read replies
  */
+uint8_t mifare_classic_set_crc_offload(mifare_classic_handle_t *handle, mifare_classic_bool_t enable);
 
 /**
- * @defgroup mifare_classic_extern_driver mifare classic extern driver function
- * @brief    mifare classic extern driver modules
- * @ingroup  mifare_classic_driver
- * @{
- */
+ * @brief      get the reader crc offload status
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *enable pointer to a bool value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t mifare_classic_get_crc_offload(mifare_classic_handle_t *handle, mifare_classic_bool_t *enable);
+
+/**
+ * @brief     enable or disable the authentication session cache
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] enable bool value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      when it is enabled, mifare_classic_authentication returns at once if the same id, sector,
+ *            key type and key are already authenticated, halt, wake up, request, anti collision, select,
+ *            raw transceiver, any error and disabling the cache close the session, enabling it keeps an open
+ *            session so helpers can enable it without a new authentication
+ */
+uint8_t mifare_classic_set_auth_cache(mifare_classic_handle_t *handle, mifare_classic_bool_t enable);
+
+/**
+ * @brief      get the authentication session cache status
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *enable pointer to a bool value buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       none
+ */
+uint8_t mifare_classic_get_auth_cache(mifare_classic_handle_t *handle, mifare_classic_bool_t *enable);
+
+/**
+ * @brief      get the card state
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *state pointer to a card state buffer
+ * @param[out] *sector pointer to an authenticated sector buffer
+ * @param[out] *key_type pointer to an authenticated key type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       the state follows the result of every command, sector and key_type are only valid
+ *             in the authenticated state, the raw mifare_classic_transceiver sets the unknown state
+ *             and a request or wake up leaves it
+ */
+uint8_t mifare_classic_get_state(mifare_classic_handle_t *handle, mifare_classic_card_state_t *state,
+                                 uint8_t *sector, mifare_classic_authentication_key_t *key_type);
+
+/**
+ * @brief      get the key of the open authentication session
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *key pointer to a key buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 no session is open
+ * @note       it is the key which the auth cache compares, sector and key_type of the session
+ *             are given by mifare_classic_get_state
+ */
+uint8_t mifare_classic_get_auth_key(mifare_classic_handle_t *handle, uint8_t key[6]);
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief      get a snapshot of the latency statistics
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *stats pointer to a statistics structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       every blocking and async command is counted once with all its frames,
+ *             a command rejected by the card state is counted as a failure with code 1
+ */
+uint8_t mifare_classic_get_stats(mifare_classic_handle_t *handle, mifare_classic_stats_t *stats);
+
+/**
+ * @brief     reset the latency statistics
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      none
+ */
+uint8_t mifare_classic_reset_stats(mifare_classic_handle_t *handle);
+
+/**
+ * @brief      get the latency summary of one command from a snapshot
+ * @param[in]  *stats pointer to a statistics structure
+ * @param[in]  command statistics command
+ * @param[out] *min_us pointer to a min latency buffer
+ * @param[out] *avg_us pointer to an average latency buffer
+ * @param[out] *max_us pointer to a max latency buffer
+ * @param[out] *p99_us pointer to a p99 latency buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 stats is NULL
+ *             - 4 command is invalid
+ * @note       p99 is the upper bound of the histogram bucket and never exceeds the max,
+ *             all outputs are 0 when no call has a latency
+ */
+uint8_t mifare_classic_stats_latency(mifare_classic_stats_t *stats, mifare_classic_stats_command_t command,
+                                     uint32_t *min_us, uint32_t *avg_us, uint32_t *max_us, uint32_t *p99_us);
+
+#endif
+
+#if (MIFARE_CLASSIC_LOG_DEFERRED != 0)
+
+/**
+ * @brief      read the oldest event of the deferred log
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *entry pointer to a log entry buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 log is empty
+ *             - 2 handle is NULL
+ * @note       the event is removed from the ring, the log works before the handle is initialized
+ *             so that the errors of mifare_classic_init can be read
+ */
+uint8_t mifare_classic_log_read(mifare_classic_handle_t *handle, mifare_classic_log_entry_t *entry);
+
+/**
+ * @brief      print and remove all events of the deferred log
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *dropped pointer to a dropped event number buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 debug_print is NULL
+ * @note       every event is printed with the same text as the immediate log of the same level,
+ *             dropped is the number of events overwritten since the last flush
+ */
+uint8_t mifare_classic_log_flush(mifare_classic_handle_t *handle, uint32_t *dropped);
+
+#endif
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup mifare_classic_async_driver mifare classic async driver function
+ * @brief    mifare classic async driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief      mifare async request
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_request(mifare_classic_handle_t *handle, mifare_classic_type_t *type);
+
+/**
+ * @brief      mifare async wake up
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *type pointer to a type buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_wake_up(mifare_classic_handle_t *handle, mifare_classic_type_t *type);
+
+/**
+ * @brief     mifare async halt
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_halt(mifare_classic_handle_t *handle);
+
+/**
+ * @brief     mifare async set the load modulation
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] mod load modulation
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_set_modulation(mifare_classic_handle_t *handle, mifare_classic_load_modulation_t mod);
+
+/**
+ * @brief     mifare async set the personalized uid
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] type personalized uid type
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_set_personalized_uid(mifare_classic_handle_t *handle, mifare_classic_personalized_uid_t type);
+
+/**
+ * @brief      mifare async anti collision cl1
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_anticollision_cl1(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief      mifare async anti collision cl2
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_anticollision_cl2(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief     mifare async select cl1
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_select_cl1(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief     mifare async select cl2
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_select_cl2(mifare_classic_handle_t *handle, uint8_t id[4]);
+
+/**
+ * @brief     mifare async authentication
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] *id pointer to an id buffer
+ * @param[in] block block of authentication
+ * @param[in] key_type authentication key type
+ * @param[in] *key pointer to a key buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_authentication(mifare_classic_handle_t *handle, uint8_t id[4], uint8_t block,
+                                            mifare_classic_authentication_key_t key_type, uint8_t key[6]);
+
+/**
+ * @brief      mifare async read
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  block block of read
+ * @param[out] *data pointer to a data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_read(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16]);
+
+/**
+ * @brief     mifare async write
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of write
+ * @param[in] *data pointer to a data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_write(mifare_classic_handle_t *handle, uint8_t block, uint8_t data[16]);
+
+/**
+ * @brief     mifare async init one block as a value block
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value inited value
+ * @param[in] addr address
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_value_init(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr);
+
+/**
+ * @brief     mifare async value write
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block set block
+ * @param[in] value written value
+ * @param[in] addr address
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_value_write(mifare_classic_handle_t *handle, uint8_t block, int32_t value, uint8_t addr);
+
+/**
+ * @brief      mifare async value read
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  block block of read
+ * @param[out] *value pointer to a value buffer
+ * @param[out] *addr pointer to an address buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_value_read(mifare_classic_handle_t *handle, uint8_t block, int32_t *value, uint8_t *addr);
+
+/**
+ * @brief     mifare async increment
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of increment
+ * @param[in] value increment value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_increment(mifare_classic_handle_t *handle, uint8_t block, uint32_t value);
+
+/**
+ * @brief     mifare async decrement
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of decrement
+ * @param[in] value decrement value
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_decrement(mifare_classic_handle_t *handle, uint8_t block, uint32_t value);
+
+/**
+ * @brief     mifare async transfer
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of transfer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_transfer(mifare_classic_handle_t *handle, uint8_t block);
+
+/**
+ * @brief     mifare async restore
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] block block of restore
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_restore(mifare_classic_handle_t *handle, uint8_t block);
+
+/**
+ * @brief     mifare async set the sector permission
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] sector set sector
+ * @param[in] *key_a pointer to a key a buffer
+ * @param[in] block_0_0_4 block0(block0-4) permission
+ * @param[in] block_1_5_9 block1(block5-9) permission
+ * @param[in] block_2_10_14 block2(block10-14) permission
+ * @param[in] block_3_15 is block3(block15) permission
+ * @param[in] user_data user data
+ * @param[in] *key_b pointer to a key b buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 operation is busy
+ *            - 5 contactless_submit is null
+ *            - 6 sector is invalid
+ * @note      the result is reported by the async callback and mifare_classic_async_poll,
+ *            all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_set_sector_permission(mifare_classic_handle_t *handle,
+                                                   uint8_t sector, uint8_t key_a[6], 
+                                                   uint8_t block_0_0_4, uint8_t block_1_5_9,
+                                                   uint8_t block_2_10_14, uint8_t block_3_15,
+                                                   uint8_t user_data, uint8_t key_b[6]);
+
+/**
+ * @brief      mifare async get the sector permission
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[in]  sector get sector
+ * @param[out] *block_0_0_4 pointer to a block0(block0-4) permission buffer
+ * @param[out] *block_1_5_9 pointer to a block1(block5-9) permission buffer
+ * @param[out] *block_2_10_14 pointer to a block2(block10-14) permission buffer
+ * @param[out] *block_3_15 pointer to a block3(block15) permission buffer
+ * @param[out] *user_data pointer to a user data buffer
+ * @param[out] *key_b pointer to a key b buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 operation is busy
+ *             - 5 contactless_submit is null
+ *             - 6 sector is invalid
+ * @note       the result is reported by the async callback and mifare_classic_async_poll,
+ *             all output buffers must stay valid until the operation is done
+ */
+uint8_t mifare_classic_async_get_sector_permission(mifare_classic_handle_t *handle,
+                                                   uint8_t sector, uint8_t *block_0_0_4, uint8_t *block_1_5_9,
+                                                   uint8_t *block_2_10_14, uint8_t *block_3_15,
+                                                   uint8_t *user_data, uint8_t key_b[6]);
+
+/**
+ * @brief     mifare async complete
+ * @param[in] *handle pointer to a mifare_classic handle structure
+ * @param[in] res transceiver result
+ * @param[in] out_len received length
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 no operation is busy
+ * @note      call it when the exchange started by contactless_submit is finished,
+ *            res is 0 when the card answered and out_len is the received length
+ */
+uint8_t mifare_classic_async_complete(mifare_classic_handle_t *handle, uint8_t res, uint8_t out_len);
+
+/**
+ * @brief      mifare async poll
+ * @param[in]  *handle pointer to a mifare_classic handle structure
+ * @param[out] *status pointer to a status buffer
+ * @param[out] *result pointer to a result buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       result is the status code of the sync function and is valid when status is done
+ */
+uint8_t mifare_classic_async_poll(mifare_classic_handle_t *handle, mifare_classic_async_status_t *status, uint8_t *result);
+
+/**
+ * @}
+ */
+
+/**
+ * @defgroup mifare_classic_extern_driver mifare classic extern driver function
+ * @brief    mifare classic extern driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
 
 /**
  * @brief         transceiver data
@@ -682,6 +1852,19 @@ uint8_t mifare_classic_get_sector_permission(mifare_classic_handle_t *handle,
  */
 uint8_t mifare_classic_transceiver(mifare_classic_handle_t *handle, uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len);
 
+/**
+ * @brief      calculate the iso14443a crc
+ * @param[in]  *buf pointer to a data buffer
+ * @param[in]  len data length
+ * @param[out] *crc pointer to a crc buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 len is invalid
+ *             - 2 buf is NULL
+ * @note       crc[0] is the lsb and crc[1] is the msb
+ */
+uint8_t mifare_classic_crc(uint8_t *buf, uint8_t len, uint8_t crc[2]);
+
 /**
  * @}
  */
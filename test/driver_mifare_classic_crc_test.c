@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_crc_test.c
+ * @brief     driver mifare classic crc test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_crc_test.h"
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief      bitwise reference crc calculation
+ * @param[in]  *p pointer to a data buffer
+ * @param[in]  len data length
+ * @param[out] *output pointer to an output buffer
+ * @note       none
+ */
+static void a_crc_test_reference(uint8_t *p, uint8_t len, uint8_t output[2])
+{
+    uint32_t w_crc = 0x6363;
+    
+    do 
+    {
+        uint8_t  bt;
+        
+        bt = *p++;                                                                                        /* get one byte */
+        bt = (bt ^ (uint8_t)(w_crc & 0x00FF));                                                            /* xor */
+        bt = (bt ^ (bt << 4));                                                                            /* xor */
+        w_crc = (w_crc >> 8) ^ ((uint32_t) bt << 8) ^ ((uint32_t) bt << 3) ^ ((uint32_t) bt >> 4);        /* get the crc */
+    } while (--len);                                                                                      /* len-- */
+
+    output[0] = (uint8_t)(w_crc & 0xFF);                                                                  /* lsb */
+    output[1] = (uint8_t)((w_crc >> 8) & 0xFF);                                                           /* msb */
+}
+
+/**
+ * @brief     crc test
+ * @param[in] times test times
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      it checks the selected crc engine against the bitwise reference and prints the speed of both
+ */
+uint8_t mifare_classic_crc_test(uint32_t times)
+{
+    uint8_t res;
+    uint8_t len;
+    uint8_t buf[64];
+    uint8_t crc[2];
+    uint8_t crc_check[2];
+    uint32_t i;
+    volatile uint8_t sink;
+    clock_t start;
+    double t_reference;
+    double t_engine;
+    
+    /* start crc test */
+    mifare_classic_interface_debug_print("mifare_classic: start crc test.\n");
+#if (MIFARE_CLASSIC_CRC_ENGINE == MIFARE_CLASSIC_CRC_ENGINE_BITWISE)
+    mifare_classic_interface_debug_print("mifare_classic: crc engine is bitwise.\n");
+#elif (MIFARE_CLASSIC_CRC_ENGINE == MIFARE_CLASSIC_CRC_ENGINE_TABLE)
+    mifare_classic_interface_debug_print("mifare_classic: crc engine is table.\n");
+#else
+    mifare_classic_interface_debug_print("mifare_classic: crc engine is slicing by 4.\n");
+#endif
+    
+    /* known frame, halt is 0x50 0x00 0x57 0xCD */
+    buf[0] = 0x50;
+    buf[1] = 0x00;
+    res = mifare_classic_crc(buf, 2, crc);
+    if ((res != 0) || (crc[0] != 0x57) || (crc[1] != 0xCD))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: halt crc is wrong.\n");
+        
+        return 1;
+    }
+    
+    /* check all lengths */
+    for (len = 1; len <= 64; len++)
+    {
+        for (i = 0; i < len; i++)
+        {
+            buf[i] = rand() % 256;
+        }
+        a_crc_test_reference(buf, len, crc_check);
+        res = mifare_classic_crc(buf, len, crc);
+        if ((res != 0) || (memcmp(crc, crc_check, 2) != 0))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: crc check failed with %d bytes.\n", len);
+            
+            return 1;
+        }
+    }
+    mifare_classic_interface_debug_print("mifare_classic: crc check ok.\n");
+    
+    /* a block payload is the longest crc on every read and write */
+    for (i = 0; i < 16; i++)
+    {
+        buf[i] = rand() % 256;
+    }
+    
+    /* reference speed */
+    sink = 0;
+    start = clock();
+    for (i = 0; i < times; i++)
+    {
+        buf[0] = (uint8_t)i;
+        a_crc_test_reference(buf, 16, crc);
+        sink ^= crc[0];
+    }
+    t_reference = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    /* engine speed */
+    start = clock();
+    for (i = 0; i < times; i++)
+    {
+        buf[0] = (uint8_t)i;
+        (void)mifare_classic_crc(buf, 16, crc);
+        sink ^= crc[0];
+    }
+    t_engine = (double)(clock() - start) / CLOCKS_PER_SEC;
+    (void)sink;
+    
+    /* output the result */
+    mifare_classic_interface_debug_print("mifare_classic: bitwise %d x 16 bytes in %0.3fms.\n", times, t_reference * 1000.0);
+    mifare_classic_interface_debug_print("mifare_classic: engine %d x 16 bytes in %0.3fms.\n", times, t_engine * 1000.0);
+    if (t_engine > 0.0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: speed up is %0.2f.\n", t_reference / t_engine);
+    }
+    
+    /* finish crc test */
+    mifare_classic_interface_debug_print("mifare_classic: finish crc test.\n");
+    
+    return 0;
+}
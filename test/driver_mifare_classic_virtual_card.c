@@ -0,0 +1,1267 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_virtual_card.c
+ * @brief     driver mifare classic virtual card source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_virtual_card.h"
+
+/**
+ * @brief virtual card frame definition
+ */
+#define VIRTUAL_ACK                    0x0A        /**< ack */
+#define VIRTUAL_NAK_INVALID            0x04        /**< nak, invalid operation */
+#define VIRTUAL_NAK_CRC                0x05        /**< nak, crc error */
+
+/**
+ * @brief virtual card permission definition
+ */
+#define VIRTUAL_KEY_A                  0x01        /**< key a is allowed */
+#define VIRTUAL_KEY_B                  0x02        /**< key b is allowed */
+#define VIRTUAL_KEY_AB                 0x03        /**< key a and key b are allowed */
+
+/**
+ * @brief data block permission table indexed by c1_c2_c3
+ */
+static const uint8_t gsc_data_read[8]        = {VIRTUAL_KEY_AB, VIRTUAL_KEY_AB, VIRTUAL_KEY_AB, VIRTUAL_KEY_B,
+                                                VIRTUAL_KEY_AB, VIRTUAL_KEY_B, VIRTUAL_KEY_AB, 0};                         /**< read */
+static const uint8_t gsc_data_write[8]       = {VIRTUAL_KEY_AB, 0, 0, VIRTUAL_KEY_B,
+                                                VIRTUAL_KEY_B, 0, VIRTUAL_KEY_B, 0};                                       /**< write */
+static const uint8_t gsc_data_increment[8]   = {VIRTUAL_KEY_AB, 0, 0, 0, 0, 0, VIRTUAL_KEY_B, 0};                          /**< increment */
+static const uint8_t gsc_data_decrement[8]   = {VIRTUAL_KEY_AB, VIRTUAL_KEY_AB, 0, 0, 0, 0, VIRTUAL_KEY_AB, 0};            /**< decrement transfer restore */
+
+/**
+ * @brief sector trailer permission table indexed by c1_c2_c3
+ */
+static const uint8_t gsc_trailer_key_a_write[8]  = {VIRTUAL_KEY_A, VIRTUAL_KEY_A, 0, VIRTUAL_KEY_B, VIRTUAL_KEY_B, 0, 0, 0};                  /**< key a write */
+static const uint8_t gsc_trailer_access_read[8]  = {VIRTUAL_KEY_A, VIRTUAL_KEY_A, VIRTUAL_KEY_A, VIRTUAL_KEY_AB,
+                                                    VIRTUAL_KEY_AB, VIRTUAL_KEY_AB, VIRTUAL_KEY_AB, VIRTUAL_KEY_AB};                        /**< access bits read */
+static const uint8_t gsc_trailer_access_write[8] = {0, VIRTUAL_KEY_A, 0, VIRTUAL_KEY_B, 0, VIRTUAL_KEY_B, 0, 0};                            /**< access bits write */
+static const uint8_t gsc_trailer_key_b_read[8]   = {VIRTUAL_KEY_A, VIRTUAL_KEY_A, VIRTUAL_KEY_A, 0, 0, 0, 0, 0};                          /**< key b read */
+static const uint8_t gsc_trailer_key_b_write[8]  = {VIRTUAL_KEY_A, VIRTUAL_KEY_A, 0, VIRTUAL_KEY_B, VIRTUAL_KEY_B, 0, 0, 0};              /**< key b write */
+
+static mifare_classic_virtual_card_t *gs_field[MIFARE_CLASSIC_VIRTUAL_FIELD_MAX_CARD];        /**< cards in the field */
+static uint8_t gs_field_count = 0;                                                            /**< card number in the field */
+static uint8_t gs_reader_crc = 0;                                                             /**< reader crc flag */
+static uint8_t gs_submit_pending = 0;                                                         /**< submitted exchange is finished flag */
+static uint8_t gs_submit_res = 0;                                                             /**< submitted exchange result */
+static uint8_t gs_submit_len = 0;                                                             /**< submitted exchange received length */
+static uint32_t gs_batch_count = 0;                                                           /**< batch submission counter */
+static uint32_t gs_clock_ms = 0;                                                              /**< virtual clock */
+static mifare_classic_virtual_card_t *gs_arrival = NULL;                                      /**< card arriving later */
+static uint32_t gs_arrival_ms = 0;                                                            /**< arrival time */
+
+/**
+ * @brief     crc calculation
+ * @param[in] *p pointer to a data buffer
+ * @param[in] len data length
+ * @param[out] *output pointer to an output buffer
+ * @note      none
+ */
+static void a_virtual_crc(uint8_t *p, uint8_t len, uint8_t output[2])
+{
+    uint32_t w_crc = 0x6363;
+
+    do
+    {
+        uint8_t  bt;
+
+        bt = *p++;                                                                                        /* get one byte */
+        bt = (bt ^ (uint8_t)(w_crc & 0x00FF));                                                            /* xor */
+        bt = (bt ^ (bt << 4));                                                                            /* xor */
+        w_crc = (w_crc >> 8) ^ ((uint32_t) bt << 8) ^ ((uint32_t) bt << 3) ^ ((uint32_t) bt >> 4);        /* get the crc */
+    } while (--len);                                                                                      /* len-- */
+
+    output[0] = (uint8_t)(w_crc & 0xFF);                                                                  /* lsb */
+    output[1] = (uint8_t)((w_crc >> 8) & 0xFF);                                                           /* msb */
+}
+
+/**
+ * @brief     check the crc of a frame
+ * @param[in] *buf pointer to a frame buffer
+ * @param[in] len frame length including the crc
+ * @return    1 if the crc is right, otherwise 0
+ * @note      none
+ */
+static uint8_t a_virtual_crc_check(uint8_t *buf, uint8_t len)
+{
+    uint8_t crc[2];
+
+    if (len < 3)                                                      /* check the length */
+    {
+        return 0;                                                     /* too short */
+    }
+    a_virtual_crc(buf, len - 2, crc);                                 /* get the crc */
+
+    return ((buf[len - 2] == crc[0]) && (buf[len - 1] == crc[1])) ? 1 : 0;
+}
+
+/**
+ * @brief     get the sector of a block
+ * @param[in] block block number
+ * @return    sector number
+ * @note      none
+ */
+static uint8_t a_virtual_sector(uint8_t block)
+{
+    if (block < 32 * 4)                                    /* small sector */
+    {
+        return block / 4;                                  /* s50 layout */
+    }
+    else
+    {
+        return 32 + ((block - (32 * 4)) / 16);             /* s70 large sector */
+    }
+}
+
+/**
+ * @brief     get the trailer block of a sector
+ * @param[in] sector sector number
+ * @return    trailer block number
+ * @note      none
+ */
+static uint8_t a_virtual_trailer(uint8_t sector)
+{
+    if (sector < 32)                                               /* small sector */
+    {
+        return (uint8_t)(sector * 4 + 3);                          /* 4 blocks */
+    }
+    else
+    {
+        return (uint8_t)(32 * 4 + (sector - 32) * 16 + 15);        /* 16 blocks */
+    }
+}
+
+/**
+ * @brief     get the block count of the card
+ * @param[in] *card pointer to a virtual card structure
+ * @return    block count
+ * @note      none
+ */
+static uint16_t a_virtual_block_count(mifare_classic_virtual_card_t *card)
+{
+    return (card->type == MIFARE_CLASSIC_TYPE_S70) ? 256 : 64;
+}
+
+/**
+ * @brief     get the access condition of a block
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] block block number
+ * @param[out] *cond pointer to a c1_c2_c3 buffer
+ * @return    1 if the access bits are valid, otherwise 0
+ * @note      none
+ */
+static uint8_t a_virtual_access(mifare_classic_virtual_card_t *card, uint8_t block, uint8_t *cond)
+{
+    uint8_t sector;
+    uint8_t trailer;
+    uint8_t group;
+    uint8_t c1, c2, c3;
+    uint8_t *t;
+
+    sector = a_virtual_sector(block);                                                        /* get the sector */
+    trailer = a_virtual_trailer(sector);                                                     /* get the trailer */
+    t = card->block[trailer];                                                                /* trailer data */
+    if ((((t[6] >> 0) & 0xF) != ((~t[7] >> 4) & 0xF)) ||
+        (((t[6] >> 4) & 0xF) != ((~t[8] >> 0) & 0xF)) ||
+        (((t[7] >> 0) & 0xF) != ((~t[8] >> 4) & 0xF)))                                       /* check the format */
+    {
+        return 0;                                                                            /* sector is blocked */
+    }
+    if (block == trailer)                                                                    /* trailer */
+    {
+        group = 3;                                                                           /* group 3 */
+    }
+    else if (sector < 32)                                                                    /* small sector */
+    {
+        group = (uint8_t)(block - (trailer - 3));                                            /* one block per group */
+    }
+    else
+    {
+        group = (uint8_t)((block - (trailer - 15)) / 5);                                     /* five blocks per group */
+    }
+    c1 = (t[7] >> (4 + group)) & 0x1;                                                        /* get c1 */
+    c2 = (t[8] >> (0 + group)) & 0x1;                                                        /* get c2 */
+    c3 = (t[8] >> (4 + group)) & 0x1;                                                        /* get c3 */
+    *cond = (uint8_t)((c1 << 2) | (c2 << 1) | (c3 << 0));                                    /* set the condition */
+
+    return 1;                                                                                /* ok */
+}
+
+/**
+ * @brief     check one permission
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] block block number
+ * @param[in] *table pointer to a permission table
+ * @return    1 if it is allowed, otherwise 0
+ * @note      none
+ */
+static uint8_t a_virtual_allowed(mifare_classic_virtual_card_t *card, uint8_t block, const uint8_t table[8])
+{
+    uint8_t cond;
+    uint8_t key;
+
+    if (a_virtual_access(card, block, &cond) == 0)                                          /* get the condition */
+    {
+        return 0;                                                                           /* blocked */
+    }
+    key = (card->auth_key == MIFARE_CLASSIC_AUTHENTICATION_KEY_A) ? VIRTUAL_KEY_A : VIRTUAL_KEY_B;
+
+    return ((table[cond] & key) != 0) ? 1 : 0;                                              /* check the key */
+}
+
+/**
+ * @brief     check the value block format
+ * @param[in] *data pointer to a block buffer
+ * @return    1 if it is a value block, otherwise 0
+ * @note      none
+ */
+static uint8_t a_virtual_is_value(uint8_t *data)
+{
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)                                                                  /* check the value */
+    {
+        if ((data[i] != data[i + 8]) || ((data[i] ^ data[i + 4]) != 0xFF))
+        {
+            return 0;                                                                        /* invalid */
+        }
+    }
+    if ((data[12] != data[14]) || (data[13] != data[15]) || ((data[12] ^ data[13]) != 0xFF))
+    {
+        return 0;                                                                            /* invalid */
+    }
+
+    return 1;                                                                                /* valid */
+}
+
+/**
+ * @brief      get the uid part of a cascade level
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  sel select code of the cascade level
+ * @param[out] *uid pointer to a 4 bytes uid and bcc buffer
+ * @return     1 if the card takes part in this cascade level, 0 if not
+ * @note       none
+ */
+static uint8_t a_virtual_level_uid(mifare_classic_virtual_card_t *card, uint8_t sel, uint8_t uid[5])
+{
+    if ((sel == 0x93) && (card->level == 0) && (card->uid_len == 4))        /* single size uid */
+    {
+        memcpy(uid, card->uid, 4);                                          /* copy the uid */
+    }
+    else if ((sel == 0x93) && (card->level == 0))                           /* first part of a double size uid */
+    {
+        uid[0] = 0x88;                                                      /* cascade tag */
+        memcpy(&uid[1], card->uid, 3);                                      /* copy the uid */
+    }
+    else if ((sel == 0x95) && (card->level == 1))                           /* second part of a double size uid */
+    {
+        memcpy(uid, &card->uid[3], 4);                                      /* copy the uid */
+    }
+    else
+    {
+        return 0;                                                           /* not this level */
+    }
+    uid[4] = uid[0] ^ uid[1] ^ uid[2] ^ uid[3];                             /* set the bcc */
+
+    return 1;                                                               /* this level */
+}
+
+/**
+ * @brief     drop the card after an error
+ * @param[in] *card pointer to a virtual card structure
+ * @note      none
+ */
+static void a_virtual_drop(mifare_classic_virtual_card_t *card)
+{
+    card->state = (card->halted != 0) ? MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT :
+                                        MIFARE_CLASSIC_VIRTUAL_CARD_STATE_IDLE;              /* back to idle or halt */
+    card->pending_command = 0;                                                               /* clear the pending command */
+    card->transfer_valid = 0;                                                                /* clear the transfer buffer */
+}
+
+/**
+ * @brief     power on the card
+ * @param[in] *card pointer to a virtual card structure
+ * @note      the card enters the idle state
+ */
+static void a_virtual_power_on(mifare_classic_virtual_card_t *card)
+{
+    card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_IDLE;                                    /* idle */
+    card->halted = 0;                                                                        /* clear the flag */
+    card->pending_command = 0;                                                               /* clear the command */
+    card->transfer_valid = 0;                                                                /* clear the buffer */
+}
+
+/**
+ * @brief      answer with a 4 bits ack or nak
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  code ack or nak code
+ * @param[out] *out pointer to an output buffer
+ * @return     output length
+ * @note       a nak drops the card
+ */
+static uint8_t a_virtual_ack(mifare_classic_virtual_card_t *card, uint8_t code, uint8_t *out)
+{
+    if (code != VIRTUAL_ACK)                                                                 /* nak */
+    {
+        a_virtual_drop(card);                                                                /* drop the card */
+    }
+    out[0] = code;                                                                           /* set the code */
+
+    return 1;                                                                                /* one byte */
+}
+
+/**
+ * @brief     write a block with the sector trailer rules
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] block block number
+ * @param[in] *data pointer to a data buffer
+ * @note      none
+ */
+static void a_virtual_write_block(mifare_classic_virtual_card_t *card, uint8_t block, uint8_t *data)
+{
+    uint8_t *t;
+
+    if (block != a_virtual_trailer(a_virtual_sector(block)))                                 /* data block */
+    {
+        memcpy(card->block[block], data, 16);                                                /* copy the data */
+
+        return;
+    }
+
+    t = card->block[block];                                                                  /* trailer */
+    if (a_virtual_allowed(card, block, gsc_trailer_key_a_write) != 0)                        /* key a */
+    {
+        memcpy(&t[0], &data[0], 6);                                                          /* write key a */
+    }
+    if (a_virtual_allowed(card, block, gsc_trailer_key_b_write) != 0)                        /* key b */
+    {
+        memcpy(&t[10], &data[10], 6);                                                        /* write key b */
+    }
+    if (a_virtual_allowed(card, block, gsc_trailer_access_write) != 0)                       /* access bits */
+    {
+        memcpy(&t[6], &data[6], 4);                                                          /* write access bits */
+    }
+}
+
+/**
+ * @brief      read a block with the sector trailer rules
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  block block number
+ * @param[out] *data pointer to a data buffer
+ * @note       none
+ */
+static void a_virtual_read_block(mifare_classic_virtual_card_t *card, uint8_t block, uint8_t *data)
+{
+    memcpy(data, card->block[block], 16);                                                    /* copy the data */
+    if (block != a_virtual_trailer(a_virtual_sector(block)))                                 /* data block */
+    {
+        return;
+    }
+
+    memset(&data[0], 0, 6);                                                                  /* key a is never readable */
+    if (a_virtual_allowed(card, block, gsc_trailer_access_read) == 0)                        /* access bits */
+    {
+        memset(&data[6], 0, 4);                                                              /* hide the access bits */
+    }
+    if (a_virtual_allowed(card, block, gsc_trailer_key_b_read) == 0)                         /* key b */
+    {
+        memset(&data[10], 0, 6);                                                             /* hide the key b */
+    }
+}
+
+/**
+ * @brief      handle the second part of write and value commands
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  *in pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     status code
+ *             - 0 answered
+ *             - 1 no answer
+ * @note       none
+ */
+static uint8_t a_virtual_second_part(mifare_classic_virtual_card_t *card, uint8_t *in, uint8_t in_len,
+                                     uint8_t *out, uint8_t *out_len)
+{
+    uint8_t command;
+    uint8_t block;
+
+    command = card->pending_command;                                                         /* get the command */
+    block = card->pending_block;                                                             /* get the block */
+    card->pending_command = 0;                                                               /* clear the command */
+
+    if (command == 0xA0)                                                                     /* write */
+    {
+        if ((in_len != 18) || (a_virtual_crc_check(in, in_len) == 0))                       /* check the frame */
+        {
+            *out_len = a_virtual_ack(card, VIRTUAL_NAK_CRC, out);                            /* nak */
+
+            return 0;                                                                        /* answered */
+        }
+        a_virtual_write_block(card, block, in);                                              /* write the block */
+        *out_len = a_virtual_ack(card, VIRTUAL_ACK, out);                                    /* ack */
+
+        return 0;                                                                            /* answered */
+    }
+    else                                                                                     /* value */
+    {
+        uint32_t v;
+        uint32_t operand;
+        uint8_t *p;
+
+        if ((in_len != 6) || (a_virtual_crc_check(in, in_len) == 0))                        /* check the frame */
+        {
+            *out_len = a_virtual_ack(card, VIRTUAL_NAK_CRC, out);                            /* nak */
+
+            return 0;                                                                        /* answered */
+        }
+        operand = ((uint32_t)in[0] << 0) | ((uint32_t)in[1] << 8) |
+                  ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);                         /* get the operand */
+        p = card->block[block];                                                              /* source block */
+        v = ((uint32_t)p[0] << 0) | ((uint32_t)p[1] << 8) |
+            ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);                                 /* get the value */
+        if (command == 0xC1)                                                                 /* increment */
+        {
+            v = v + operand;                                                                 /* add */
+        }
+        else if (command == 0xC0)                                                            /* decrement */
+        {
+            v = v - operand;                                                                 /* sub */
+        }
+        else                                                                                 /* restore */
+        {
+            /* keep the value */
+        }
+        card->transfer_buf[0] = (uint8_t)((v >> 0) & 0xFF);                                  /* set the value */
+        card->transfer_buf[1] = (uint8_t)((v >> 8) & 0xFF);                                  /* set the value */
+        card->transfer_buf[2] = (uint8_t)((v >> 16) & 0xFF);                                 /* set the value */
+        card->transfer_buf[3] = (uint8_t)((v >> 24) & 0xFF);                                 /* set the value */
+        card->transfer_buf[4] = (uint8_t)(~card->transfer_buf[0]);                           /* set the inverted value */
+        card->transfer_buf[5] = (uint8_t)(~card->transfer_buf[1]);                           /* set the inverted value */
+        card->transfer_buf[6] = (uint8_t)(~card->transfer_buf[2]);                           /* set the inverted value */
+        card->transfer_buf[7] = (uint8_t)(~card->transfer_buf[3]);                           /* set the inverted value */
+        memcpy(&card->transfer_buf[8], &card->transfer_buf[0], 4);                           /* set the value */
+        memcpy(&card->transfer_buf[12], &p[12], 4);                                          /* keep the address */
+        card->transfer_valid = 1;                                                            /* set valid */
+
+        return 1;                                                                            /* the card never answers */
+    }
+}
+
+/**
+ * @brief      handle an authenticated command
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  *in pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     status code
+ *             - 0 answered
+ *             - 1 no answer
+ * @note       none
+ */
+static uint8_t a_virtual_command(mifare_classic_virtual_card_t *card, uint8_t *in, uint8_t in_len,
+                                 uint8_t *out, uint8_t *out_len)
+{
+    uint8_t block;
+
+    if ((in_len != 4) || (a_virtual_crc_check(in, in_len) == 0))                            /* check the frame */
+    {
+        *out_len = a_virtual_ack(card, VIRTUAL_NAK_CRC, out);                                /* nak */
+
+        return 0;                                                                            /* answered */
+    }
+    if ((in[0] == 0x50) && (in[1] == 0x00))                                                  /* halt */
+    {
+        card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT;                                /* halt */
+        card->halted = 1;                                                                    /* set halted */
+        card->pending_command = 0;                                                           /* clear the command */
+        card->transfer_valid = 0;                                                            /* clear the buffer */
+
+        return 1;                                                                            /* no answer */
+    }
+    if (card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_AUTHENTICATED)                      /* check the state */
+    {
+        *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                            /* nak */
+
+        return 0;                                                                            /* answered */
+    }
+    if ((in[0] == 0x43) || (in[0] == 0x40))                                                  /* set modulation or personalize uid */
+    {
+        *out_len = a_virtual_ack(card, VIRTUAL_ACK, out);                                    /* ack */
+
+        return 0;                                                                            /* answered */
+    }
+
+    block = in[1];                                                                           /* get the block */
+    if (((uint16_t)block >= a_virtual_block_count(card)) ||
+        (a_virtual_sector(block) != card->auth_sector))                                      /* check the block */
+    {
+        *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                            /* nak */
+
+        return 0;                                                                            /* answered */
+    }
+    switch (in[0])
+    {
+        case 0x30 :                                                                          /* read */
+        {
+            if (a_virtual_allowed(card, block, gsc_data_read) == 0)                          /* check the permission */
+            {
+                if (block != a_virtual_trailer(card->auth_sector))                           /* the trailer is always readable */
+                {
+                    *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                /* nak */
+
+                    return 0;                                                                /* answered */
+                }
+            }
+            if (*out_len < 18)                                                               /* check the buffer */
+            {
+                return 1;                                                                    /* buffer is too small */
+            }
+            a_virtual_read_block(card, block, out);                                          /* read the block */
+            a_virtual_crc(out, 16, out + 16);                                                /* append the crc */
+            *out_len = 18;                                                                   /* set the length */
+
+            return 0;                                                                        /* answered */
+        }
+        case 0xA0 :                                                                          /* write */
+        {
+            if ((block == 0) ||
+                ((block != a_virtual_trailer(card->auth_sector)) &&
+                 (a_virtual_allowed(card, block, gsc_data_write) == 0)))                     /* check the permission */
+            {
+                *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                    /* nak */
+
+                return 0;                                                                    /* answered */
+            }
+            card->pending_command = in[0];                                                   /* save the command */
+            card->pending_block = block;                                                     /* save the block */
+            *out_len = a_virtual_ack(card, VIRTUAL_ACK, out);                                /* ack */
+
+            return 0;                                                                        /* answered */
+        }
+        case 0xC0 :                                                                          /* decrement */
+        case 0xC1 :                                                                          /* increment */
+        case 0xC2 :                                                                          /* restore */
+        {
+            const uint8_t *table;
+
+            table = (in[0] == 0xC1) ? gsc_data_increment : gsc_data_decrement;               /* get the table */
+            if ((block == a_virtual_trailer(card->auth_sector)) ||
+                (a_virtual_is_value(card->block[block]) == 0) ||
+                (a_virtual_allowed(card, block, table) == 0))                                /* check the permission */
+            {
+                *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                    /* nak */
+
+                return 0;                                                                    /* answered */
+            }
+            card->pending_command = in[0];                                                   /* save the command */
+            card->pending_block = block;                                                     /* save the block */
+            *out_len = a_virtual_ack(card, VIRTUAL_ACK, out);                                /* ack */
+
+            return 0;                                                                        /* answered */
+        }
+        case 0xB0 :                                                                          /* transfer */
+        {
+            if ((card->transfer_valid == 0) || (block == 0) ||
+                (block == a_virtual_trailer(card->auth_sector)) ||
+                (a_virtual_allowed(card, block, gsc_data_decrement) == 0))                   /* check the permission */
+            {
+                *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                    /* nak */
+
+                return 0;                                                                    /* answered */
+            }
+            memcpy(card->block[block], card->transfer_buf, 16);                              /* write the buffer */
+            card->transfer_valid = 0;                                                        /* clear the buffer */
+            *out_len = a_virtual_ack(card, VIRTUAL_ACK, out);                                /* ack */
+
+            return 0;                                                                        /* answered */
+        }
+        default :
+        {
+            *out_len = a_virtual_ack(card, VIRTUAL_NAK_INVALID, out);                        /* nak */
+
+            return 0;                                                                        /* answered */
+        }
+    }
+}
+
+/**
+ * @brief      handle one frame
+ * @param[in]  *card pointer to a virtual card structure
+ * @param[in]  *in pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out pointer to an output buffer
+ * @param[out] *out_len pointer to an output length buffer
+ * @return     status code
+ *             - 0 answered
+ *             - 1 no answer
+ * @note       none
+ */
+static uint8_t a_virtual_frame(mifare_classic_virtual_card_t *card, uint8_t *in, uint8_t in_len,
+                               uint8_t *out, uint8_t *out_len)
+{
+    uint8_t level_uid[5];
+
+    if (in_len == 0)                                                                               /* check the length */
+    {
+        return 1;                                                                                  /* no answer */
+    }
+    if (card->pending_command != 0)                                                                /* second part */
+    {
+        return a_virtual_second_part(card, in, in_len, out, out_len);                              /* run the second part */
+    }
+
+    if ((in_len == 1) && ((in[0] == 0x26) || (in[0] == 0x52)))                                     /* request or wake up */
+    {
+        if ((card->state == MIFARE_CLASSIC_VIRTUAL_CARD_STATE_IDLE) ||
+            ((card->state == MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT) && (in[0] == 0x52)))          /* check the state */
+        {
+            card->halted = (card->state == MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT) ? 1 : 0;        /* save the source state */
+            card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_READY;                                 /* ready */
+            card->level = 0;                                                                       /* cascade level 1 */
+            out[0] = (card->type == MIFARE_CLASSIC_TYPE_S70) ? 0x02 : 0x04;                        /* atqa */
+            out[0] |= (card->uid_len == 7) ? 0x40 : 0x00;                                          /* double size uid */
+            out[1] = 0x00;                                                                         /* atqa */
+            *out_len = 2;                                                                          /* set the length */
+
+            return 0;                                                                              /* answered */
+        }
+        if (card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT)                                 /* not halted */
+        {
+            a_virtual_drop(card);                                                                  /* unexpected command */
+        }
+
+        return 1;                                                                                  /* no answer */
+    }
+    if ((in_len == 2) && ((in[0] == 0x93) || (in[0] == 0x95)) && (in[1] == 0x20))                  /* anti collision cl1 and cl2 */
+    {
+        if ((card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_READY) ||
+            (a_virtual_level_uid(card, in[0], out) == 0))                                          /* check the state and level */
+        {
+            a_virtual_drop(card);                                                                  /* unexpected command */
+
+            return 1;                                                                              /* no answer */
+        }
+        *out_len = 5;                                                                              /* set the length */
+
+        return 0;                                                                                  /* answered */
+    }
+    if ((in_len == 9) && ((in[0] == 0x93) || (in[0] == 0x95)) && (in[1] == 0x70))                  /* select cl1 and cl2 */
+    {
+        if ((card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_READY) ||
+            (a_virtual_crc_check(in, in_len) == 0) ||
+            (a_virtual_level_uid(card, in[0], level_uid) == 0) ||
+            (memcmp(&in[2], level_uid, 4) != 0))                                                   /* check the frame */
+        {
+            a_virtual_drop(card);                                                                  /* unexpected command */
+
+            return 1;                                                                              /* no answer */
+        }
+        if (level_uid[0] == 0x88)                                                                  /* cascade tag */
+        {
+            card->level = 1;                                                                       /* next cascade level */
+            out[0] = 0x04;                                                                         /* uid is not complete */
+        }
+        else
+        {
+            card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_ACTIVE;                                /* active */
+            out[0] = (card->type == MIFARE_CLASSIC_TYPE_S70) ? 0x18 : 0x08;                        /* sak */
+        }
+        *out_len = 1;                                                                              /* set the length */
+
+        return 0;                                                                                  /* answered */
+    }
+    if ((in_len == 12) && ((in[0] == 0x60) || (in[0] == 0x61)))                                    /* authentication */
+    {
+        uint8_t trailer;
+        uint8_t key_ok;
+
+        if (((card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_ACTIVE) &&
+             (card->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_AUTHENTICATED)) ||
+            ((uint16_t)in[1] >= a_virtual_block_count(card)) ||
+            (memcmp(&in[8], &card->uid[card->uid_len - 4], 4) != 0))                               /* check the frame */
+        {
+            a_virtual_drop(card);                                                                  /* drop the card */
+
+            return 1;                                                                              /* no answer */
+        }
+        trailer = a_virtual_trailer(a_virtual_sector(in[1]));                                      /* get the trailer */
+        if (in[0] == 0x60)                                                                         /* key a */
+        {
+            key_ok = (memcmp(&in[2], &card->block[trailer][0], 6) == 0) ? 1 : 0;                   /* check key a */
+            card->auth_key = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;                                  /* key a */
+        }
+        else                                                                                       /* key b */
+        {
+            key_ok = (memcmp(&in[2], &card->block[trailer][10], 6) == 0) ? 1 : 0;                  /* check key b */
+            card->auth_key = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;                                  /* check with key a */
+            if (a_virtual_allowed(card, trailer, gsc_trailer_key_b_read) != 0)                     /* readable key b can't be used */
+            {
+                key_ok = 0;                                                                        /* key b is readable */
+            }
+            card->auth_key = MIFARE_CLASSIC_AUTHENTICATION_KEY_B;                                  /* key b */
+        }
+        if (key_ok == 0)                                                                           /* check the key */
+        {
+            a_virtual_drop(card);                                                                  /* drop the card */
+
+            return 1;                                                                              /* no answer */
+        }
+        card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_AUTHENTICATED;                             /* authenticated */
+        card->auth_sector = a_virtual_sector(in[1]);                                               /* save the sector */
+        card->transfer_valid = 0;                                                                  /* clear the buffer */
+        *out_len = 0;                                                                              /* no data */
+
+        return 0;                                                                                  /* answered */
+    }
+    if ((card->state == MIFARE_CLASSIC_VIRTUAL_CARD_STATE_ACTIVE) ||
+        (card->state == MIFARE_CLASSIC_VIRTUAL_CARD_STATE_AUTHENTICATED))                          /* check the state */
+    {
+        return a_virtual_command(card, in, in_len, out, out_len);                                  /* run the command */
+    }
+
+    return 1;                                                                                      /* no answer */
+}
+
+/**
+ * @brief      initialize a virtual card with the transport configuration
+ * @param[out] *card pointer to a virtual card structure
+ * @param[in]  type card type
+ * @param[in]  *uid pointer to an uid buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 type is invalid
+ *             - 2 card is NULL
+ * @note       all keys are 0xFFFFFFFFFFFF and all access bits are FF 07 80
+ */
+uint8_t mifare_classic_virtual_card_init(mifare_classic_virtual_card_t *card, mifare_classic_type_t type, uint8_t uid[4])
+{
+    uint16_t i;
+    uint16_t count;
+
+    if (card == NULL)                                                                 /* check the card */
+    {
+        return 2;                                                                     /* return error */
+    }
+    if ((type != MIFARE_CLASSIC_TYPE_S50) && (type != MIFARE_CLASSIC_TYPE_S70))      /* check the type */
+    {
+        return 1;                                                                     /* return error */
+    }
+
+    memset(card, 0, sizeof(mifare_classic_virtual_card_t));                           /* clear the card */
+    card->type = (uint8_t)type;                                                       /* set the type */
+    memcpy(card->uid, uid, 4);                                                        /* set the uid */
+    card->uid_len = 4;                                                                /* single size uid */
+    count = a_virtual_block_count(card);                                              /* get the block count */
+    for (i = 0; i < count; i++)                                                       /* set all trailers */
+    {
+        if (i == a_virtual_trailer(a_virtual_sector((uint8_t)i)))                     /* trailer */
+        {
+            memset(&card->block[i][0], 0xFF, 6);                                      /* key a */
+            card->block[i][6] = 0xFF;                                                 /* access bits */
+            card->block[i][7] = 0x07;                                                 /* access bits */
+            card->block[i][8] = 0x80;                                                 /* access bits */
+            card->block[i][9] = 0x69;                                                 /* user data */
+            memset(&card->block[i][10], 0xFF, 6);                                     /* key b */
+        }
+    }
+    memcpy(&card->block[0][0], uid, 4);                                               /* manufacturer block uid */
+    card->block[0][4] = uid[0] ^ uid[1] ^ uid[2] ^ uid[3];                            /* bcc */
+    card->block[0][5] = (type == MIFARE_CLASSIC_TYPE_S70) ? 0x18 : 0x08;              /* sak */
+    card->block[0][6] = (type == MIFARE_CLASSIC_TYPE_S70) ? 0x02 : 0x04;              /* atqa */
+    card->block[0][7] = 0x00;                                                         /* atqa */
+    card->state = MIFARE_CLASSIC_VIRTUAL_CARD_STATE_IDLE;                             /* idle */
+
+    return 0;                                                                         /* success return 0 */
+}
+/**
+ * @brief     give a virtual card a double size uid
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] *uid pointer to a 7 bytes uid buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card answers in two cascade levels like a 7 bytes uid ev1 card
+ */
+uint8_t mifare_classic_virtual_card_set_double_uid(mifare_classic_virtual_card_t *card, uint8_t uid[7])
+{
+    if (card == NULL)                                                                 /* check the card */
+    {
+        return 2;                                                                     /* return error */
+    }
+
+    memcpy(card->uid, uid, 7);                                                        /* set the uid */
+    card->uid_len = 7;                                                                /* double size uid */
+    memcpy(&card->block[0][0], uid, 7);                                               /* manufacturer block uid */
+    card->block[0][7] = (card->type == MIFARE_CLASSIC_TYPE_S70) ? 0x18 : 0x08;        /* sak */
+    card->block[0][8] = (card->type == MIFARE_CLASSIC_TYPE_S70) ? 0x42 : 0x44;        /* atqa */
+    card->block[0][9] = 0x00;                                                         /* atqa */
+
+    return 0;                                                                         /* success return 0 */
+}
+
+/**
+ * @brief     put a virtual card into the field
+ * @param[in] *card pointer to a virtual card structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card enters the idle state
+ */
+uint8_t mifare_classic_virtual_card_insert(mifare_classic_virtual_card_t *card)
+{
+    if (card == NULL)                                               /* check the card */
+    {
+        return 2;                                                   /* return error */
+    }
+
+    a_virtual_power_on(card);                                       /* power on */
+    gs_field[0] = card;                                             /* put into the field */
+    gs_field_count = 1;                                             /* only this card */
+
+    return 0;                                                       /* success return 0 */
+}
+
+/**
+ * @brief  remove the virtual card from the field
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_card_remove(void)
+{
+    gs_field_count = 0;                                             /* empty field */
+
+    return 0;                                                       /* success return 0 */
+}
+
+/**
+ * @brief     put one more virtual card into the field
+ * @param[in] *card pointer to a virtual card structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 field is full
+ *            - 2 card is NULL
+ * @note      the cards answer together and the different answers collide
+ */
+uint8_t mifare_classic_virtual_card_add(mifare_classic_virtual_card_t *card)
+{
+    if (card == NULL)                                               /* check the card */
+    {
+        return 2;                                                   /* return error */
+    }
+    if (gs_field_count >= MIFARE_CLASSIC_VIRTUAL_FIELD_MAX_CARD)    /* check the field */
+    {
+        return 1;                                                   /* return error */
+    }
+
+    a_virtual_power_on(card);                                       /* power on */
+    gs_field[gs_field_count] = card;                                /* add the card */
+    gs_field_count++;                                               /* one more card */
+
+    return 0;                                                       /* success return 0 */
+}
+
+/**
+ * @brief     put a virtual card into the field after a while
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] ms arrival delay on the virtual clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card arrives during the mifare_classic_virtual_delay_ms which reaches the time
+ */
+uint8_t mifare_classic_virtual_card_insert_later(mifare_classic_virtual_card_t *card, uint32_t ms)
+{
+    if (card == NULL)                                               /* check the card */
+    {
+        return 2;                                                   /* return error */
+    }
+
+    gs_arrival = card;                                              /* set the card */
+    gs_arrival_ms = gs_clock_ms + ms;                               /* set the arrival time */
+
+    return 0;                                                       /* success return 0 */
+}
+
+/**
+ * @brief     enable or disable the crc handling of the virtual reader
+ * @param[in] enable bool value
+ * @return    status code
+ *            - 0 success
+ * @note      when it is enabled, the virtual reader appends and checks the crc like a reader
+ *            which is used with mifare_classic_set_crc_offload
+ */
+uint8_t mifare_classic_virtual_card_set_reader_crc(mifare_classic_bool_t enable)
+{
+    gs_reader_crc = (uint8_t)enable;                              /* set the flag */
+    
+    return 0;                                                     /* success return 0 */
+}
+
+/**
+ * @brief  virtual contactless init
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_contactless_init(void)
+{
+    return 0;
+}
+
+/**
+ * @brief  virtual contactless deinit
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_contactless_deinit(void)
+{
+    return 0;
+}
+
+/**
+ * @brief         virtual contactless transceiver
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 no response
+ * @note          it behaves like a reader with the cards in the field and answers at memory speed,
+ *                the atqa of several cards is merged and other different answers are a collision error
+ */
+uint8_t mifare_classic_virtual_contactless_transceiver(uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
+{
+    uint8_t i;
+    uint8_t k;
+    uint8_t res;
+    uint8_t len;
+    uint8_t card_len;
+    uint8_t answered;
+    uint8_t collision = 0;
+    uint8_t buf[18];
+    uint8_t card_buf[18];
+    uint8_t frame[20];
+
+    if ((in_buf == NULL) || (out_buf == NULL) || (out_len == NULL))                        /* check the params */
+    {
+        return 1;                                                                          /* return error */
+    }
+    if (gs_field_count == 0)                                                               /* check the field */
+    {
+        *out_len = 0;                                                                      /* nothing */
+
+        return 1;                                                                          /* timeout */
+    }
+
+    if ((gs_reader_crc != 0) && (in_len <= 18) &&
+        (in_len != 1) &&                                                                   /* short frame */
+        !((in_len == 2) && ((in_buf[0] == 0x93) || (in_buf[0] == 0x95)) && (in_buf[1] == 0x20)) &&
+        !((in_len == 12) && ((in_buf[0] == 0x60) || (in_buf[0] == 0x61))))                 /* anti collision and authentication */
+    {
+        memcpy(frame, in_buf, in_len);                                                     /* copy the frame */
+        a_virtual_crc(frame, in_len, frame + in_len);                                      /* reader appends the crc */
+        in_buf = frame;                                                                    /* use the new frame */
+        in_len = (uint8_t)(in_len + 2);                                                    /* add the crc length */
+    }
+    answered = 0;                                                                          /* init 0 */
+    len = 0;                                                                               /* init 0 */
+    for (i = 0; i < gs_field_count; i++)                                                   /* all cards hear the frame */
+    {
+        gs_field[i]->frame_count++;                                                        /* count the frame */
+        card_len = sizeof(card_buf);                                                       /* set the buffer size */
+        if (a_virtual_frame(gs_field[i], in_buf, in_len, card_buf, &card_len) != 0)        /* run the card */
+        {
+            continue;                                                                      /* silent card */
+        }
+        if (answered == 0)                                                                 /* first answer */
+        {
+            memcpy(buf, card_buf, card_len);                                               /* save the answer */
+            len = card_len;                                                                /* save the length */
+        }
+        else if ((in_len == 1) && (card_len == len))                                       /* atqa of several cards */
+        {
+            for (k = 0; k < len; k++)                                                      /* all bytes */
+            {
+                buf[k] |= card_buf[k];                                                     /* the reader gets the or of the bits */
+            }
+        }
+        else if ((card_len != len) || (memcmp(buf, card_buf, len) != 0))                   /* different answer */
+        {
+            collision = 1;                                                                 /* collision */
+        }
+        else
+        {
+            /* the same answer */
+        }
+        answered++;                                                                        /* count the answer */
+    }
+    res = ((answered == 0) || (collision != 0)) ? 1 : 0;                                   /* a collision is a receive error */
+    if ((res == 0) && (gs_reader_crc != 0) && (len == 18))                                 /* reader checks the crc */
+    {
+        if (a_virtual_crc_check(buf, len) == 0)                                            /* check the crc */
+        {
+            res = 1;                                                                       /* crc error */
+        }
+        len = 16;                                                                          /* strip the crc */
+    }
+    if ((res != 0) || (len > *out_len))                                                    /* check the answer */
+    {
+        *out_len = 0;                                                                      /* nothing */
+
+        return 1;                                                                          /* timeout */
+    }
+    memcpy(out_buf, buf, len);                                                             /* copy the answer */
+    *out_len = len;                                                                        /* set the length */
+
+    return 0;                                                                              /* success return 0 */
+}
+
+/**
+ * @brief      virtual contactless bit transceiver
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_bits input bit length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[out] *out_bits pointer to a received bit length buffer
+ * @param[out] *collision pointer to a collision position buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no response
+ * @note       it only runs the anti collision frames, every ready card whose uid part of the cascade level begins with the sent bits
+ *             answers and a collided bit is received as 1
+ */
+uint8_t mifare_classic_virtual_contactless_bit_transceiver(uint8_t *in_buf, uint8_t in_bits, uint8_t *out_buf,
+                                                           uint8_t *out_bits, uint8_t *collision)
+{
+    uint8_t i;
+    uint8_t j;
+    uint8_t k;
+    uint8_t known;
+    uint8_t bit;
+    uint8_t value;
+    uint8_t pos;
+    uint8_t answered;
+    uint8_t match[MIFARE_CLASSIC_VIRTUAL_FIELD_MAX_CARD];
+    uint8_t uid[MIFARE_CLASSIC_VIRTUAL_FIELD_MAX_CARD][5];
+
+    if ((in_buf == NULL) || (out_buf == NULL) || (out_bits == NULL) || (collision == NULL))            /* check the params */
+    {
+        return 1;                                                                                      /* return error */
+    }
+    *out_bits = 0;                                                                                     /* nothing */
+    if ((in_bits < 16) || ((in_buf[0] != 0x93) && (in_buf[0] != 0x95)))                                /* only the cl1 anti collision */
+    {
+        return 1;                                                                                      /* no answer */
+    }
+    known = (uint8_t)((((in_buf[1] >> 4) - 2) * 8) + (in_buf[1] & 0x07));                              /* get the known bits */
+    if ((known >= 40) || (in_bits != (16 + known)))                                                    /* check the nvb */
+    {
+        return 1;                                                                                      /* no answer */
+    }
+
+    answered = 0;                                                                                      /* init 0 */
+    for (i = 0; i < gs_field_count; i++)                                                               /* all cards hear the frame */
+    {
+        gs_field[i]->frame_count++;                                                                    /* count the frame */
+        match[i] = 0;                                                                                  /* init 0 */
+        if ((gs_field[i]->state != MIFARE_CLASSIC_VIRTUAL_CARD_STATE_READY) ||
+            (a_virtual_level_uid(gs_field[i], in_buf[0], uid[i]) == 0))                                /* only the ready cards of the level */
+        {
+            continue;                                                                                  /* silent card */
+        }
+        match[i] = 1;                                                                                  /* flag the card */
+        for (k = 0; k < known; k++)                                                                    /* check the sent bits */
+        {
+            if (((uid[i][k / 8] >> (k % 8)) & 0x01) != ((in_buf[2 + k / 8] >> (k % 8)) & 0x01))        /* check one bit */
+            {
+                match[i] = 0;                                                                          /* other uid */
+                
+                break;                                                                                 /* break */
+            }
+        }
+        answered = (uint8_t)(answered + match[i]);                                                     /* count the answer */
+    }
+    if (answered == 0)                                                                                 /* check the answer */
+    {
+        return 1;                                                                                      /* no answer */
+    }
+
+    *out_bits = (uint8_t)(40 - known);                                                                 /* set the received bits */
+    *collision = *out_bits;                                                                            /* no collision */
+    memset(out_buf, 0, (known % 8 + *out_bits + 7) / 8);                                               /* clear the buffer */
+    for (k = known; k < 40; k++)                                                                       /* send the other bits */
+    {
+        bit = 0;                                                                                       /* init 0 */
+        value = 0xFF;                                                                                  /* no value */
+        for (j = 0; j < gs_field_count; j++)                                                           /* all answering cards */
+        {
+            if (match[j] == 0)                                                                         /* check the card */
+            {
+                continue;                                                                              /* next */
+            }
+            bit |= (uint8_t)((uid[j][k / 8] >> (k % 8)) & 0x01);                                       /* modulated bit */
+            if ((value != 0xFF) && (value != ((uid[j][k / 8] >> (k % 8)) & 0x01)) &&
+                (*collision == *out_bits))                                                             /* first collision */
+            {
+                *collision = (uint8_t)(k - known);                                                     /* save the position */
+            }
+            value = (uid[j][k / 8] >> (k % 8)) & 0x01;                                                 /* save the value */
+        }
+        pos = (uint8_t)((known % 8) + (k - known));                                                    /* received bit position */
+        out_buf[pos / 8] |= (uint8_t)(bit << (pos % 8));                                               /* set the bit */
+    }
+
+    return 0;                                                                                          /* success return 0 */
+}
+
+/**
+ * @brief      virtual contactless submit
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[in]  out_len output buffer length
+ * @return     status code
+ *             - 0 success
+ *             - 1 busy
+ * @note       the exchange runs at once and is reported by mifare_classic_virtual_contactless_poll
+ */
+uint8_t mifare_classic_virtual_contactless_submit(uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t out_len)
+{
+    if (gs_submit_pending != 0)                                                                                     /* check the pending exchange */
+    {
+        return 1;                                                                                                   /* return error */
+    }
+    
+    gs_submit_len = out_len;                                                                                        /* set the buffer size */
+    gs_submit_res = mifare_classic_virtual_contactless_transceiver(in_buf, in_len, out_buf, &gs_submit_len);        /* run the exchange */
+    gs_submit_pending = 1;                                                                                          /* flag finished */
+    
+    return 0;                                                                                                       /* success return 0 */
+}
+
+/**
+ * @brief      virtual contactless poll
+ * @param[out] *res pointer to a result buffer
+ * @param[out] *out_len pointer to a received length buffer
+ * @return     1 if a submitted exchange is finished, 0 if nothing is pending
+ * @note       none
+ */
+uint8_t mifare_classic_virtual_contactless_poll(uint8_t *res, uint8_t *out_len)
+{
+    if (gs_submit_pending == 0)        /* check the pending exchange */
+    {
+        return 0;                      /* nothing */
+    }
+    
+    *res = gs_submit_res;              /* get the result */
+    *out_len = gs_submit_len;          /* get the length */
+    gs_submit_pending = 0;             /* clear the flag */
+    
+    return 1;                          /* finished */
+}
+
+/**
+ * @brief         virtual contactless batch
+ * @param[in,out] *frame pointer to a frame array
+ * @param[in]     count frame number
+ * @return        status code
+ *                - 0 success
+ *                - 1 frame is NULL
+ * @note          frames with out_len 0 expect no answer, so a timeout is a success for them
+ */
+uint8_t mifare_classic_virtual_contactless_batch(mifare_classic_frame_t *frame, uint8_t count)
+{
+    uint8_t i;
+    uint8_t expect;
+    
+    if (frame == NULL)                                                                                             /* check the frame */
+    {
+        return 1;                                                                                                  /* return error */
+    }
+    
+    gs_batch_count++;                                                                                              /* count the submission */
+    for (i = 0; i < count; i++)                                                                                    /* run all frames */
+    {
+        expect = frame[i].out_len;                                                                                 /* save the expected length */
+        frame[i].res = mifare_classic_virtual_contactless_transceiver(frame[i].in_buf, frame[i].in_len,
+                                                                      frame[i].out_buf, &frame[i].out_len);        /* run the frame */
+        if (expect == 0)                                                                                           /* no answer is expected */
+        {
+            frame[i].res = 0;                                                                                      /* timeout is ok */
+        }
+    }
+    
+    return 0;                                                                                                      /* success return 0 */
+}
+
+/**
+ * @brief  get the virtual batch submission counter
+ * @return batch submission counter
+ * @note   none
+ */
+uint32_t mifare_classic_virtual_contactless_batch_count(void)
+{
+    return gs_batch_count;        /* return the counter */
+}
+
+/**
+ * @brief     virtual delay ms
+ * @param[in] ms time
+ * @note      it returns at once and only moves the virtual clock
+ */
+void mifare_classic_virtual_delay_ms(uint32_t ms)
+{
+    gs_clock_ms += ms;                                                  /* move the clock */
+    if ((gs_arrival != NULL) && (gs_clock_ms >= gs_arrival_ms))         /* check the arrival */
+    {
+        (void)mifare_classic_virtual_card_insert(gs_arrival);           /* put into the field */
+        gs_arrival = NULL;                                              /* clear the arrival */
+    }
+}
+
+/**
+ * @brief  get the virtual clock
+ * @return virtual time in ms
+ * @note   none
+ */
+uint32_t mifare_classic_virtual_timestamp_ms(void)
+{
+    return gs_clock_ms;        /* return the clock */
+}
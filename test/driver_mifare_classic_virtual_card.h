@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_virtual_card.h
+ * @brief     driver mifare classic virtual card header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_MIFARE_CLASSIC_VIRTUAL_CARD_H
+#define DRIVER_MIFARE_CLASSIC_VIRTUAL_CARD_H
+
+#include "driver_mifare_classic_interface.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup mifare_classic_virtual_card_driver mifare classic virtual card driver function
+ * @brief    mifare classic virtual card driver modules
+ * @ingroup  mifare_classic_driver
+ * @{
+ */
+
+/**
+ * @brief mifare classic virtual card max block definition
+ */
+#define MIFARE_CLASSIC_VIRTUAL_CARD_MAX_BLOCK        256        /**< s70 has 256 blocks */
+#define MIFARE_CLASSIC_VIRTUAL_FIELD_MAX_CARD        4          /**< max cards in the field */
+
+/**
+ * @brief mifare_classic virtual card state enumeration definition
+ */
+typedef enum
+{
+    MIFARE_CLASSIC_VIRTUAL_CARD_STATE_IDLE          = 0x00,        /**< idle state */
+    MIFARE_CLASSIC_VIRTUAL_CARD_STATE_READY         = 0x01,        /**< ready state */
+    MIFARE_CLASSIC_VIRTUAL_CARD_STATE_ACTIVE        = 0x02,        /**< active state */
+    MIFARE_CLASSIC_VIRTUAL_CARD_STATE_AUTHENTICATED = 0x03,        /**< authenticated state */
+    MIFARE_CLASSIC_VIRTUAL_CARD_STATE_HALT          = 0x04,        /**< halt state */
+} mifare_classic_virtual_card_state_t;
+
+/**
+ * @brief mifare_classic virtual card structure definition
+ */
+typedef struct mifare_classic_virtual_card_s
+{
+    uint8_t type;                                                  /**< card type */
+    uint8_t uid[7];                                                /**< card uid */
+    uint8_t uid_len;                                               /**< uid length, 4 or 7 */
+    uint8_t level;                                                 /**< cascade level */
+    uint8_t block[MIFARE_CLASSIC_VIRTUAL_CARD_MAX_BLOCK][16];      /**< card memory */
+    uint8_t state;                                                 /**< iso14443 state */
+    uint8_t halted;                                                /**< woken up from the halt state flag */
+    uint8_t auth_sector;                                           /**< authenticated sector */
+    uint8_t auth_key;                                              /**< authenticated key type */
+    uint8_t pending_command;                                       /**< command waiting for its second part */
+    uint8_t pending_block;                                         /**< block of the pending command */
+    uint8_t transfer_valid;                                        /**< transfer buffer valid flag */
+    uint8_t transfer_buf[16];                                      /**< transfer buffer */
+    uint32_t frame_count;                                          /**< received frame counter */
+} mifare_classic_virtual_card_t;
+
+/**
+ * @brief      initialize a virtual card with the transport configuration
+ * @param[out] *card pointer to a virtual card structure
+ * @param[in]  type card type
+ * @param[in]  *uid pointer to an uid buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 type is invalid
+ *             - 2 card is NULL
+ * @note       all keys are 0xFFFFFFFFFFFF and all access bits are FF 07 80
+ */
+uint8_t mifare_classic_virtual_card_init(mifare_classic_virtual_card_t *card, mifare_classic_type_t type, uint8_t uid[4]);
+
+/**
+ * @brief     give a virtual card a double size uid
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] *uid pointer to a 7 bytes uid buffer
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card answers in two cascade levels like a 7 bytes uid ev1 card
+ */
+uint8_t mifare_classic_virtual_card_set_double_uid(mifare_classic_virtual_card_t *card, uint8_t uid[7]);
+
+/**
+ * @brief     put a virtual card into the field
+ * @param[in] *card pointer to a virtual card structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card enters the idle state
+ */
+uint8_t mifare_classic_virtual_card_insert(mifare_classic_virtual_card_t *card);
+
+/**
+ * @brief  remove the virtual card from the field
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_card_remove(void);
+
+/**
+ * @brief     put one more virtual card into the field
+ * @param[in] *card pointer to a virtual card structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 field is full
+ *            - 2 card is NULL
+ * @note      the cards answer together and the different answers collide
+ */
+uint8_t mifare_classic_virtual_card_add(mifare_classic_virtual_card_t *card);
+
+/**
+ * @brief     put a virtual card into the field after a while
+ * @param[in] *card pointer to a virtual card structure
+ * @param[in] ms arrival delay on the virtual clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 card is NULL
+ * @note      the card arrives during the mifare_classic_virtual_delay_ms which reaches the time
+ */
+uint8_t mifare_classic_virtual_card_insert_later(mifare_classic_virtual_card_t *card, uint32_t ms);
+
+/**
+ * @brief     enable or disable the crc handling of the virtual reader
+ * @param[in] enable bool value
+ * @return    status code
+ *            - 0 success
+ * @note      when it is enabled, the virtual reader appends and checks the crc like a reader
+ *            which is used with mifare_classic_set_crc_offload
+ */
+uint8_t mifare_classic_virtual_card_set_reader_crc(mifare_classic_bool_t enable);
+
+/**
+ * @brief  virtual contactless init
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_contactless_init(void);
+
+/**
+ * @brief  virtual contactless deinit
+ * @return status code
+ *         - 0 success
+ * @note   none
+ */
+uint8_t mifare_classic_virtual_contactless_deinit(void);
+
+/**
+ * @brief         virtual contactless transceiver
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 no response
+ * @note          it behaves like a reader with the cards in the field and answers at memory speed,
+ *                the atqa of several cards is merged and other different answers are a collision error
+ */
+uint8_t mifare_classic_virtual_contactless_transceiver(uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len);
+
+/**
+ * @brief      virtual contactless bit transceiver
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_bits input bit length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[out] *out_bits pointer to a received bit length buffer
+ * @param[out] *collision pointer to a collision position buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no response
+ * @note       it only runs the anti collision frames, every ready card whose uid part of the cascade level begins with the sent bits
+ *             answers and a collided bit is received as 1
+ */
+uint8_t mifare_classic_virtual_contactless_bit_transceiver(uint8_t *in_buf, uint8_t in_bits, uint8_t *out_buf,
+                                                           uint8_t *out_bits, uint8_t *collision);
+
+/**
+ * @brief      virtual contactless submit
+ * @param[in]  *in_buf pointer to an input buffer
+ * @param[in]  in_len input length
+ * @param[out] *out_buf pointer to an output buffer
+ * @param[in]  out_len output buffer length
+ * @return     status code
+ *             - 0 success
+ *             - 1 busy
+ * @note       the exchange runs at once and is reported by mifare_classic_virtual_contactless_poll
+ */
+uint8_t mifare_classic_virtual_contactless_submit(uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t out_len);
+
+/**
+ * @brief      virtual contactless poll
+ * @param[out] *res pointer to a result buffer
+ * @param[out] *out_len pointer to a received length buffer
+ * @return     1 if a submitted exchange is finished, 0 if nothing is pending
+ * @note       none
+ */
+uint8_t mifare_classic_virtual_contactless_poll(uint8_t *res, uint8_t *out_len);
+
+/**
+ * @brief         virtual contactless batch
+ * @param[in,out] *frame pointer to a frame array
+ * @param[in]     count frame number
+ * @return        status code
+ *                - 0 success
+ *                - 1 frame is NULL
+ * @note          frames with out_len 0 expect no answer, so a timeout is a success for them
+ */
+uint8_t mifare_classic_virtual_contactless_batch(mifare_classic_frame_t *frame, uint8_t count);
+
+/**
+ * @brief  get the virtual batch submission counter
+ * @return batch submission counter
+ * @note   none
+ */
+uint32_t mifare_classic_virtual_contactless_batch_count(void);
+
+/**
+ * @brief     virtual delay ms
+ * @param[in] ms time
+ * @note      it returns at once and only moves the virtual clock
+ */
+void mifare_classic_virtual_delay_ms(uint32_t ms);
+
+/**
+ * @brief  get the virtual clock
+ * @return virtual time in ms
+ * @note   none
+ */
+uint32_t mifare_classic_virtual_timestamp_ms(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
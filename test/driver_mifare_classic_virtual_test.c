@@ -0,0 +1,2517 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_mifare_classic_virtual_test.c
+ * @brief     driver mifare classic virtual test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2022-06-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2022/06/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_mifare_classic_virtual_test.h"
+#include "driver_mifare_classic_keyring.h"
+#include "driver_mifare_classic_cache.h"
+#include "driver_mifare_classic_purse.h"
+#include "driver_mifare_classic_tap.h"
+#include "driver_mifare_classic_plan.h"
+#include "driver_mifare_classic_poll.h"
+#include "driver_mifare_classic_trace.h"
+
+static mifare_classic_handle_t gs_handle;                                  /**< mifare_classic handle */
+static mifare_classic_virtual_card_t gs_card;                              /**< virtual card */
+static mifare_classic_virtual_card_t gs_wallet[3];                         /**< cards in one wallet */
+static uint8_t gs_async_count;                                             /**< async callback counter */
+static uint16_t gs_dump_block;                                             /**< dumped block counter */
+static uint16_t gs_dump_error;                                             /**< dump error counter */
+static uint8_t gs_image[2][64 * 16];                                       /**< target and last known card image */
+static uint8_t gs_ticket[16];                                              /**< ticket block of the tap */
+static mifare_classic_trace_record_t gs_record[8];                         /**< recorded frames */
+static mifare_classic_trace_record_t gs_replay[8];                         /**< replayed frames */
+static uint8_t gs_trace_buf[8 * MIFARE_CLASSIC_TRACE_MAX_RECORD_SIZE];     /**< encoded trace */
+static mifare_classic_handle_t gs_reader[2];                               /**< handles of two readers */
+static uint32_t gs_reader_frame[2];                                        /**< frame counter of each reader */
+#if (MIFARE_CLASSIC_STATS != 0)
+static uint32_t gs_stats_call;                                             /**< timestamp call counter */
+#endif
+
+/**
+ * @brief     make gs_card and put it into the field
+ * @param[in] type card type
+ * @param[in] *uid pointer to an uid buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 make failed
+ * @note      the blocks of gs_card can be changed after the card is in the field
+ */
+static uint8_t a_virtual_card_make(mifare_classic_type_t type, uint8_t uid[4])
+{
+    if (mifare_classic_virtual_card_init(&gs_card, type, uid) != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: virtual card init failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_insert(&gs_card);
+    
+    return 0;
+}
+
+/**
+ * @brief      make gs_card, put it into the field and select it with gs_handle
+ * @param[in]  type card type
+ * @param[in]  *uid pointer to an uid buffer
+ * @param[out] *id pointer to an id buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 select failed
+ * @note       the request must report the card type and the anti collision must report the uid
+ */
+static uint8_t a_virtual_card_select(mifare_classic_type_t type, uint8_t uid[4], uint8_t id[4])
+{
+    mifare_classic_type_t type_check;
+    
+    if (a_virtual_card_make(type, uid) != 0)
+    {
+        return 1;
+    }
+    if ((mifare_classic_request(&gs_handle, &type_check) != 0) || (type_check != type) ||
+        (mifare_classic_anticollision_cl1(&gs_handle, id) != 0) || (memcmp(id, uid, 4) != 0) ||
+        (mifare_classic_select_cl1(&gs_handle, id) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: select failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     run the test on one virtual card
+ * @param[in] type card type
+ * @param[in] sector test sector
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+static uint8_t a_virtual_test_card(mifare_classic_type_t type, uint8_t sector)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t addr;
+    uint8_t first;
+    uint8_t last;
+    uint8_t block;
+    int32_t value_check;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t key_wrong[6];
+    uint8_t key_check[6];
+    uint8_t data[16];
+    uint8_t data_check[16];
+    uint8_t sector_buf[16 * 16];
+    uint32_t frame_count;
+    uint8_t count;
+    uint8_t block_0_0_4;
+    uint8_t block_1_5_9;
+    uint8_t block_2_10_14;
+    uint8_t block_3_15;
+    uint8_t user_data;
+    uint8_t key_b[6];
+    mifare_classic_type_t type_check;
+    
+    /* make the card */
+    uid[0] = 0x12;
+    uid[1] = 0x34;
+    uid[2] = 0x56;
+    uid[3] = (uint8_t)type;
+    if (a_virtual_card_select(type, uid, id) != 0)
+    {
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: find %s card.\n", (type == MIFARE_CLASSIC_TYPE_S70) ? "S70" : "S50");
+    mifare_classic_interface_debug_print("mifare_classic: id is 0x%02X 0x%02X 0x%02X 0x%02X.\n",
+                                         id[0], id[1], id[2], id[3]);
+    
+    /* get the sector range */
+    res = mifare_classic_sector_first_block(&gs_handle, sector, &first);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: first block failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_sector_last_block(&gs_handle, sector, &last);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: last block failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: sector%d: block %d - %d.\n", sector, first, last);
+    block = first + 1;
+    
+    /* authentication with a wrong key */
+    memset(key, 0xFF, 6);
+    memset(key_wrong, 0xA5, 6);
+    res = mifare_classic_authentication(&gs_handle, id, block,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key_wrong);
+    if (res == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: wrong key is accepted.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: wrong key is rejected.\n");
+    
+    /* the card falls back to idle after the failed authentication */
+    res = mifare_classic_request(&gs_handle, &type_check);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: request failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_anticollision_cl1(&gs_handle, id);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: anti collision cl1 failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_select_cl1(&gs_handle, id);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: select cl1 failed.\n");
+        
+        return 1;
+    }
+    
+    /* key b is readable in the transport configuration and can't be used */
+    res = mifare_classic_authentication(&gs_handle, id, block,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_B, key);
+    if (res == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: readable key b is accepted.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_request(&gs_handle, &type_check);
+    (void)mifare_classic_anticollision_cl1(&gs_handle, id);
+    (void)mifare_classic_select_cl1(&gs_handle, id);
+    
+    /* authentication */
+    res = mifare_classic_authentication(&gs_handle, id, block,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authentication failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: authentication block %d ok.\n", block);
+    
+    /* the open session covers the whole sector and survives enabling the cache again */
+    frame_count = gs_card.frame_count;
+    (void)mifare_classic_set_auth_cache(&gs_handle, MIFARE_CLASSIC_BOOL_TRUE);
+    res = mifare_classic_authentication(&gs_handle, id, first,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    if ((res != 0) || (frame_count != gs_card.frame_count))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: auth cache failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: authentication is cached.\n");
+    if ((mifare_classic_get_auth_key(&gs_handle, key_check) != 0) || (memcmp(key, key_check, 6) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: get auth key failed.\n");
+        
+        return 1;
+    }
+    
+    /* write */
+    for (i = 0; i < 16; i++)
+    {
+        data[i] = (uint8_t)(i * 17 + type);
+    }
+    res = mifare_classic_write(&gs_handle, block, data);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: write failed.\n");
+        
+        return 1;
+    }
+    
+    /* read */
+    res = mifare_classic_read(&gs_handle, block, data_check);
+    if ((res != 0) || (memcmp(data, data_check, 16) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: read failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: check data ok.\n");
+    
+    /* read the whole sector with one authentication */
+    res = mifare_classic_read_sector(&gs_handle, id, sector, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key,
+                                     MIFARE_CLASSIC_BOOL_TRUE, sector_buf, &count);
+    if ((res != 0) || (count != last - first + 1) || (memcmp(&sector_buf[(block - first) * 16], data, 16) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: read sector failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: read sector %d blocks ok.\n", count);
+    
+    /* a sector beyond the card */
+    res = mifare_classic_read_sector(&gs_handle, id, (type == MIFARE_CLASSIC_TYPE_S50) ? 16 : 40,
+                                     MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key,
+                                     MIFARE_CLASSIC_BOOL_TRUE, sector_buf, &count);
+    if (res != 4)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: read sector range check failed.\n");
+        
+        return 1;
+    }
+    
+    /* value init */
+    res = mifare_classic_value_init(&gs_handle, block, 100, block);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: value init failed.\n");
+        
+        return 1;
+    }
+    
+    /* value write */
+    res = mifare_classic_value_write(&gs_handle, block, -10, block);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: value write failed.\n");
+        
+        return 1;
+    }
+    
+    /* increment */
+    res = mifare_classic_increment(&gs_handle, block, 26);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: increment failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_transfer(&gs_handle, block);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: transfer failed.\n");
+        
+        return 1;
+    }
+    
+    /* decrement */
+    res = mifare_classic_decrement(&gs_handle, block, 5);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: decrement failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_transfer(&gs_handle, block);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: transfer failed.\n");
+        
+        return 1;
+    }
+    
+    /* restore to the next block */
+    res = mifare_classic_restore(&gs_handle, block);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: restore failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_transfer(&gs_handle, block + 1);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: transfer failed.\n");
+        
+        return 1;
+    }
+    
+    /* value read */
+    res = mifare_classic_value_read(&gs_handle, block + 1, &value_check, &addr);
+    if ((res != 0) || (value_check != 11) || (addr != block))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: value read failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: read value is %d.\n", value_check);
+    
+    /* increment on a data block must be refused */
+    res = mifare_classic_write(&gs_handle, block, data);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: write failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_increment(&gs_handle, block, 1);
+    if (res == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: increment on a data block is accepted.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_request(&gs_handle, &type_check);
+    (void)mifare_classic_anticollision_cl1(&gs_handle, id);
+    (void)mifare_classic_select_cl1(&gs_handle, id);
+    res = mifare_classic_authentication(&gs_handle, id, last,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authentication failed.\n");
+        
+        return 1;
+    }
+    
+    /* set modulation */
+    res = mifare_classic_set_modulation(&gs_handle, MIFARE_CLASSIC_LOAD_MODULATION_NORMAL);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set modulation failed.\n");
+        
+        return 1;
+    }
+    
+    /* set personalized uid */
+    res = mifare_classic_set_personalized_uid(&gs_handle, MIFARE_CLASSIC_PERSONALIZED_UID_0);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set personalized uid failed.\n");
+        
+        return 1;
+    }
+    
+    /* get sector permission */
+    res = mifare_classic_get_sector_permission(&gs_handle,
+                                               sector, &block_0_0_4, &block_1_5_9,
+                                               &block_2_10_14, &block_3_15,
+                                               &user_data, key_b);
+    if ((res != 0) || (block_0_0_4 != 0) || (block_1_5_9 != 0) ||
+        (block_2_10_14 != 0) || (block_3_15 != 1))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: get sector permission failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: permission block0 block1 block2 block3 0x%02X 0x%02X 0x%02X 0x%02X.\n",
+                                         block_0_0_4, block_1_5_9, block_2_10_14, block_3_15);
+    
+    /* set sector permission, key b is not readable any more */
+    res = mifare_classic_set_sector_permission(&gs_handle, sector, key, 0x0, 0x0, 0x0, 0x3, 0x00, key);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set sector permission failed.\n");
+        
+        return 1;
+    }
+    
+    /* authentication with key b */
+    res = mifare_classic_authentication(&gs_handle, id, block,
+                                        MIFARE_CLASSIC_AUTHENTICATION_KEY_B, key);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authentication failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: authentication with key b ok.\n");
+    
+    /* halt */
+    res = mifare_classic_halt(&gs_handle);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: halt failed.\n");
+        
+        return 1;
+    }
+    if (mifare_classic_get_auth_key(&gs_handle, key_check) != 4)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: halt keeps the auth key.\n");
+        
+        return 1;
+    }
+    
+    /* a halted card ignores the request */
+    res = mifare_classic_request(&gs_handle, &type_check);
+    if (res == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: halted card answers the request.\n");
+        
+        return 1;
+    }
+    
+    /* wake up */
+    res = mifare_classic_wake_up(&gs_handle, &type_check);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: wake up failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: halt and wake up ok.\n");
+    mifare_classic_interface_debug_print("mifare_classic: %d frames are exchanged.\n", gs_card.frame_count);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief     async callback
+ * @param[in] type operation type
+ * @param[in] res operation result
+ * @note      none
+ */
+static void a_virtual_async_callback(mifare_classic_operation_type_t type, uint8_t res)
+{
+    (void)type;
+    (void)res;
+    
+    gs_async_count++;
+}
+
+/**
+ * @brief     async context callback
+ * @param[in] *context pointer to a callback counter
+ * @param[in] type operation type
+ * @param[in] res operation result
+ * @note      none
+ */
+static void a_virtual_async_callback_ctx(void *context, mifare_classic_operation_type_t type, uint8_t res)
+{
+    (void)type;
+    (void)res;
+    
+    (*(uint8_t *)context)++;
+}
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief  statistics timestamp
+ * @return modeled time in us
+ * @note   every call counts as 100 us and every frame as 1000 us, so a command without a frame takes 100 us
+ *         and a command with one frame takes 1100 us
+ */
+static uint32_t a_virtual_timestamp_us(void)
+{
+    gs_stats_call++;
+    
+    return gs_stats_call * 100 + gs_card.frame_count * 1000;
+}
+
+#endif
+
+/**
+ * @brief      wait for the async operation
+ * @param[out] *result pointer to a result buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 wait failed
+ * @note       it plays the reader interrupt by moving the finished exchange into the driver
+ */
+static uint8_t a_virtual_async_wait(uint8_t *result)
+{
+    uint8_t res;
+    uint8_t len;
+    mifare_classic_async_status_t status;
+    
+    while (1)
+    {
+        if (mifare_classic_async_poll(&gs_handle, &status, result) != 0)
+        {
+            return 1;
+        }
+        if (status == MIFARE_CLASSIC_ASYNC_STATUS_DONE)
+        {
+            return 0;
+        }
+        if (mifare_classic_virtual_contactless_poll(&res, &len) == 0)
+        {
+            return 1;
+        }
+        if (mifare_classic_async_complete(&gs_handle, res, len) != 0)
+        {
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief     dump callback
+ * @param[in] sector sector number
+ * @param[in] block block number
+ * @param[in] res read result
+ * @param[in] *data pointer to a data buffer
+ * @note      bytes 0 - 5 are skipped because key a of a trailer is read as zeros
+ */
+static void a_virtual_dump_callback(uint8_t sector, uint8_t block, uint8_t res, uint8_t *data)
+{
+    (void)sector;
+    
+    if ((res == 0) && (data != NULL) && (memcmp(&data[6], &gs_card.block[block][6], 10) == 0))
+    {
+        gs_dump_block++;
+    }
+    else
+    {
+        gs_dump_error++;
+    }
+}
+
+/**
+ * @brief  run the dump test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   sector 5 gets an unknown key and must be reported without stopping the dump
+ */
+static uint8_t a_virtual_test_dump(void)
+{
+    uint8_t res;
+    uint8_t failed;
+    uint8_t id[4];
+    uint8_t uid[4];
+    mifare_classic_key_t key[2];
+    
+    /* make the card */
+    uid[0] = 0x0D;
+    uid[1] = 0x0E;
+    uid[2] = 0x0A;
+    uid[3] = 0x0D;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S70, uid, id) != 0)
+    {
+        return 1;
+    }
+    memset(gs_card.block[23], 0x11, 6);
+    
+    /* a wrong key first and the transport key */
+    key[0].key_type = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;
+    memset(key[0].key, 0xA5, 6);
+    key[1].key_type = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;
+    memset(key[1].key, 0xFF, 6);
+    gs_dump_block = 0;
+    gs_dump_error = 0;
+    gs_card.frame_count = 0;
+    res = mifare_classic_dump(&gs_handle, id, key, 2, a_virtual_dump_callback, &failed);
+    if ((res != 0) || (failed != 1) || (gs_dump_error != 1) || (gs_dump_block != 256 - 4))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: dump failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: dump %d blocks, %d failed sector with %d frames.\n",
+                                         gs_dump_block, failed, gs_card.frame_count);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the differential update test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   only the three changed data blocks must be written and sector 6 gets an unknown key
+ */
+static uint8_t a_virtual_test_update(void)
+{
+    uint8_t res;
+    uint16_t i;
+    uint16_t written;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t outcome[64];
+    uint32_t frame;
+    mifare_classic_key_t key;
+    
+    /* make the card */
+    uid[0] = 0x44;
+    uid[1] = 0x49;
+    uid[2] = 0x46;
+    uid[3] = 0x46;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    key.key_type = MIFARE_CLASSIC_AUTHENTICATION_KEY_A;
+    memset(key.key, 0xFF, 6);
+    
+    /* the last image is the card, the target changes two sectors and one trailer */
+    memcpy(gs_image[1], gs_card.block, 64 * 16);
+    memcpy(gs_image[0], gs_image[1], 64 * 16);
+    gs_image[0][4 * 16] = 0x01;
+    gs_image[0][6 * 16 + 15] = 0x02;
+    gs_image[0][41 * 16 + 8] = 0x03;
+    gs_image[0][7 * 16] = 0x04;
+    gs_card.frame_count = 0;
+    res = mifare_classic_update(&gs_handle, id, &key, 1, 0, 64, gs_image[0], gs_image[1], outcome, &written);
+    frame = gs_card.frame_count;
+    if ((res != 0) || (written != 3) ||
+        (outcome[4] != MIFARE_CLASSIC_UPDATE_WRITTEN) || (outcome[6] != MIFARE_CLASSIC_UPDATE_WRITTEN) ||
+        (outcome[41] != MIFARE_CLASSIC_UPDATE_WRITTEN) || (outcome[5] != MIFARE_CLASSIC_UPDATE_UNCHANGED) ||
+        (outcome[0] != MIFARE_CLASSIC_UPDATE_SKIPPED) || (outcome[7] != MIFARE_CLASSIC_UPDATE_SKIPPED) ||
+        (gs_card.block[6][15] != 0x02) || (gs_card.block[41][8] != 0x03) || (gs_card.block[7][0] == 0x04) ||
+        (memcmp(gs_image[0] + 4 * 16, gs_image[1] + 4 * 16, 16) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: update failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: update wrote %d blocks with %d frames.\n", written, frame);
+    
+    /* the same image again needs no frame */
+    gs_card.frame_count = 0;
+    res = mifare_classic_update(&gs_handle, id, &key, 1, 0, 64, gs_image[0], gs_image[1], outcome, &written);
+    if ((res != 0) || (written != 0) || (gs_card.frame_count != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: update of the same image failed.\n");
+        
+        return 1;
+    }
+    
+    /* a sector without a working key */
+    memset(gs_card.block[27], 0x11, 6);
+    gs_image[0][24 * 16] = 0x05;
+    gs_image[0][25 * 16] = 0x06;
+    gs_image[0][28 * 16] = 0x07;
+    res = mifare_classic_update(&gs_handle, id, &key, 1, 0, 64, gs_image[0], gs_image[1], outcome, &written);
+    if ((res != 1) || (written != 1) || (outcome[24] != MIFARE_CLASSIC_UPDATE_FAILED) ||
+        (outcome[25] != MIFARE_CLASSIC_UPDATE_FAILED) || (outcome[28] != MIFARE_CLASSIC_UPDATE_WRITTEN))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: update of a locked sector failed.\n");
+        
+        return 1;
+    }
+    for (i = 0; i < 64; i++)
+    {
+        if ((i % 4 != 3) && (i != 24) && (i != 25) && (memcmp(gs_card.block[i], &gs_image[0][i * 16], 16) != 0))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: update block %d is wrong.\n", i);
+            
+            return 1;
+        }
+    }
+    
+    /* a range which wraps the 16 bit block counter */
+    res = mifare_classic_update(&gs_handle, id, &key, 1, 1, 0xFFFF, gs_image[0], gs_image[1], outcome, &written);
+    if (res != 6)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: wrapped update range is not refused.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the keyring test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the odd sectors use another key a and the second pass must need one attempt per sector
+ */
+static uint8_t a_virtual_test_keyring(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t pass;
+    uint8_t index;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint32_t attempt;
+    uint32_t attempt_first;
+    uint32_t success;
+    mifare_classic_keyring_t ring;
+    
+    /* make the card */
+    uid[0] = 0x4B;
+    uid[1] = 0x45;
+    uid[2] = 0x59;
+    uid[3] = 0x53;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    for (i = 1; i < 16; i += 2)
+    {
+        memset(gs_card.block[i * 4 + 3], 0x11, 6);
+    }
+    
+    /* a wrong key, the odd sector key and the transport key */
+    (void)mifare_classic_keyring_init(&ring);
+    memset(key, 0xA5, 6);
+    (void)mifare_classic_keyring_add(&ring, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    memset(key, 0x11, 6);
+    (void)mifare_classic_keyring_add(&ring, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    memset(key, 0xFF, 6);
+    (void)mifare_classic_keyring_add(&ring, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    
+    attempt_first = 0;
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < 16; i++)
+        {
+            res = mifare_classic_keyring_authentication(&gs_handle, &ring, id, (uint8_t)(i * 4), &index);
+            if ((res != 0) || (index != (((i % 2) != 0) ? 1 : 2)))
+            {
+                mifare_classic_interface_debug_print("mifare_classic: keyring authentication sector %d failed.\n", i);
+                
+                return 1;
+            }
+        }
+        (void)mifare_classic_keyring_get_statistics(&ring, &attempt, &success);
+        mifare_classic_interface_debug_print("mifare_classic: keyring pass %d, %d attempts for %d sectors.\n",
+                                             pass + 1, attempt, success);
+        if (pass == 0)
+        {
+            attempt_first = attempt;
+        }
+    }
+    if ((success != 32) || (attempt - attempt_first != 16))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: keyring memo failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the purse test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   a torn primary block must roll back to the value before the torn debit
+ */
+static uint8_t a_virtual_test_purse(void)
+{
+    uint8_t res;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    int32_t value;
+    uint32_t frame;
+    mifare_classic_bool_t recovered;
+    mifare_classic_purse_t purse;
+    
+    /* make the card */
+    uid[0] = 0x50;
+    uid[1] = 0x55;
+    uid[2] = 0x52;
+    uid[3] = 0x53;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    memset(key, 0xFF, 6);
+    if ((mifare_classic_purse_init(&purse, &gs_handle, 4, 7) != 4) ||
+        (mifare_classic_purse_init(&purse, &gs_handle, 4, 8) != 4) ||
+        (mifare_classic_purse_init(&purse, &gs_handle, 4, 64) != 4) ||
+        (mifare_classic_purse_init(&purse, &gs_handle, 4, 5) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse init failed.\n");
+        
+        return 1;
+    }
+    if (mifare_classic_purse_format(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 100) != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse format failed.\n");
+        
+        return 1;
+    }
+    
+    /* two debits */
+    gs_card.frame_count = 0;
+    res = mifare_classic_purse_debit(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 30, &value);
+    frame = gs_card.frame_count;
+    if ((res != 0) || (value != 70) ||
+        (mifare_classic_purse_debit(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 20, &value) != 0) ||
+        (value != 50) || (gs_card.block[4][0] != 50) || (gs_card.block[5][0] != 70))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse debit failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: purse debit with %d frames.\n", frame);
+    
+    /* not enough value */
+    if ((mifare_classic_purse_debit(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 51, &value) != 6) ||
+        (gs_card.block[4][0] != 50))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse overdraft failed.\n");
+        
+        return 1;
+    }
+    
+    /* a torn debit */
+    gs_card.block[4][8] ^= 0x5A;
+    res = mifare_classic_purse_read(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, &value, &recovered);
+    if ((res != 0) || (value != 70) || (recovered != MIFARE_CLASSIC_BOOL_TRUE) ||
+        (memcmp(gs_card.block[4], gs_card.block[5], 16) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse recovery failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_purse_read(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, &value, &recovered);
+    if ((res != 0) || (value != 70) || (recovered != MIFARE_CLASSIC_BOOL_FALSE))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse read failed.\n");
+        
+        return 1;
+    }
+    
+    /* both blocks torn */
+    gs_card.block[4][8] ^= 0x5A;
+    gs_card.block[5][8] ^= 0x5A;
+    if (mifare_classic_purse_debit(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 1, &value) != 5)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse broken check failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  tap timestamp
+ * @return modeled time in us
+ * @note   every frame counts as 100 us
+ */
+static uint32_t a_virtual_tap_timestamp_us(void)
+{
+    return gs_card.frame_count * 100;
+}
+
+/**
+ * @brief     tap ticket condition
+ * @param[in] *tap pointer to a tap structure
+ * @param[in] step step index
+ * @return    1 if the ticket is valid, 0 if not
+ * @note      none
+ */
+static uint8_t a_virtual_tap_ticket_valid(mifare_classic_tap_t *tap, uint8_t step)
+{
+    (void)tap;
+    (void)step;
+    
+    return (gs_ticket[0] == 0x01) ? 1 : 0;
+}
+
+/**
+ * @brief  run the tap transaction test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the debit depends on the ticket block and a failed debit jumps to the halt,
+ *         it runs in the session of the authentication step without a frame of its own
+ */
+static uint8_t a_virtual_test_tap(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t run;
+    uint8_t failed;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t log[16];
+    uint32_t total;
+    uint32_t sum;
+    mifare_classic_purse_t purse;
+    mifare_classic_tap_t tap;
+    mifare_classic_tap_report_t report;
+    
+    /* make the card with a purse of 100 and a valid ticket */
+    uid[0] = 0x54;
+    uid[1] = 0x41;
+    uid[2] = 0x50;
+    uid[3] = 0x21;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    gs_card.block[8][0] = 0x01;
+    memset(key, 0xFF, 6);
+    if ((mifare_classic_purse_init(&purse, &gs_handle, 4, 5) != 0) ||
+        (mifare_classic_purse_format(&purse, id, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, 100) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: purse format failed.\n");
+        
+        return 1;
+    }
+    
+    /* gate program */
+    memset(log, 0x4C, 16);
+    (void)mifare_classic_tap_init(&tap, &gs_handle);
+    tap.timestamp_us = a_virtual_tap_timestamp_us;
+    if ((mifare_classic_tap_add_debit(&tap, 4, 8, 30, NULL, MIFARE_CLASSIC_TAP_RULE_ABORT) != 4) ||
+        (mifare_classic_tap_add_select(&tap, MIFARE_CLASSIC_TAP_RULE_ABORT) != 0) ||
+        (mifare_classic_tap_add_authentication(&tap, 2, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, MIFARE_CLASSIC_TAP_RULE_ABORT) != 0) ||
+        (mifare_classic_tap_add_read(&tap, 8, 1, gs_ticket, MIFARE_CLASSIC_TAP_RULE_ABORT) != 0) ||
+        (mifare_classic_tap_add_authentication(&tap, 1, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, MIFARE_CLASSIC_TAP_RULE_ABORT) != 0) ||
+        (mifare_classic_tap_add_debit(&tap, 4, 5, 30, a_virtual_tap_ticket_valid, MIFARE_CLASSIC_TAP_RULE_HALT) != 0) ||
+        (mifare_classic_tap_add_write(&tap, 6, log, NULL, MIFARE_CLASSIC_TAP_RULE_CONTINUE) != 0) ||
+        (mifare_classic_tap_add_halt(&tap) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: tap program failed.\n");
+        
+        return 1;
+    }
+    
+    /* three taps pay, the fourth one has not enough value */
+    for (run = 0; run < 4; run++)
+    {
+        (void)mifare_classic_virtual_card_insert(&gs_card);
+        res = mifare_classic_tap_run(&tap, &failed, &total);
+        if (run < 3)
+        {
+            if ((res != 0) || (failed != 7) || (tap.balance != 70 - run * 30) ||
+                (memcmp(gs_card.block[6], log, 16) != 0) || (tap.report[4].time_us != 7 * 100))
+            {
+                mifare_classic_interface_debug_print("mifare_classic: tap run %d failed.\n", run + 1);
+                
+                return 1;
+            }
+            continue;
+        }
+        (void)mifare_classic_tap_get_report(&tap, 4, &report);
+        if ((res != 1) || (failed != 4) || (report.status != MIFARE_CLASSIC_TAP_STATUS_FAILED) || (report.res != 6) ||
+            (tap.report[5].status != MIFARE_CLASSIC_TAP_STATUS_NOT_RUN) ||
+            (tap.report[6].status != MIFARE_CLASSIC_TAP_STATUS_DONE) || (gs_card.block[4][0] != 10))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: tap with not enough value failed.\n");
+            
+            return 1;
+        }
+    }
+    
+    /* an invalid ticket skips the debit */
+    gs_card.block[8][0] = 0x00;
+    gs_card.block[6][0] = 0x00;
+    (void)mifare_classic_virtual_card_insert(&gs_card);
+    res = mifare_classic_tap_run(&tap, &failed, &total);
+    if ((res != 0) || (tap.report[4].status != MIFARE_CLASSIC_TAP_STATUS_SKIPPED) ||
+        (gs_card.block[6][0] != 0x4C) || (gs_card.block[4][0] != 10))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: tap with an invalid ticket failed.\n");
+        
+        return 1;
+    }
+    
+    /* the step times add up to the total */
+    sum = 0;
+    for (i = 0; i < 7; i++)
+    {
+        sum += tap.report[i].time_us;
+        mifare_classic_interface_debug_print("mifare_classic: tap step %d status %d in %d us.\n",
+                                             i, tap.report[i].status, tap.report[i].time_us);
+    }
+    if ((total == 0) || (sum != total))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: tap time failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: tap total %d us.\n", total);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the transaction planner test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   interleaved operations on three sectors must need three authentications and the
+ *         planned frames must match the card, two sectors need key b for their writes
+ */
+static uint8_t a_virtual_test_plan(void)
+{
+    uint8_t res;
+    uint8_t failed;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t key_b2[6];
+    uint8_t key_b3[6];
+    uint8_t block4[16];
+    uint8_t read[4][16];
+    uint8_t data[2][16];
+    mifare_classic_plan_cost_t cost;
+    mifare_classic_plan_t plan;
+    
+    /* make the card, sector 2 and 3 allow their writes and increments with key b only */
+    uid[0] = 0x50;
+    uid[1] = 0x4C;
+    uid[2] = 0x41;
+    uid[3] = 0x4E;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    memset(gs_card.block[4], 0x44, 16);
+    memcpy(block4, gs_card.block[4], 16);
+    memset(key, 0xFF, 6);
+    memset(key_b2, 0xB2, 6);
+    memset(key_b3, 0xB3, 6);
+    if ((mifare_classic_authentication(&gs_handle, id, 8, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_set_sector_permission(&gs_handle, 2, key, 4, 0, 0, 3, 0x69, key_b2) != 0) ||
+        (mifare_classic_authentication(&gs_handle, id, 12, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_value_init(&gs_handle, 12, 100, 12) != 0) ||
+        (mifare_classic_set_sector_permission(&gs_handle, 3, key, 6, 0, 0, 3, 0x69, key_b3) != 0) ||
+        (mifare_classic_halt(&gs_handle) != 0) ||
+        (mifare_classic_reselect(&gs_handle, id) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan card setup failed.\n");
+        
+        return 1;
+    }
+    
+    /* interleaved operations, key b of sector 1 is known but readable */
+    memset(data[0], 0x57, 16);
+    memset(data[1], 0x58, 16);
+    (void)mifare_classic_plan_init(&plan, &gs_handle);
+    if ((mifare_classic_plan_add_sector(&plan, 1, key, key, 0, 0, 0, 1) != 0) ||
+        (mifare_classic_plan_add_sector(&plan, 2, key, key_b2, 4, 0, 0, 3) != 0) ||
+        (mifare_classic_plan_add_sector(&plan, 3, key, key_b3, 6, 0, 0, 3) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_READ, 4, 0, read[0]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_READ, 8, 0, read[1]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_WRITE, 5, 0, data[0]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_DECREMENT, 12, 10, NULL) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_WRITE, 9, 0, data[1]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_READ, 6, 0, read[2]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_WRITE, 8, 0, data[0]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_INCREMENT, 12, 5, NULL) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_READ, 13, 0, read[3]) != 0) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_READ, 7, 0, read[3]) != 4) ||
+        (mifare_classic_plan_add(&plan, MIFARE_CLASSIC_PLAN_OP_WRITE, 10, 0, NULL) != 4))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan add failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_plan_build(&plan, &cost);
+    if ((res != 0) || (plan.group_count != 3) || (cost.auth != 3) || (cost.naive_auth != 9) ||
+        (cost.frame != 19) || (cost.naive_frame != 25) || (cost.time_us >= cost.naive_time_us) ||
+        (plan.group[0].key_type != MIFARE_CLASSIC_AUTHENTICATION_KEY_A) ||
+        (plan.group[1].key_type != MIFARE_CLASSIC_AUTHENTICATION_KEY_B) ||
+        (plan.group[2].key_type != MIFARE_CLASSIC_AUTHENTICATION_KEY_B) ||
+        (plan.order[0] != 0) || (plan.order[1] != 2) || (plan.order[2] != 5) || (plan.order[3] != 1))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan build failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: plan %d auth %d frames %d us, naive %d auth %d frames %d us.\n",
+                                         cost.auth, cost.frame, cost.time_us,
+                                         cost.naive_auth, cost.naive_frame, cost.naive_time_us);
+    
+    /* run with the estimated frames */
+    gs_card.frame_count = 0;
+    res = mifare_classic_plan_run(&plan, id, &failed);
+    if ((res != 0) || (failed != 0) || (gs_card.frame_count != cost.frame) ||
+        (memcmp(read[0], block4, 16) != 0) || (memcmp(gs_card.block[5], data[0], 16) != 0) ||
+        (memcmp(gs_card.block[8], data[0], 16) != 0) || (memcmp(gs_card.block[9], data[1], 16) != 0) ||
+        (gs_card.block[12][0] != 95) || (plan.op[8].status != MIFARE_CLASSIC_PLAN_STATUS_DONE))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan run failed.\n");
+        
+        return 1;
+    }
+    
+    /* the open session keeps its sector first and needs no authentication */
+    res = mifare_classic_plan_build(&plan, &cost);
+    if ((res != 0) || (plan.group[0].sector != 2) || (cost.auth != 2))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan with an open session failed.\n");
+        
+        return 1;
+    }
+    
+    /* no key allows the write without key b */
+    if ((mifare_classic_plan_add_sector(&plan, 2, key, NULL, 4, 0, 0, 3) != 0) ||
+        (mifare_classic_plan_build(&plan, &cost) != 5) || (plan.denied != 6) ||
+        (mifare_classic_plan_run(&plan, id, &failed) != 3))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: plan denied check failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the block cache test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   three read-modify-write cycles must need one card read and the flush one write per dirty block
+ */
+static uint8_t a_virtual_test_cache(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t data[16];
+    uint32_t hit;
+    uint32_t miss;
+    uint32_t rf_write;
+    mifare_classic_cache_t cache;
+    
+    /* make the card */
+    uid[0] = 0x43;
+    uid[1] = 0x41;
+    uid[2] = 0x43;
+    uid[3] = 0x48;
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    (void)mifare_classic_cache_init(&cache, &gs_handle);
+    (void)mifare_classic_cache_begin(&cache, id);
+    memset(key, 0xFF, 6);
+    
+    /* read-modify-write cycles on one block */
+    for (i = 0; i < 3; i++)
+    {
+        if ((mifare_classic_cache_read(&cache, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 0) ||
+            (data[0] != i))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: cache read failed.\n");
+            
+            return 1;
+        }
+        data[0]++;
+        if (mifare_classic_cache_write(&cache, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: cache write failed.\n");
+            
+            return 1;
+        }
+    }
+    memset(data, 0x55, 16);
+    if ((mifare_classic_cache_write(&cache, 8, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 0) ||
+        (mifare_classic_cache_write(&cache, 5, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 0) ||
+        (mifare_classic_cache_write(&cache, 7, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 4) ||
+        (mifare_classic_cache_write(&cache, 0, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 4))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: cache write failed.\n");
+        
+        return 1;
+    }
+    if ((gs_card.block[4][0] != 0) || (gs_card.block[5][0] != 0) || (gs_card.block[8][0] != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: cache wrote through.\n");
+        
+        return 1;
+    }
+    
+    /* flush */
+    res = mifare_classic_cache_flush(&cache);
+    (void)mifare_classic_cache_get_statistics(&cache, &hit, &miss, &rf_write);
+    if ((res != 0) || (hit != 2) || (miss != 1) || (rf_write != 3) ||
+        (gs_card.block[4][0] != 3) || (gs_card.block[5][0] != 0x55) || (gs_card.block[8][0] != 0x55))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: cache flush failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: cache %d hits, %d misses and %d card writes.\n",
+                                         hit, miss, rf_write);
+    
+    /* abort */
+    memset(data, 0x66, 16);
+    (void)mifare_classic_cache_write(&cache, 9, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data);
+    (void)mifare_classic_cache_abort(&cache);
+    res = mifare_classic_cache_flush(&cache);
+    (void)mifare_classic_cache_get_statistics(&cache, &hit, &miss, &rf_write);
+    if ((res != 0) || (rf_write != 3) || (gs_card.block[9][0] != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: cache abort failed.\n");
+        
+        return 1;
+    }
+    
+    /* card loss */
+    (void)mifare_classic_cache_write(&cache, 10, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data);
+    (void)mifare_classic_halt(&gs_handle);
+    (void)mifare_classic_virtual_card_remove();
+    if ((mifare_classic_cache_flush(&cache) != 5) ||
+        (mifare_classic_cache_read(&cache, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key, data) != 3))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: cache discard failed.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  run the enumerate test on several virtual cards
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the uids collide at different bits and all cards must be found in one call
+ */
+static uint8_t a_virtual_test_enumerate(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t j;
+    uint8_t count;
+    uint8_t found;
+    uint8_t data[16];
+    uint8_t key[6];
+    uint8_t id[4];
+    uint32_t frame;
+    mifare_classic_type_t type;
+    mifare_classic_uid_t card[4];
+    const uint8_t uid[3][7] = {{0x11, 0x22, 0x33, 0x44}, {0x11, 0x22, 0x33, 0x45}, {0x04, 0x91, 0x22, 0x33, 0x44, 0x55, 0x66}};
+    const uint8_t len[3] = {4, 4, 7};
+    
+    /* make the wallet */
+    for (i = 0; i < 3; i++)
+    {
+        res = mifare_classic_virtual_card_init(&gs_wallet[i], MIFARE_CLASSIC_TYPE_S50, (uint8_t *)uid[i]);
+        if (res != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: virtual card init failed.\n");
+            
+            return 1;
+        }
+    }
+    (void)mifare_classic_virtual_card_set_double_uid(&gs_wallet[2], (uint8_t *)uid[2]);
+    (void)mifare_classic_virtual_card_insert(&gs_wallet[0]);
+    (void)mifare_classic_virtual_card_add(&gs_wallet[1]);
+    (void)mifare_classic_virtual_card_add(&gs_wallet[2]);
+    
+    /* the byte oriented anti collision can't split the cards */
+    res = mifare_classic_enumerate(&gs_handle, card, 4, &count);
+    if ((res != 0) || (count != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: byte oriented enumerate failed.\n");
+        
+        return 1;
+    }
+    
+    /* the bit oriented anti collision finds all cards */
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER(&gs_handle, mifare_classic_virtual_contactless_bit_transceiver);
+    (void)mifare_classic_virtual_card_insert(&gs_wallet[0]);
+    (void)mifare_classic_virtual_card_add(&gs_wallet[1]);
+    (void)mifare_classic_virtual_card_add(&gs_wallet[2]);
+    res = mifare_classic_enumerate(&gs_handle, card, 4, &count);
+    if ((res != 0) || (count != 3))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: bit oriented enumerate failed.\n");
+        
+        return 1;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        found = 0;
+        for (j = 0; j < count; j++)
+        {
+            if ((card[j].len == len[i]) && (memcmp(card[j].uid, uid[i], len[i]) == 0))
+            {
+                found = 1;
+            }
+        }
+        if (found == 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: card %d is not found.\n", i);
+            
+            return 1;
+        }
+    }
+    mifare_classic_interface_debug_print("mifare_classic: enumerate found %d cards.\n", count);
+    
+    /* talk to one card of the wallet */
+    memset(key, 0xFF, 6);
+    if ((mifare_classic_wake_up(&gs_handle, &type) != 0) ||
+        (mifare_classic_select_cl1(&gs_handle, (uint8_t *)uid[1]) != 0) ||
+        (mifare_classic_authentication(&gs_handle, (uint8_t *)uid[1], 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_read(&gs_handle, 4, data) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: wallet card read failed.\n");
+        
+        return 1;
+    }
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER(&gs_handle, NULL);
+    
+    /* a double size uid card alone needs one pass and authenticates with its last 4 bytes */
+    (void)mifare_classic_virtual_card_insert(&gs_wallet[2]);
+    if ((mifare_classic_request(&gs_handle, &type) != 0) ||
+        (mifare_classic_select(&gs_handle, &card[0]) != 0) ||
+        (card[0].len != 7) || (memcmp(card[0].uid, uid[2], 7) != 0) ||
+        (mifare_classic_uid_to_id(&card[0], id) != 0) ||
+        (mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_read(&gs_handle, 4, data) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: double size uid card read failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: double size uid card sak 0x%02X.\n", card[0].sak);
+    
+    /* a failed authentication drops the card and the reselect skips the anti collision */
+    memset(key, 0xA5, 6);
+    if (mifare_classic_authentication(&gs_handle, id, 8, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: wrong key is accepted.\n");
+        
+        return 1;
+    }
+    frame = gs_wallet[2].frame_count;
+    memset(key, 0xFF, 6);
+    if ((mifare_classic_reselect(&gs_handle, id) != 0) ||
+        (gs_wallet[2].frame_count - frame != 3) ||
+        (mifare_classic_authentication(&gs_handle, id, 8, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_read(&gs_handle, 8, data) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: double size uid card reselect failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: reselect with wake up and 2 select frames.\n");
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the card state test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the commands which the card can't accept must fail without a frame
+ */
+static uint8_t a_virtual_test_state(void)
+{
+    uint8_t sector;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t data[16];
+    uint32_t frame;
+    mifare_classic_type_t type;
+    mifare_classic_card_state_t state;
+    mifare_classic_authentication_key_t key_type;
+    
+    /* make the card */
+    uid[0] = 0x53;
+    uid[1] = 0x54;
+    uid[2] = 0x41;
+    uid[3] = 0x54;
+    memset(key, 0xFF, 6);
+    
+    /* read before the authentication */
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    frame = gs_card.frame_count;
+    (void)mifare_classic_get_state(&gs_handle, &state, &sector, &key_type);
+    if ((state != MIFARE_CLASSIC_CARD_STATE_ACTIVE) || (mifare_classic_read(&gs_handle, 4, data) != 1) ||
+        (gs_card.frame_count != frame))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: read before authentication is sent.\n");
+        
+        return 1;
+    }
+    
+    /* read another sector */
+    if (mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authentication failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_get_state(&gs_handle, &state, &sector, &key_type);
+    if ((state != MIFARE_CLASSIC_CARD_STATE_AUTHENTICATED) || (sector != 1) ||
+        (key_type != MIFARE_CLASSIC_AUTHENTICATION_KEY_A))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authenticated state is wrong.\n");
+        
+        return 1;
+    }
+    frame = gs_card.frame_count;
+    if ((mifare_classic_read(&gs_handle, 8, data) != 1) || (gs_card.frame_count != frame) ||
+        (mifare_classic_read(&gs_handle, 5, data) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: read of another sector is sent.\n");
+        
+        return 1;
+    }
+    
+    /* authentication after the halt */
+    (void)mifare_classic_halt(&gs_handle);
+    frame = gs_card.frame_count;
+    if ((mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 1) ||
+        (gs_card.frame_count != frame))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: authentication after halt is sent.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_request(&gs_handle, &type);
+    (void)mifare_classic_get_state(&gs_handle, &state, &sector, &key_type);
+    if (state != MIFARE_CLASSIC_CARD_STATE_HALT)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: halted card answers the request.\n");
+        
+        return 1;
+    }
+    if ((mifare_classic_reselect(&gs_handle, id) != 0) ||
+        (mifare_classic_get_state(&gs_handle, &state, &sector, &key_type) != 0) ||
+        (state != MIFARE_CLASSIC_CARD_STATE_ACTIVE))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: reselect state is wrong.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief      run one traced tap
+ * @param[out] *data pointer to a data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 tap failed
+ * @note       none
+ */
+static uint8_t a_virtual_trace_tap(uint8_t data[16])
+{
+    uint8_t id[4];
+    uint8_t key[6];
+    mifare_classic_type_t type;
+    mifare_classic_uid_t uid;
+    
+    memset(key, 0xFF, 6);
+    if ((mifare_classic_request(&gs_handle, &type) != 0) ||
+        (mifare_classic_select(&gs_handle, &uid) != 0) ||
+        (mifare_classic_uid_to_id(&uid, id) != 0) ||
+        (mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+        (mifare_classic_read(&gs_handle, 5, data) != 0))
+    {
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  run the trace test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the replayed tap must run without the card and get the recorded data
+ */
+static uint8_t a_virtual_test_trace(void)
+{
+    uint8_t res;
+    uint8_t uid[4];
+    uint8_t data[16];
+    uint8_t check[16];
+    uint16_t pos;
+    uint16_t mismatch;
+    uint8_t len;
+    uint32_t used;
+    mifare_classic_trace_t trace;
+    mifare_classic_trace_t replay;
+    mifare_classic_trace_record_t record;
+    
+    /* make the card */
+    uid[0] = 0x54;
+    uid[1] = 0x52;
+    uid[2] = 0x43;
+    uid[3] = 0x45;
+    if (a_virtual_card_make(MIFARE_CLASSIC_TYPE_S50, uid) != 0)
+    {
+        return 1;
+    }
+    gs_card.block[5][0] = 0xA5;
+    
+    /* record */
+    (void)mifare_classic_trace_init(&trace, gs_record, 8);
+    trace.timestamp_ms = mifare_classic_virtual_timestamp_ms;
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER(&gs_handle, mifare_classic_virtual_contactless_bit_transceiver);
+    res = mifare_classic_trace_start(&gs_handle, &trace);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BIT_TRANSCEIVER(&gs_handle, NULL);
+    if (res != 4)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: trace misses the bit frames.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_trace_start(&gs_handle, &trace);
+    res = a_virtual_trace_tap(data);
+    (void)mifare_classic_trace_stop(&gs_handle);
+    if ((res != 0) || (trace.count == 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: traced tap failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_trace_encode(&trace, gs_trace_buf, sizeof(gs_trace_buf), &used);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: trace encode failed.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: %d frames in %d bytes.\n", trace.count, used);
+    
+    /* replay without the card */
+    (void)mifare_classic_virtual_card_remove();
+    (void)mifare_classic_trace_init(&replay, gs_replay, 8);
+    res = mifare_classic_trace_decode(&replay, gs_trace_buf, used);
+    if ((res != 0) || (replay.count != trace.count))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: trace decode failed.\n");
+        
+        return 1;
+    }
+    
+    /* a reply which does not fit the buffer is refused */
+    (void)mifare_classic_trace_get(&replay, 0, &record);
+    len = (uint8_t)(record.out_len - 1);
+    (void)mifare_classic_trace_replay_start(&gs_handle, &replay);
+    res = mifare_classic_transceiver(&gs_handle, record.in_buf, record.in_len, check, &len);
+    (void)mifare_classic_trace_replay_get_status(&replay, &pos, &mismatch);
+    (void)mifare_classic_trace_stop(&gs_handle);
+    if ((res != 1) || (len != 0) || (mismatch != 1))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: replayed reply overruns the buffer.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_trace_replay_start(&gs_handle, &replay);
+    res = a_virtual_trace_tap(check);
+    (void)mifare_classic_trace_replay_get_status(&replay, &pos, &mismatch);
+    (void)mifare_classic_trace_stop(&gs_handle);
+    if ((res != 0) || (memcmp(data, check, 16) != 0) || (pos != replay.count) || (mismatch != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: replayed tap is different.\n");
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief     reader context init
+ * @param[in] *context pointer to a frame counter
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+static uint8_t a_virtual_reader_init(void *context)
+{
+    *(uint32_t *)context = 0;
+    
+    return mifare_classic_virtual_contactless_init();
+}
+
+/**
+ * @brief     reader context deinit
+ * @param[in] *context pointer to a frame counter
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+static uint8_t a_virtual_reader_deinit(void *context)
+{
+    (void)context;
+    
+    return mifare_classic_virtual_contactless_deinit();
+}
+
+/**
+ * @brief         reader context transceiver
+ * @param[in]     *context pointer to a frame counter
+ * @param[in]     *in_buf pointer to an input buffer
+ * @param[in]     in_len input length
+ * @param[out]    *out_buf pointer to an output buffer
+ * @param[in,out] *out_len pointer to an output length buffer
+ * @return        status code
+ *                - 0 success
+ *                - 1 no response
+ * @note          all readers share the virtual field and only count their own frames
+ */
+static uint8_t a_virtual_reader_transceiver(void *context, uint8_t *in_buf, uint8_t in_len, uint8_t *out_buf, uint8_t *out_len)
+{
+    (*(uint32_t *)context)++;
+    
+    return mifare_classic_virtual_contactless_transceiver(in_buf, in_len, out_buf, out_len);
+}
+
+/**
+ * @brief  run the context test with two readers
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   one set of context callbacks drives two handles and every frame must reach the context of its handle
+ */
+static uint8_t a_virtual_test_context(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t data[16];
+    uint32_t frame[2];
+    mifare_classic_type_t type;
+    mifare_classic_trace_t trace[2];
+    mifare_classic_trace_record_t record[2][8];
+    
+    /* make the card */
+    uid[0] = 0x43;
+    uid[1] = 0x54;
+    uid[2] = 0x58;
+    uid[3] = 0x31;
+    if (a_virtual_card_make(MIFARE_CLASSIC_TYPE_S50, uid) != 0)
+    {
+        return 1;
+    }
+    memset(key, 0xFF, 6);
+    
+    /* link and init both readers */
+    for (i = 0; i < 2; i++)
+    {
+        DRIVER_MIFARE_CLASSIC_LINK_INIT(&gs_reader[i], mifare_classic_handle_t);
+        DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(&gs_reader[i], &gs_reader_frame[i]);
+        DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT_CTX(&gs_reader[i], a_virtual_reader_init);
+        DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT_CTX(&gs_reader[i], a_virtual_reader_deinit);
+        DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER_CTX(&gs_reader[i], a_virtual_reader_transceiver);
+        DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&gs_reader[i], mifare_classic_virtual_delay_ms);
+        DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_reader[i], mifare_classic_interface_debug_print);
+        res = mifare_classic_init(&gs_reader[i]);
+        if (res != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d init failed.\n", i);
+            
+            return 1;
+        }
+    }
+    
+    /* one tap with each reader */
+    for (i = 0; i < 2; i++)
+    {
+        (void)mifare_classic_virtual_card_insert(&gs_card);
+        if ((mifare_classic_request(&gs_reader[i], &type) != 0) ||
+            (mifare_classic_anticollision_cl1(&gs_reader[i], id) != 0) ||
+            (mifare_classic_select_cl1(&gs_reader[i], id) != 0) ||
+            (mifare_classic_authentication(&gs_reader[i], id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key) != 0) ||
+            (mifare_classic_read(&gs_reader[i], 4, data) != 0) ||
+            (mifare_classic_halt(&gs_reader[i]) != 0))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d tap failed.\n", i);
+            
+            return 1;
+        }
+        if (gs_reader_frame[1 - i] != ((i == 0) ? 0 : gs_reader_frame[0]))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d frame is counted by the other reader.\n", i);
+            
+            return 1;
+        }
+    }
+    mifare_classic_interface_debug_print("mifare_classic: reader frames %d and %d.\n", gs_reader_frame[0], gs_reader_frame[1]);
+    
+    /* one trace on each reader */
+    for (i = 0; i < 2; i++)
+    {
+        (void)mifare_classic_trace_init(&trace[i], record[i], 8);
+        if (mifare_classic_trace_start(&gs_reader[i], &trace[i]) != 0)
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d trace start failed.\n", i);
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < 2; i++)
+    {
+        frame[i] = gs_reader_frame[i];
+        (void)mifare_classic_virtual_card_insert(&gs_card);
+        (void)mifare_classic_request(&gs_reader[i], &type);
+        frame[i] = gs_reader_frame[i] - frame[i];
+    }
+    for (i = 0; i < 2; i++)
+    {
+        (void)mifare_classic_trace_stop(&gs_reader[i]);
+        if ((frame[i] == 0) || (trace[i].count != frame[i]) || (gs_reader[i].context != &gs_reader_frame[i]))
+        {
+            mifare_classic_interface_debug_print("mifare_classic: reader %d trace is wrong.\n", i);
+            
+            return 1;
+        }
+    }
+    for (i = 0; i < 2; i++)
+    {
+        (void)mifare_classic_deinit(&gs_reader[i]);
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+#if (MIFARE_CLASSIC_STATS != 0)
+
+/**
+ * @brief  run the latency statistics test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   every command must be counted once and the rejected ones as failures
+ */
+static uint8_t a_virtual_test_stats(void)
+{
+    uint8_t res;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t data[16];
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t p99_us;
+    mifare_classic_stats_t stats;
+    
+    /* make the card */
+    uid[0] = 0x53;
+    uid[1] = 0x54;
+    uid[2] = 0x41;
+    uid[3] = 0x53;
+    memset(key, 0xFF, 6);
+    gs_stats_call = 0;
+    DRIVER_MIFARE_CLASSIC_LINK_TIMESTAMP_US(&gs_handle, a_virtual_timestamp_us);
+    (void)mifare_classic_reset_stats(&gs_handle);
+    
+    /* one tap with a rejected read */
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    (void)mifare_classic_read(&gs_handle, 4, data);
+    (void)mifare_classic_authentication(&gs_handle, id, 4, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    (void)mifare_classic_read(&gs_handle, 4, data);
+    (void)mifare_classic_read(&gs_handle, 5, data);
+    (void)mifare_classic_halt(&gs_handle);
+    
+    /* check the counters */
+    res = mifare_classic_get_stats(&gs_handle, &stats);
+    if ((res != 0) || (stats.command[MIFARE_CLASSIC_STATS_COMMAND_REQUEST].count != 1) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_SELECT].count != 1) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_AUTHENTICATION].count != 1) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].count != 3) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].failure[1] != 1) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].timed != 3) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_HALT].count != 1) || (stats.crc_error != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: statistics counters are wrong.\n");
+        
+        return 1;
+    }
+    
+    /* the rejected read has no frame, the other two have one */
+    res = mifare_classic_stats_latency(&stats, MIFARE_CLASSIC_STATS_COMMAND_READ, &min_us, &avg_us, &max_us, &p99_us);
+    if ((res != 0) || (min_us != 100) || (avg_us != 766) || (max_us != 1100) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].histogram[7] != 1) ||
+        (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].histogram[11] != 2) || (p99_us < 1024) || (p99_us > max_us))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: statistics latency is wrong.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: read min %d us avg %d us max %d us p99 %d us.\n",
+                                         min_us, avg_us, max_us, p99_us);
+    
+    /* reset */
+    (void)mifare_classic_reset_stats(&gs_handle);
+    (void)mifare_classic_get_stats(&gs_handle, &stats);
+    if (stats.command[MIFARE_CLASSIC_STATS_COMMAND_READ].count != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: statistics reset failed.\n");
+        
+        return 1;
+    }
+    DRIVER_MIFARE_CLASSIC_LINK_TIMESTAMP_US(&gs_handle, NULL);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+#endif
+
+#if ((MIFARE_CLASSIC_LOG_DEFERRED != 0) && (MIFARE_CLASSIC_LOG_LEVEL >= MIFARE_CLASSIC_LOG_LEVEL_ERROR))
+
+/**
+ * @brief  run the deferred log test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   a rejected command must record one event and a full ring must drop the oldest events
+ */
+static uint8_t a_virtual_test_log(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t data[16];
+    uint32_t dropped;
+    mifare_classic_log_entry_t entry;
+    
+    /* make the card */
+    uid[0] = 0x4C;
+    uid[1] = 0x4F;
+    uid[2] = 0x47;
+    uid[3] = 0x53;
+    (void)mifare_classic_log_flush(&gs_handle, &dropped);
+    
+    /* a read without authentication is rejected */
+    if (a_virtual_card_select(MIFARE_CLASSIC_TYPE_S50, uid, id) != 0)
+    {
+        return 1;
+    }
+    (void)mifare_classic_read(&gs_handle, 4, data);
+    res = mifare_classic_log_read(&gs_handle, &entry);
+    if ((res != 0) || (entry.event != MIFARE_CLASSIC_EVENT_STATE_INVALID) ||
+        (entry.arg != MIFARE_CLASSIC_OPERATION_READ))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: log event is wrong.\n");
+        
+        return 1;
+    }
+    if (mifare_classic_log_read(&gs_handle, &entry) != 1)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: log is not empty.\n");
+        
+        return 1;
+    }
+    
+    /* overflow the ring */
+    for (i = 0; i < MIFARE_CLASSIC_LOG_DEPTH + 2; i++)
+    {
+        (void)mifare_classic_read(&gs_handle, 4, data);
+    }
+    res = mifare_classic_log_flush(&gs_handle, &dropped);
+    if ((res != 0) || (dropped != 2) || (mifare_classic_log_read(&gs_handle, &entry) != 1))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: log flush failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_halt(&gs_handle);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+#endif
+
+/**
+ * @brief  run the poll test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   the idle poll must back off and the poll after a card leaves must be aggressive
+ */
+static uint8_t a_virtual_test_poll(void)
+{
+    uint8_t res;
+    uint8_t uid[4];
+    uint32_t last;
+    uint32_t max;
+    uint32_t avg;
+    uint32_t fixed;
+    mifare_classic_type_t type;
+    mifare_classic_poll_t poll;
+    mifare_classic_uid_t found;
+    
+    /* make the card */
+    uid[0] = 0x50;
+    uid[1] = 0x4F;
+    uid[2] = 0x4C;
+    uid[3] = 0x4C;
+    if (a_virtual_card_make(MIFARE_CLASSIC_TYPE_S50, uid) != 0)
+    {
+        return 1;
+    }
+    (void)mifare_classic_virtual_card_remove();
+    
+    /* fixed poll */
+    res = mifare_classic_poll_init(&poll, MIFARE_CLASSIC_POLL_MODE_FIXED, 20, 200, 2000);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: poll init failed.\n");
+        
+        return 1;
+    }
+    poll.timestamp_ms = mifare_classic_virtual_timestamp_ms;
+    (void)mifare_classic_virtual_card_insert_later(&gs_card, 50);
+    res = mifare_classic_poll_search(&gs_handle, &poll, &type, &found, 10);
+    if ((res != 0) || ((found.len != 4) || (memcmp(found.uid, uid, 4) != 0)))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: fixed poll search failed.\n");
+        
+        return 1;
+    }
+    fixed = poll.latency_last_ms;
+    mifare_classic_interface_debug_print("mifare_classic: fixed poll latency %dms.\n", fixed);
+    (void)mifare_classic_virtual_card_remove();
+    
+    /* the idle adaptive poll backs off to the slow interval */
+    res = mifare_classic_poll_init(&poll, MIFARE_CLASSIC_POLL_MODE_ADAPTIVE, 20, 200, 2000);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: poll init failed.\n");
+        
+        return 1;
+    }
+    poll.timestamp_ms = mifare_classic_virtual_timestamp_ms;
+    res = mifare_classic_poll_search(&gs_handle, &poll, &type, &found, 10);
+    if ((res != 1) || (poll.interval_ms != 200))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: idle poll back off failed.\n");
+        
+        return 1;
+    }
+    
+    /* a card arrives */
+    (void)mifare_classic_virtual_card_insert_later(&gs_card, 1000);
+    res = mifare_classic_poll_search(&gs_handle, &poll, &type, &found, 100);
+    if ((res != 0) || (poll.latency_last_ms > 200))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: adaptive poll search failed.\n");
+        
+        return 1;
+    }
+    
+    /* the card leaves and comes back at once */
+    (void)mifare_classic_virtual_card_remove();
+    (void)mifare_classic_virtual_card_insert_later(&gs_card, 50);
+    res = mifare_classic_poll_search(&gs_handle, &poll, &type, &found, 100);
+    if ((res != 0) || (poll.latency_last_ms > 20) || (poll.latency_last_ms >= fixed))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: aggressive poll search failed.\n");
+        
+        return 1;
+    }
+    (void)mifare_classic_poll_get_latency(&poll, &last, &max, &avg);
+    mifare_classic_interface_debug_print("mifare_classic: adaptive poll latency last %dms max %dms avg %dms.\n",
+                                         last, max, avg);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  run the async test on one virtual card
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   none
+ */
+static uint8_t a_virtual_test_async(void)
+{
+    uint8_t res;
+    uint8_t i;
+    uint8_t result;
+    uint8_t block;
+    uint8_t addr;
+    uint8_t count;
+    int32_t value;
+    uint8_t id[4];
+    uint8_t uid[4];
+    uint8_t key[6];
+    uint8_t data[16];
+    uint8_t data_check[16];
+    mifare_classic_type_t type;
+    
+    /* make the card */
+    uid[0] = 0xA5;
+    uid[1] = 0x5A;
+    uid[2] = 0x01;
+    uid[3] = 0x02;
+    if (a_virtual_card_make(MIFARE_CLASSIC_TYPE_S50, uid) != 0)
+    {
+        return 1;
+    }
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_SUBMIT(&gs_handle, mifare_classic_virtual_contactless_submit);
+    DRIVER_MIFARE_CLASSIC_LINK_ASYNC_CALLBACK(&gs_handle, a_virtual_async_callback);
+    gs_async_count = 0;
+    block = 12;
+    for (i = 0; i < 6; i++)
+    {
+        key[i] = 0xFF;
+    }
+    for (i = 0; i < 16; i++)
+    {
+        data[i] = (uint8_t)(0x80 + i);
+    }
+    
+    /* request */
+    res = mifare_classic_async_request(&gs_handle, &type);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0) || (type != MIFARE_CLASSIC_TYPE_S50))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async request failed.\n");
+        
+        return 1;
+    }
+    
+    /* anti collision cl1 */
+    res = mifare_classic_async_anticollision_cl1(&gs_handle, id);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0) || (memcmp(id, uid, 4) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async anti collision cl1 failed.\n");
+        
+        return 1;
+    }
+    
+    /* select cl1 */
+    res = mifare_classic_async_select_cl1(&gs_handle, id);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async select cl1 failed.\n");
+        
+        return 1;
+    }
+    
+    /* authentication */
+    res = mifare_classic_async_authentication(&gs_handle, id, block, MIFARE_CLASSIC_AUTHENTICATION_KEY_A, key);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async authentication failed.\n");
+        
+        return 1;
+    }
+    
+    /* write */
+    res = mifare_classic_async_write(&gs_handle, block, data);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async write failed.\n");
+        
+        return 1;
+    }
+    
+    /* read and a second start while busy */
+    res = mifare_classic_async_read(&gs_handle, block, data_check);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async read failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_async_read(&gs_handle, block, data_check);
+    if (res != 4)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: busy operation is not refused.\n");
+        
+        return 1;
+    }
+    if ((a_virtual_async_wait(&result) != 0) || (result != 0) || (memcmp(data, data_check, 16) != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async read failed.\n");
+        
+        return 1;
+    }
+    
+    /* value init, increment and transfer */
+    res = mifare_classic_async_value_init(&gs_handle, block + 1, 100, block + 1);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async value init failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_async_increment(&gs_handle, block + 1, 23);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async increment failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_async_transfer(&gs_handle, block + 1);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async transfer failed.\n");
+        
+        return 1;
+    }
+    res = mifare_classic_async_value_read(&gs_handle, block + 1, &value, &addr);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0) || (value != 123) || (addr != block + 1))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async value read failed.\n");
+        
+        return 1;
+    }
+    
+    /* check the callback */
+    if (gs_async_count != 10)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async callback count is %d.\n", gs_async_count);
+        
+        return 1;
+    }
+    
+    /* the context callback is used instead */
+    count = 0;
+    DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(&gs_handle, &count);
+    DRIVER_MIFARE_CLASSIC_LINK_ASYNC_CALLBACK_CTX(&gs_handle, a_virtual_async_callback_ctx);
+    res = mifare_classic_async_read(&gs_handle, block, data_check);
+    if ((res != 0) || (a_virtual_async_wait(&result) != 0) || (result != 0) || (count != 1) || (gs_async_count != 10))
+    {
+        mifare_classic_interface_debug_print("mifare_classic: async context callback failed.\n");
+        
+        return 1;
+    }
+    DRIVER_MIFARE_CLASSIC_LINK_ASYNC_CALLBACK_CTX(&gs_handle, NULL);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTEXT(&gs_handle, NULL);
+    
+    /* nothing is busy */
+    res = mifare_classic_async_complete(&gs_handle, 0, 0);
+    if (res != 4)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: idle complete is not refused.\n");
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: async operations ok.\n");
+    mifare_classic_interface_debug_print("mifare_classic: %d frames are exchanged.\n", gs_card.frame_count);
+    (void)mifare_classic_virtual_card_remove();
+    
+    return 0;
+}
+
+/**
+ * @brief  virtual card test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   it runs all driver functions against a virtual s50 and s70 card without any reader
+ */
+uint8_t mifare_classic_virtual_test(void)
+{
+    uint8_t res;
+    mifare_classic_type_t type;
+    
+    /* link function */
+    DRIVER_MIFARE_CLASSIC_LINK_INIT(&gs_handle, mifare_classic_handle_t);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_INIT(&gs_handle, mifare_classic_virtual_contactless_init);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_DEINIT(&gs_handle, mifare_classic_virtual_contactless_deinit);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_TRANSCEIVER(&gs_handle, mifare_classic_virtual_contactless_transceiver);
+    DRIVER_MIFARE_CLASSIC_LINK_DELAY_MS(&gs_handle, mifare_classic_virtual_delay_ms);
+    DRIVER_MIFARE_CLASSIC_LINK_DEBUG_PRINT(&gs_handle, mifare_classic_interface_debug_print);
+    
+    /* start virtual test */
+    mifare_classic_interface_debug_print("mifare_classic: start virtual test.\n");
+    
+    /* init */
+    res = mifare_classic_init(&gs_handle);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: init failed.\n");
+        
+        return 1;
+    }
+    
+    /* auth cache */
+    res = mifare_classic_set_auth_cache(&gs_handle, MIFARE_CLASSIC_BOOL_TRUE);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set auth cache failed.\n");
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* empty field */
+    (void)mifare_classic_virtual_card_remove();
+    res = mifare_classic_request(&gs_handle, &type);
+    if (res == 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: empty field answers the request.\n");
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* s50 test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card test.\n");
+    res = a_virtual_test_card(MIFARE_CLASSIC_TYPE_S50, 1);
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* s70 test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S70 card test.\n");
+    res = a_virtual_test_card(MIFARE_CLASSIC_TYPE_S70, 33);
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* crc offload test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card with reader crc test.\n");
+    (void)mifare_classic_virtual_card_set_reader_crc(MIFARE_CLASSIC_BOOL_TRUE);
+    res = mifare_classic_set_crc_offload(&gs_handle, MIFARE_CLASSIC_BOOL_TRUE);
+    if (res != 0)
+    {
+        mifare_classic_interface_debug_print("mifare_classic: set crc offload failed.\n");
+        (void)mifare_classic_virtual_card_set_reader_crc(MIFARE_CLASSIC_BOOL_FALSE);
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    res = a_virtual_test_card(MIFARE_CLASSIC_TYPE_S50, 2);
+    (void)mifare_classic_virtual_card_set_reader_crc(MIFARE_CLASSIC_BOOL_FALSE);
+    (void)mifare_classic_set_crc_offload(&gs_handle, MIFARE_CLASSIC_BOOL_FALSE);
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* batch test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card with batch transceiver test.\n");
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BATCH(&gs_handle, mifare_classic_virtual_contactless_batch);
+    res = a_virtual_test_card(MIFARE_CLASSIC_TYPE_S50, 3);
+    DRIVER_MIFARE_CLASSIC_LINK_CONTACTLESS_BATCH(&gs_handle, NULL);
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    mifare_classic_interface_debug_print("mifare_classic: %d batch submissions.\n", mifare_classic_virtual_contactless_batch_count());
+    
+    /* dump test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S70 card dump test.\n");
+    res = a_virtual_test_dump();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* update test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card differential update test.\n");
+    res = a_virtual_test_update();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* keyring test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card keyring test.\n");
+    res = a_virtual_test_keyring();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* cache test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card block cache test.\n");
+    res = a_virtual_test_cache();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* purse test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card purse test.\n");
+    res = a_virtual_test_purse();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* tap test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card tap transaction test.\n");
+    res = a_virtual_test_tap();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* plan test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card transaction plan test.\n");
+    res = a_virtual_test_plan();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* enumerate test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 wallet enumerate test.\n");
+    res = a_virtual_test_enumerate();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* state test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card state test.\n");
+    res = a_virtual_test_state();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* trace test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card trace test.\n");
+    res = a_virtual_test_trace();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* context test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card context test.\n");
+    res = a_virtual_test_context();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+#if (MIFARE_CLASSIC_STATS != 0)
+    /* statistics test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card statistics test.\n");
+    res = a_virtual_test_stats();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+#endif
+#if ((MIFARE_CLASSIC_LOG_DEFERRED != 0) && (MIFARE_CLASSIC_LOG_LEVEL >= MIFARE_CLASSIC_LOG_LEVEL_ERROR))
+    /* deferred log test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card deferred log test.\n");
+    res = a_virtual_test_log();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+#endif
+    /* poll test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card poll test.\n");
+    res = a_virtual_test_poll();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* async test */
+    mifare_classic_interface_debug_print("mifare_classic: virtual S50 card async test.\n");
+    res = a_virtual_test_async();
+    if (res != 0)
+    {
+        (void)mifare_classic_deinit(&gs_handle);
+        
+        return 1;
+    }
+    
+    /* finish virtual test */
+    mifare_classic_interface_debug_print("mifare_classic: finish virtual test.\n");
+    (void)mifare_classic_deinit(&gs_handle);
+    
+    return 0;
+}